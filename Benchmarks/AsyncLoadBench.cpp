@@ -0,0 +1,296 @@
+/* Benchmark do carregamento assíncrono (AssetLoader.h) contra o carregamento bloqueante
+ *
+ * Carrega a cena inteira de Modelos3D/Novos (todos os .obj, os materiais e as texturas
+ * citadas nos .mtl, mais o atlas TexturasOffice.png) de duas formas:
+ *   - bloqueante: como o main() dos exemplos, tudo é lido e enviado à OpenGL antes
+ *                 do primeiro frame (CachedMesh::load, glBufferData, stbi_load e
+ *                 glTexImage2D na thread do contexto)
+ *   - assíncrona: AssetLoader; a janela desenha desde o primeiro frame e cada
+ *                 objeto aparece quando fica pronto, com update() limitado por frame
+ * e mede o tempo até o primeiro frame, o tempo até a cena completa, o pior frame
+ * (o maior "engasgo") enquanto a cena chega e o maior tempo de envio em um frame. Usa
+ * uma janela invisível; funciona também com Mesa llvmpipe.
+ *
+ * Com "frio" os caches das malhas (.cgmesh) são ignorados: o parsing, a otimização e os
+ * níveis de detalhe entram na conta, como na primeira execução de um exemplo.
+ *
+ * Uso: AsyncLoadBench [frio] [orçamento de envio por frame em KB]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+//STB_IMAGE
+#include <stb_image.h>
+
+//Classe gerenciadora de shaders
+#include "Shader.h"
+#include "FrameData.h"
+#include "MeshCache.h"
+#include "MeshBuffers.h"
+#include "AssetLoader.h"
+#include "DrawList.h"
+#include "Timing.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+const string MODELS = "../Modelos3D/Novos/";
+
+// Objeto da cena: malha e textura por material, já na GPU
+struct SceneObject
+{
+	GLuint VAO = 0;
+	vector<Submesh> submeshes;
+	vector<GLuint> textures; // por material (0: atlas)
+	glm::mat4 model = glm::mat4(1);
+};
+
+struct LoadResult
+{
+	double firstFrameMs = 0.0;
+	double completeMs = 0.0;
+	double worstFrameMs = 0.0;
+	double worstUploadMs = 0.0; // maior tempo gasto enviando dados em um frame
+	int frames = 0;
+};
+
+static void drawScene(Shader& shader, const vector<SceneObject>& objects, GLuint atlas)
+{
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	shader.Use();
+	for (const SceneObject& object : objects)
+	{
+		if (object.VAO == 0)
+			continue;
+		glUniformMatrix4fv(shader.uniform("model"), 1, GL_FALSE, glm::value_ptr(object.model));
+		glBindVertexArray(object.VAO);
+		for (const Submesh& submesh : object.submeshes)
+		{
+			GLuint texture = submesh.material >= 0 && submesh.material < (int)object.textures.size() ? object.textures[submesh.material] : 0;
+			glBindTexture(GL_TEXTURE_2D, texture != 0 ? texture : atlas);
+			glDrawElements(GL_TRIANGLES, submesh.indexCount, GL_UNSIGNED_INT, (GLvoid*)(submesh.firstIndex * sizeof(GLuint)));
+		}
+	}
+	glBindVertexArray(0);
+	glFinish(); // o frame só conta quando a GPU termina
+}
+
+static GLuint uploadTexture(const string& path)
+{
+	int width, height, channels;
+	unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+	if (!data)
+		return 0;
+	GLuint texID;
+	glGenTextures(1, &texID);
+	glBindTexture(GL_TEXTURE_2D, texID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	stbi_image_free(data);
+	return texID;
+}
+
+// Cada objeto em uma casa de uma grade, para todos aparecerem na câmera
+static glm::mat4 placement(size_t i)
+{
+	return glm::translate(glm::mat4(1), glm::vec3((float)(i % 4) * 3.0f - 4.5f, 0.0f, -(float)(i / 4) * 3.0f));
+}
+
+static LoadResult loadBlocking(const vector<string>& paths, bool useCache, Shader& shader)
+{
+	LoadResult result;
+	auto start = Clock::now();
+	vector<SceneObject> objects(paths.size());
+	GLuint atlas = uploadTexture(MODELS + "TexturasOffice.png");
+	vector<GLuint> created = { atlas };
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		CachedMesh mesh;
+		SceneMesh sceneMesh;
+		if (!loadSceneMesh(paths[i], mesh, sceneMesh, useCache))
+			continue;
+		SceneObject& object = objects[i];
+		object.VAO = sceneMesh.VAO;
+		object.submeshes = sceneMesh.submeshes;
+		object.model = placement(i);
+
+		for (const Material& material : sceneMesh.materials)
+		{
+			object.textures.push_back(material.mapKd.empty() ? 0 : uploadTexture(material.mapKd));
+			created.push_back(object.textures.back());
+		}
+	}
+	result.completeMs = elapsedMs(start);
+
+	auto frameStart = Clock::now();
+	drawScene(shader, objects, atlas);
+	result.worstFrameMs = elapsedMs(frameStart);
+	result.firstFrameMs = elapsedMs(start);
+	result.completeMs = result.firstFrameMs;
+	result.frames = 1;
+
+	for (SceneObject& object : objects)
+		glDeleteVertexArrays(1, &object.VAO);
+	glDeleteTextures((GLsizei)created.size(), created.data());
+	return result;
+}
+
+static LoadResult loadAsync(const vector<string>& paths, bool useCache, size_t budget, Shader& shader)
+{
+	LoadResult result;
+	auto start = Clock::now();
+	AssetLoader loader(budget);
+	TextureHandle atlas = loader.loadTexture(MODELS + "TexturasOffice.png");
+	vector<MeshHandle> meshes;
+	for (const string& path : paths)
+		meshes.push_back(loader.loadMesh(path, useCache));
+
+	vector<SceneObject> objects(paths.size());
+	vector<vector<TextureHandle>> materialTextures(paths.size());
+	vector<bool> placed(paths.size(), false);
+	bool complete = false;
+	while (!complete)
+	{
+		auto frameStart = Clock::now();
+		loader.update();
+		result.worstUploadMs = max(result.worstUploadMs, elapsedMs(frameStart));
+
+		// Objetos prontos entram na cena; as texturas dos materiais são pedidas
+		// quando a malha (e o .mtl) termina de carregar
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			if (placed[i] || !meshes[i]->ready())
+				continue;
+			if (materialTextures[i].empty())
+				for (const Material& material : meshes[i]->materials)
+					materialTextures[i].push_back(material.mapKd.empty() ? nullptr : loader.loadTexture(material.mapKd));
+			SceneObject& object = objects[i];
+			object.VAO = meshes[i]->VAO;
+			object.submeshes = meshes[i]->submeshes;
+			object.model = placement(i);
+			placed[i] = true;
+		}
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			objects[i].textures.resize(materialTextures[i].size(), 0);
+			for (size_t m = 0; m < materialTextures[i].size(); m++)
+				if (materialTextures[i][m] && materialTextures[i][m]->ready())
+					objects[i].textures[m] = materialTextures[i][m]->texID;
+		}
+		drawScene(shader, objects, atlas->ready() ? atlas->texID : 0);
+
+		double frameMs = elapsedMs(frameStart);
+		result.frames++;
+		if (result.frames == 1)
+			result.firstFrameMs = elapsedMs(start);
+		result.worstFrameMs = max(result.worstFrameMs, frameMs);
+
+		complete = loader.pending() == 0;
+		for (const MeshHandle& mesh : meshes)
+			complete = complete && mesh->done();
+	}
+	result.completeMs = elapsedMs(start);
+
+	for (const MeshHandle& mesh : meshes)
+		mesh->destroy();
+	atlas->destroy();
+	for (auto& textures : materialTextures)
+		for (const TextureHandle& texture : textures)
+			if (texture)
+				texture->destroy();
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	bool cold = argc > 1 && strcmp(argv[1], "frio") == 0;
+	size_t budget = argc > 2 ? (size_t)max(1, atoi(argv[2])) * 1024 : ASSET_UPLOAD_BUDGET;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(512, 512, "AsyncLoadBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+
+	vector<string> paths;
+	for (auto& entry : filesystem::directory_iterator(MODELS))
+		if (entry.is_regular_file() && entry.path().extension() == ".obj")
+			paths.push_back(entry.path().string());
+	sort(paths.begin(), paths.end());
+
+	// Sem "frio", garante que os caches existam antes das duas medições
+	if (!cold)
+	{
+		for (const string& path : paths)
+		{
+			CachedMesh mesh;
+			mesh.load(path);
+		}
+	}
+
+	Shader shader("../Hello3D- Texturas/phong.vs", "../Hello3D- Texturas/phong.fs");
+	shader.Use();
+	glUniform1i(shader.uniform("texBuffer"), 0);
+	DrawList::applyMaterial(shader, DrawList::defaultMaterial());
+	glActiveTexture(GL_TEXTURE0);
+
+	FrameUniforms frameUniforms;
+	frameUniforms.create();
+	FrameData frameData;
+	frameData.cameraPos = glm::vec4(0.0f, 6.0f, 8.0f, 1.0f);
+	frameData.view = glm::lookAt(glm::vec3(frameData.cameraPos), glm::vec3(0.0f, 0.0f, -2.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	frameData.projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+	frameData.lightPos = glm::vec4(-2.0f, 10.0f, 3.0f, 1.0f);
+	frameUniforms.update(frameData);
+	glEnable(GL_DEPTH_TEST);
+	glViewport(0, 0, 512, 512);
+
+	cout << paths.size() << " malhas de " << MODELS << (cold ? " sem cache" : " com cache")
+		<< ", envio de " << budget / 1024 << " KB por frame" << endl;
+	cout << fixed << setprecision(1);
+	cout << setw(14) << "modo" << setw(16) << "1o frame ms" << setw(16) << "completa ms"
+		<< setw(16) << "pior frame ms" << setw(16) << "pior envio ms" << setw(10) << "frames" << endl;
+	LoadResult blocking = loadBlocking(paths, !cold, shader);
+	cout << setw(14) << "bloqueante" << setw(16) << blocking.firstFrameMs << setw(16) << blocking.completeMs
+		<< setw(16) << blocking.firstFrameMs << setw(16) << blocking.completeMs << setw(10) << blocking.frames << endl;
+	LoadResult async = loadAsync(paths, !cold, budget, shader);
+	cout << setw(14) << "assincrona" << setw(16) << async.firstFrameMs << setw(16) << async.completeMs
+		<< setw(16) << async.worstFrameMs << setw(16) << async.worstUploadMs << setw(10) << async.frames << endl;
+	cout << "(no modo bloqueante a janela fica parada até o primeiro frame, então o pior frame é ele)" << endl;
+
+	frameUniforms.destroy();
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,215 @@
+/* Benchmark do frustum culling com a BVH da cena (SceneBVH.h)
+ *
+ * Espalha N cópias (100 mil por padrão) das malhas de Modelos3D em um terreno de
+ * 2 x 2 km, com rotação e escala aleatórias, e move a câmera em círculo por alguns
+ * frames. Em cada frame as cópias são testadas contra o frustum de várias formas:
+ *   - força bruta, esfera: um teste de esfera por cópia (o mínimo sem hierarquia)
+ *   - força bruta, caixa: um teste de caixa (com os 6 planos) por cópia
+ *   - BVH, folhas escalares: a SceneBVH com as caixas das folhas testadas uma a uma
+ *   - BVH, folhas SIMD: a SceneBVH com 8 caixas por teste (AVX, ou 2 x 4 com SSE2)
+ * e mostra o tempo médio por frame, as cópias visíveis e as drawcalls puladas. O
+ * resultado da BVH é conferido com o da força bruta com caixas (devem ser iguais).
+ *
+ * Depois mede a parte dinâmica: a montagem inicial, o refit quando 10% das cópias se
+ * movem a cada frame (update + cull) e as remontagens disparadas pelo refit.
+ *
+ * Uso: CullingBench [cópias] [frames]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <filesystem>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "MeshCache.h"
+#include "SceneBVH.h"
+#include "Timing.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+struct Instance
+{
+	int mesh;
+	glm::mat4 model;
+	glm::vec4 sphere; // em coordenadas de mundo
+	AABB box;
+};
+
+int main(int argc, char** argv)
+{
+	int nInstances = argc > 1 ? max(1, atoi(argv[1])) : 100000;
+	int frames = argc > 2 ? max(1, atoi(argv[2])) : 60;
+
+	// Caixa e esfera de cada malha de Modelos3D, calculadas no carregamento
+	vector<string> names;
+	vector<MeshBounds> meshBounds;
+	vector<string> paths;
+	for (auto& entry : filesystem::recursive_directory_iterator("../Modelos3D"))
+		if (entry.is_regular_file() && entry.path().extension() == ".obj")
+			paths.push_back(entry.path().generic_string());
+	sort(paths.begin(), paths.end());
+	for (const string& path : paths)
+	{
+		CachedMesh mesh;
+		if (!mesh.load(path))
+			continue;
+		names.push_back(filesystem::path(path).filename().string());
+		meshBounds.push_back(mesh.bounds());
+	}
+	if (meshBounds.empty())
+	{
+		cout << "Nenhuma malha em ../Modelos3D" << endl;
+		return 1;
+	}
+	cout << meshBounds.size() << " malhas:";
+	for (size_t m = 0; m < names.size(); m++)
+		cout << " " << names[m] << " (raio " << fixed << setprecision(2) << meshBounds[m].sphere.w << ")";
+	cout << endl;
+
+	// Cópias espalhadas, com tamanho normalizado para uns 2 a 6 metros
+	const float worldSize = 2000.0f;
+	mt19937 rng(1234);
+	uniform_real_distribution<float> position(-0.5f * worldSize, 0.5f * worldSize), unit(0.0f, 1.0f);
+	vector<Instance> instances(nInstances);
+	for (Instance& instance : instances)
+	{
+		instance.mesh = (int)(rng() % meshBounds.size());
+		const MeshBounds& bounds = meshBounds[instance.mesh];
+		float scale = (2.0f + 4.0f * unit(rng)) / max(bounds.sphere.w, 1e-3f);
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), 40.0f * unit(rng), position(rng)));
+		model = glm::rotate(model, 6.2832f * unit(rng), glm::vec3(0.0f, 1.0f, 0.0f));
+		instance.model = glm::scale(model, glm::vec3(scale));
+		instance.sphere = glm::vec4(glm::vec3(instance.model * glm::vec4(glm::vec3(bounds.sphere), 1.0f)), bounds.sphere.w * scale);
+		instance.box = transformBounds(bounds, instance.model);
+	}
+
+	// Câmera em círculo, olhando para fora, com alcance de 500 m
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+	auto frustumAt = [&](int frame)
+	{
+		float angle = 6.2832f * frame / frames;
+		glm::vec3 eye(300.0f * cos(angle), 20.0f, 300.0f * sin(angle));
+		glm::vec3 front(-sin(angle), -0.05f, cos(angle));
+		return Frustum(projection * glm::lookAt(eye, eye + front, glm::vec3(0.0f, 1.0f, 0.0f)));
+	};
+
+	SceneBVH bvh;
+	auto t0 = Clock::now();
+	for (const Instance& instance : instances)
+		bvh.insert(instance.box);
+	bvh.rebuild();
+	double buildMs = elapsedMs(t0);
+	cout << nInstances << " copias, BVH com " << bvh.nNodes() << " nos e " << bvh.nLeaves() << " folhas, montagem "
+		<< setprecision(2) << buildMs << " ms" << endl << endl;
+
+	vector<int> visible;
+	vector<vector<int>> reference(frames);
+	struct Mode
+	{
+		const char* name;
+		function<CullStats(int)> cull;
+	};
+	vector<Mode> modes;
+	modes.push_back({ "forca bruta, esfera", [&](int frame)
+	{
+		Frustum frustum = frustumAt(frame);
+		CullStats stats;
+		visible.clear();
+		for (int i = 0; i < nInstances; i++)
+			if (frustum.testSphere(glm::vec3(instances[i].sphere), instances[i].sphere.w))
+				visible.push_back(i);
+		stats.visible = (int)visible.size();
+		stats.culled = nInstances - stats.visible;
+		return stats;
+	} });
+	modes.push_back({ "forca bruta, caixa", [&](int frame)
+	{
+		Frustum frustum = frustumAt(frame);
+		CullStats stats;
+		visible.clear();
+		for (int i = 0; i < nInstances; i++)
+			if (frustum.testAABB(instances[i].box) != FRUSTUM_OUTSIDE)
+				visible.push_back(i);
+		stats.visible = (int)visible.size();
+		stats.culled = nInstances - stats.visible;
+		return stats;
+	} });
+	for (bool simd : { false, true })
+	{
+		modes.push_back({ simd ? "BVH, folhas SIMD" : "BVH, folhas escalares", [&, simd](int frame)
+		{
+			bvh.simd = simd;
+			CullStats stats;
+			bvh.cull(frustumAt(frame), visible, &stats);
+			return stats;
+		} });
+	}
+
+	cout << setw(24) << "modo" << setw(12) << "ms/frame" << setw(12) << "visiveis" << setw(12) << "puladas"
+		<< setw(10) << "nos" << setw(14) << "folhas SIMD" << setw(16) << "folhas aceitas" << setw(12) << "conferido" << endl;
+	for (size_t m = 0; m < modes.size(); m++)
+	{
+		double totalMs = 0.0;
+		CullStats sum;
+		bool matches = true;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			auto t1 = Clock::now();
+			CullStats stats = modes[m].cull(frame);
+			totalMs += elapsedMs(t1);
+			sum.visible += stats.visible;
+			sum.culled += stats.culled;
+			sum.nodesVisited += stats.nodesVisited;
+			sum.leavesTested += stats.leavesTested;
+			sum.leavesAccepted += stats.leavesAccepted;
+			sort(visible.begin(), visible.end());
+			if (m == 1)
+				reference[frame] = visible;
+			else if (m > 1)
+				matches = matches && visible == reference[frame];
+		}
+		cout << setw(24) << modes[m].name << setw(12) << setprecision(3) << totalMs / frames << setw(12) << sum.visible / frames
+			<< setw(12) << sum.culled / frames << setw(10) << sum.nodesVisited / frames << setw(14) << sum.leavesTested / frames
+			<< setw(16) << sum.leavesAccepted / frames << setw(12) << (m > 1 ? (matches ? "sim" : "NAO") : "-") << endl;
+	}
+
+	// Parte dinâmica: 10% das cópias andam um pouco a cada frame
+	bvh.simd = true;
+	int moving = max(1, nInstances / 10);
+	int rebuildsBefore = bvh.nRebuilds();
+	double updateMs = 0.0, cullMs = 0.0;
+	CullStats stats;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		auto t1 = Clock::now();
+		for (int k = 0; k < moving; k++)
+		{
+			Instance& instance = instances[(frame * 7919 + k * 13) % nInstances];
+			instance.model = glm::translate(glm::mat4(1.0f), glm::vec3(4.0f * unit(rng) - 2.0f, 0.0f, 4.0f * unit(rng) - 2.0f)) * instance.model;
+			instance.box = transformBounds(meshBounds[instance.mesh], instance.model);
+			bvh.update((frame * 7919 + k * 13) % nInstances, instance.box);
+		}
+		auto t2 = Clock::now();
+		bvh.cull(frustumAt(frame), visible, &stats);
+		updateMs += chrono::duration<double, milli>(t2 - t1).count();
+		cullMs += elapsedMs(t2);
+	}
+	cout << endl << moving << " copias movidas por frame: update " << updateMs / frames << " ms, refit + cull "
+		<< cullMs / frames << " ms por frame, " << bvh.nRebuilds() - rebuildsBefore << " remontagens em " << frames << " frames" << endl;
+	t0 = Clock::now();
+	bvh.rebuild();
+	cout << "rebuild sob demanda: " << elapsedMs(t0) << " ms" << endl;
+	return 0;
+}
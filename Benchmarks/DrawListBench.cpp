@@ -0,0 +1,312 @@
+/* Benchmark da DrawList (DrawList.h): drawcalls e trocas de estado na cena do escritório
+ *
+ * Monta uma sala com fileiras de estações de trabalho (mesa, computador, cadeira, mouse
+ * e mousepad de Modelos3D/Novos), mais o sofá e a placa do curso. Cada objeto é
+ * desenhado com uma drawcall por submesh (material do .mtl) e dois programas:
+ *   - texturizado (phong de Hello3D- Texturas): material MateriaisOfficeSheet, com o
+ *     atlas TexturasOffice.png, ou qualquer material com map_Kd
+ *   - sem textura (phong de Hello3D- Iluminacao): os demais materiais
+ * Materiais com o mesmo nome são compartilhados pela cena inteira (vários .mtl repetem
+ * MateriaisOfficeSheet), como faria um gerenciador de materiais.
+ *
+ * Compara a ordem da cena (objeto por objeto, submesh por submesh) com a ordem de
+ * DrawList::sort, contando drawcalls e trocas de programa, textura, material e VAO, e
+ * mede o tempo de CPU do submit ("envio") e o frame com glFinish. Por último desenha a
+ * mesma cena com DrawBatches: as texturas em um texture array (TextureArray.h, com uma
+ * camada branca para os materiais sem textura), um só programa (phong-array.vs e
+ * phong-array.fs, nesta pasta) e uma glMultiDrawElementsIndirect por malha, e mostra
+ * a redução de drawcalls. Usa uma janela invisível; funciona também com Mesa llvmpipe.
+ *
+ * Uso: DrawListBench [estações por fileira] [fileiras] [frames por medição]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+//STB_IMAGE
+#include <stb_image.h>
+
+//Classe gerenciadora de shaders
+#include "Shader.h"
+#include "FrameData.h"
+#include "MeshCache.h"
+#include "MeshBuffers.h"
+#include "DrawList.h"
+#include "TextureArray.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+const string MODELS = "../Modelos3D/Novos/";
+const string ATLAS_MATERIAL = "MateriaisOfficeSheet";
+
+// Malha da cena com os materiais trocados pelos da biblioteca compartilhada
+struct OfficeMesh : SceneMesh
+{
+	vector<const Material*> shared; // índice da submesh -> material compartilhado
+};
+
+// Biblioteca de materiais da cena: um Material por nome (endereços estáveis no deque)
+static deque<Material> materialLibrary;
+static map<string, const Material*> materialByName;
+static map<string, GLuint> textureByPath;
+
+static GLuint loadTexture(const string& filePath)
+{
+	auto found = textureByPath.find(filePath);
+	if (found != textureByPath.end())
+		return found->second;
+
+	GLuint texID;
+	glGenTextures(1, &texID);
+	glBindTexture(GL_TEXTURE_2D, texID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 4);
+	if (data)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		cout << "Failed to load texture " << filePath << endl;
+	}
+	stbi_image_free(data);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	textureByPath[filePath] = texID;
+	return texID;
+}
+
+static bool loadOfficeMesh(const string& objPath, OfficeMesh& sceneMesh)
+{
+	CachedMesh mesh;
+	if (!loadSceneMesh(objPath, mesh, sceneMesh))
+		return false;
+	for (const Material& material : sceneMesh.materials)
+	{
+		auto found = materialByName.find(material.name);
+		if (found == materialByName.end())
+		{
+			materialLibrary.push_back(material);
+			found = materialByName.emplace(material.name, &materialLibrary.back()).first;
+		}
+		sceneMesh.shared.push_back(found->second);
+	}
+	return true;
+}
+
+struct FrameTime
+{
+	double submitMs = 0.0;
+	double frameMs = 0.0;
+	DrawStats stats;
+};
+
+static FrameTime measure(int frames, const function<DrawStats()>& submit)
+{
+	FrameTime t;
+	submit(); // aquecimento
+	glFinish();
+	for (int f = 0; f < frames; f++)
+	{
+		auto t0 = Clock::now();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		t.stats = submit();
+		auto t1 = Clock::now();
+		glFinish();
+		auto t2 = Clock::now();
+		t.submitMs += chrono::duration<double, milli>(t1 - t0).count();
+		t.frameMs += chrono::duration<double, milli>(t2 - t0).count();
+	}
+	t.submitMs /= frames;
+	t.frameMs /= frames;
+	return t;
+}
+
+static void printRow(const char* label, const FrameTime& t)
+{
+	cout << setw(10) << label << setw(8) << t.stats.draws << setw(10) << t.stats.programChanges
+		<< setw(10) << t.stats.textureChanges << setw(10) << t.stats.materialChanges
+		<< setw(8) << t.stats.vaoChanges << setw(12) << t.submitMs << setw(12) << t.frameMs << endl;
+}
+
+int main(int argc, char** argv)
+{
+	int perRow = argc > 1 ? max(1, atoi(argv[1])) : 6;
+	int rows = argc > 2 ? max(1, atoi(argv[2])) : 4;
+	int frames = argc > 3 ? max(1, atoi(argv[3])) : 5;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(256, 256, "DrawListBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+	bool multiDraw = loadGLExtensions().multiDrawIndirect;
+
+	Shader textured("../Hello3D- Texturas/phong.vs", "../Hello3D- Texturas/phong.fs");
+	Shader untextured("../Hello3D- Iluminacao/phong.vs", "../Hello3D- Iluminacao/phong.fs");
+	Shader arrayShader("phong-array.vs", "phong-array.fs");
+	textured.Use();
+	glUniform1i(textured.uniform("texBuffer"), 0);
+	arrayShader.Use();
+	glUniform1i(arrayShader.uniform("texArray"), 1);
+	glActiveTexture(GL_TEXTURE0);
+
+	const char* names[] = { "desk", "computer", "BlueChair", "OrangeChair", "mouse", "mousepad", "couch", "cienciaDaComputacao" };
+	map<string, OfficeMesh> meshes;
+	for (const char* name : names)
+	{
+		OfficeMesh& sceneMesh = meshes[name];
+		if (!loadOfficeMesh(MODELS + name + ".obj", sceneMesh))
+		{
+			cout << "Erro ao tentar ler o arquivo " << MODELS + name + ".obj" << endl;
+			return 1;
+		}
+	}
+	GLuint atlas = loadTexture(MODELS + "TexturasOffice.png");
+
+	// As mesmas texturas em camadas; os materiais sem textura usam a camada branca
+	TextureArray textureArray;
+	int atlasLayer = textureArray.addImage(MODELS + "TexturasOffice.png");
+	int whiteLayer = textureArray.addColor(255, 255, 255);
+
+	// Ordem da cena: um objeto de cada vez, cada um com todas as suas submeshes
+	DrawList drawList;
+	int nTriangles = 0;
+	auto place = [&](const string& name, glm::vec3 position, float angle)
+	{
+		const OfficeMesh& sceneMesh = meshes[name];
+		glm::mat4 model = glm::translate(glm::mat4(1), position);
+		model = glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
+		for (const Submesh& submesh : sceneMesh.submeshes)
+		{
+			DrawItem item;
+			item.material = submesh.material >= 0 ? sceneMesh.shared[submesh.material] : nullptr;
+			bool useAtlas = item.material != nullptr && item.material->name == ATLAS_MATERIAL;
+			bool hasMap = item.material != nullptr && !item.material->mapKd.empty();
+			item.shader = (useAtlas || hasMap) ? &textured : &untextured;
+			item.texture = hasMap ? loadTexture(item.material->mapKd) : (useAtlas ? atlas : 0);
+			item.layer = hasMap ? textureArray.addImage(item.material->mapKd) : (useAtlas ? atlasLayer : whiteLayer);
+			item.VAO = sceneMesh.VAO;
+			item.firstIndex = submesh.firstIndex;
+			item.indexCount = submesh.indexCount;
+			item.model = model;
+			drawList.add(item);
+		}
+		nTriangles += sceneMesh.nTriangles;
+	};
+	const float spacing = 3.0f;
+	for (int r = 0; r < rows; r++)
+	{
+		for (int c = 0; c < perRow; c++)
+		{
+			glm::vec3 base(c * spacing, 0.0f, r * spacing);
+			place("desk", base, 0.0f);
+			place("computer", base + glm::vec3(0.0f, 0.75f, -0.2f), 0.0f);
+			place("mousepad", base + glm::vec3(0.4f, 0.75f, 0.1f), 0.0f);
+			place("mouse", base + glm::vec3(0.4f, 0.76f, 0.1f), 0.0f);
+			place((r + c) % 2 == 0 ? "BlueChair" : "OrangeChair", base + glm::vec3(0.0f, 0.0f, 0.8f), 180.0f);
+		}
+	}
+	place("couch", glm::vec3(-3.0f, 0.0f, 0.0f), 90.0f);
+	place("cienciaDaComputacao", glm::vec3(0.5f * perRow * spacing, 2.0f, -2.0f), 0.0f);
+	cout << "Cena: " << drawList.items.size() << " submeshes, " << nTriangles << " triangulos, "
+		<< materialLibrary.size() << " materiais distintos" << endl;
+
+	FrameUniforms frameUniforms;
+	frameUniforms.create();
+	FrameData frameData;
+	glm::vec3 center(0.5f * (perRow - 1) * spacing, 0.0f, 0.5f * (rows - 1) * spacing);
+	float distance = max(perRow, rows) * spacing + 3.0f;
+	frameData.cameraPos = glm::vec4(center + glm::vec3(0.0f, distance * 0.6f, distance), 1.0f);
+	frameData.view = glm::lookAt(glm::vec3(frameData.cameraPos), center, glm::vec3(0.0f, 1.0f, 0.0f));
+	frameData.projection = glm::perspective(glm::radians(39.6f), 1.0f, 0.1f, distance * 4.0f);
+	frameData.lightPos = glm::vec4(center + glm::vec3(-2.0f, 10.0f, 3.0f), 1.0f);
+	frameUniforms.update(frameData);
+
+	glEnable(GL_DEPTH_TEST);
+	glViewport(0, 0, 256, 256);
+
+	cout << fixed << setprecision(3);
+	cout << setw(10) << "ordem" << setw(8) << "draws" << setw(10) << "programas" << setw(10) << "texturas"
+		<< setw(10) << "materiais" << setw(8) << "VAOs" << setw(12) << "envio ms" << setw(12) << "frame ms" << endl;
+
+	auto submitList = [&]() { return drawList.submit(); };
+	printRow("cena", measure(frames, submitList));
+
+	auto t0 = Clock::now();
+	drawList.sort();
+	auto t1 = Clock::now();
+	FrameTime sorted = measure(frames, submitList);
+	printRow("ordenada", sorted);
+
+	// Lotes: um programa, um texture array e uma glMultiDrawElementsIndirect por VAO
+	textureArray.create();
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.ID);
+	glActiveTexture(GL_TEXTURE0);
+	vector<DrawItem> arrayItems = drawList.items;
+	for (DrawItem& item : arrayItems)
+		item.shader = &arrayShader;
+	DrawBatches batches;
+	auto t2 = Clock::now();
+	batches.build(arrayItems);
+	auto t3 = Clock::now();
+	FrameTime batched = measure(frames, [&]() { return batches.submit(); });
+	printRow("lotes", batched);
+
+	cout << "sort: " << chrono::duration<double, milli>(t1 - t0).count() << " ms, DrawBatches::build: "
+		<< chrono::duration<double, milli>(t3 - t2).count() << " ms" << endl;
+	cout << "Texture array: " << textureArray.nLayers() << " camadas de " << textureArray.width << "x" << textureArray.height
+		<< ", " << textureArray.nLevels << " niveis, " << textureArray.bytes / 1024 << " KB, montagem "
+		<< textureArray.buildMs << " ms, envio " << textureArray.uploadMs << " ms" << endl;
+	for (int layer = 0; layer < textureArray.nLayers(); layer++)
+	{
+		const string& path = textureArray.layerPath(layer);
+		cout << "  camada " << layer << ": " << (path.empty() ? "cor solida" : path)
+			<< (path.empty() || textureArray.layerLoaded(layer) ? "" : " (falha na leitura, branca)") << endl;
+	}
+	cout << "Drawcalls: " << sorted.stats.draws << " -> " << batched.stats.draws << " ("
+		<< (double)sorted.stats.draws / max(1, batched.stats.draws) << "x menos; " << batches.nBatches() << " lotes com "
+		<< batched.stats.commands << " comandos indiretos"
+		<< (multiDraw ? ")" : ", sem GL 4.3: uma glDrawElementsInstanced por comando)") << endl;
+
+	batches.destroy();
+	textureArray.destroy();
+	frameUniforms.destroy();
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,314 @@
+/* Benchmark do culling na GPU (GPUCulling.h)
+ *
+ * A mesma sala de aula de OcclusionBench (fileiras de mesas com computadores, mouse,
+ * mousepad e cadeira, mais o sofá e a placa do curso), desenhada de dois jeitos:
+ *   - DrawList: frustum culling dos objetos na CPU e uma drawcall por submesh visível
+ *     (phong.vs/phong.fs de Hello3D- Iluminacao)
+ *   - GPUCulling: a profundidade do frame anterior vira a pirâmide Hi-Z, cull.cs testa
+ *     frustum e oclusão e a cena sai em uma glMultiDrawElementsIndirect(Count)
+ *     (phong-array.vs/phong-array.fs, cull.cs e hiz.cs, nesta pasta)
+ * com a câmera andando na frente da sala. Mostra o tempo de CPU das chamadas de cada
+ * frame (sem esperar a GPU), o tempo do frame com glFinish e quantos desenhos sobraram.
+ * No llvmpipe a "GPU" é a própria CPU e boa parte do desenho acontece dentro das
+ * chamadas, então as duas colunas ficam parecidas.
+ *
+ * Conferência, em cada posição da câmera:
+ *   1. a cena é desenhada só com o frustum, a pirâmide é montada com essa profundidade
+ *      e a mesma vista é desenhada com oclusão: as duas imagens precisam ser iguais
+ *      pixel a pixel (só somem desenhos que não apareceriam)
+ *   2. o status de cada desenho na GPU é comparado com GPUCulling::cullReference (o
+ *      mesmo teste na CPU) e o número de comandos compactados com o de visíveis
+ *   3. o mesmo com um comando fixo por desenho (compact = false), o caminho sem
+ *      ARB_indirect_parameters
+ *
+ * Uso: GPUCullingBench [mesas por fileira] [fileiras] [frames]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+//Classe gerenciadora de shaders
+#include "Shader.h"
+#include "FrameData.h"
+#include "MeshCache.h"
+#include "MeshBuffers.h"
+#include "DrawList.h"
+#include "TextureArray.h"
+#include "GPUCulling.h"
+#include "Timing.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+const string MODELS = "../Modelos3D/Novos/";
+const int WIDTH = 512, HEIGHT = 256;
+
+// O VAO é usado pela DrawList
+struct GPUSceneMesh : SceneMesh
+{
+	int gpuMesh = -1; // índice em GPUCulling
+};
+
+static bool loadGPUSceneMesh(const string& objPath, GPUCulling& culling, GPUSceneMesh& sceneMesh)
+{
+	CachedMesh mesh;
+	if (!loadSceneMesh(objPath, mesh, sceneMesh))
+		return false;
+	sceneMesh.gpuMesh = culling.addMesh(mesh);
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	int perRow = argc > 1 ? max(1, atoi(argv[1])) : 4;
+	int rows = argc > 2 ? max(1, atoi(argv[2])) : 6;
+	int frames = argc > 3 ? max(2, atoi(argv[3])) : 8;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "GPUCullingBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+	const GLExtensionSupport& support = loadGLExtensions();
+	cout << "Compute shaders: " << (support.computeShader ? "sim" : "nao") << ", multi-draw indirect: "
+		<< (support.multiDrawIndirect ? "sim" : "nao") << ", contagem indireta (ARB_indirect_parameters): "
+		<< (support.indirectCount ? "sim" : "nao") << endl;
+
+	GPUCulling culling;
+	if (!culling.create("cull.cs", "hiz.cs"))
+	{
+		cout << "Culling na GPU indisponivel (precisa de OpenGL 4.3)" << endl;
+		return 1;
+	}
+	Shader phong("../Hello3D- Iluminacao/phong.vs", "../Hello3D- Iluminacao/phong.fs");
+	Shader phongArray("phong-array.vs", "phong-array.fs");
+
+	// Só a camada branca: os materiais da sala usam a cor Kd
+	TextureArray textureArray;
+	int whiteLayer = textureArray.addColor(255, 255, 255);
+	textureArray.create();
+	glUseProgram(phongArray.ID);
+	phongArray.setInt("texArray", 0);
+
+	const char* names[] = { "desk", "computer", "BlueChair", "OrangeChair", "mouse", "mousepad", "couch", "cienciaDaComputacao" };
+	map<string, GPUSceneMesh> meshes;
+	for (const char* name : names)
+	{
+		if (!loadGPUSceneMesh(MODELS + name + ".obj", culling, meshes[name]))
+		{
+			cout << "Erro ao tentar ler o arquivo " << MODELS + name + ".obj" << endl;
+			return 1;
+		}
+	}
+
+	// Sala: mesas de 11.7 x 2.5 x 4.6 (unidades dos .obj) em fileiras ao longo de -z
+	DrawList drawList;
+	vector<AABB> boxes;
+	auto place = [&](const string& name, glm::vec3 position, float angle)
+	{
+		const GPUSceneMesh& mesh = meshes[name];
+		glm::mat4 model = glm::rotate(glm::translate(glm::mat4(1), position), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
+		size_t first = drawList.items.size();
+		drawList.addSubmeshes(&phong, mesh.VAO, mesh.submeshes, mesh.materials, vector<GLuint>(), 0, model);
+		for (size_t i = first; i < drawList.items.size(); i++)
+			drawList.items[i].object = (int)boxes.size();
+		boxes.push_back(transformBounds(mesh.bounds, model));
+		culling.addObject(mesh.gpuMesh, model, mesh.materials, vector<int>(), (GLuint)whiteLayer);
+	};
+	const float spacingX = 13.0f, spacingZ = 9.0f, deskTop = 2.49f;
+	for (int r = 0; r < rows; r++)
+	{
+		for (int c = 0; c < perRow; c++)
+		{
+			glm::vec3 base((c - 0.5f * (perRow - 1)) * spacingX, 0.0f, -r * spacingZ);
+			place("desk", base, 0.0f);
+			for (float side : { -3.0f, 3.0f })
+			{
+				place("computer", base + glm::vec3(side, deskTop, -1.0f), 0.0f);
+				place("mousepad", base + glm::vec3(side + 2.0f, deskTop, 0.8f), 0.0f);
+				place("mouse", base + glm::vec3(side + 2.0f, deskTop + 0.2f, 0.8f), 0.0f);
+				place((r + c) % 2 == 0 ? "BlueChair" : "OrangeChair", base + glm::vec3(side, 1.67f, 3.4f), 180.0f);
+			}
+		}
+	}
+	float back = -rows * spacingZ;
+	place("couch", glm::vec3(0.0f, 0.57f, back), 0.0f);
+	place("cienciaDaComputacao", glm::vec3(0.0f, 7.0f, back - 2.0f), 0.0f);
+	drawList.sort();
+	culling.upload();
+	cout << "Cena: " << boxes.size() << " objetos, " << culling.nDraws() << " desenhos (submeshes), "
+		<< culling.nMeshes() << " malhas em um VBO" << endl;
+
+	// Framebuffer com a profundidade em uma textura, lida por buildHiZ
+	GLuint FBO, colorRBO, depthTexture;
+	glGenFramebuffers(1, &FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glGenRenderbuffers(1, &colorRBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, WIDTH, HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+	glGenTextures(1, &depthTexture);
+	glBindTexture(GL_TEXTURE_2D, depthTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, WIDTH, HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		cout << "Framebuffer incompleto" << endl;
+		return 1;
+	}
+	glViewport(0, 0, WIDTH, HEIGHT);
+	glEnable(GL_DEPTH_TEST);
+	glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.ID);
+
+	FrameUniforms frameUniforms;
+	frameUniforms.create();
+	FrameData frameData;
+	frameData.projection = glm::perspective(glm::radians(50.0f), (float)WIDTH / HEIGHT, 0.1f, 400.0f);
+	frameData.lightPos = glm::vec4(0.0f, 30.0f, 10.0f, 1.0f);
+	float halfWidth = 0.5f * perRow * spacingX;
+	auto setCamera = [&](int frame)
+	{
+		float s = (float)frame / (frames - 1);
+		glm::vec3 eye(-0.6f * halfWidth + 1.2f * halfWidth * s, 3.6f, 8.0f);
+		frameData.view = glm::lookAt(eye, eye + glm::vec3(0.0f, -0.12f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		frameData.cameraPos = glm::vec4(eye, 1.0f);
+		frameUniforms.update(frameData);
+		return frameData.projection * frameData.view;
+	};
+	auto readImage = [&](vector<unsigned char>& pixels)
+	{
+		pixels.resize((size_t)WIDTH * HEIGHT * 4);
+		glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	};
+
+	// Conferência
+	int differentPixels = 0, statusMismatches = 0, countMismatches = 0, occludedDraws = 0, frustumDraws = 0;
+	for (int compact = 1; compact >= 0; compact--)
+	{
+		culling.compact = compact != 0;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			glm::mat4 viewProjection = setCamera(frame);
+			vector<unsigned char> reference, culled;
+			culling.occlusion = false;
+			culling.cull(viewProjection);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			culling.submit(phongArray);
+			readImage(reference);
+
+			culling.occlusion = true;
+			culling.buildHiZ(depthTexture, WIDTH, HEIGHT);
+			culling.cull(viewProjection);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			culling.submit(phongArray);
+			readImage(culled);
+			for (size_t p = 0; p < reference.size(); p += 4)
+				differentPixels += memcmp(&reference[p], &culled[p], 4) != 0;
+
+			vector<uint8_t> gpu, cpu;
+			culling.readStatus(gpu);
+			culling.cullReference(cpu);
+			int visible = 0;
+			for (size_t i = 0; i < gpu.size(); i++)
+			{
+				statusMismatches += gpu[i] != cpu[i];
+				visible += gpu[i] == GPU_CULL_VISIBLE;
+				if (compact)
+				{
+					occludedDraws += gpu[i] == GPU_CULL_OCCLUDED;
+					frustumDraws += gpu[i] == GPU_CULL_FRUSTUM;
+				}
+			}
+			countMismatches += culling.readVisibleCount() != visible;
+		}
+	}
+	int checks = 2 * frames;
+	cout << endl << "Conferencia em " << frames << " vistas, com e sem compactacao:" << endl;
+	cout << "  pixels diferentes entre so frustum e frustum + Hi-Z: " << differentPixels << endl;
+	cout << "  desenhos com status diferente da referencia na CPU: " << statusMismatches << " de " << checks * culling.nDraws() << endl;
+	cout << "  contagens de comandos diferentes do numero de visiveis: " << countMismatches << " de " << checks << endl;
+	cout << fixed << setprecision(1) << "  por vista: " << (double)frustumDraws / frames << " desenhos fora do frustum, "
+		<< (double)occludedDraws / frames << " ocultos, de " << culling.nDraws() << endl;
+
+	// Tempos com a câmera andando; a pirâmide vem do frame anterior
+	culling.compact = true;
+	culling.occlusion = true;
+	double listCpuMs = 0.0, listFrameMs = 0.0, gpuCpuMs = 0.0, gpuFrameMs = 0.0;
+	double listDraws = 0.0, gpuVisible = 0.0;
+	vector<uint8_t> inFrustum(boxes.size());
+	for (int frame = 0; frame < frames; frame++)
+	{
+		glm::mat4 viewProjection = setCamera(frame);
+
+		// DrawList: frustum e uma drawcall por submesh visível
+		glFinish();
+		auto t0 = Clock::now();
+		Frustum frustum(viewProjection);
+		for (size_t i = 0; i < boxes.size(); i++)
+			inFrustum[i] = frustum.testAABB(boxes[i]) != FRUSTUM_OUTSIDE;
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		DrawStats stats = drawList.submit(inFrustum.data());
+		listCpuMs += elapsedMs(t0);
+		glFinish();
+		listFrameMs += elapsedMs(t0);
+		listDraws += stats.draws;
+
+		// GPUCulling: Hi-Z do frame anterior (no primeiro frame, da DrawList acima)
+		glFinish();
+		t0 = Clock::now();
+		culling.buildHiZ(depthTexture, WIDTH, HEIGHT);
+		culling.cull(viewProjection);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		culling.submit(phongArray);
+		gpuCpuMs += elapsedMs(t0);
+		glFinish();
+		gpuFrameMs += elapsedMs(t0);
+		gpuVisible += culling.readVisibleCount();
+	}
+	cout << endl << setprecision(3) << setw(34) << "" << setw(12) << "CPU ms" << setw(14) << "frame ms" << setw(12) << "drawcalls"
+		<< setw(12) << "desenhos" << endl;
+	cout << setw(34) << "DrawList (frustum na CPU)" << setw(12) << listCpuMs / frames << setw(14) << listFrameMs / frames
+		<< setw(12) << setprecision(1) << listDraws / frames << setw(12) << listDraws / frames << endl;
+	cout << setprecision(3) << setw(34) << "GPUCulling (frustum + Hi-Z)" << setw(12) << gpuCpuMs / frames << setw(14)
+		<< gpuFrameMs / frames << setw(12) << 1 << setw(12) << setprecision(1) << gpuVisible / frames << endl;
+
+	culling.destroy();
+	textureArray.destroy();
+	frameUniforms.destroy();
+	glDeleteFramebuffers(1, &FBO);
+	glDeleteRenderbuffers(1, &colorRBO);
+	glDeleteTextures(1, &depthTexture);
+	glfwTerminate();
+	return 0;
+}
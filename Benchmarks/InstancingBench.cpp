@@ -0,0 +1,178 @@
+/* Benchmark do desenho instanciado (InstancedRenderer.h) contra uma drawcall por cópia
+ *
+ * Monta uma grade de cadeiras com 100, 1000 e 10000 cópias da mesma malha e mede o
+ * tempo por frame de duas formas, com o mesmo shader e o mesmo trabalho na GPU:
+ *   - individual: para cada cópia, envia a matriz e o material (como atributos
+ *                 constantes, glVertexAttrib*) e chama glDrawElements
+ *   - instanciado: InstancedMesh::draw, uma única glDrawElementsInstanced
+ * "envio" é o tempo de CPU gasto emitindo os comandos; "frame" inclui o glFinish.
+ * Usa uma janela invisível; funciona também com Mesa llvmpipe. Lá o processamento de
+ * vértices acontece dentro da própria drawcall, então "envio" inclui esse trabalho, e
+ * 10000 cadeiras (242 milhões de triângulos) levam dezenas de segundos por frame; use
+ * um modelo leve, como "../Hello3D- Texturas/cube.obj", para isolar o custo das drawcalls.
+ *
+ * Uso: InstancingBench [cópias máximas] [arquivo .obj] [frames por medição]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+//Classe gerenciadora de shaders
+#include "Shader.h"
+#include "FrameData.h"
+#include "InstancedRenderer.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+struct FrameTime
+{
+	double submitMs = 0.0;
+	double frameMs = 0.0;
+};
+
+template <typename F>
+static FrameTime measure(int frames, F drawFrame)
+{
+	FrameTime t;
+	drawFrame(); // aquecimento
+	glFinish();
+	for (int f = 0; f < frames; f++)
+	{
+		auto t0 = Clock::now();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		drawFrame();
+		auto t1 = Clock::now();
+		glFinish();
+		auto t2 = Clock::now();
+		t.submitMs += chrono::duration<double, milli>(t1 - t0).count();
+		t.frameMs += chrono::duration<double, milli>(t2 - t0).count();
+	}
+	t.submitMs /= frames;
+	t.frameMs /= frames;
+	return t;
+}
+
+int main(int argc, char** argv)
+{
+	int maxInstances = argc > 1 ? max(1, atoi(argv[1])) : 10000;
+	string objPath = argc > 2 ? argv[2] : "../Modelos3D/Novos/BlueChair.obj";
+	int frames = argc > 3 ? max(1, atoi(argv[3])) : 3;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(256, 256, "InstancingBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+
+	Shader shader("../Hello3D- Instancias/phong-instanced.vs", "../Hello3D- Instancias/phong-instanced.fs");
+	shader.Use();
+
+	InstancedMesh instanced;
+	if (!instanced.load(objPath))
+	{
+		cout << "Erro ao tentar ler o arquivo " << objPath << endl;
+		return 1;
+	}
+	// Mesma malha sem os atributos por instância: cada cópia recebe matriz e material
+	// como valores constantes de atributo antes da sua própria drawcall
+	InstancedMesh single;
+	single.load(objPath);
+	glBindVertexArray(single.VAO);
+	for (GLuint location = INSTANCE_MODEL_LOCATION; location <= INSTANCE_MATERIAL_LOCATION; location++)
+		glDisableVertexAttribArray(location);
+	glBindVertexArray(0);
+	cout << "Malha: " << objPath << " (" << instanced.nIndices / 3 << " triangulos)" << endl;
+
+	MaterialTable materialTable;
+	materialTable.create();
+	InstanceMaterial plain, tinted;
+	tinted.color = glm::vec4(1.0f, 0.85f, 0.7f, 1.0f);
+	materialTable.add(plain);
+	materialTable.add(tinted);
+	materialTable.update();
+
+	FrameUniforms frameUniforms;
+	frameUniforms.create();
+	FrameData frameData;
+	frameData.lightPos = glm::vec4(-20.0f, 40.0f, 30.0f, 1.0f);
+
+	glEnable(GL_DEPTH_TEST);
+	glViewport(0, 0, 256, 256);
+
+	cout << fixed << setprecision(2);
+	cout << setw(8) << "copias" << setw(16) << "indiv. envio" << setw(16) << "indiv. frame"
+		<< setw(16) << "inst. envio" << setw(16) << "inst. frame" << endl;
+
+	for (int count = 100; count <= maxInstances; count *= 10)
+	{
+		// Grade quadrada com espaçamento de 3 unidades, vista de cima e de longe
+		int side = (int)ceil(sqrt((double)count));
+		float spacing = 3.0f;
+		float half = 0.5f * (side - 1) * spacing;
+		instanced.clear();
+		for (int i = 0; i < count; i++)
+		{
+			glm::vec3 position((i % side) * spacing - half, 0.0f, (i / side) * spacing - half);
+			instanced.add(glm::translate(glm::mat4(1), position), (GLuint)(i % 3 == 0));
+		}
+		float distance = half * 2.5f + 5.0f;
+		frameData.cameraPos = glm::vec4(0.0f, distance, distance, 1.0f);
+		frameData.view = glm::lookAt(glm::vec3(frameData.cameraPos), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		frameData.projection = glm::perspective(glm::radians(39.6f), 1.0f, 0.1f, distance * 4.0f);
+		frameUniforms.update(frameData);
+
+		FrameTime individual = measure(frames, [&]() {
+			glBindVertexArray(single.VAO);
+			for (int i = 0; i < count; i++)
+			{
+				const InstanceData& data = instanced.instance(i);
+				for (GLuint c = 0; c < 4; c++)
+					glVertexAttrib4fv(INSTANCE_MODEL_LOCATION + c, glm::value_ptr(data.model[c]));
+				glVertexAttribI4ui(INSTANCE_MATERIAL_LOCATION, data.material, 0, 0, 0);
+				glDrawElements(GL_TRIANGLES, single.nIndices, GL_UNSIGNED_INT, 0);
+			}
+			glBindVertexArray(0);
+		});
+		FrameTime batched = measure(frames, [&]() {
+			instanced.draw();
+		});
+
+		cout << setw(8) << count << setw(16) << individual.submitMs << setw(16) << individual.frameMs
+			<< setw(16) << batched.submitMs << setw(16) << batched.frameMs << endl;
+	}
+
+	instanced.destroy();
+	single.destroy();
+	materialTable.destroy();
+	frameUniforms.destroy();
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,194 @@
+/* Benchmark dos níveis de detalhe (buildLODs em MeshOptimizer.h, InstancedMesh::drawLOD)
+ *
+ * Para cada malha mostra os níveis gerados (triângulos e erro relativo ao raio da
+ * esfera envolvente). Depois monta um campo com cópias de cada malha (fileiras que se
+ * afastam da câmera, como um pátio cheio de móveis) e desenha o mesmo quadro de duas
+ * formas:
+ *   - sem LOD: InstancedMesh::draw, todas as cópias com a malha completa
+ *   - com LOD: InstancedMesh::drawLOD, cada cópia no nível mais simples cujo erro
+ *              projetado não passa de LOD_PIXEL_ERROR pixels
+ * contando triângulos enviados e o tempo por frame (com glFinish). Usa uma janela
+ * invisível; funciona também com Mesa llvmpipe, onde o custo por vértice pesa no frame.
+ * A primeira execução gera os níveis e grava o cache de cada malha (.cgmesh).
+ *
+ * Uso: LODBench [cópias por malha] [frames por medição] [resolução]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+//Classe gerenciadora de shaders
+#include "Shader.h"
+#include "FrameData.h"
+#include "InstancedRenderer.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+struct FrameTime
+{
+	double frameMs = 0.0;
+	size_t triangles = 0;
+};
+
+template <typename F>
+static FrameTime measure(int frames, F drawFrame)
+{
+	FrameTime t;
+	t.triangles = drawFrame(); // aquecimento
+	glFinish();
+	for (int f = 0; f < frames; f++)
+	{
+		auto t0 = Clock::now();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		drawFrame();
+		glFinish();
+		auto t1 = Clock::now();
+		t.frameMs += chrono::duration<double, milli>(t1 - t0).count();
+	}
+	t.frameMs /= frames;
+	return t;
+}
+
+int main(int argc, char** argv)
+{
+	int copies = argc > 1 ? max(1, atoi(argv[1])) : 400;
+	int frames = argc > 2 ? max(1, atoi(argv[2])) : 3;
+	int resolution = argc > 3 ? max(64, atoi(argv[3])) : 512;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(resolution, resolution, "LODBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+
+	Shader shader("../Hello3D- Instancias/phong-instanced.vs", "../Hello3D- Instancias/phong-instanced.fs");
+	shader.Use();
+
+	const char* paths[] = {
+		"../Modelos3D/Novos/couch.obj",
+		"../Modelos3D/Novos/desk.obj",
+		"../Modelos3D/Novos/BlueChair.obj",
+		"../Modelos3D/Naves/LightCruiser05.obj",
+	};
+	const int nMeshes = sizeof(paths) / sizeof(paths[0]);
+	vector<InstancedMesh> meshes(nMeshes);
+	cout << fixed;
+	for (int m = 0; m < nMeshes; m++)
+	{
+		auto t0 = Clock::now();
+		if (!meshes[m].load(paths[m]))
+		{
+			cout << "Erro ao tentar ler o arquivo " << paths[m] << endl;
+			return 1;
+		}
+		auto t1 = Clock::now();
+		cout << paths[m] << " (" << setprecision(1) << chrono::duration<double, milli>(t1 - t0).count() << " ms)" << endl;
+		cout << "  nivel 0: " << setw(8) << meshes[m].nIndices / 3 << " triangulos" << endl;
+		for (size_t l = 0; l < meshes[m].lods.size(); l++)
+			cout << "  nivel " << l + 1 << ": " << setw(8) << meshes[m].lods[l].indexCount / 3 << " triangulos, erro "
+				<< setprecision(5) << meshes[m].lods[l].error << endl;
+	}
+
+	MaterialTable materialTable;
+	materialTable.create();
+	materialTable.add(InstanceMaterial());
+	materialTable.update();
+
+	// Cada malha em uma faixa do campo; as cópias são escaladas para um raio de 1
+	// unidade e ficam em fileiras de 0 a ~160 unidades da câmera
+	int perRow = (int)ceil(sqrt((double)copies));
+	const float spacing = 4.0f;
+	for (int m = 0; m < nMeshes; m++)
+	{
+		float scale = 1.0f / max(meshes[m].bounds.w, 1e-6f);
+		glm::vec3 center = glm::vec3(meshes[m].bounds);
+		for (int i = 0; i < copies; i++)
+		{
+			float x = ((i % perRow) * nMeshes + m - 0.5f * perRow * nMeshes) * spacing;
+			float z = -(float)(i / perRow) * spacing * nMeshes;
+			glm::mat4 model = glm::translate(glm::mat4(1), glm::vec3(x, 1.0f, z));
+			model = glm::scale(model, glm::vec3(scale));
+			model = glm::translate(model, -center);
+			meshes[m].add(model);
+		}
+	}
+
+	FrameUniforms frameUniforms;
+	frameUniforms.create();
+	FrameData frameData;
+	frameData.cameraPos = glm::vec4(0.0f, 2.5f, 3.0f, 1.0f);
+	frameData.view = glm::lookAt(glm::vec3(frameData.cameraPos), glm::vec3(0.0f, 1.0f, -20.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	frameData.projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 1000.0f);
+	frameData.lightPos = glm::vec4(-20.0f, 40.0f, 30.0f, 1.0f);
+	frameUniforms.update(frameData);
+
+	glEnable(GL_DEPTH_TEST);
+	glViewport(0, 0, resolution, resolution);
+
+	cout << copies << " copias de cada malha, " << resolution << "x" << resolution << endl;
+	FrameTime full = measure(frames, [&]() {
+		size_t triangles = 0;
+		for (InstancedMesh& mesh : meshes)
+		{
+			mesh.draw();
+			triangles += mesh.trianglesDrawn;
+		}
+		return triangles;
+	});
+	FrameTime lod = measure(frames, [&]() {
+		size_t triangles = 0;
+		for (InstancedMesh& mesh : meshes)
+		{
+			mesh.drawLOD(frameData.view, frameData.projection, (float)resolution);
+			triangles += mesh.trianglesDrawn;
+		}
+		return triangles;
+	});
+
+	cout << setw(10) << "modo" << setw(14) << "triangulos" << setw(12) << "frame ms" << endl;
+	cout << setprecision(2);
+	cout << setw(10) << "sem LOD" << setw(14) << full.triangles << setw(12) << full.frameMs << endl;
+	cout << setw(10) << "com LOD" << setw(14) << lod.triangles << setw(12) << lod.frameMs << endl;
+	for (int m = 0; m < nMeshes; m++)
+	{
+		cout << "  " << paths[m] << ": copias por nivel";
+		for (int count : meshes[m].instancesPerLevel)
+			cout << " " << count;
+		cout << endl;
+	}
+
+	for (InstancedMesh& mesh : meshes)
+		mesh.destroy();
+	materialTable.destroy();
+	frameUniforms.destroy();
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,99 @@
+/* Benchmark do cache binário de malhas
+ *
+ * Para cada .obj em Modelos3D compara o caminho "frio" (parsing do texto + indexação,
+ * como na primeira execução) com o caminho "quente" (abrir o .cgmesh mapeado em
+ * memória). Os caches são (re)gerados antes da medição.
+ *
+ * Uso: MeshCacheBench [pasta dos modelos] [repetições]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <algorithm>
+
+using namespace std;
+
+#include "OBJLoader.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+
+template <typename F>
+static double bestOf(int repeats, F f)
+{
+	double best = 1e30;
+	for (int i = 0; i < repeats; i++)
+	{
+		auto t0 = chrono::high_resolution_clock::now();
+		f();
+		auto t1 = chrono::high_resolution_clock::now();
+		best = min(best, chrono::duration<double>(t1 - t0).count());
+	}
+	return best;
+}
+
+int main(int argc, char** argv)
+{
+	string root = argc > 1 ? argv[1] : "../Modelos3D";
+	int repeats = argc > 2 ? max(1, atoi(argv[2])) : 5;
+
+	vector<filesystem::path> files;
+	for (auto& entry : filesystem::recursive_directory_iterator(root))
+		if (entry.is_regular_file() && entry.path().extension() == ".obj")
+			files.push_back(entry.path());
+	sort(files.begin(), files.end());
+
+	cout << left << setw(28) << "arquivo" << right << setw(12) << "texto ms"
+		<< setw(12) << "cache ms" << setw(10) << "ganho" << setw(12) << "KB cache" << setw(8) << "igual" << endl;
+
+	double totalText = 0.0, totalCache = 0.0;
+	for (const auto& path : files)
+	{
+		string objPath = path.string();
+
+		IndexedMesh reference;
+		{
+			OBJData data;
+			if (!loadOBJ(objPath, data))
+				continue;
+			buildIndexedMesh(data, reference);
+			optimizeMesh(reference);
+			buildLODs(reference);
+			if (!writeMeshCache(objPath, reference))
+			{
+				cout << "Nao foi possivel gravar o cache de " << objPath << endl;
+				continue;
+			}
+		}
+
+		double tText = bestOf(repeats, [&]() {
+			CachedMesh mesh;
+			mesh.load(objPath, false);
+		});
+
+		bool same = false;
+		double tCache = bestOf(repeats, [&]() {
+			CachedMesh mesh;
+			mesh.load(objPath, true);
+			same = mesh.fromCache() && mesh.vertexBytes() == reference.vertices.size() * sizeof(float) &&
+				mesh.indexBytes() == reference.indices.size() * sizeof(unsigned int) &&
+				memcmp(mesh.vertexData(), reference.vertices.data(), mesh.vertexBytes()) == 0 &&
+				memcmp(mesh.indexData(), reference.indices.data(), mesh.indexBytes()) == 0;
+		});
+
+		totalText += tText;
+		totalCache += tCache;
+		cout << left << setw(28) << path.filename().string() << right << fixed << setprecision(3)
+			<< setw(12) << tText * 1000.0 << setw(12) << tCache * 1000.0
+			<< setprecision(1) << setw(9) << tText / tCache << "x"
+			<< setw(12) << filesystem::file_size(meshCachePath(objPath)) / 1024
+			<< setw(8) << (same ? "sim" : "NAO") << endl;
+	}
+	cout << "Total: texto " << fixed << setprecision(1) << totalText * 1000.0 << " ms, cache "
+		<< setprecision(3) << totalCache * 1000.0 << " ms" << endl;
+	return 0;
+}
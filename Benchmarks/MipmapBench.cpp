@@ -0,0 +1,180 @@
+/* Benchmark da geração de mipmaps na CPU (TextureMips.h)
+ *
+ * Para Terra.jpg e 2k_mercury.jpg (Modelos3D/Planetas) gera a cadeia completa de
+ * mipmaps de várias formas e mostra o melhor tempo de cada uma:
+ *   - ingênuo: downsampleRGBA8 nível a nível, média de 2x2 em 8 bits sem correção de
+ *              gama, em uma thread (o que TextureBake fazia antes)
+ *   - cada filtro (box, kaiser, lanczos) com os laços escalares em uma thread, com
+ *     SIMD em uma thread (só SSE2 e, se a CPU tiver, com as colunas em AVX2 e FMA) e
+ *     com SIMD em todas as threads do pool
+ *   - glGenerateMipmap, para comparar com a GPU (ou com o llvmpipe)
+ *   - leitura da cadeia pronta de um .cgtex, o que os exemplos fazem a partir da
+ *     segunda execução (gravado em uma cópia da imagem na pasta temporária, para não
+ *     mexer no cache da imagem original)
+ * e a maior diferença entre os caminhos SIMD e escalar (deve ser 0 ou 1 por arredondamento).
+ *
+ * Uso: MipmapBench [repetições]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//STB_IMAGE
+#include <stb_image.h>
+
+#include "ThreadPool.h"
+#include "TextureCompression.h"
+#include "TextureMips.h"
+#include "Timing.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+const string PLANETS = "../Modelos3D/Planetas/";
+
+static double best(int repeats, const function<void()>& run)
+{
+	double bestMs = 1e30;
+	for (int r = 0; r < repeats; r++)
+	{
+		auto t0 = Clock::now();
+		run();
+		bestMs = min(bestMs, elapsedMs(t0));
+	}
+	return bestMs;
+}
+
+static void naiveChain(const unsigned char* rgba, int width, int height, vector<vector<unsigned char>>& levels)
+{
+	levels.assign(1, vector<unsigned char>(rgba, rgba + (size_t)width * height * 4));
+	for (int w = width, h = height; w > 1 || h > 1; w = max(1, w / 2), h = max(1, h / 2))
+	{
+		levels.emplace_back();
+		downsampleRGBA8(levels[levels.size() - 2].data(), w, h, levels.back());
+	}
+}
+
+static int maxDifference(const TextureLevels& a, const TextureLevels& b)
+{
+	int difference = 0;
+	for (size_t i = 0; i < a.data.size(); i++)
+		difference = max(difference, abs((int)a.data[i] - (int)b.data[i]));
+	return difference;
+}
+
+int main(int argc, char** argv)
+{
+	int repeats = argc > 1 ? max(1, atoi(argv[1])) : 3;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "MipmapBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	unsigned nThreads = ThreadPool::global().size();
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+	bool avx2 = mipCpuHasAVX2();
+	cout << "SIMD: " << mipSimdLevel() << (avx2 ? "" : " (CPU sem AVX2/FMA)") << ", " << nThreads << " threads no pool" << endl;
+
+	cout << fixed << setprecision(1);
+	for (const char* name : { "Terra.jpg", "2k_mercury.jpg" })
+	{
+		string path = PLANETS + name;
+		int width, height, channels;
+		unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+		if (!pixels)
+		{
+			cout << "Falha ao ler " << path << endl;
+			continue;
+		}
+		cout << endl << name << " (" << width << "x" << height << ")" << endl;
+		cout << setw(28) << "modo" << setw(12) << "ms" << setw(12) << "x ingenuo" << setw(12) << "x escalar" << endl;
+
+		vector<vector<unsigned char>> naive;
+		double naiveMs = best(repeats, [&]() { naiveChain(pixels, width, height, naive); });
+		cout << setw(28) << "ingenuo (box 8 bits)" << setw(12) << naiveMs << setw(12) << 1.0 << endl;
+
+		TextureLevels kaiser;
+		for (MipFilter filter : { MIP_BOX, MIP_KAISER, MIP_LANCZOS })
+		{
+			MipSettings settings;
+			settings.filter = filter;
+			TextureLevels scalar, sse2, simd;
+			settings.simd = false;
+			settings.nThreads = 1;
+			double scalarMs = best(repeats, [&]() { generateMipChain(pixels, width, height, settings, scalar); });
+			settings.simd = true;
+			settings.useAVX2 = false;
+			double sse2Ms = best(repeats, [&]() { generateMipChain(pixels, width, height, settings, sse2); });
+			settings.useAVX2 = true;
+			double simdMs = avx2 ? best(repeats, [&]() { generateMipChain(pixels, width, height, settings, simd); }) : sse2Ms;
+			settings.nThreads = 0;
+			double threadsMs = best(repeats, [&]() { generateMipChain(pixels, width, height, settings, simd); });
+
+			string label = mipFilterName(filter);
+			cout << setw(28) << label + " escalar 1 thread" << setw(12) << scalarMs << setw(12) << naiveMs / scalarMs << endl;
+			cout << setw(28) << label + " SSE2 1 thread" << setw(12) << sse2Ms << setw(12) << naiveMs / sse2Ms << setw(12) << scalarMs / sse2Ms
+				<< "   (diferenca SSE2/escalar: " << maxDifference(sse2, scalar) << ")" << endl;
+			if (avx2)
+				cout << setw(28) << label + " AVX2 1 thread" << setw(12) << simdMs << setw(12) << naiveMs / simdMs << setw(12) << scalarMs / simdMs
+					<< "   (diferenca AVX2/escalar: " << maxDifference(simd, scalar) << ")" << endl;
+			cout << setw(28) << label + " SIMD pool (" + to_string(nThreads) + ")" << setw(12) << threadsMs << setw(12) << naiveMs / threadsMs
+				<< setw(12) << scalarMs / threadsMs << "   (diferenca SIMD/escalar: " << maxDifference(simd, scalar) << ")" << endl;
+			if (filter == MIP_KAISER)
+				kaiser = move(simd);
+		}
+
+		GLuint texID;
+		glGenTextures(1, &texID);
+		glBindTexture(GL_TEXTURE_2D, texID);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		glFinish();
+		double gpuMs = best(repeats, [&]()
+		{
+			glGenerateMipmap(GL_TEXTURE_2D);
+			glFinish();
+		});
+		glDeleteTextures(1, &texID);
+		cout << setw(28) << "glGenerateMipmap" << setw(12) << gpuMs << setw(12) << naiveMs / gpuMs << endl;
+
+		// Cadeia pronta no .cgtex, como nas execuções seguintes dos exemplos
+		string copyPath = (filesystem::temp_directory_path() / name).string();
+		filesystem::copy_file(path, copyPath, filesystem::copy_options::overwrite_existing);
+		if (writeTextureCache(copyPath, kaiser))
+		{
+			TextureLevels cached;
+			double readMs = best(repeats, [&]() { readTextureCache(copyPath, cached); });
+			cout << setw(28) << "leitura do .cgtex" << setw(12) << readMs << setw(12) << naiveMs / readMs
+				<< "   (" << cached.bytes() / 1024 << " KB, diferenca: " << maxDifference(cached, kaiser) << ")" << endl;
+			filesystem::remove(textureCachePath(copyPath));
+		}
+		filesystem::remove(copyPath);
+		stbi_image_free(pixels);
+	}
+
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,80 @@
+/* Relatório da geometria indexada
+ *
+ * Para cada .obj em Modelos3D compara o buffer "sopa de triângulos" (um vértice de
+ * OBJ_FLOATS_PER_VERTEX floats por canto, desenhado com glDrawArrays) com a versão
+ * indexada de buildIndexedMesh (vértices únicos + índices para glDrawElements).
+ * Também confere se expandir os índices reproduz exatamente o buffer original.
+ *
+ * Uso: OBJIndexingBench [pasta dos modelos]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <algorithm>
+
+using namespace std;
+
+//Leitor de arquivos OBJ
+#include "OBJLoader.h"
+
+static bool expandsToSoup(const IndexedMesh& mesh, const OBJData& data)
+{
+	const size_t stride = OBJ_FLOATS_PER_VERTEX * sizeof(float);
+	for (size_t i = 0; i < mesh.indices.size(); i++)
+		if (memcmp(&mesh.vertices[mesh.indices[i] * OBJ_FLOATS_PER_VERTEX],
+			&data.vBuffer[i * OBJ_FLOATS_PER_VERTEX], stride) != 0)
+			return false;
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	string root = argc > 1 ? argv[1] : "../Modelos3D";
+
+	vector<filesystem::path> files;
+	for (auto& entry : filesystem::recursive_directory_iterator(root))
+		if (entry.is_regular_file() && entry.path().extension() == ".obj")
+			files.push_back(entry.path());
+	sort(files.begin(), files.end());
+
+	cout << left << setw(28) << "arquivo" << right
+		<< setw(10) << "antes" << setw(10) << "depois" << setw(8) << "razao"
+		<< setw(12) << "KB antes" << setw(12) << "KB depois" << setw(10) << "economia"
+		<< setw(10) << "ms" << setw(6) << "ok" << endl;
+
+	size_t totalBefore = 0, totalAfter = 0;
+	for (const auto& path : files)
+	{
+		OBJData data;
+		if (!loadOBJ(path.string(), data))
+			continue;
+
+		IndexedMesh mesh;
+		auto t0 = chrono::high_resolution_clock::now();
+		buildIndexedMesh(data, mesh);
+		auto t1 = chrono::high_resolution_clock::now();
+
+		size_t before = data.vBuffer.size() * sizeof(float);
+		size_t after = mesh.sizeInBytes();
+		totalBefore += before;
+		totalAfter += after;
+
+		cout << left << setw(28) << path.filename().string() << right << fixed
+			<< setw(10) << data.nVertices() << setw(10) << mesh.nVertices()
+			<< setprecision(2) << setw(8) << (double)data.nVertices() / max(1, mesh.nVertices())
+			<< setw(12) << before / 1024 << setw(12) << after / 1024
+			<< setprecision(1) << setw(9) << 100.0 * (1.0 - (double)after / before) << "%"
+			<< setprecision(2) << setw(10) << chrono::duration<double, milli>(t1 - t0).count()
+			<< setw(6) << (expandsToSoup(mesh, data) ? "sim" : "NAO") << endl;
+	}
+
+	cout << "Total: " << totalBefore / 1024 << " KB -> " << totalAfter / 1024 << " KB ("
+		<< fixed << setprecision(1) << 100.0 * (1.0 - (double)totalAfter / max<size_t>(1, totalBefore))
+		<< "% menos memória de vídeo e banda de upload)" << endl;
+	return 0;
+}
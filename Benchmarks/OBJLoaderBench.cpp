@@ -0,0 +1,162 @@
+/* Benchmark do leitor de OBJ
+ *
+ * Compara o parsing original do loadSimpleOBJ (getline + istringstream + stoi)
+ * com o leitor mapeado em memória de Common/src/OBJLoader.cpp, para todos os
+ * arquivos .obj encontrados em Modelos3D. Reporta MB/s e faces/s.
+ *
+ * Uso: OBJLoaderBench [pasta dos modelos] [repetições]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+
+using namespace std;
+
+//GLM
+#include <glm/glm.hpp>
+
+//Leitor de arquivos OBJ
+#include "OBJLoader.h"
+
+// Parsing como era feito no loadSimpleOBJ dos exemplos (sem a parte da OpenGL)
+static size_t legacyParse(const string& filePath, vector<float>& vBuffer)
+{
+	vector <glm::vec3> vertices;
+	vector <glm::vec2> texCoords;
+	vector <glm::vec3> normals;
+	glm::vec3 color = glm::vec3(1.0, 0.0, 0.0);
+	size_t nFaces = 0;
+
+	ifstream arqEntrada(filePath.c_str());
+	string line;
+	while (getline(arqEntrada, line))
+	{
+		istringstream ssline(line);
+		string word;
+		ssline >> word;
+		if (word == "v")
+		{
+			glm::vec3 v;
+			ssline >> v.x >> v.y >> v.z;
+			vertices.push_back(v);
+		}
+		else if (word == "vt")
+		{
+			glm::vec2 vt;
+			ssline >> vt.s >> vt.t;
+			texCoords.push_back(vt);
+		}
+		else if (word == "vn")
+		{
+			glm::vec3 vn;
+			ssline >> vn.x >> vn.y >> vn.z;
+			normals.push_back(vn);
+		}
+		else if (word == "f")
+		{
+			nFaces++;
+			while (ssline >> word)
+			{
+				istringstream ss(word);
+				string index;
+				getline(ss, index, '/');
+				int vi = stoi(index) - 1;
+				getline(ss, index, '/');
+				int ti = stoi(index) - 1;
+				getline(ss, index);
+				int ni = stoi(index) - 1;
+
+				float corner[OBJ_FLOATS_PER_VERTEX] = {
+					vertices[vi].x, vertices[vi].y, vertices[vi].z,
+					color.r, color.g, color.b,
+					texCoords[ti].s, texCoords[ti].t,
+					normals[ni].x, normals[ni].y, normals[ni].z
+				};
+				vBuffer.insert(vBuffer.end(), corner, corner + OBJ_FLOATS_PER_VERTEX);
+			}
+		}
+	}
+	return nFaces;
+}
+
+// Executa f() "repeats" vezes e devolve o menor tempo, em segundos
+template <typename F>
+static double bestOf(int repeats, F f)
+{
+	double best = 1e30;
+	for (int i = 0; i < repeats; i++)
+	{
+		auto t0 = chrono::high_resolution_clock::now();
+		f();
+		auto t1 = chrono::high_resolution_clock::now();
+		best = min(best, chrono::duration<double>(t1 - t0).count());
+	}
+	return best;
+}
+
+int main(int argc, char** argv)
+{
+	string root = argc > 1 ? argv[1] : "../Modelos3D";
+	int repeats = argc > 2 ? max(1, atoi(argv[2])) : 3;
+
+	vector<filesystem::path> files;
+	for (auto& entry : filesystem::recursive_directory_iterator(root))
+		if (entry.is_regular_file() && entry.path().extension() == ".obj")
+			files.push_back(entry.path());
+	sort(files.begin(), files.end());
+
+	if (files.empty())
+	{
+		cout << "Nenhum arquivo .obj encontrado em " << root << endl;
+		return 1;
+	}
+
+	cout << left << setw(40) << "arquivo" << right
+		<< setw(10) << "MB" << setw(10) << "faces"
+		<< setw(14) << "antigo MB/s" << setw(14) << "novo MB/s"
+		<< setw(16) << "novo faces/s" << setw(10) << "ganho" << endl;
+
+	double totalMB = 0.0, totalLegacy = 0.0, totalNew = 0.0;
+	size_t totalFaces = 0;
+	for (const auto& path : files)
+	{
+		double mb = filesystem::file_size(path) / (1024.0 * 1024.0);
+
+		size_t faces = 0;
+		double tLegacy = bestOf(repeats, [&]() {
+			vector<float> vBuffer;
+			legacyParse(path.string(), vBuffer);
+		});
+		double tNew = bestOf(repeats, [&]() {
+			OBJData data;
+			loadOBJ(path.string(), data);
+			faces = data.nFaces;
+		});
+
+		totalMB += mb;
+		totalFaces += faces;
+		totalLegacy += tLegacy;
+		totalNew += tNew;
+
+		cout << left << setw(40) << path.filename().string() << right << fixed
+			<< setprecision(2) << setw(10) << mb << setw(10) << faces
+			<< setprecision(1) << setw(14) << mb / tLegacy << setw(14) << mb / tNew
+			<< setprecision(0) << setw(16) << faces / tNew
+			<< setprecision(1) << setw(9) << tLegacy / tNew << "x" << endl;
+	}
+
+	cout << left << setw(40) << "TOTAL" << right << fixed
+		<< setprecision(2) << setw(10) << totalMB << setw(10) << totalFaces
+		<< setprecision(1) << setw(14) << totalMB / totalLegacy << setw(14) << totalMB / totalNew
+		<< setprecision(0) << setw(16) << totalFaces / totalNew
+		<< setprecision(1) << setw(9) << totalLegacy / totalNew << "x" << endl;
+
+	return 0;
+}
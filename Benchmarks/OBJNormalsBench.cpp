@@ -0,0 +1,175 @@
+/* Benchmark da geração de normais suaves (generateNormals em OBJLoader.h)
+ *
+ * Para cada modelo, remove as normais do texto do .obj (registros vn apagados e
+ * faces reescritas de v/vt/vn para v/vt, ou de v//vn para v) e mede:
+ *   - o parsing do texto sem normais (parseOBJ)
+ *   - generateNormals com 1..N threads, conferindo se o resultado é idêntico ao de 1
+ *   - o desvio médio e o percentil 95, em graus, entre as normais geradas e as
+ *     normais originais do arquivo, canto por canto
+ *   - os vértices únicos depois da indexação, com as normais originais e com as geradas
+ *
+ * Uso: OBJNormalsBench [max threads] [ângulo de quina em graus] [arquivo.obj ...]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+//GLM
+#include <glm/glm.hpp>
+
+//Leitor de arquivos OBJ
+#include "OBJLoader.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+// Copia o texto do .obj sem as normais: linhas vn somem e o último campo de cada
+// canto de face (depois da segunda barra) é descartado
+static string stripNormals(const char* begin, const char* end)
+{
+	string out;
+	out.reserve((size_t)(end - begin));
+	const char* p = begin;
+	while (p < end)
+	{
+		const char* lineEnd = (const char*)memchr(p, '\n', (size_t)(end - p));
+		lineEnd = lineEnd ? lineEnd + 1 : end;
+		if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t'))
+		{
+			p = lineEnd;
+			continue;
+		}
+		if (lineEnd - p >= 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+		{
+			int slashes = 0;
+			for (const char* q = p; q < lineEnd; q++)
+			{
+				if (*q == '/')
+				{
+					slashes++;
+					if (slashes == 2)
+					{
+						// v//vn vira v; v/vt/vn vira v/vt
+						if (out.back() == '/')
+							out.pop_back();
+						while (q + 1 < lineEnd && q[1] != ' ' && q[1] != '\t' && q[1] != '\r' && q[1] != '\n')
+							q++;
+						continue;
+					}
+				}
+				else if (*q == ' ' || *q == '\t')
+					slashes = 0;
+				out.push_back(*q);
+			}
+		}
+		else
+			out.append(p, lineEnd);
+		p = lineEnd;
+	}
+	return out;
+}
+
+static bool sameNormals(const OBJData& a, const OBJData& b)
+{
+	return a.normals.size() == b.normals.size() && a.vBuffer.size() == b.vBuffer.size() &&
+		memcmp(a.vBuffer.data(), b.vBuffer.data(), a.vBuffer.size() * sizeof(float)) == 0;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned maxThreads = argc > 1 ? (unsigned)max(1, atoi(argv[1])) : max(1u, thread::hardware_concurrency());
+	float creaseAngle = argc > 2 ? (float)atof(argv[2]) : OBJ_CREASE_ANGLE;
+	vector<string> files;
+	for (int i = 3; i < argc; i++)
+		files.push_back(argv[i]);
+	if (files.empty())
+		files = { "../Modelos3D/Suzannes/SuzanneHigh.obj", "../Modelos3D/Novos/couch.obj" };
+
+	const int repeats = 5;
+	cout << fixed;
+	for (const string& path : files)
+	{
+		MappedFile file;
+		if (!file.open(path))
+		{
+			cout << "Erro ao tentar ler o arquivo " << path << endl;
+			continue;
+		}
+		OBJData original;
+		parseOBJ(file.data(), file.data() + file.size(), original);
+		string stripped = stripNormals(file.data(), file.data() + file.size());
+
+		OBJData parsed;
+		auto t0 = Clock::now();
+		parseOBJ(stripped.data(), stripped.data() + stripped.size(), parsed);
+		auto t1 = Clock::now();
+		cout << path << " (" << parsed.nTriangles() << " triangulos, " << parsed.vertices.size() << " posicoes, "
+			<< original.normals.size() << " -> " << parsed.normals.size() << " vn)" << endl;
+		cout << "  parsing sem normais: " << setprecision(2) << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+		cout << setw(10) << "threads" << setw(12) << "ms" << setw(12) << "speedup" << setw(12) << "identico" << endl;
+
+		OBJData reference;
+		double baseTime = 0.0;
+		for (unsigned t = 1; t <= maxThreads; t++)
+		{
+			double best = 1e30;
+			bool identical = true;
+			for (int r = 0; r < repeats; r++)
+			{
+				OBJData data = parsed;
+				auto s0 = Clock::now();
+				generateNormals(data, creaseAngle, t);
+				auto s1 = Clock::now();
+				best = min(best, chrono::duration<double, milli>(s1 - s0).count());
+				if (t == 1 && r == 0)
+					reference = data;
+				else
+					identical = identical && sameNormals(reference, data);
+			}
+			if (t == 1)
+				baseTime = best;
+			cout << setw(10) << t << setw(12) << setprecision(3) << best << setw(12) << setprecision(2) << baseTime / best
+				<< setw(12) << (identical ? "sim" : "NAO") << endl;
+		}
+
+		// Desvio em relação às normais do arquivo (mesmos cantos, mesma ordem)
+		vector<float> deviations;
+		if (original.vBuffer.size() == reference.vBuffer.size())
+		{
+			for (size_t c = 0; c < reference.corners.size(); c++)
+			{
+				const float* a = original.vBuffer.data() + c * OBJ_FLOATS_PER_VERTEX + 8;
+				const float* b = reference.vBuffer.data() + c * OBJ_FLOATS_PER_VERTEX + 8;
+				glm::vec3 na(a[0], a[1], a[2]), nb(b[0], b[1], b[2]);
+				float la = glm::length(na), lb = glm::length(nb);
+				if (la > 0.0f && lb > 0.0f)
+					deviations.push_back(glm::degrees(acos(glm::clamp(glm::dot(na, nb) / (la * lb), -1.0f, 1.0f))));
+			}
+		}
+		if (!deviations.empty())
+		{
+			double mean = 0.0;
+			for (float d : deviations)
+				mean += d;
+			mean /= deviations.size();
+			nth_element(deviations.begin(), deviations.begin() + deviations.size() * 95 / 100, deviations.end());
+			cout << "  desvio das normais do arquivo: media " << setprecision(2) << mean << " graus, p95 "
+				<< deviations[deviations.size() * 95 / 100] << " graus (quina de " << setprecision(0) << creaseAngle << " graus)" << endl;
+		}
+
+		IndexedMesh withFile, generated;
+		buildIndexedMesh(original, withFile);
+		buildIndexedMesh(reference, generated);
+		cout << "  vertices unicos: " << withFile.nVertices() << " (normais do arquivo), "
+			<< generated.nVertices() << " (geradas)" << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,80 @@
+/* Benchmark de escalabilidade do parsing paralelo de OBJ
+ *
+ * Mede parseOBJParallel com 1..N threads para os modelos maiores da cena do
+ * escritório e confere se o buffer gerado é idêntico (byte a byte) ao do
+ * parsing sequencial.
+ *
+ * Uso: OBJParallelBench [max threads] [arquivo.obj ...]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+//Leitor de arquivos OBJ
+#include "OBJLoader.h"
+
+static bool sameData(const OBJData& a, const OBJData& b)
+{
+	return a.nFaces == b.nFaces && a.vBuffer.size() == b.vBuffer.size() &&
+		memcmp(a.vBuffer.data(), b.vBuffer.data(), a.vBuffer.size() * sizeof(float)) == 0;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned maxThreads = argc > 1 ? (unsigned)max(1, atoi(argv[1])) : max(1u, thread::hardware_concurrency());
+	vector<string> files;
+	for (int i = 2; i < argc; i++)
+		files.push_back(argv[i]);
+	if (files.empty())
+		files = { "../Modelos3D/Novos/couch.obj", "../Modelos3D/Novos/desk.obj", "../Modelos3D/Novos/BlueChair.obj" };
+
+	const int repeats = 5;
+	for (const string& path : files)
+	{
+		MappedFile file;
+		if (!file.open(path))
+		{
+			cout << "Erro ao tentar ler o arquivo " << path << endl;
+			continue;
+		}
+		double mb = file.size() / (1024.0 * 1024.0);
+
+		OBJData reference;
+		parseOBJ(file.data(), file.data() + file.size(), reference);
+
+		cout << path << " (" << fixed << setprecision(2) << mb << " MB, " << reference.nFaces << " faces)" << endl;
+		cout << setw(10) << "threads" << setw(12) << "ms" << setw(12) << "MB/s" << setw(12) << "speedup" << setw(12) << "idêntico" << endl;
+
+		double baseTime = 0.0;
+		for (unsigned t = 1; t <= maxThreads; t++)
+		{
+			double best = 1e30;
+			bool identical = true;
+			for (int r = 0; r < repeats; r++)
+			{
+				OBJData data;
+				auto t0 = chrono::high_resolution_clock::now();
+				parseOBJParallel(file.data(), file.data() + file.size(), data, t);
+				auto t1 = chrono::high_resolution_clock::now();
+				best = min(best, chrono::duration<double>(t1 - t0).count());
+				identical = identical && sameData(reference, data);
+			}
+			if (t == 1)
+				baseTime = best;
+			cout << setw(10) << t << setprecision(2) << setw(12) << best * 1000.0
+				<< setprecision(1) << setw(12) << mb / best
+				<< setprecision(2) << setw(12) << baseTime / best
+				<< setw(12) << (identical ? "sim" : "NAO") << endl;
+		}
+		cout << endl;
+	}
+	return 0;
+}
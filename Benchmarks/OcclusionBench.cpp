@@ -0,0 +1,314 @@
+/* Benchmark da oclusão na CPU (OcclusionCulling.h)
+ *
+ * Monta uma sala de aula com as malhas de Modelos3D/Novos: fileiras de mesas, cada uma
+ * com dois computadores, mouse e mousepad, e uma cadeira na frente, mais o sofá na
+ * parede do fundo e a placa do curso. A câmera fica em pé na frente da sala e anda de
+ * um lado para o outro; as mesas e os computadores das primeiras fileiras escondem boa
+ * parte das de trás.
+ *
+ * A cada frame:
+ *   1. frustum culling das caixas dos objetos
+ *   2. mesas, computadores, cadeiras e sofá (no nível de detalhe de OccluderMesh) são
+ *      rasterizados no OcclusionBuffer, e as caixas de todos os objetos dentro do
+ *      frustum são testadas contra a pirâmide Hi-Z
+ *   3. a máscara resultante vai para DrawList::submit (phong.fs de Hello3D- Iluminacao)
+ * Mostra os tempos da oclusão com cada rasterizador (escalar, SSE2, AVX2) e número de
+ * threads, a porcentagem de drawcalls descartadas e o tempo de GPU (glFinish) com e
+ * sem a máscara.
+ *
+ * Conferência: para cada objeto descartado pela oclusão, a cena visível é desenhada e
+ * o objeto é testado com uma occlusion query (GL_ANY_SAMPLES_PASSED) na resolução da
+ * janela; amostras que passam indicam um objeto descartado que apareceria.
+ *
+ * Uso: OcclusionBench [mesas por fileira] [fileiras] [frames]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+//Classe gerenciadora de shaders
+#include "Shader.h"
+#include "FrameData.h"
+#include "MeshCache.h"
+#include "MeshBuffers.h"
+#include "DrawList.h"
+#include "OcclusionCulling.h"
+#include "ThreadPool.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+const string MODELS = "../Modelos3D/Novos/";
+const int WIDTH = 512, HEIGHT = 256; // mesma proporção do OcclusionBuffer
+
+struct OccluderSceneMesh : SceneMesh
+{
+	OccluderMesh occluder;
+};
+
+struct SceneObject
+{
+	const OccluderSceneMesh* mesh;
+	glm::mat4 model;
+	AABB box;      // em coordenadas de mundo
+	bool occluder; // entra no OcclusionBuffer
+};
+
+static bool loadOccluderMesh(const string& objPath, OccluderSceneMesh& sceneMesh)
+{
+	CachedMesh mesh;
+	if (!loadSceneMesh(objPath, mesh, sceneMesh))
+		return false;
+	sceneMesh.occluder.build(mesh);
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	int perRow = argc > 1 ? max(1, atoi(argv[1])) : 4;
+	int rows = argc > 2 ? max(1, atoi(argv[2])) : 8;
+	int frames = argc > 3 ? max(1, atoi(argv[3])) : 16;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "OcclusionBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+
+	Shader shader("../Hello3D- Iluminacao/phong.vs", "../Hello3D- Iluminacao/phong.fs");
+
+	const char* names[] = { "desk", "computer", "BlueChair", "OrangeChair", "mouse", "mousepad", "couch", "cienciaDaComputacao" };
+	map<string, OccluderSceneMesh> meshes;
+	for (const char* name : names)
+	{
+		if (!loadOccluderMesh(MODELS + name + ".obj", meshes[name]))
+		{
+			cout << "Erro ao tentar ler o arquivo " << MODELS + name + ".obj" << endl;
+			return 1;
+		}
+	}
+	cout << "Oclusores (nivel de detalhe com erro ate " << OCCLUDER_MAX_ERROR << " do raio):";
+	for (const char* name : { "desk", "computer", "BlueChair", "couch" })
+		cout << " " << name << " " << meshes[name].nTriangles << " -> " << meshes[name].occluder.nTriangles();
+	cout << " triangulos" << endl;
+
+	// Sala: mesas de 11.7 x 2.5 x 4.6 (unidades dos .obj) em fileiras ao longo de -z
+	vector<SceneObject> objects;
+	DrawList drawList;
+	int nTriangles = 0;
+	auto place = [&](const string& name, glm::vec3 position, float angle, bool occluder)
+	{
+		const OccluderSceneMesh& mesh = meshes[name];
+		SceneObject object;
+		object.mesh = &mesh;
+		object.model = glm::rotate(glm::translate(glm::mat4(1), position), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
+		object.box = transformBounds(mesh.bounds, object.model);
+		object.occluder = occluder;
+		size_t first = drawList.items.size();
+		drawList.addSubmeshes(&shader, mesh.VAO, mesh.submeshes, mesh.materials, vector<GLuint>(), 0, object.model);
+		for (size_t i = first; i < drawList.items.size(); i++)
+			drawList.items[i].object = (int)objects.size();
+		objects.push_back(object);
+		nTriangles += mesh.nTriangles;
+	};
+	const float spacingX = 13.0f, spacingZ = 9.0f, deskTop = 2.49f;
+	for (int r = 0; r < rows; r++)
+	{
+		for (int c = 0; c < perRow; c++)
+		{
+			glm::vec3 base((c - 0.5f * (perRow - 1)) * spacingX, 0.0f, -r * spacingZ);
+			place("desk", base, 0.0f, true);
+			for (float side : { -3.0f, 3.0f })
+			{
+				place("computer", base + glm::vec3(side, deskTop, -1.0f), 0.0f, true);
+				place("mousepad", base + glm::vec3(side + 2.0f, deskTop, 0.8f), 0.0f, false);
+				place("mouse", base + glm::vec3(side + 2.0f, deskTop + 0.2f, 0.8f), 0.0f, false);
+				place((r + c) % 2 == 0 ? "BlueChair" : "OrangeChair", base + glm::vec3(side, 1.67f, 3.4f), 180.0f, true);
+			}
+		}
+	}
+	float back = -rows * spacingZ;
+	place("couch", glm::vec3(0.0f, 0.57f, back), 0.0f, true);
+	place("cienciaDaComputacao", glm::vec3(0.0f, 7.0f, back - 2.0f), 0.0f, false);
+	drawList.sort();
+	cout << "Cena: " << objects.size() << " objetos, " << drawList.items.size() << " submeshes (drawcalls), "
+		<< nTriangles << " triangulos" << endl;
+
+	FrameUniforms frameUniforms;
+	frameUniforms.create();
+	FrameData frameData;
+	frameData.projection = glm::perspective(glm::radians(50.0f), (float)WIDTH / HEIGHT, 0.1f, 400.0f);
+	frameData.lightPos = glm::vec4(0.0f, 30.0f, 10.0f, 1.0f);
+	float halfWidth = 0.5f * perRow * spacingX;
+	auto viewAt = [&](int frame)
+	{
+		float s = frames > 1 ? (float)frame / (frames - 1) : 0.5f;
+		glm::vec3 eye(-0.6f * halfWidth + 1.2f * halfWidth * s, 3.6f, 8.0f);
+		return glm::lookAt(eye, eye + glm::vec3(0.0f, -0.12f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	};
+
+	// Máscara do frame: frustum e depois oclusão
+	OcclusionBuffer occlusion;
+	vector<uint8_t> inFrustum(objects.size()), visible(objects.size());
+	auto cullFrame = [&](int frame)
+	{
+		glm::mat4 viewProjection = frameData.projection * viewAt(frame);
+		Frustum frustum(viewProjection);
+		occlusion.begin(viewProjection);
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			inFrustum[i] = frustum.testAABB(objects[i].box) != FRUSTUM_OUTSIDE;
+			if (inFrustum[i] && objects[i].occluder)
+				occlusion.addOccluder(objects[i].mesh->occluder, objects[i].model);
+		}
+		occlusion.rasterize();
+		for (size_t i = 0; i < objects.size(); i++)
+			visible[i] = inFrustum[i] && !occlusion.isOccluded(objects[i].box);
+	};
+	auto countItems = [&](const vector<uint8_t>& mask)
+	{
+		int n = 0;
+		for (const DrawItem& item : drawList.items)
+			n += mask[item.object] != 0;
+		return n;
+	};
+
+	// Tempos da oclusão por rasterizador e threads
+	unsigned threads = ThreadPool::global().size() + 1;
+	struct Config
+	{
+		const char* name;
+		bool simd, avx2;
+		unsigned threads;
+	};
+	vector<Config> configs = { { "escalar", false, false, 1 }, { "SSE2", true, false, 1 } };
+	if (OcclusionBuffer::cpuHasAVX2())
+		configs.push_back({ "AVX2", true, true, 1 });
+	if (threads > 1)
+		configs.push_back({ OcclusionBuffer::cpuHasAVX2() ? "AVX2" : "SSE2", true, true, threads });
+	cout << fixed << setprecision(3);
+	cout << endl << setw(10) << "raster" << setw(9) << "threads" << setw(12) << "preparo ms" << setw(11) << "raster ms"
+		<< setw(9) << "Hi-Z ms" << setw(10) << "teste ms" << setw(10) << "total ms" << setw(12) << "triangulos" << endl;
+	vector<vector<uint8_t>> reference(frames);
+	bool sameMasks = true;
+	for (const Config& config : configs)
+	{
+		occlusion.simd = config.simd;
+		occlusion.useAVX2 = config.avx2;
+		occlusion.maxThreads = config.threads;
+		double setupMs = 0.0, rasterMs = 0.0, hizMs = 0.0, testMs = 0.0, totalMs = 0.0;
+		int binned = 0;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			auto t0 = Clock::now();
+			cullFrame(frame);
+			totalMs += chrono::duration<double, milli>(Clock::now() - t0).count();
+			const OcclusionStats& stats = occlusion.stats();
+			setupMs += stats.setupMs;
+			rasterMs += stats.rasterMs;
+			hizMs += stats.hizMs;
+			binned += stats.trianglesBinned;
+			if (reference[frame].empty())
+				reference[frame] = visible;
+			else
+				sameMasks = sameMasks && reference[frame] == visible;
+		}
+		testMs = totalMs - setupMs - rasterMs - hizMs;
+		cout << setw(10) << config.name << setw(9) << config.threads << setw(12) << setupMs / frames << setw(11) << rasterMs / frames
+			<< setw(9) << hizMs / frames << setw(10) << testMs / frames << setw(10) << totalMs / frames << setw(12) << binned / frames << endl;
+	}
+	cout << "Mascaras iguais entre os rasterizadores: " << (sameMasks ? "sim" : "NAO") << endl;
+
+	// Drawcalls descartadas e tempo de GPU, com a máscara do último rasterizador
+	glEnable(GL_DEPTH_TEST);
+	glViewport(0, 0, WIDTH, HEIGHT);
+	vector<uint8_t> all(objects.size(), 1);
+	int totalItems = (int)drawList.items.size();
+	double frustumItems = 0.0, visibleItems = 0.0, frustumMs = 0.0, occlusionMs = 0.0;
+	int wrong = 0, checked = 0;
+	GLuint query;
+	glGenQueries(1, &query);
+	for (int frame = 0; frame < frames; frame++)
+	{
+		cullFrame(frame);
+		frameData.view = viewAt(frame);
+		frameData.cameraPos = glm::inverse(frameData.view)[3];
+		frameUniforms.update(frameData);
+		frustumItems += countItems(inFrustum);
+		visibleItems += countItems(visible);
+
+		for (int pass = 0; pass < 2; pass++)
+		{
+			glFinish();
+			auto t0 = Clock::now();
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			drawList.submit(pass == 0 ? inFrustum.data() : visible.data());
+			glFinish();
+			(pass == 0 ? frustumMs : occlusionMs) += chrono::duration<double, milli>(Clock::now() - t0).count();
+		}
+
+		// Conferência: com a cena visível no depth buffer, nenhum objeto descartado
+		// pela oclusão deveria ter amostras na frente dela
+		glDepthMask(GL_FALSE);
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		vector<uint8_t> single(objects.size(), 0);
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			if (!inFrustum[i] || visible[i])
+				continue;
+			single[i] = 1;
+			glBeginQuery(GL_ANY_SAMPLES_PASSED, query);
+			drawList.submit(single.data());
+			glEndQuery(GL_ANY_SAMPLES_PASSED);
+			single[i] = 0;
+			GLuint passed = 0;
+			glGetQueryObjectuiv(query, GL_QUERY_RESULT, &passed);
+			wrong += passed != 0;
+			checked++;
+		}
+		glDepthMask(GL_TRUE);
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	}
+	glDeleteQueries(1, &query);
+
+	frustumItems /= frames;
+	visibleItems /= frames;
+	cout << endl << setprecision(1) << "Drawcalls por frame: " << totalItems << " na cena, " << frustumItems << " no frustum, "
+		<< visibleItems << " depois da oclusao (" << 100.0 * (frustumItems - visibleItems) / max(frustumItems, 1.0)
+		<< "% das do frustum descartadas pela oclusao, " << 100.0 * (totalItems - visibleItems) / totalItems << "% no total)" << endl;
+	cout << setprecision(3) << "Frame na GPU (com glFinish): " << frustumMs / frames << " ms so com frustum, " << occlusionMs / frames
+		<< " ms com oclusao" << endl;
+	cout << "Conferencia com occlusion query: " << checked << " objetos descartados, " << wrong << " com amostras visiveis" << endl;
+
+	frameUniforms.destroy();
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,213 @@
+/* Benchmark da BVH de triângulos (MeshBVH.h)
+ *
+ * Para couch.obj e LightCruiser05.obj (ou as malhas passadas na linha de comando) mede
+ * a montagem da árvore com uma thread e com todas as do pool, e depois a vazão em
+ * milhões de raios por segundo de três conjuntos de raios:
+ *   - primários: uma câmera olhando para a malha, um raio por pixel (coerentes)
+ *   - aleatórios: de pontos ao redor da malha para pontos dentro da caixa dela
+ *   - sombra: dos pontos acertados pelos primários até uma luz (any hit, occluded)
+ * cada um com a travessia escalar, com SSE em uma thread e com SSE em lote (todas as
+ * threads). Os acertos mais próximos são conferidos com a força bruta (todos os
+ * triângulos) em uma amostra dos raios aleatórios.
+ *
+ * Uso: RaycastBench [resolução dos primários] [malha.obj...]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "MeshCache.h"
+#include "MeshBVH.h"
+#include "ThreadPool.h"
+#include "Timing.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+// Menor t entre todos os triângulos (referência)
+static RayHit bruteForce(const CachedMesh& mesh, const Ray& ray)
+{
+	RayHit best;
+	const float* vertices = mesh.vertexData();
+	const unsigned int* indices = mesh.indexData();
+	for (int t = 0; t < mesh.nIndices() / 3; t++)
+	{
+		glm::vec3 v0 = glm::make_vec3(vertices + (size_t)indices[3 * t] * OBJ_FLOATS_PER_VERTEX);
+		glm::vec3 e1 = glm::make_vec3(vertices + (size_t)indices[3 * t + 1] * OBJ_FLOATS_PER_VERTEX) - v0;
+		glm::vec3 e2 = glm::make_vec3(vertices + (size_t)indices[3 * t + 2] * OBJ_FLOATS_PER_VERTEX) - v0;
+		glm::vec3 p = glm::cross(ray.direction, e2);
+		float det = glm::dot(e1, p);
+		if (det == 0.0f)
+			continue;
+		glm::vec3 s = ray.origin - v0;
+		float u = glm::dot(s, p) / det;
+		glm::vec3 q = glm::cross(s, e1);
+		float v = glm::dot(ray.direction, q) / det;
+		float d = glm::dot(e2, q) / det;
+		if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && d > ray.tMin && d < best.t)
+		{
+			best.t = d;
+			best.triangle = t;
+		}
+	}
+	return best;
+}
+
+int main(int argc, char** argv)
+{
+	int resolution = argc > 1 ? max(16, atoi(argv[1])) : 512;
+	vector<string> paths;
+	for (int i = 2; i < argc; i++)
+		paths.push_back(argv[i]);
+	if (paths.empty())
+		paths = { "../Modelos3D/Novos/couch.obj", "../Modelos3D/Naves/LightCruiser05.obj" };
+	unsigned threads = ThreadPool::global().size() + 1;
+	cout << "Pool com " << threads << " threads, primarios em " << resolution << "x" << resolution << endl;
+
+	for (const string& path : paths)
+	{
+		CachedMesh mesh;
+		if (!mesh.load(path))
+		{
+			cout << "Erro ao ler " << path << endl;
+			continue;
+		}
+		cout << endl << path << ": " << mesh.nIndices() / 3 << " triangulos" << endl;
+
+		// Montagem
+		MeshBVH bvh;
+		double serialMs = 0.0, parallelMs = 0.0;
+		const int builds = 5;
+		for (int b = 0; b < builds; b++)
+		{
+			bvh.build(mesh, 1);
+			serialMs += bvh.buildMs;
+			bvh.build(mesh);
+			parallelMs += bvh.buildMs;
+		}
+		cout << fixed << setprecision(2) << "montagem: " << serialMs / builds << " ms com 1 thread, " << parallelMs / builds
+			<< " ms com " << threads << "; " << bvh.nNodes() << " nos de 4 filhos, " << bvh.nLeaves() << " folhas" << endl;
+
+		// Raios primários: câmera na frente da malha, um pouco acima
+		const MeshBounds& bounds = mesh.bounds();
+		glm::vec3 center = glm::vec3(bounds.sphere);
+		float radius = bounds.sphere.w;
+		glm::vec3 eye = center + radius * glm::vec3(0.8f, 0.9f, 2.2f);
+		glm::mat4 view = glm::lookAt(eye, center, glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f * radius);
+		vector<Ray> primary;
+		primary.reserve((size_t)resolution * resolution);
+		for (int y = 0; y < resolution; y++)
+			for (int x = 0; x < resolution; x++)
+				primary.push_back(screenRay(x + 0.5, y + 0.5, resolution, resolution, projection, view));
+
+		// Raios aleatórios: de pontos numa esfera ao redor da malha para pontos da caixa
+		mt19937 rng(42);
+		uniform_real_distribution<float> unit(0.0f, 1.0f);
+		vector<Ray> random(primary.size());
+		for (Ray& ray : random)
+		{
+			glm::vec3 direction;
+			do
+				direction = glm::vec3(unit(rng), unit(rng), unit(rng)) * 2.0f - 1.0f;
+			while (glm::dot(direction, direction) > 1.0f || glm::dot(direction, direction) < 1e-4f);
+			glm::vec3 origin = center + 2.0f * radius * glm::normalize(direction);
+			glm::vec3 target = bounds.min + glm::vec3(unit(rng), unit(rng), unit(rng)) * (bounds.max - bounds.min);
+			ray = Ray(origin, glm::normalize(target - origin));
+		}
+
+		// Referência dos acertos mais próximos (SIMD, em lote) e raios de sombra
+		vector<RayHit> primaryHits(primary.size()), hits(primary.size());
+		bvh.intersect(primary.data(), primaryHits.data(), primary.size());
+		glm::vec3 light = center + radius * glm::vec3(-2.0f, 3.0f, 1.0f);
+		vector<Ray> shadow;
+		for (size_t i = 0; i < primary.size(); i++)
+		{
+			if (primaryHits[i].triangle < 0)
+				continue;
+			glm::vec3 point = primary[i].at(primaryHits[i].t);
+			glm::vec3 toLight = light - point;
+			Ray ray(point, toLight, 1.0f);
+			ray.tMin = 1e-4f;
+			shadow.push_back(ray);
+		}
+		vector<uint8_t> occlusion(shadow.size());
+
+		struct RaySet
+		{
+			const char* name;
+			const vector<Ray>* rays;
+			bool anyHit;
+		};
+		RaySet sets[] = { { "primarios", &primary, false }, { "aleatorios", &random, false }, { "sombra (any hit)", &shadow, true } };
+		cout << setw(18) << "raios" << setw(10) << "n" << setw(11) << "acertos" << setw(12) << "escalar" << setw(12) << "SSE"
+			<< setw(14) << "SSE em lote" << "  (Mraios/s)" << endl;
+		for (const RaySet& set : sets)
+		{
+			const vector<Ray>& rays = *set.rays;
+			if (rays.empty())
+				continue;
+			double mrays[3];
+			size_t hitCount[3];
+			for (int mode = 0; mode < 3; mode++)
+			{
+				bvh.simd = mode > 0;
+				auto t0 = Clock::now();
+				if (mode < 2)
+				{
+					for (size_t i = 0; i < rays.size(); i++)
+					{
+						if (set.anyHit)
+							occlusion[i] = bvh.occluded(rays[i]) ? 1 : 0;
+						else
+							bvh.intersect(rays[i], hits[i]);
+					}
+				}
+				else if (set.anyHit)
+				{
+					bvh.occluded(rays.data(), occlusion.data(), rays.size());
+				}
+				else
+				{
+					bvh.intersect(rays.data(), hits.data(), rays.size());
+				}
+				mrays[mode] = rays.size() / (elapsedMs(t0) * 1000.0);
+				hitCount[mode] = 0;
+				for (size_t i = 0; i < rays.size(); i++)
+					hitCount[mode] += set.anyHit ? occlusion[i] : (hits[i].triangle >= 0);
+			}
+			cout << setw(18) << set.name << setw(10) << rays.size() << setw(11) << hitCount[1] << setw(12) << mrays[0]
+				<< setw(12) << mrays[1] << setw(14) << mrays[2]
+				<< (hitCount[0] == hitCount[1] && hitCount[1] == hitCount[2] ? "" : "  (acertos diferentes!)") << endl;
+		}
+
+		// Conferência com a força bruta
+		bvh.simd = true;
+		const size_t sample = 2000;
+		size_t mismatches = 0;
+		for (size_t i = 0; i < min(sample, random.size()); i++)
+		{
+			RayHit hit, reference = bruteForce(mesh, random[i]);
+			bvh.intersect(random[i], hit);
+			bool same = hit.triangle == reference.triangle ||
+				(hit.triangle >= 0 && reference.triangle >= 0 && fabs(hit.t - reference.t) <= 1e-5f * max(1.0f, reference.t));
+			mismatches += !same;
+		}
+		cout << "forca bruta em " << min(sample, random.size()) << " raios aleatorios: "
+			<< (mismatches == 0 ? "iguais" : to_string(mismatches) + " diferentes") << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,269 @@
+/* Benchmark da RenderQueue (RenderQueue.h): trocas de estado e tempo de envio
+ *
+ * Monta uma cena sintética com muitos desenhos pequenos (triângulos de
+ * Hello3D- Curvas), espalhados entre alguns programas (os shaders de Hello3D- Curvas
+ * compilados várias vezes, como programas diferentes), texturas 4x4 e VAOs, gravados
+ * em ordem aleatória, como sai de um percurso da cena que não olha o estado. Compara:
+ *   - direto: o que drawGrid, drawAxesVAO e drawTriangle faziam antes da fila, com
+ *     glUseProgram, glGetUniformLocation, glBindTexture e glBindVertexArray a cada desenho
+ *   - fila na ordem do push: a RenderQueue sem sort, que só pula o estado repetido
+ *   - fila ordenada: com sort (radix sort das chaves de 64 bits)
+ * e mede o tempo de CPU do envio ("envio") e o frame com glFinish. Por último compara o
+ * sort da fila com std::stable_sort das mesmas chaves. Usa uma janela invisível;
+ * funciona também com Mesa llvmpipe.
+ *
+ * Uso: RenderQueueBench [desenhos] [programas] [texturas] [VAOs] [frames por medição]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+//Classe gerenciadora de shaders
+#include "Shader.h"
+#include "RenderQueue.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+const string CURVES = "../Hello3D- Curvas/";
+
+struct FrameTime
+{
+	double submitMs = 0.0;
+	double frameMs = 0.0;
+	RenderQueueStats stats;
+};
+
+static FrameTime measure(int frames, const function<RenderQueueStats()>& submit)
+{
+	FrameTime t;
+	submit(); // aquecimento
+	glFinish();
+	for (int f = 0; f < frames; f++)
+	{
+		auto t0 = Clock::now();
+		glClear(GL_COLOR_BUFFER_BIT);
+		t.stats = submit();
+		auto t1 = Clock::now();
+		glFinish();
+		auto t2 = Clock::now();
+		t.submitMs += chrono::duration<double, milli>(t1 - t0).count();
+		t.frameMs += chrono::duration<double, milli>(t2 - t0).count();
+	}
+	t.submitMs /= frames;
+	t.frameMs /= frames;
+	return t;
+}
+
+static void printRow(const char* label, const FrameTime& t)
+{
+	cout << setw(14) << label << setw(10) << t.stats.programChanges << setw(10) << t.stats.textureChanges
+		<< setw(8) << t.stats.vaoChanges << setw(10) << t.stats.uniformUploads
+		<< setw(12) << t.submitMs << setw(12) << t.frameMs << endl;
+}
+
+static GLuint createTriangleVAO(float offset)
+{
+	GLfloat vertices[] = {
+		-0.5f + offset, -0.5f, 0.0f,
+		0.5f + offset, -0.5f, 0.0f,
+		0.0f + offset, 0.5f, 0.0f,
+	};
+	GLuint VBO, VAO;
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glGenVertexArrays(1, &VAO);
+	glBindVertexArray(VAO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	return VAO;
+}
+
+static GLuint createTexture(mt19937& rng)
+{
+	unsigned char pixels[4 * 4 * 4];
+	for (unsigned char& p : pixels)
+		p = (unsigned char)(rng() & 0xFF);
+	GLuint texID;
+	glGenTextures(1, &texID);
+	glBindTexture(GL_TEXTURE_2D, texID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return texID;
+}
+
+int main(int argc, char** argv)
+{
+	int nDraws = argc > 1 ? max(1, atoi(argv[1])) : 20000;
+	int nPrograms = argc > 2 ? max(1, atoi(argv[2])) : 4;
+	int nTextures = argc > 3 ? max(1, atoi(argv[3])) : 16;
+	int nVAOs = argc > 4 ? max(1, atoi(argv[4])) : 32;
+	int frames = argc > 5 ? max(1, atoi(argv[5])) : 5;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(256, 256, "RenderQueueBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+
+	// Programas distintos com o mesmo código (cada Shader tem o seu ID)
+	vector<unique_ptr<Shader>> shaders;
+	for (int i = 0; i < nPrograms; i++)
+		shaders.emplace_back(new Shader((CURVES + "hello-triangle.vs").c_str(), (CURVES + "hello-curves.fs").c_str()));
+
+	mt19937 rng(42);
+	vector<GLuint> textures, vaos;
+	for (int i = 0; i < nTextures; i++)
+		textures.push_back(createTexture(rng));
+	for (int i = 0; i < nVAOs; i++)
+		vaos.push_back(createTriangleVAO(0.01f * i));
+
+	RenderQueue queue;
+	vector<int> materials;
+	for (int i = 0; i < nTextures; i++)
+		materials.push_back(queue.addMaterial(glm::vec4((i & 1) ? 1.0f : 0.2f, (i & 2) ? 1.0f : 0.2f, (i & 4) ? 1.0f : 0.2f, 1.0f), textures[i]));
+
+	// Desenhos em ordem aleatória, cada um com a sua matriz de modelo
+	uniform_int_distribution<int> pickProgram(0, nPrograms - 1), pickMaterial(0, nTextures - 1), pickVAO(0, nVAOs - 1);
+	uniform_real_distribution<float> pickPos(-0.9f, 0.9f);
+	vector<RenderPacket> scene(nDraws);
+	for (RenderPacket& packet : scene)
+	{
+		packet.shader = shaders[pickProgram(rng)].get();
+		packet.VAO = vaos[pickVAO(rng)];
+		packet.material = materials[pickMaterial(rng)];
+		packet.mode = GL_TRIANGLES;
+		packet.count = 3;
+		packet.hasModel = true;
+		packet.model = glm::translate(glm::mat4(1.0f), glm::vec3(pickPos(rng), pickPos(rng), 0.0f));
+		packet.model = glm::scale(packet.model, glm::vec3(0.02f));
+	}
+	cout << "Cena: " << nDraws << " desenhos, " << nPrograms << " programas, " << nTextures << " texturas, "
+		<< nVAOs << " VAOs" << endl;
+
+	glViewport(0, 0, 256, 256);
+	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+	glActiveTexture(GL_TEXTURE0);
+
+	cout << fixed << setprecision(3);
+	cout << setw(14) << "ordem" << setw(10) << "programas" << setw(10) << "texturas" << setw(8) << "VAOs"
+		<< setw(10) << "uniforms" << setw(12) << "envio ms" << setw(12) << "frame ms" << endl;
+
+	// Sem fila: liga tudo e procura os uniforms pelo nome a cada desenho
+	FrameTime direct = measure(frames, [&]()
+	{
+		RenderQueueStats stats;
+		for (const RenderPacket& packet : scene)
+		{
+			const RenderMaterial& material = queue.material(packet.material);
+			GLuint program = packet.shader->ID;
+			glUseProgram(program);
+			glUniform4fv(glGetUniformLocation(program, "finalColor"), 1, glm::value_ptr(material.color));
+			glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, glm::value_ptr(packet.model));
+			glBindTexture(GL_TEXTURE_2D, material.texture);
+			glBindVertexArray(packet.VAO);
+			glDrawArrays(packet.mode, packet.first, packet.count);
+			glBindVertexArray(0);
+			stats.packets++;
+			stats.programChanges++;
+			stats.textureChanges++;
+			stats.vaoChanges++;
+			stats.uniformUploads += 2;
+		}
+		return stats;
+	});
+	printRow("direto", direct);
+
+	// Na fila, o envio inclui gravar os pacotes do frame (e ordenar)
+	auto record = [&]()
+	{
+		queue.begin();
+		for (const RenderPacket& packet : scene)
+			queue.push(packet);
+	};
+	FrameTime inOrder = measure(frames, [&]() { record(); return queue.submit(); });
+	printRow("fila (push)", inOrder);
+	FrameTime sorted = measure(frames, [&]() { record(); queue.sort(); return queue.submit(); });
+	printRow("fila ordenada", sorted);
+
+	const RenderQueueStats& stats = sorted.stats;
+	cout << "Trocas evitadas pela fila ordenada: programas " << stats.programChangesAvoided() << ", texturas "
+		<< stats.textureChangesAvoided() << ", VAOs " << stats.vaoChangesAvoided() << " de " << stats.packets
+		<< " desenhos (na ordem do push seriam " << stats.programChangesInOrder << ", " << stats.textureChangesInOrder
+		<< " e " << stats.vaoChangesInOrder << " trocas)" << endl;
+
+	// A ordem tem que seguir as chaves, e chaves iguais a ordem do push
+	bool ordered = true;
+	for (int i = 1; i < queue.nPackets(); i++)
+		ordered = ordered && queue.key(i - 1) <= queue.key(i);
+	cout << "Ordem das chaves: " << (ordered ? "ok" : "ERRADA") << endl;
+
+	// sort da fila (monta as chaves e faz o radix sort) contra std::stable_sort das
+	// mesmas chaves já prontas, embaralhadas
+	const int repeats = 20;
+	double radixMs = 0.0;
+	for (int r = 0; r < repeats; r++)
+	{
+		auto t0 = Clock::now();
+		queue.sort();
+		radixMs += chrono::duration<double, milli>(Clock::now() - t0).count();
+	}
+	vector<pair<uint64_t, uint32_t>> keys(queue.nPackets());
+	for (int i = 0; i < queue.nPackets(); i++)
+		keys[i] = make_pair(queue.key(i), (uint32_t)i);
+	double stdMs = 0.0;
+	for (int r = 0; r < repeats; r++)
+	{
+		vector<pair<uint64_t, uint32_t>> shuffled = keys;
+		shuffle(shuffled.begin(), shuffled.end(), rng);
+		auto t0 = Clock::now();
+		stable_sort(shuffled.begin(), shuffled.end(), [](const pair<uint64_t, uint32_t>& a, const pair<uint64_t, uint32_t>& b)
+		{
+			return a.first < b.first;
+		});
+		stdMs += chrono::duration<double, milli>(Clock::now() - t0).count();
+	}
+	cout << "sort da fila: " << radixMs / repeats << " ms (chaves + radix sort), std::stable_sort: "
+		<< stdMs / repeats << " ms (só a ordenação)" << endl;
+
+	for (GLuint texture : textures)
+		glDeleteTextures(1, &texture);
+	for (GLuint VAO : vaos)
+		glDeleteVertexArrays(1, &VAO);
+	glfwTerminate();
+	return 0;
+}
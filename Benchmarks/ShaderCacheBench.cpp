@@ -0,0 +1,117 @@
+/* Benchmark do cache de binários de programa da classe Shader
+ *
+ * Constrói os programas de shader dos exemplos de três formas:
+ *   - fonte: cache desligado (Shader::cacheDirectory vazio), compila e linka sempre
+ *   - frio:  cache vazio, compila, linka e grava o binário
+ *   - cache: carrega o binário gravado com glProgramBinary
+ * Usa uma janela invisível; funciona também com Mesa llvmpipe. O Mesa tem um cache
+ * interno em disco que acelera as rodadas "fonte" depois da primeira; aponte
+ * MESA_SHADER_CACHE_DIR para uma pasta vazia a cada execução para medir a
+ * compilação real (MESA_SHADER_CACHE_DISABLE=true também desliga os binários de
+ * programa, e o benchmark avisa).
+ *
+ * Uso: ShaderCacheBench [repetições]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//Classe gerenciadora de shaders
+#include "Shader.h"
+
+struct ShaderPair
+{
+	const char* vertexPath;
+	const char* fragmentPath;
+};
+
+static const ShaderPair shaderPairs[] = {
+	{ "../Hello3D- Texturas/phong.vs", "../Hello3D- Texturas/phong.fs" },
+	{ "../Hello3D- Iluminacao/phong.vs", "../Hello3D- Iluminacao/phong.fs" },
+	{ "../Hello3D- Curvas/hello-curves.vs", "../Hello3D- Curvas/hello-curves.fs" },
+	{ "../Hello3D- Curvas/hello-triangle.vs", "../Hello3D- Curvas/hello-curves.fs" },
+};
+
+// Constrói todos os programas e devolve o tempo total em ms
+static double buildAll()
+{
+	auto t0 = chrono::high_resolution_clock::now();
+	for (const ShaderPair& pair : shaderPairs)
+	{
+		Shader shader(pair.vertexPath, pair.fragmentPath);
+		glDeleteProgram(shader.ID);
+	}
+	glFinish();
+	auto t1 = chrono::high_resolution_clock::now();
+	return chrono::duration<double, milli>(t1 - t0).count();
+}
+
+static void printRow(const char* label, double ms)
+{
+	const ShaderStartupStats& s = Shader::startupStats;
+	cout << setw(8) << label << setw(12) << ms << setw(12) << s.compileMs << setw(12) << s.linkMs
+		<< setw(12) << s.cacheHitMs << setw(10) << s.cacheHits << endl;
+}
+
+int main(int argc, char** argv)
+{
+	int rounds = argc > 1 ? max(1, atoi(argv[1])) : 5;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "ShaderCacheBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+	cout << "OpenGL version supported " << glGetString(GL_VERSION) << endl;
+	if (!loadGLExtensions().programBinary)
+		cout << "Aviso: o driver não oferece binários de programa; todas as linhas compilam do fonte" << endl;
+
+	string cacheDir = "shader_cache_bench/";
+	error_code ec;
+	filesystem::remove_all(cacheDir, ec);
+
+	cout << fixed << setprecision(2);
+	cout << setw(8) << "modo" << setw(12) << "total ms" << setw(12) << "compile ms" << setw(12) << "link ms"
+		<< setw(12) << "cache ms" << setw(10) << "hits" << endl;
+	for (int r = 0; r < rounds; r++)
+	{
+		Shader::cacheDirectory = "";
+		Shader::startupStats = ShaderStartupStats();
+		printRow("fonte", buildAll());
+
+		filesystem::remove_all(cacheDir, ec);
+		Shader::cacheDirectory = cacheDir;
+		Shader::startupStats = ShaderStartupStats();
+		printRow("frio", buildAll());
+
+		Shader::startupStats = ShaderStartupStats();
+		printRow("cache", buildAll());
+	}
+
+	filesystem::remove_all(cacheDir, ec);
+	glfwTerminate();
+	return 0;
+}
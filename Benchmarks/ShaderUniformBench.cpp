@@ -0,0 +1,102 @@
+/* Microbenchmark dos setters de uniform da classe Shader
+ *
+ * Compara, por chamada:
+ *   - antigo: glGetUniformLocation(nome) + glUniform* (como os setters faziam antes)
+ *   - nome:   setter por std::string, que agora consulta o cache do Shader
+ *   - handle: setter com a localização obtida uma vez por shader.uniform()
+ * Usa uma janela invisível; funciona também com Mesa llvmpipe.
+ *
+ * Uso: ShaderUniformBench [iterações]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+//Classe gerenciadora de shaders
+#include "Shader.h"
+
+template <typename F>
+static double nsPerCall(int iterations, F f)
+{
+	glFinish();
+	auto t0 = chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++)
+		f(i);
+	glFinish();
+	auto t1 = chrono::high_resolution_clock::now();
+	return chrono::duration<double, nano>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+	int iterations = argc > 1 ? max(1, atoi(argv[1])) : 1000000;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "ShaderUniformBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+
+	Shader shader("../Hello3D- Texturas/phong.vs", "../Hello3D- Texturas/phong.fs");
+	shader.Use();
+
+	glm::mat4 model(1.0f);
+	GLint modelLoc = shader.uniform("model");
+	GLint kdLoc = shader.uniform("kd");
+
+	double oldMat = nsPerCall(iterations, [&](int i) {
+		model[3][0] = (float)i;
+		glUniformMatrix4fv(glGetUniformLocation(shader.ID, "model"), 1, GL_FALSE, glm::value_ptr(model));
+	});
+	double nameMat = nsPerCall(iterations, [&](int i) {
+		model[3][0] = (float)i;
+		shader.setMat4("model", glm::value_ptr(model));
+	});
+	double handleMat = nsPerCall(iterations, [&](int i) {
+		model[3][0] = (float)i;
+		shader.setMat4(modelLoc, glm::value_ptr(model));
+	});
+
+	double oldVec = nsPerCall(iterations, [&](int i) {
+		glUniform1f(glGetUniformLocation(shader.ID, "kd"), (float)i);
+	});
+	double nameVec = nsPerCall(iterations, [&](int i) {
+		shader.setFloat("kd", (float)i);
+	});
+	double handleVec = nsPerCall(iterations, [&](int i) {
+		shader.setFloat(kdLoc, (float)i);
+	});
+
+	cout << fixed << setprecision(1);
+	cout << setw(12) << "uniform" << setw(14) << "antigo ns" << setw(14) << "nome ns" << setw(14) << "handle ns" << endl;
+	cout << setw(12) << "mat4 model" << setw(14) << oldMat << setw(14) << nameMat << setw(14) << handleMat << endl;
+	cout << setw(12) << "float kd" << setw(14) << oldVec << setw(14) << nameVec << setw(14) << handleVec << endl;
+
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,173 @@
+/* Benchmark do cache de texturas (TextureCache.h)
+ *
+ * Monta a lista de texturas que os exemplos pediriam para a cena do escritório: uma
+ * por material dos .obj de Modelos3D/Novos (o atlas TexturasOffice.png para os
+ * materiais MateriaisOfficeSheet, o map_Kd para os demais), mais as outras imagens de
+ * Modelos3D uma vez cada. Carrega a lista de duas formas:
+ *   - sem cache: como o loadTexture dos exemplos, stbi_load e glTexImage2D na thread
+ *                do contexto, uma textura nova por pedido
+ *   - com cache: TextureCache::acquire para cada pedido e finish(); cada arquivo é
+ *                decodificado uma vez, nas threads do pool
+ * e mostra o tempo total, as texturas criadas e a memória de vídeo de cada forma, e o
+ * relatório do cache (decodificação, envio e memória por textura). Usa uma janela
+ * invisível; funciona também com Mesa llvmpipe.
+ *
+ * Uso: TextureCacheBench [repetições]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//STB_IMAGE
+#include <stb_image.h>
+
+#include "MeshCache.h"
+#include "AssetLoader.h"
+#include "TextureCache.h"
+#include "Timing.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+const string MODELS = "../Modelos3D/Novos/";
+const string ATLAS_MATERIAL = "MateriaisOfficeSheet";
+
+static size_t mipChainBytes(int width, int height)
+{
+	size_t bytes = 0;
+	for (int w = width, h = height; ; w = max(1, w / 2), h = max(1, h / 2))
+	{
+		bytes += (size_t)w * h * 4;
+		if (w == 1 && h == 1)
+			break;
+	}
+	return bytes;
+}
+
+// Como o loadTexture dos exemplos: tudo na thread do contexto, sem reaproveitar nada
+static GLuint loadTexture(const string& path, size_t& residentBytes)
+{
+	int width, height, channels;
+	unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+	if (!data)
+		return 0;
+	GLuint texID;
+	glGenTextures(1, &texID);
+	glBindTexture(GL_TEXTURE_2D, texID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	stbi_image_free(data);
+	residentBytes += mipChainBytes(width, height);
+	return texID;
+}
+
+int main(int argc, char** argv)
+{
+	int repeats = argc > 1 ? max(1, atoi(argv[1])) : 3;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "TextureCacheBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+
+	// Pedidos da cena: um por material
+	vector<string> requests;
+	vector<string> objPaths;
+	for (auto& entry : filesystem::directory_iterator(MODELS))
+		if (entry.is_regular_file() && entry.path().extension() == ".obj")
+			objPaths.push_back(entry.path().string());
+	sort(objPaths.begin(), objPaths.end());
+	for (const string& path : objPaths)
+	{
+		CachedMesh mesh;
+		if (!mesh.load(path))
+			continue;
+		vector<Material> materials;
+		loadMaterials(path, mesh.materialLibs(), mesh.materialNames(), materials);
+		for (const Material& material : materials)
+		{
+			if (!material.mapKd.empty())
+				requests.push_back(material.mapKd);
+			else if (material.name == ATLAS_MATERIAL)
+				requests.push_back(MODELS + "TexturasOffice.png");
+		}
+	}
+	size_t sceneRequests = requests.size();
+	for (auto& entry : filesystem::recursive_directory_iterator("../Modelos3D"))
+	{
+		string extension = entry.path().extension().string();
+		if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".jpeg")
+			&& entry.path().filename() != "TexturasOffice.png")
+			requests.push_back(entry.path().generic_string());
+	}
+	cout << requests.size() << " pedidos de textura (" << sceneRequests << " dos materiais de " << MODELS << "), "
+		<< ThreadPool::global().size() << " threads no pool" << endl;
+
+	cout << fixed << setprecision(1);
+	double bestPlain = 1e30, bestCached = 1e30;
+	size_t plainTextures = 0, plainBytes = 0, cachedTextures = 0, cachedBytes = 0;
+	for (int r = 0; r < repeats; r++)
+	{
+		auto t0 = Clock::now();
+		vector<GLuint> created;
+		plainBytes = 0;
+		for (const string& path : requests)
+		{
+			GLuint texID = loadTexture(path, plainBytes);
+			if (texID != 0)
+				created.push_back(texID);
+		}
+		glFinish();
+		bestPlain = min(bestPlain, elapsedMs(t0));
+		plainTextures = created.size();
+		glDeleteTextures((GLsizei)created.size(), created.data());
+
+		AssetLoader loader;
+		TextureCache cache(loader);
+		auto t1 = Clock::now();
+		vector<TextureHandle> handles;
+		for (const string& path : requests)
+			handles.push_back(cache.acquire(path));
+		cache.finish();
+		glFinish();
+		bestCached = min(bestCached, elapsedMs(t1));
+		cachedTextures = cache.size();
+		cachedBytes = cache.residentBytes();
+		if (r == repeats - 1)
+			cache.report();
+		for (const TextureHandle& handle : handles)
+			cache.release(handle);
+	}
+	cout << setw(12) << "modo" << setw(12) << "ms" << setw(12) << "texturas" << setw(14) << "KB na GPU" << endl;
+	cout << setw(12) << "sem cache" << setw(12) << bestPlain << setw(12) << plainTextures << setw(14) << plainBytes / 1024 << endl;
+	cout << setw(12) << "com cache" << setw(12) << bestCached << setw(12) << cachedTextures << setw(14) << cachedBytes / 1024 << endl;
+
+	glfwTerminate();
+	return 0;
+}
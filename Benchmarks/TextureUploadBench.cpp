@@ -0,0 +1,127 @@
+/* Benchmark do envio de texturas do AssetLoader
+ *
+ * Carrega todas as imagens de Modelos3D com o AssetLoader e, a cada "frame", chama
+ * update() com o orçamento de envio dado, medindo o tempo gasto em update() (as chamadas
+ * OpenGL na thread do contexto). Compara três formas de envio:
+ *   - mutável:   glTexImage2D por nível e glTexSubImage2D a partir da memória do programa
+ *   - imutável:  glTexStorage2D e glTexSubImage2D a partir da memória do programa
+ *   - PBO:       glTexStorage2D e glTexSubImage2D a partir do anel de PBOs mapeados
+ *                persistentemente (PixelUploadRing.h)
+ * para as cadeias RGBA8 (filtradas na hora, sem o .cgtex) e para as cadeias do .cgtex
+ * (BC1/BC3 se TextureBake já foi executado). Mostra os frames até tudo chegar, o tempo
+ * total e o pior frame em update(), e o tempo até a GPU terminar (glFinish no fim).
+ *
+ * Uso: TextureUploadBench [orçamento de envio por frame em KB]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#include "AssetLoader.h"
+#include "Timing.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+int main(int argc, char** argv)
+{
+	size_t budget = argc > 1 ? (size_t)max(1, atoi(argv[1])) * 1024 : ASSET_UPLOAD_BUDGET;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "TextureUploadBench", nullptr, nullptr);
+	if (!window)
+	{
+		cout << "Falha ao criar o contexto OpenGL" << endl;
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "Failed to initialize GLAD" << endl;
+		return 1;
+	}
+	const GLExtensionSupport& extensions = loadGLExtensions();
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+	cout << "glTexStorage2D: " << (extensions.textureStorage ? "sim" : "nao") << ", buffer storage: "
+		<< (extensions.bufferStorage ? "sim" : "nao") << ", orcamento " << budget / 1024 << " KB por frame" << endl;
+
+	vector<string> paths;
+	for (auto& entry : filesystem::recursive_directory_iterator("../Modelos3D"))
+	{
+		string extension = entry.path().extension().string();
+		if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".jpeg"))
+			paths.push_back(entry.path().generic_string());
+	}
+	sort(paths.begin(), paths.end());
+	cout << paths.size() << " imagens" << endl;
+
+	struct Mode
+	{
+		const char* name;
+		bool textureStorage, pixelBuffers;
+	};
+	const Mode modes[] = { { "mutavel", false, false }, { "imutavel", true, false }, { "PBO", true, true } };
+
+	cout << fixed << setprecision(2);
+	for (bool useCache : { false, true })
+	{
+		cout << endl << (useCache ? "cadeias do .cgtex" : "cadeias RGBA8 (sem .cgtex)") << endl;
+		cout << setw(10) << "modo" << setw(10) << "frames" << setw(14) << "update ms" << setw(14) << "pior frame" << setw(14) << "glFinish ms"
+			<< setw(12) << "KB" << endl;
+		for (const Mode& mode : modes)
+		{
+			AssetLoader loader(budget);
+			loader.useTextureStorage = mode.textureStorage;
+			loader.usePixelBuffers = mode.pixelBuffers;
+			vector<TextureHandle> textures;
+			for (const string& path : paths)
+				textures.push_back(loader.loadTexture(path, useCache));
+
+			int frames = 0;
+			double totalMs = 0.0, worstMs = 0.0;
+			size_t bytes = 0;
+			while (loader.pending() > 0)
+			{
+				auto t0 = Clock::now();
+				size_t sent = loader.update();
+				double ms = elapsedMs(t0);
+				if (sent == 0)
+				{
+					// Nada pronto ainda: deixa o pool trabalhar
+					this_thread::sleep_for(chrono::milliseconds(1));
+					continue;
+				}
+				bytes += sent;
+				frames++;
+				totalMs += ms;
+				worstMs = max(worstMs, ms);
+				glFlush();
+			}
+			auto t1 = Clock::now();
+			glFinish();
+			double finishMs = elapsedMs(t1);
+			cout << setw(10) << mode.name << setw(10) << frames << setw(14) << totalMs << setw(14) << worstMs << setw(14) << finishMs
+				<< setw(12) << bytes / 1024 << endl;
+			for (const TextureHandle& texture : textures)
+				texture->destroy();
+		}
+	}
+
+	glfwTerminate();
+	return 0;
+}
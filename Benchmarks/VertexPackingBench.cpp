@@ -0,0 +1,107 @@
+/* Verificação do formato compacto de vértice (VertexPacking.h)
+ *
+ * 1. Confere a conversão float <-> half em todos os 65536 valores de half.
+ * 2. Para cada .obj em Modelos3D, empacota a malha indexada e verifica se o erro
+ *    de quantização fica dentro dos limites teóricos:
+ *      - normal snorm de 10 bits: |erro| <= 0.5 / 511 por componente
+ *      - uv em half-float: |erro| <= max(|uv| * 2^-11, 2^-25)
+ *    e reporta o tamanho do VBO antes e depois.
+ * Retorna 1 se algum limite for violado.
+ *
+ * Uso: VertexPackingBench [pasta dos modelos]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <filesystem>
+#include <algorithm>
+
+using namespace std;
+
+#include "OBJLoader.h"
+#include "VertexPacking.h"
+
+static bool checkHalfRoundTrip()
+{
+	for (uint32_t h = 0; h < 65536; h++)
+	{
+		uint16_t half = (uint16_t)h;
+		bool isNaN = ((half >> 10) & 0x1F) == 0x1F && (half & 0x3FF) != 0;
+		if (isNaN)
+			continue;
+		if (floatToHalf(halfToFloat(half)) != half)
+		{
+			cout << "Falha na conversao half: 0x" << hex << h << dec << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	string root = argc > 1 ? argv[1] : "../Modelos3D";
+	bool ok = checkHalfRoundTrip();
+	cout << "Conversao float <-> half: " << (ok ? "ok" : "FALHOU") << endl;
+
+	const float normalBound = 0.5f / 511.0f + 1e-6f;
+
+	vector<filesystem::path> files;
+	for (auto& entry : filesystem::recursive_directory_iterator(root))
+		if (entry.is_regular_file() && entry.path().extension() == ".obj")
+			files.push_back(entry.path());
+	sort(files.begin(), files.end());
+
+	cout << left << setw(28) << "arquivo" << right << setw(10) << "vertices"
+		<< setw(12) << "KB 44B" << setw(12) << "KB 20B"
+		<< setw(14) << "erro normal" << setw(14) << "erro uv" << setw(6) << "ok" << endl;
+
+	for (const auto& path : files)
+	{
+		OBJData data;
+		if (!loadOBJ(path.string(), data))
+			continue;
+		IndexedMesh mesh;
+		buildIndexedMesh(data, mesh);
+		vector<PackedVertex> packed;
+		packVertices(mesh, packed);
+
+		float maxNormalError = 0.0f, maxUVError = 0.0f;
+		bool fileOk = true;
+		for (size_t i = 0; i < packed.size(); i++)
+		{
+			const float* v = &mesh.vertices[i * OBJ_FLOATS_PER_VERTEX];
+			glm::vec3 n(v[8], v[9], v[10]);
+			if (glm::length(n) > 0.0f)
+				n = glm::normalize(n);
+			glm::vec3 dn = glm::abs(unpackNormal(packed[i].normal) - n);
+			float en = max(dn.x, max(dn.y, dn.z));
+			maxNormalError = max(maxNormalError, en);
+			if (en > normalBound)
+				fileOk = false;
+
+			for (int c = 0; c < 2; c++)
+			{
+				float uv = v[6 + c];
+				float eu = fabs(halfToFloat(packed[i].texCoord[c]) - uv);
+				maxUVError = max(maxUVError, eu);
+				if (eu > max(fabs(uv) * ldexp(1.0f, -11), ldexp(1.0f, -25)))
+					fileOk = false;
+			}
+		}
+		ok = ok && fileOk;
+
+		cout << left << setw(28) << path.filename().string() << right
+			<< setw(10) << packed.size()
+			<< setw(12) << mesh.vertices.size() * sizeof(float) / 1024
+			<< setw(12) << packed.size() * sizeof(PackedVertex) / 1024
+			<< scientific << setprecision(2) << setw(14) << maxNormalError << setw(14) << maxUVError
+			<< defaultfloat << setw(6) << (fileOk ? "sim" : "NAO") << endl;
+	}
+
+	cout << (ok ? "Todos os erros dentro dos limites" : "ERRO: limite de quantizacao violado") << endl;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+#version 430
+layout (local_size_x = 64) in; //GPU_CULL_GROUP_SIZE
+
+//Culling de todos os desenhos da cena, uma invocação por desenho (ver
+//Common/include/GPUCulling.h). Os visíveis viram comandos de
+//glMultiDrawElementsIndirect; o baseInstance de cada um é o índice do desenho, que
+//escolhe a matriz e o material nos atributos por instância.
+
+struct Draw
+{
+	vec4 boxMin; //caixa em coordenadas de mundo
+	vec4 boxMax;
+	uint count;
+	uint firstIndex;
+	int baseVertex;
+	uint padding;
+};
+
+struct Command //DrawElementsIndirectCommand
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Draws { Draw draws[]; };
+layout (std430, binding = 1) writeonly buffer Commands { Command commands[]; };
+layout (std430, binding = 2) buffer Count { uint visibleCount; };
+layout (std430, binding = 3) writeonly buffer Status { uint status[]; }; //GPUCullStatus
+layout (std430, binding = 4) readonly buffer HiZ { float hiz[]; };         //níveis um depois do outro (hiz.cs)
+
+uniform uint drawCount;
+uniform vec4 planes[6]; //normais para dentro (ver Common/include/Frustum.h)
+uniform mat4 viewProjection;
+uniform bool occlusion;
+uniform bool compact; //true: comandos compactados e contados em visibleCount
+uniform int hizLevels;
+uniform int hizOffsets[16]; //GPU_HIZ_MAX_LEVELS
+uniform ivec2 hizSizes[16];
+
+bool insideFrustum(vec3 boxMin, vec3 boxMax)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		//Canto mais à frente na direção da normal
+		vec3 positive = mix(boxMin, boxMax, greaterThan(planes[i].xyz, vec3(0.0)));
+		if (dot(planes[i].xyz, positive) + planes[i].w < 0.0)
+			return false;
+	}
+	return true;
+}
+
+//true se até o canto mais próximo da caixa está atrás da maior profundidade do
+//retângulo que ela cobre, lida no nível em que ele ocupa no máximo 4 x 4 texels
+bool occluded(vec3 boxMin, vec3 boxMax)
+{
+	ivec2 size = hizSizes[0];
+	vec2 lo = vec2(1e30), hi = vec2(-1e30);
+	float nearest = 1e30;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		vec3 p = vec3((corner & 1) != 0 ? boxMax.x : boxMin.x, (corner & 2) != 0 ? boxMax.y : boxMin.y,
+			(corner & 4) != 0 ? boxMax.z : boxMin.z);
+		vec4 clip = viewProjection * vec4(p, 1.0);
+		if (clip.w <= 1e-6 || clip.z < -clip.w)
+			return false; //cruza o near: pode estar na frente de tudo
+		vec3 ndc = clip.xyz / clip.w;
+		vec2 xy = (ndc.xy * 0.5 + 0.5) * vec2(size);
+		lo = min(lo, xy);
+		hi = max(hi, xy);
+		nearest = min(nearest, ndc.z * 0.5 + 0.5);
+	}
+	ivec2 p0 = max(ivec2(0), ivec2(floor(lo)));
+	ivec2 p1 = min(size - 1, ivec2(floor(hi)));
+	if (any(greaterThan(p0, p1)))
+		return false;
+
+	int level = 0;
+	while (level + 1 < hizLevels && any(greaterThanEqual((p1 >> level) - (p0 >> level), ivec2(4))))
+		level++;
+	ivec2 levelSize = hizSizes[level];
+	ivec2 t0 = min(p0 >> level, levelSize - 1), t1 = min(p1 >> level, levelSize - 1);
+	float farthest = 0.0;
+	for (int y = t0.y; y <= t1.y; y++)
+		for (int x = t0.x; x <= t1.x; x++)
+			farthest = max(farthest, hiz[hizOffsets[level] + y * levelSize.x + x]);
+	return nearest > farthest;
+}
+
+void main()
+{
+	uint i = gl_GlobalInvocationID.x;
+	if (i >= drawCount)
+		return;
+
+	Draw draw = draws[i];
+	uint result = 2u; //GPU_CULL_VISIBLE
+	if (!insideFrustum(draw.boxMin.xyz, draw.boxMax.xyz))
+		result = 0u; //GPU_CULL_FRUSTUM
+	else if (occlusion && occluded(draw.boxMin.xyz, draw.boxMax.xyz))
+		result = 1u; //GPU_CULL_OCCLUDED
+	status[i] = result;
+
+	Command command = Command(draw.count, 1u, draw.firstIndex, draw.baseVertex, i);
+	if (compact)
+	{
+		if (result == 2u)
+			commands[atomicAdd(visibleCount, 1u)] = command;
+	}
+	else
+	{
+		//Um comando fixo por desenho; os descartados não desenham nenhuma instância
+		command.instanceCount = result == 2u ? 1u : 0u;
+		commands[i] = command;
+	}
+}
@@ -0,0 +1,37 @@
+#version 430
+layout (local_size_x = 8, local_size_y = 8) in; //GPU_HIZ_GROUP_SIZE
+
+//Um nível da pirâmide Hi-Z (ver GPUCulling::buildHiZ em Common/include/GPUCulling.h):
+//cada texel guarda a maior profundidade dos 2 x 2 do nível de baixo, então a pirâmide
+//nunca diz que algo está mais perto do que está. Os níveis ficam um depois do outro
+//no SSBO, linha a linha.
+layout (std430, binding = 4) buffer HiZ { float hiz[]; }; //GPU_CULL_HIZ_BINDING
+
+uniform int level; //0: cópia da textura de profundidade
+uniform sampler2D depthTexture;
+uniform int belowOffset; //nível level - 1
+uniform ivec2 belowSize;
+uniform int offset;      //nível level
+uniform ivec2 size;
+
+void main()
+{
+	ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+	if (p.x >= size.x || p.y >= size.y)
+		return;
+
+	float depth = 0.0;
+	if (level == 0)
+	{
+		depth = texelFetch(depthTexture, p, 0).r;
+	}
+	else
+	{
+		//Nas dimensões ímpares, o último texel também cobre a sobra
+		ivec2 last = min(2 * p + 1 + ivec2(equal(p, size - 1)) * (belowSize & 1), belowSize - 1);
+		for (int y = 2 * p.y; y <= last.y; y++)
+			for (int x = 2 * p.x; x <= last.x; x++)
+				depth = max(depth, hiz[belowOffset + y * belowSize.x + x]);
+	}
+	hiz[offset + p.y * size.x + p.x] = depth;
+}
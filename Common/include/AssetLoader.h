@@ -0,0 +1,537 @@
+// Carregamento assíncrono de malhas e texturas
+// A parte pesada de CPU (parsing do .obj ou leitura do cache, materiais do .mtl e
+// decodificação das imagens com stb_image) roda nas threads do ThreadPool global. As
+// chamadas OpenGL ficam para a thread do contexto: a cada frame, AssetLoader::update
+// envia no máximo uploadBudget bytes (glBufferSubData / glTexSubImage2D em pedaços),
+// então um modelo grande é enviado ao longo de vários frames em vez de travar um só.
+// As texturas são alocadas com glTexStorage2D e os pixels passam por um anel de PBOs
+// mapeados persistentemente (ver PixelUploadRing.h), então o driver não precisa copiar
+// os dados dentro da chamada; sem essas extensões o envio usa a memória do programa.
+//
+// Texturas com um cache comprimido válido ao lado (ver TextureCompression.h e a
+// ferramenta TextureBake) são lidas do .cgtex e enviadas com glCompressedTexImage2D,
+// já com os mipmaps, quando a OpenGL aceita S3TC; senão a imagem original é usada.
+// Os mipmaps das imagens sem cache são filtrados na CPU (generateMipChain, ver
+// TextureMips.h) em vez de glGenerateMipmap, e a cadeia RGBA8 resultante é gravada no
+// .cgtex, então a próxima execução só lê o arquivo.
+//
+// Cada pedido devolve um handle (shared_ptr) que funciona como um future: ready()
+// fica verdadeiro quando os objetos OpenGL estiverem prontos para desenhar, e
+// failed() quando o arquivo não pôde ser lido.
+//
+// Uso:
+//   AssetLoader loader;
+//   auto chair = loader.loadMesh("../Modelos3D/Novos/BlueChair.obj");
+//   auto atlas = loader.loadTexture("../Modelos3D/Novos/TexturasOffice.png");
+//   while (...) {
+//       loader.update();                 // na thread do contexto, uma vez por frame
+//       if (chair->ready()) ...          // desenha chair->VAO com atlas->texID
+//   }
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+//STB_IMAGE
+#include <stb_image.h>
+
+#include "ThreadPool.h"
+#include "OBJLoader.h"
+#include "MeshCache.h"
+#include "MeshBuffers.h"
+#include "MeshOptimizer.h"
+#include "TextureCompression.h"
+#include "TextureMips.h"
+#include "GLExtensions.h"
+#include "PixelUploadRing.h"
+
+// Bytes enviados por frame em AssetLoader::update (~1 ms de cópia em uma GPU comum)
+const size_t ASSET_UPLOAD_BUDGET = 4 * 1024 * 1024;
+
+// O anel de PBOs das texturas guarda o envio de alguns frames (a GPU lê um enquanto o
+// programa escreve o seguinte), limitado a ASSET_UPLOAD_RING_MAX bytes
+const size_t ASSET_UPLOAD_RING_FRAMES = 3;
+const size_t ASSET_UPLOAD_RING_MAX = 64 * 1024 * 1024;
+
+enum AssetState
+{
+	ASSET_LOADING,   // na fila do pool ou sendo lido
+	ASSET_UPLOADING, // dados na memória, esperando update() enviar à OpenGL
+	ASSET_READY,
+	ASSET_FAILED
+};
+
+// Malha no layout de OBJ_FLOATS_PER_VERTEX floats (locations 0 a 3 dos exemplos)
+struct MeshAsset
+{
+	std::string path;
+	std::atomic<int> state{ ASSET_LOADING };
+
+	// Válidos quando ready()
+	GLuint VAO = 0, VBO = 0, EBO = 0;
+	int nIndices = 0;
+	std::vector<Submesh> submeshes;
+	std::vector<Material> materials; // na ordem de Submesh::material
+	std::vector<MeshLOD> lods;       // índices logo depois dos nIndices do nível 0
+	glm::vec4 bounds = glm::vec4(0.0f);
+
+	double loadMs = 0.0; // tempo na thread do pool (parsing/cache e materiais)
+
+	bool ready() const { return this->state.load() == ASSET_READY; }
+	bool failed() const { return this->state.load() == ASSET_FAILED; }
+	bool done() const { return ready() || failed(); }
+
+	// Pode ser chamado antes de ready(): o que ainda faltar enviar é descartado
+	void destroy()
+	{
+		this->discarded = true;
+		glDeleteVertexArrays(1, &this->VAO);
+		glDeleteBuffers(1, &this->VBO);
+		glDeleteBuffers(1, &this->EBO);
+		this->VAO = this->VBO = this->EBO = 0;
+	}
+
+private:
+	friend class AssetLoader;
+	std::unique_ptr<CachedMesh> data; // liberado depois do envio
+	size_t uploaded = 0;
+	std::atomic<bool> discarded{ false };
+};
+
+// Textura RGBA8 (ou BC1/BC3, vinda do cache comprimido) com mipmaps
+struct TextureAsset
+{
+	std::string path;
+	std::atomic<int> state{ ASSET_LOADING };
+
+	// Válidos quando ready()
+	GLuint texID = 0;
+	int width = 0, height = 0;
+	uint32_t blockFormat = BLOCK_RGBA8; // BlockFormat dos níveis enviados
+
+	double decodeMs = 0.0;      // stbi_load (ou leitura do .cgtex) na thread do pool
+	double mipMs = 0.0;         // generateMipChain, quando não havia cache
+	double uploadMs = 0.0;      // chamadas OpenGL de todos os pedaços, somadas (tempo de CPU)
+	size_t residentBytes = 0;   // memória de vídeo do nível 0 e dos mipmaps
+
+	bool ready() const { return this->state.load() == ASSET_READY; }
+	bool failed() const { return this->state.load() == ASSET_FAILED; }
+	bool done() const { return ready() || failed(); }
+
+	// Pode ser chamado antes de ready(): o que ainda faltar enviar é descartado
+	void destroy()
+	{
+		this->discarded = true;
+		glDeleteTextures(1, &this->texID);
+		this->texID = 0;
+	}
+
+private:
+	friend class AssetLoader;
+	std::unique_ptr<TextureLevels> levels; // liberado depois do envio
+	int uploadedRows = 0; // do nível uploadedLevels, em linhas de pixels (RGBA8) ou de blocos
+	size_t uploadedLevels = 0;
+	std::atomic<bool> discarded{ false };
+};
+
+typedef std::shared_ptr<MeshAsset> MeshHandle;
+typedef std::shared_ptr<TextureAsset> TextureHandle;
+
+class AssetLoader
+{
+public:
+	size_t uploadBudget;
+	bool useTextureStorage = true; // glTexStorage2D, se existir (false: glTexImage2D por nível)
+	bool usePixelBuffers = true;   // anel de PBOs, se existir (false: glTexSubImage2D da memória)
+
+	explicit AssetLoader(size_t uploadBudget = ASSET_UPLOAD_BUDGET)
+		: uploadBudget(uploadBudget), queue(std::make_shared<UploadQueue>())
+	{
+	}
+
+	// Tarefas ainda em andamento no pool continuam donas dos seus assets, mas os
+	// dados delas não são mais enviados. O anel de PBOs só é apagado se o contexto
+	// ainda existir (nos exemplos o glfwTerminate vem antes e já libera tudo).
+	~AssetLoader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->queue->mutex);
+			for (Upload& upload : this->queue->uploads)
+				if (upload.texture)
+					upload.texture->levels.reset();
+			this->queue->uploads.clear();
+		}
+		if (this->ring.valid() && glfwGetCurrentContext() != nullptr)
+			this->ring.destroy();
+	}
+
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+
+	// useCache == false sempre faz o parsing do texto (ver CachedMesh::load)
+	MeshHandle loadMesh(const std::string& objPath, bool useCache = true)
+	{
+		MeshHandle mesh = std::make_shared<MeshAsset>();
+		mesh->path = objPath;
+		mesh->data.reset(new CachedMesh());
+		std::shared_ptr<UploadQueue> target = this->queue;
+		target->pending++;
+		ThreadPool::global().submit([mesh, target, useCache]()
+		{
+			auto t0 = std::chrono::high_resolution_clock::now();
+			bool ok = mesh->data->load(mesh->path, useCache);
+			if (ok)
+			{
+				loadMaterials(mesh->path, mesh->data->materialLibs(), mesh->data->materialNames(), mesh->materials);
+				mesh->bounds = computeBoundingSphere(mesh->data->vertexData(), mesh->data->nVertices());
+			}
+			auto t1 = std::chrono::high_resolution_clock::now();
+			mesh->loadMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+			if (!ok)
+				mesh->state = ASSET_FAILED;
+			target->push(Upload{ mesh, nullptr }, ok);
+		});
+		return mesh;
+	}
+
+	// Decodifica sempre com 4 canais (JPEGs de 3 canais, como texture_1.jpeg, ganham
+	// alfa 255): os mipmaps e a compressão trabalham em RGBA8, e as linhas ficam
+	// alinhadas em 4 bytes para qualquer largura. Consulta as extensões da
+	// OpenGL, então deve ser chamado na thread do contexto. useCache == false ignora o
+	// .cgtex e sempre decodifica e filtra a imagem (sem gravar o cache).
+	TextureHandle loadTexture(const std::string& filePath, bool useCache = true)
+	{
+		TextureHandle texture = std::make_shared<TextureAsset>();
+		texture->path = filePath;
+		bool useCompressed = loadGLExtensions().textureCompressionS3TC;
+		std::shared_ptr<UploadQueue> target = this->queue;
+		target->pending++;
+		ThreadPool::global().submit([texture, target, useCompressed, useCache]()
+		{
+			auto t0 = std::chrono::high_resolution_clock::now();
+			std::unique_ptr<TextureLevels> levels(new TextureLevels());
+			bool cached = useCache && readTextureCache(texture->path, *levels);
+			bool usable = cached && (!levels->compressed() || useCompressed);
+			auto t1 = t0;
+			if (!usable)
+			{
+				int width, height, channels;
+				unsigned char* pixels = stbi_load(texture->path.c_str(), &width, &height, &channels, 4);
+				t1 = std::chrono::high_resolution_clock::now();
+				if (pixels)
+				{
+					generateMipChain(pixels, width, height, MipSettings(), *levels);
+					stbi_image_free(pixels);
+					texture->mipMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t1).count();
+					// Um cache comprimido válido (sem S3TC nesta máquina) não é sobrescrito
+					if (useCache && !cached)
+						writeTextureCache(texture->path, *levels);
+				}
+				else
+					levels.reset();
+			}
+			else
+				t1 = std::chrono::high_resolution_clock::now();
+			texture->decodeMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+			bool ok = levels != nullptr;
+			if (ok)
+			{
+				texture->width = levels->width;
+				texture->height = levels->height;
+				texture->blockFormat = levels->format;
+				texture->levels = std::move(levels);
+			}
+			if (!ok)
+				texture->state = ASSET_FAILED;
+			target->push(Upload{ nullptr, texture }, ok);
+		});
+		return texture;
+	}
+
+	// Na thread do contexto: envia até uploadBudget bytes dos assets já lidos, na
+	// ordem em que ficaram prontos. Devolve os bytes enviados.
+	size_t update()
+	{
+		return pump(this->uploadBudget, false);
+	}
+
+	// Pedidos ainda não prontos (lendo ou esperando envio)
+	int pending() const { return this->queue->pending.load(); }
+
+	// Bloqueia até todos os pedidos terminarem, enviando sem limite por frame
+	void finish()
+	{
+		while (pending() > 0)
+		{
+			if (pump(SIZE_MAX, true) == 0)
+			{
+				std::unique_lock<std::mutex> lock(this->queue->mutex);
+				this->queue->arrived.wait(lock, [this]() { return !this->queue->uploads.empty() || this->queue->pending.load() == 0; });
+			}
+		}
+	}
+
+private:
+	struct Upload
+	{
+		MeshHandle mesh;
+		TextureHandle texture;
+	};
+
+	// Compartilhada com as tarefas do pool, que podem terminar depois do AssetLoader
+	struct UploadQueue
+	{
+		std::mutex mutex;
+		std::condition_variable arrived;
+		std::deque<Upload> uploads;
+		std::atomic<int> pending{ 0 };
+
+		void push(const Upload& upload, bool ok)
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (ok)
+			{
+				if (upload.mesh)
+					upload.mesh->state = ASSET_UPLOADING;
+				else
+					upload.texture->state = ASSET_UPLOADING;
+				this->uploads.push_back(upload);
+			}
+			else
+				this->pending--;
+			this->arrived.notify_all();
+		}
+	};
+
+	std::shared_ptr<UploadQueue> queue;
+	PixelUploadRing ring;
+	bool ringChecked = false;
+
+	size_t pump(size_t budget, bool wait)
+	{
+		size_t sent = 0;
+		while (sent < budget)
+		{
+			Upload upload;
+			{
+				std::lock_guard<std::mutex> lock(this->queue->mutex);
+				if (this->queue->uploads.empty())
+					break;
+				upload = this->queue->uploads.front();
+			}
+			bool finished;
+			if (upload.mesh)
+				finished = upload.mesh->discarded ? discardMesh(*upload.mesh) : uploadMesh(*upload.mesh, budget - sent, sent);
+			else
+				finished = upload.texture->discarded ? discardTexture(*upload.texture) : uploadTexture(*upload.texture, budget - sent, sent, wait);
+			if (!finished)
+				break;
+			std::lock_guard<std::mutex> lock(this->queue->mutex);
+			this->queue->uploads.pop_front();
+			this->queue->pending--;
+		}
+		this->ring.endFrame();
+		return sent;
+	}
+
+	// Assets destruídos antes de terminar: só libera a cópia na memória
+	static bool discardMesh(MeshAsset& mesh)
+	{
+		mesh.data.reset();
+		mesh.state = ASSET_FAILED;
+		return true;
+	}
+
+	static bool discardTexture(TextureAsset& texture)
+	{
+		texture.levels.reset();
+		texture.state = ASSET_FAILED;
+		return true;
+	}
+
+	// Cria os buffers no primeiro envio e copia [vértices | índices | índices dos
+	// LODs] em pedaços. Devolve true quando a malha terminou.
+	static bool uploadMesh(MeshAsset& mesh, size_t budget, size_t& sent)
+	{
+		const CachedMesh& data = *mesh.data;
+		size_t vertexBytes = data.vertexBytes();
+		size_t indexBytes = data.indexBytes() + data.lodIndexBytes();
+		if (mesh.VAO == 0)
+		{
+			glGenVertexArrays(1, &mesh.VAO);
+			glGenBuffers(1, &mesh.VBO);
+			glGenBuffers(1, &mesh.EBO);
+			glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+			glBufferData(GL_ARRAY_BUFFER, vertexBytes, nullptr, GL_STATIC_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.EBO);
+			glBufferData(GL_COPY_WRITE_BUFFER, indexBytes, nullptr, GL_STATIC_DRAW);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+
+		// Trechos [início, fim) do envio total e de onde vem cada um
+		struct Range { GLenum target; GLuint buffer; size_t offset, size; const void* src; };
+		const Range ranges[3] = {
+			{ GL_ARRAY_BUFFER, mesh.VBO, 0, vertexBytes, data.vertexData() },
+			{ GL_COPY_WRITE_BUFFER, mesh.EBO, 0, data.indexBytes(), data.indexData() },
+			{ GL_COPY_WRITE_BUFFER, mesh.EBO, data.indexBytes(), data.lodIndexBytes(), data.lodIndexData() },
+		};
+		size_t total = vertexBytes + indexBytes, base = 0;
+		for (const Range& range : ranges)
+		{
+			// budget pode ser SIZE_MAX (finish): limita ao que falta para não dar a volta
+			size_t begin = std::max(mesh.uploaded, base);
+			size_t end = std::min(base + range.size, mesh.uploaded + std::min(budget, total - mesh.uploaded));
+			if (begin < end)
+			{
+				glBindBuffer(range.target, range.buffer);
+				glBufferSubData(range.target, range.offset + (begin - base), end - begin, (const char*)range.src + (begin - base));
+				glBindBuffer(range.target, 0);
+				sent += end - begin;
+				budget -= end - begin;
+				mesh.uploaded = end;
+			}
+			base += range.size;
+		}
+		if (mesh.uploaded < total)
+			return false;
+
+		// Tudo enviado: configura o VAO (o EBO fica registrado nele)
+		setupMeshAttributes(mesh.VAO, mesh.VBO, mesh.EBO);
+
+		mesh.nIndices = data.nIndices();
+		mesh.submeshes = data.submeshes();
+		mesh.lods = data.lods();
+		mesh.data.reset();
+		mesh.state = ASSET_READY;
+		return true;
+	}
+
+	// Cria a textura no primeiro envio, com glTexStorage2D (armazenamento imutável, todos
+	// os níveis de uma vez) quando existir, e copia faixas de linhas inteiras dentro do
+	// orçamento, nível a nível. Nos formatos comprimidos a faixa anda de 4 em 4 linhas
+	// (uma linha de blocos). Com o anel de PBOs os dados passam pela memória mapeada;
+	// sem ele (OpenGL sem buffer storage) saem direto de TextureLevels. Com wait espera a
+	// GPU liberar o anel em vez de deixar o resto para o próximo frame. Devolve true
+	// quando a textura terminou.
+	bool uploadTexture(TextureAsset& texture, size_t budget, size_t& sent, bool wait)
+	{
+		auto t0 = std::chrono::high_resolution_clock::now();
+		const TextureLevels& data = *texture.levels;
+		if (texture.texID == 0)
+		{
+			glGenTextures(1, &texture.texID);
+			glBindTexture(GL_TEXTURE_2D, texture.texID);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)data.levels.size() - 1);
+			if (this->useTextureStorage && loadGLExtensions().textureStorage)
+				glTexStorage2D(GL_TEXTURE_2D, (GLsizei)data.levels.size(), data.format, data.width, data.height);
+			else
+				for (size_t i = 0; i < data.levels.size(); i++)
+				{
+					const TextureCacheLevel& level = data.levels[i];
+					if (data.compressed())
+						glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, data.format, level.width, level.height, 0, (GLsizei)level.size, nullptr);
+					else
+						glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+				}
+			texture.residentBytes = data.bytes();
+		}
+		else
+			glBindTexture(GL_TEXTURE_2D, texture.texID);
+
+		PixelUploadRing* ring = uploadRing();
+		if (ring)
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->PBO);
+		size_t start = sent;
+		while (texture.uploadedLevels < data.levels.size())
+		{
+			const TextureCacheLevel& level = data.levels[texture.uploadedLevels];
+			// Uma "linha" é uma linha de pixels (RGBA8) ou de blocos de 4x4 (BC1/BC3)
+			int rowHeight = data.compressed() ? 4 : 1;
+			int nRows = ((int)level.height + rowHeight - 1) / rowHeight;
+			size_t rowBytes = (size_t)level.size / nRows;
+			size_t left = budget > sent - start ? budget - (sent - start) : 0;
+			if (sent > start && left < rowBytes)
+				break;
+			size_t maxRows = std::max<size_t>(1, left / rowBytes);
+			if (ring)
+				maxRows = std::min(maxRows, std::max<size_t>(1, ring->capacity() / ASSET_UPLOAD_RING_FRAMES / rowBytes));
+			int rows = (int)std::min<size_t>(nRows - texture.uploadedRows, maxRows);
+			size_t bytes = rows * rowBytes;
+			const unsigned char* source = data.level(texture.uploadedLevels) + texture.uploadedRows * rowBytes;
+			const void* pixels = source;
+			if (ring)
+			{
+				size_t offset;
+				unsigned char* dst = ring->allocate(bytes, offset, wait);
+				if (!dst)
+					break;
+				memcpy(dst, source, bytes);
+				pixels = (const void*)offset;
+			}
+			int y = texture.uploadedRows * rowHeight;
+			int height = std::min((int)level.height - y, rows * rowHeight);
+			if (data.compressed())
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, (GLint)texture.uploadedLevels, 0, y, level.width, height, data.format, (GLsizei)bytes, pixels);
+			else
+			{
+				// O padrão (4) só vale para linhas múltiplas de 4 bytes; usa o maior
+				// alinhamento que a largura da linha permite em vez de depender do estado
+				glPixelStorei(GL_UNPACK_ALIGNMENT, rowBytes % 8 == 0 ? 8 : rowBytes % 4 == 0 ? 4 : rowBytes % 2 == 0 ? 2 : 1);
+				glTexSubImage2D(GL_TEXTURE_2D, (GLint)texture.uploadedLevels, 0, y, level.width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+			}
+			texture.uploadedRows += rows;
+			sent += bytes;
+			if (texture.uploadedRows == nRows)
+			{
+				texture.uploadedRows = 0;
+				texture.uploadedLevels++;
+			}
+		}
+		if (ring)
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		bool finished = texture.uploadedLevels == data.levels.size();
+		if (finished)
+		{
+			texture.levels.reset();
+			texture.state = ASSET_READY;
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		texture.uploadMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+		return finished;
+	}
+
+	// Criado no primeiro envio de textura; nullptr se a OpenGL não tiver buffer storage
+	PixelUploadRing* uploadRing()
+	{
+		if (!this->ringChecked)
+		{
+			this->ringChecked = true;
+			size_t capacity = std::min(ASSET_UPLOAD_RING_MAX, std::max(ASSET_UPLOAD_BUDGET, this->uploadBudget) * ASSET_UPLOAD_RING_FRAMES);
+			if (this->usePixelBuffers && loadGLExtensions().bufferStorage)
+				this->ring.create(capacity);
+		}
+		return this->ring.valid() ? &this->ring : nullptr;
+	}
+};
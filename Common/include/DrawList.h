@@ -0,0 +1,431 @@
+// Lista de desenho ordenada por estado
+// Cada DrawItem é uma faixa do buffer de índices (uma Submesh) com o programa, a
+// textura e o material usados nela. DrawList::sort agrupa os itens pelo estado mais
+// caro de trocar (programa, depois textura, depois material, depois VAO) e
+// DrawList::submit só envia à OpenGL o que mudou em relação ao item anterior,
+// contando as trocas em DrawStats.
+//
+// O material é aplicado nos uniforms do phong.fs dos exemplos (ka, kd, ks, q). Como
+// eles são escalares, Ka/Kd/Ks viram a média dos três canais; o Blender exporta
+// Ka 1 1 1 em todos os materiais, então Ka é multiplicado por MATERIAL_AMBIENT_SCALE
+// para manter a luz ambiente dos exemplos (0.2).
+//
+// DrawBatches desenha os mesmos itens em lotes: com as texturas em um texture array
+// (TextureArray.h) e os materiais em uma MaterialTable, a textura e o material viram
+// dados por desenho (camada e índice, nos atributos por instância de
+// InstancedRenderer.h) e todos os itens de um mesmo programa e VAO saem em uma única
+// glMultiDrawElementsIndirect, um comando por item (itens seguidos com a mesma faixa
+// de índices viram instâncias do mesmo comando).
+//
+// Uso:
+//   DrawList drawList;
+//   drawList.addSubmeshes(&shader, VAO, mesh.submeshes(), materials, textures, texID, model);
+//   drawList.sort();              // depois de acrescentar ou remover itens
+//   DrawStats stats = drawList.submit();
+//   drawList.submit(visible.data()); // só os itens de objetos com visible[item.object] != 0
+//
+//   DrawBatches batches;          // itens com item.layer e um programa com sampler2DArray
+//   batches.build(drawList.items); // depois de acrescentar, remover ou mover itens
+//   glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.ID);
+//   DrawStats stats = batches.submit();
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Shader.h"
+#include "OBJLoader.h"
+#include "GLExtensions.h"
+#include "InstancedRenderer.h"
+
+const float MATERIAL_AMBIENT_SCALE = 0.2f;
+
+struct DrawItem
+{
+	Shader* shader;
+	GLuint VAO;
+	GLuint texture;           // 0: nenhuma textura ligada
+	const Material* material; // nullptr: mantém o material padrão (Material())
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	glm::mat4 model;
+	GLuint layer = 0;         // camada do texture array (só em DrawBatches)
+	int object = -1;          // objeto dono, índice na máscara de visibilidade de submit (-1: sempre desenha)
+};
+
+// Contagem de drawcalls e trocas de estado de um submit
+struct DrawStats
+{
+	int draws = 0;
+	int programChanges = 0;
+	int textureChanges = 0;
+	int materialChanges = 0;
+	int vaoChanges = 0;
+	int commands = 0; // comandos dentro das glMultiDrawElementsIndirect (DrawBatches)
+	int culled = 0;   // itens pulados pela máscara de visibilidade
+};
+
+class DrawList
+{
+public:
+	std::vector<DrawItem> items;
+
+	void add(const DrawItem& item) { this->items.push_back(item); }
+	void clear() { this->items.clear(); }
+
+	// Um item por submesh. textures[i] é a textura do material i (0 ou ausente: usa
+	// defaultTexture); submeshes sem material usam o material padrão e defaultTexture.
+	void addSubmeshes(Shader* shader, GLuint VAO, const std::vector<Submesh>& submeshes,
+		const std::vector<Material>& materials, const std::vector<GLuint>& textures,
+		GLuint defaultTexture, const glm::mat4& model)
+	{
+		for (const Submesh& submesh : submeshes)
+		{
+			DrawItem item;
+			item.shader = shader;
+			item.VAO = VAO;
+			item.texture = defaultTexture;
+			item.material = nullptr;
+			if (submesh.material >= 0 && submesh.material < (int)materials.size())
+			{
+				item.material = &materials[submesh.material];
+				if (submesh.material < (int)textures.size() && textures[submesh.material] != 0)
+					item.texture = textures[submesh.material];
+			}
+			item.firstIndex = submesh.firstIndex;
+			item.indexCount = submesh.indexCount;
+			item.model = model;
+			add(item);
+		}
+	}
+
+	// Ordena por programa, textura, material e VAO. A ordenação é estável, então
+	// itens com o mesmo estado mantêm a ordem em que foram acrescentados.
+	void sort()
+	{
+		std::stable_sort(this->items.begin(), this->items.end(), [](const DrawItem& a, const DrawItem& b)
+		{
+			if (a.shader->ID != b.shader->ID)
+				return a.shader->ID < b.shader->ID;
+			if (a.texture != b.texture)
+				return a.texture < b.texture;
+			if (a.material != b.material)
+				return std::less<const Material*>()(a.material, b.material);
+			return a.VAO < b.VAO;
+		});
+	}
+
+	// Desenha todos os itens na ordem atual. Usa a unidade de textura ativa. Com
+	// visible, itens com object >= 0 e visible[object] == 0 são pulados (por exemplo,
+	// objetos ocultos segundo o OcclusionBuffer de OcclusionCulling.h), sem mudar a ordem.
+	DrawStats submit(const uint8_t* visible = nullptr)
+	{
+		DrawStats stats;
+		GLuint program = 0, texture = 0, VAO = 0;
+		const Material* material = nullptr;
+		const glm::mat4* model = nullptr;
+		bool first = true;
+		for (const DrawItem& item : this->items)
+		{
+			if (visible && item.object >= 0 && !visible[item.object])
+			{
+				stats.culled++;
+				continue;
+			}
+			bool programChanged = first || item.shader->ID != program;
+			if (programChanged)
+			{
+				program = item.shader->ID;
+				glUseProgram(program);
+				stats.programChanges++;
+			}
+			if (first || item.texture != texture)
+			{
+				texture = item.texture;
+				glBindTexture(GL_TEXTURE_2D, texture);
+				stats.textureChanges++;
+			}
+			// Uniforms pertencem ao programa: depois de trocar de programa o material
+			// e a matriz de modelo precisam ser enviados de novo
+			if (programChanged || item.material != material)
+			{
+				material = item.material;
+				applyMaterial(*item.shader, material != nullptr ? *material : defaultMaterial());
+				stats.materialChanges++;
+			}
+			if (programChanged || memcmp(model, &item.model, sizeof(glm::mat4)) != 0)
+			{
+				model = &item.model;
+				glUniformMatrix4fv(item.shader->uniform("model"), 1, GL_FALSE, glm::value_ptr(item.model));
+			}
+			if (first || item.VAO != VAO)
+			{
+				VAO = item.VAO;
+				glBindVertexArray(VAO);
+				stats.vaoChanges++;
+			}
+			glDrawElements(GL_TRIANGLES, item.indexCount, GL_UNSIGNED_INT,
+				(GLvoid*)(item.firstIndex * sizeof(GLuint)));
+			stats.draws++;
+			first = false;
+		}
+		glBindVertexArray(0);
+		return stats;
+	}
+
+	// Converte o material do .mtl para os coeficientes escalares do phong.fs
+	static void applyMaterial(const Shader& shader, const Material& material)
+	{
+		InstanceMaterial converted = instanceMaterial(material, true);
+		shader.setFloat("ka", converted.coefficients.x);
+		shader.setFloat("kd", converted.coefficients.y);
+		shader.setFloat("ks", converted.coefficients.z);
+		shader.setFloat("q", converted.coefficients.w);
+	}
+
+	// O mesmo para a MaterialTable. Sem textura, a cor Kd vai inteira em color (que
+	// multiplica a camada branca do texture array) e o coeficiente kd fica 1.
+	static InstanceMaterial instanceMaterial(const Material& material, bool textured)
+	{
+		auto mean = [](const glm::vec3& v) { return (v.r + v.g + v.b) / 3.0f; };
+		InstanceMaterial converted;
+		converted.color = glm::vec4(textured ? glm::vec3(1.0f) : material.kd, 1.0f);
+		converted.coefficients = glm::vec4(MATERIAL_AMBIENT_SCALE * mean(material.ka), textured ? mean(material.kd) : 1.0f,
+			mean(material.ks), std::max(material.ns, 1.0f));
+		return converted;
+	}
+
+	static const Material& defaultMaterial()
+	{
+		static const Material material;
+		return material;
+	}
+};
+
+// Comando de glDrawElementsIndirect / glMultiDrawElementsIndirect (layout fixo da OpenGL)
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance; // primeira instância lida dos atributos com divisor 1
+};
+
+class DrawBatches
+{
+public:
+	GLuint instanceVBO = 0;    // um InstanceData por instância, na ordem dos comandos
+	GLuint indirectBuffer = 0; // os DrawElementsIndirectCommand de todos os lotes
+	MaterialTable materials;   // ligada ao ponto Shader::MATERIALS_BINDING
+
+	// Monta os lotes a partir dos itens (em qualquer ordem). Os VAOs dos itens ganham
+	// os atributos por instância (locations 4 a 9), que os programas sem eles ignoram.
+	void build(const std::vector<DrawItem>& items)
+	{
+		if (this->instanceVBO == 0)
+		{
+			glGenBuffers(1, &this->instanceVBO);
+			glGenBuffers(1, &this->indirectBuffer);
+			this->materials.create();
+		}
+		this->batches.clear();
+		this->commands.clear();
+		this->instances.clear();
+		this->materials.materials.clear();
+		this->materials.overflow = 0;
+		this->materialIndex.clear();
+
+		// Agrupa por programa e VAO; dentro do lote, itens com a mesma faixa ficam juntos
+		std::vector<size_t> order(items.size());
+		for (size_t i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+		{
+			const DrawItem& x = items[a];
+			const DrawItem& y = items[b];
+			if (x.shader->ID != y.shader->ID)
+				return x.shader->ID < y.shader->ID;
+			if (x.VAO != y.VAO)
+				return x.VAO < y.VAO;
+			if (x.firstIndex != y.firstIndex)
+				return x.firstIndex < y.firstIndex;
+			return x.indexCount < y.indexCount;
+		});
+
+		for (size_t i : order)
+		{
+			const DrawItem& item = items[i];
+			if (this->batches.empty() || this->batches.back().shader != item.shader || this->batches.back().VAO != item.VAO)
+			{
+				Batch batch;
+				batch.shader = item.shader;
+				batch.VAO = item.VAO;
+				batch.firstCommand = this->commands.size();
+				this->batches.push_back(batch);
+			}
+			Batch& batch = this->batches.back();
+			DrawElementsIndirectCommand* last = batch.nCommands > 0 ? &this->commands.back() : nullptr;
+			if (last && last->firstIndex == item.firstIndex && last->count == item.indexCount)
+			{
+				last->instanceCount++;
+			}
+			else
+			{
+				DrawElementsIndirectCommand command;
+				command.count = item.indexCount;
+				command.instanceCount = 1;
+				command.firstIndex = item.firstIndex;
+				command.baseVertex = 0;
+				command.baseInstance = (GLuint)this->instances.size();
+				this->commands.push_back(command);
+				batch.nCommands++;
+			}
+			InstanceData data = {};
+			data.model = item.model;
+			data.material = materialFor(item);
+			data.layer = item.layer;
+			this->instances.push_back(data);
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, this->instances.size() * sizeof(InstanceData), this->instances.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, this->indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, this->commands.size() * sizeof(DrawElementsIndirectCommand), this->commands.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		this->materials.update();
+
+		GLuint lastVAO = 0;
+		for (const Batch& batch : this->batches)
+		{
+			if (batch.VAO == lastVAO)
+				continue;
+			lastVAO = batch.VAO;
+			glBindVertexArray(batch.VAO);
+			for (GLuint location = INSTANCE_MODEL_LOCATION; location <= INSTANCE_LAYER_LOCATION; location++)
+			{
+				glEnableVertexAttribArray(location);
+				glVertexAttribDivisor(location, 1);
+			}
+			pointInstanceAttributes(0);
+		}
+		glBindVertexArray(0);
+	}
+
+	int nBatches() const { return (int)this->batches.size(); }
+	int nCommands() const { return (int)this->commands.size(); }
+
+	// Uma glMultiDrawElementsIndirect por lote. Sem GL 4.3 (glExtensions().multiDrawIndirect),
+	// cai para uma glDrawElementsInstanced por comando, apontando os atributos por
+	// instância para o baseInstance de cada um.
+	DrawStats submit()
+	{
+		DrawStats stats;
+		bool multiDraw = glExtensions().multiDrawIndirect;
+		GLuint program = 0, VAO = 0;
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, this->indirectBuffer);
+		for (const Batch& batch : this->batches)
+		{
+			if (batch.shader->ID != program)
+			{
+				program = batch.shader->ID;
+				glUseProgram(program);
+				stats.programChanges++;
+			}
+			if (batch.VAO != VAO)
+			{
+				VAO = batch.VAO;
+				glBindVertexArray(VAO);
+				stats.vaoChanges++;
+			}
+			if (multiDraw)
+			{
+				glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+					(const void*)(batch.firstCommand * sizeof(DrawElementsIndirectCommand)), (GLsizei)batch.nCommands, 0);
+				stats.draws++;
+			}
+			else
+			{
+				for (size_t c = batch.firstCommand; c < batch.firstCommand + batch.nCommands; c++)
+				{
+					const DrawElementsIndirectCommand& command = this->commands[c];
+					pointInstanceAttributes(command.baseInstance);
+					glDrawElementsInstanced(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+						(GLvoid*)(command.firstIndex * sizeof(GLuint)), command.instanceCount);
+					stats.draws++;
+				}
+				pointInstanceAttributes(0);
+			}
+			stats.commands += (int)batch.nCommands;
+		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		glBindVertexArray(0);
+		return stats;
+	}
+
+	void destroy()
+	{
+		glDeleteBuffers(1, &this->instanceVBO);
+		glDeleteBuffers(1, &this->indirectBuffer);
+		this->materials.destroy();
+		this->instanceVBO = this->indirectBuffer = 0;
+		this->batches.clear();
+		this->commands.clear();
+		this->instances.clear();
+		this->materialIndex.clear();
+	}
+
+private:
+	struct Batch
+	{
+		Shader* shader;
+		GLuint VAO;
+		size_t firstCommand;
+		size_t nCommands = 0;
+	};
+	std::vector<Batch> batches;
+	std::vector<DrawElementsIndirectCommand> commands;
+	std::vector<InstanceData> instances;
+	std::vector<std::pair<std::pair<const Material*, bool>, GLuint>> materialIndex;
+
+	// Índice na MaterialTable do material do item (com e sem textura são entradas diferentes)
+	GLuint materialFor(const DrawItem& item)
+	{
+		std::pair<const Material*, bool> key(item.material, item.texture != 0);
+		for (const auto& entry : this->materialIndex)
+			if (entry.first == key)
+				return entry.second;
+		const Material& material = item.material != nullptr ? *item.material : DrawList::defaultMaterial();
+		GLuint index = this->materials.add(DrawList::instanceMaterial(material, key.second));
+		this->materialIndex.emplace_back(key, index);
+		return index;
+	}
+
+	// Aponta os atributos por instância do VAO ligado para instanceVBO, a partir da
+	// instância first
+	void pointInstanceAttributes(size_t first)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+		size_t base = first * sizeof(InstanceData);
+		for (GLuint c = 0; c < 4; c++)
+			glVertexAttribPointer(INSTANCE_MODEL_LOCATION + c, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+				(GLvoid*)(base + offsetof(InstanceData, model) + c * sizeof(glm::vec4)));
+		glVertexAttribIPointer(INSTANCE_MATERIAL_LOCATION, 1, GL_UNSIGNED_INT, sizeof(InstanceData),
+			(GLvoid*)(base + offsetof(InstanceData, material)));
+		glVertexAttribIPointer(INSTANCE_LAYER_LOCATION, 1, GL_UNSIGNED_INT, sizeof(InstanceData),
+			(GLvoid*)(base + offsetof(InstanceData, layer)));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+};
@@ -0,0 +1,160 @@
+// Observa arquivos em uma thread de fundo e marca os que foram alterados
+// No Linux usa inotify sobre a pasta de cada arquivo (editores costumam salvar em um
+// arquivo temporário e renomear, o que um watch no próprio arquivo perderia). Nos
+// outros sistemas compara a data de modificação a cada POLL_INTERVAL_MS.
+//
+// Uso (ver Shader::enableHotReload):
+//   int id = FileWatcher::global().watch("phong.fs");
+//   ...
+//   if (FileWatcher::global().changed(id)) // consome a marcação
+//       recarrega();
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+class FileWatcher
+{
+public:
+	static const int POLL_INTERVAL_MS = 250;
+
+	FileWatcher()
+	{
+#ifdef __linux__
+		this->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+		this->running = true;
+		this->worker = std::thread([this] { run(); });
+	}
+
+	~FileWatcher()
+	{
+		this->running = false;
+		if (this->worker.joinable())
+			this->worker.join();
+#ifdef __linux__
+		if (this->inotifyFd >= 0)
+			close(this->inotifyFd);
+#endif
+	}
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	// Começa a observar path; devolve o identificador usado em changed() (-1 se falhar)
+	int watch(const std::string& path)
+	{
+		std::error_code ec;
+		std::filesystem::path full = std::filesystem::absolute(path, ec);
+		if (ec)
+			return -1;
+		Entry entry;
+		entry.directory = full.parent_path().string();
+		entry.name = full.filename().string();
+		entry.mtime = std::filesystem::last_write_time(full, ec);
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+#ifdef __linux__
+		if (this->inotifyFd < 0)
+			return -1;
+		entry.wd = inotify_add_watch(this->inotifyFd, entry.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (entry.wd < 0)
+			return -1;
+#endif
+		this->entries.push_back(entry);
+		return (int)this->entries.size() - 1;
+	}
+
+	// true se o arquivo mudou desde a última consulta
+	bool changed(int id)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (id < 0 || id >= (int)this->entries.size() || !this->entries[id].changed)
+			return false;
+		this->entries[id].changed = false;
+		return true;
+	}
+
+	// Instância compartilhada pelo programa inteiro (uma única thread de fundo)
+	static FileWatcher& global()
+	{
+		static FileWatcher watcher;
+		return watcher;
+	}
+
+private:
+	struct Entry
+	{
+		std::string directory;
+		std::string name;
+		std::filesystem::file_time_type mtime;
+		int wd = -1;
+		bool changed = false;
+	};
+
+	std::vector<Entry> entries;
+	std::mutex mutex;
+	std::thread worker;
+	std::atomic<bool> running;
+#ifdef __linux__
+	int inotifyFd = -1;
+#endif
+
+	void run()
+	{
+		while (this->running)
+		{
+#ifdef __linux__
+			if (this->inotifyFd < 0)
+				return;
+			// O timeout do poll garante que o destrutor não espere mais que um intervalo
+			pollfd pfd = { this->inotifyFd, POLLIN, 0 };
+			if (poll(&pfd, 1, POLL_INTERVAL_MS) <= 0)
+				continue;
+			alignas(inotify_event) char buffer[4096];
+			ssize_t length;
+			while ((length = read(this->inotifyFd, buffer, sizeof(buffer))) > 0)
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				for (char* p = buffer; p < buffer + length; )
+				{
+					const inotify_event* event = (const inotify_event*)p;
+					if (event->len > 0)
+					{
+						for (Entry& entry : this->entries)
+							if (entry.wd == event->wd && entry.name == event->name)
+								entry.changed = true;
+					}
+					p += sizeof(inotify_event) + event->len;
+				}
+			}
+#else
+			std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+			std::lock_guard<std::mutex> lock(this->mutex);
+			for (Entry& entry : this->entries)
+			{
+				std::error_code ec;
+				auto mtime = std::filesystem::last_write_time(std::filesystem::path(entry.directory) / entry.name, ec);
+				if (!ec && mtime != entry.mtime)
+				{
+					entry.mtime = mtime;
+					entry.changed = true;
+				}
+			}
+#endif
+		}
+	}
+};
@@ -0,0 +1,138 @@
+// Dados por frame compartilhados por todos os programas de shader
+// Câmera e luz ficam em um único Uniform Buffer Object (layout std140) ligado ao
+// ponto FRAME_DATA_BINDING. A classe Shader liga automaticamente o bloco
+// "FrameData" de cada programa a esse ponto, então basta atualizar o UBO uma vez
+// por frame, em vez de repetir os glUniform* em cada programa.
+//
+// Declaração correspondente nos shaders:
+//   layout (std140) uniform FrameData
+//   {
+//       mat4 view;
+//       mat4 projection;
+//       vec4 cameraPos;  // xyz
+//       vec4 lightPos;   // xyz
+//       vec4 lightColor; // rgb
+//   };
+
+#pragma once
+
+#include <cstring>
+#include <cstddef>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "GLExtensions.h"
+
+// Espelho em C++ do bloco std140 (vec3 ocupam 16 bytes, por isso vec4)
+struct FrameData
+{
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::mat4 projection = glm::mat4(1.0f);
+	glm::vec4 cameraPos = glm::vec4(0.0f);
+	glm::vec4 lightPos = glm::vec4(0.0f);
+	glm::vec4 lightColor = glm::vec4(1.0f);
+};
+
+static_assert(sizeof(FrameData) == 2 * 64 + 3 * 16, "FrameData deve seguir o layout std140");
+
+// Com glBufferStorage (GL 4.4, carregada por GLExtensions.h) o UBO guarda
+// FRAME_UNIFORM_COPIES cópias do bloco e fica mapeado o tempo todo: cada update escreve
+// na cópia seguinte e a liga com glBindBufferRange, sem chamada de envio. Um fence por
+// cópia garante que a GPU já terminou de ler a que vai ser reescrita. Sem a extensão,
+// um UBO de uma cópia atualizado com glBufferSubData.
+const int FRAME_UNIFORM_COPIES = 3;
+
+class FrameUniforms
+{
+public:
+	GLuint UBO = 0;
+
+	bool persistent() const { return this->mapped != nullptr; }
+
+	// Cria o buffer e o liga ao ponto FRAME_DATA_BINDING (precisa de contexto OpenGL)
+	void create()
+	{
+		glGenBuffers(1, &this->UBO);
+		glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+		if (loadGLExtensions().bufferStorage)
+		{
+			GLint alignment = 256;
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+			this->stride = (sizeof(FrameData) + alignment - 1) / alignment * alignment;
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			GLsizeiptr size = (GLsizeiptr)(this->stride * FRAME_UNIFORM_COPIES);
+			glBufferStorage(GL_UNIFORM_BUFFER, size, nullptr, flags);
+			this->mapped = (unsigned char*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags);
+			if (!this->mapped)
+			{
+				// O armazenamento imutável não aceita glBufferData: recomeça com outro buffer
+				glDeleteBuffers(1, &this->UBO);
+				glGenBuffers(1, &this->UBO);
+				glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+			}
+		}
+		if (!this->mapped)
+			glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		this->copy = 0;
+		glBindBufferRange(GL_UNIFORM_BUFFER, Shader::FRAME_DATA_BINDING, this->UBO, 0, sizeof(FrameData));
+	}
+
+	// Envia os dados do frame (uma única vez por frame, valendo para todos os programas)
+	void update(const FrameData& data)
+	{
+		if (!this->mapped)
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+			glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			return;
+		}
+		// Os desenhos que leram a cópia atual já foram enviados: o fence fica atrás deles
+		if (this->written)
+			this->fences[this->copy] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		this->copy = (this->copy + 1) % FRAME_UNIFORM_COPIES;
+		if (this->fences[this->copy])
+		{
+			glClientWaitSync(this->fences[this->copy], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync(this->fences[this->copy]);
+			this->fences[this->copy] = 0;
+		}
+		size_t offset = this->copy * this->stride;
+		memcpy(this->mapped + offset, &data, sizeof(FrameData));
+		this->written = true;
+		glBindBufferRange(GL_UNIFORM_BUFFER, Shader::FRAME_DATA_BINDING, this->UBO, (GLintptr)offset, sizeof(FrameData));
+	}
+
+	void destroy()
+	{
+		for (GLsync& fence : this->fences)
+		{
+			if (fence)
+				glDeleteSync(fence);
+			fence = 0;
+		}
+		if (this->mapped)
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+			glUnmapBuffer(GL_UNIFORM_BUFFER);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &this->UBO);
+		this->UBO = 0;
+		this->mapped = nullptr;
+		this->written = false;
+	}
+
+private:
+	unsigned char* mapped = nullptr;
+	size_t stride = sizeof(FrameData); // distância entre as cópias (alinhada para glBindBufferRange)
+	int copy = 0;                      // cópia ligada ao ponto FRAME_DATA_BINDING
+	bool written = false;
+	GLsync fences[FRAME_UNIFORM_COPIES] = {};
+};
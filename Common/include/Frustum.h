@@ -0,0 +1,141 @@
+// Volume de visão (frustum) e caixas alinhadas aos eixos
+// Os seis planos são extraídos direto de projection * view (método de Gribb e
+// Hartmann): cada plano é a soma ou a diferença entre a quarta linha da matriz e uma
+// das outras três, com a normal apontando para dentro do volume. Um ponto p está do
+// lado de dentro de um plano se dot(plane.xyz, p) + plane.w >= 0.
+//
+// Uso:
+//   Frustum frustum(frameData.projection * frameData.view);
+//   AABB box = transformBounds(mesh.bounds(), model); // caixa em coordenadas de mundo
+//   if (frustum.testAABB(box) != FRUSTUM_OUTSIDE) ...
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "MeshOptimizer.h"
+
+struct AABB
+{
+	glm::vec3 min = glm::vec3(0.0f);
+	glm::vec3 max = glm::vec3(0.0f);
+
+	glm::vec3 center() const { return 0.5f * (this->min + this->max); }
+	glm::vec3 extent() const { return this->max - this->min; }
+
+	// Metade da área da superfície (o custo usado pelo SAH)
+	float halfArea() const
+	{
+		glm::vec3 e = glm::max(extent(), glm::vec3(0.0f));
+		return e.x * e.y + e.y * e.z + e.z * e.x;
+	}
+
+	void grow(const AABB& other)
+	{
+		this->min = glm::min(this->min, other.min);
+		this->max = glm::max(this->max, other.max);
+	}
+
+	static AABB empty()
+	{
+		AABB box;
+		box.min = glm::vec3(INFINITY);
+		box.max = glm::vec3(-INFINITY);
+		return box;
+	}
+};
+
+// Caixa em coordenadas de mundo que contém a caixa da malha transformada por model
+// (método de Arvo: cada eixo da caixa nova soma as contribuições mínima e máxima de
+// cada coluna da matriz, sem transformar os 8 cantos)
+inline AABB transformBounds(const glm::vec3& min, const glm::vec3& max, const glm::mat4& model)
+{
+	AABB box;
+	box.min = box.max = glm::vec3(model[3]);
+	for (int c = 0; c < 3; c++)
+	{
+		glm::vec3 a = glm::vec3(model[c]) * min[c];
+		glm::vec3 b = glm::vec3(model[c]) * max[c];
+		box.min += glm::min(a, b);
+		box.max += glm::max(a, b);
+	}
+	return box;
+}
+
+inline AABB transformBounds(const MeshBounds& bounds, const glm::mat4& model)
+{
+	return transformBounds(bounds.min, bounds.max, model);
+}
+
+enum FrustumTest
+{
+	FRUSTUM_OUTSIDE = 0,
+	FRUSTUM_INTERSECTS = 1,
+	FRUSTUM_INSIDE = 2
+};
+
+const int FRUSTUM_PLANES = 6;
+
+struct Frustum
+{
+	glm::vec4 planes[FRUSTUM_PLANES]; // esquerda, direita, baixo, cima, perto, longe
+
+	Frustum() {}
+
+	explicit Frustum(const glm::mat4& viewProjection)
+	{
+		// glm guarda as matrizes por coluna: a linha i é (m[0][i], m[1][i], m[2][i], m[3][i])
+		glm::vec4 row[4];
+		for (int i = 0; i < 4; i++)
+			row[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+		this->planes[0] = row[3] + row[0];
+		this->planes[1] = row[3] - row[0];
+		this->planes[2] = row[3] + row[1];
+		this->planes[3] = row[3] - row[1];
+		this->planes[4] = row[3] + row[2];
+		this->planes[5] = row[3] - row[2];
+		for (glm::vec4& plane : this->planes)
+			plane /= glm::length(glm::vec3(plane));
+	}
+
+	bool testSphere(const glm::vec3& center, float radius) const
+	{
+		for (const glm::vec4& plane : this->planes)
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+				return false;
+		return true;
+	}
+
+	// Só testa os planos com o bit ligado em planeMask. Os planos dos quais a caixa fica
+	// inteira do lado de dentro são desligados em planeMask, para os filhos não os
+	// testarem de novo.
+	FrustumTest testAABB(const AABB& box, unsigned& planeMask) const
+	{
+		for (int p = 0; p < FRUSTUM_PLANES; p++)
+		{
+			if (!(planeMask & (1u << p)))
+				continue;
+			const glm::vec4& plane = this->planes[p];
+			// Canto mais à frente (p) e mais atrás (n) na direção da normal
+			glm::vec3 positive(plane.x > 0.0f ? box.max.x : box.min.x, plane.y > 0.0f ? box.max.y : box.min.y,
+				plane.z > 0.0f ? box.max.z : box.min.z);
+			glm::vec3 negative(plane.x > 0.0f ? box.min.x : box.max.x, plane.y > 0.0f ? box.min.y : box.max.y,
+				plane.z > 0.0f ? box.min.z : box.max.z);
+			if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+				return FRUSTUM_OUTSIDE;
+			if (glm::dot(glm::vec3(plane), negative) + plane.w >= 0.0f)
+				planeMask &= ~(1u << p);
+		}
+		return planeMask == 0 ? FRUSTUM_INSIDE : FRUSTUM_INTERSECTS;
+	}
+
+	FrustumTest testAABB(const AABB& box) const
+	{
+		unsigned planeMask = (1u << FRUSTUM_PLANES) - 1;
+		return testAABB(box, planeMask);
+	}
+};
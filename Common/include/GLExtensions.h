@@ -0,0 +1,242 @@
+// Funções e constantes da OpenGL posteriores à versão 4.0
+// O GLAD distribuído em Dependencies foi gerado para OpenGL 4.0 sem extensões, então
+// as funções mais novas usadas pelos utilitários de Common são carregadas aqui, com o
+// mesmo glfwGetProcAddress usado pelo GLAD. O código chama os nomes padrão
+// (glGetProgramBinary, glBufferStorage...); se um GLAD mais novo for gerado, as
+// definições dele têm prioridade e este arquivo apenas completa o que faltar.
+//
+// Chame loadGLExtensions() depois de gladLoadGLLoader (é seguro chamar mais de uma vez)
+// e consulte os campos de glExtensions() antes de usar cada recurso.
+
+#pragma once
+
+#include <cstring>
+#include <string>
+
+//GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#ifndef APIENTRYP
+#define APIENTRYP APIENTRY *
+#endif
+
+// ----------------------------------------------------------------------------
+// Constantes
+// ----------------------------------------------------------------------------
+
+// GL 4.1 / ARB_get_program_binary
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_PROGRAM_BINARY_FORMATS 0x87FF
+#endif
+
+// KHR_parallel_shader_compile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// EXT_texture_compression_s3tc (formatos BC1 a BC3)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// GL 4.2 / ARB_texture_storage
+#ifndef GL_TEXTURE_IMMUTABLE_FORMAT
+#define GL_TEXTURE_IMMUTABLE_FORMAT 0x912F
+#endif
+
+// GL 4.4 / ARB_buffer_storage
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+// GL 4.3 / ARB_compute_shader e ARB_shader_storage_buffer_object
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#endif
+
+// GL 4.6 / ARB_indirect_parameters
+#ifndef GL_PARAMETER_BUFFER
+#define GL_PARAMETER_BUFFER 0x80EE
+#endif
+
+// ----------------------------------------------------------------------------
+// Ponteiros de função
+// ----------------------------------------------------------------------------
+
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC_CG)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC_CG)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC_CG)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_CG)(GLuint count);
+typedef void (APIENTRYP PFNGLTEXSTORAGE2DPROC_CG)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC_CG)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC_CG)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC_CG)(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC_CG)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC_CG)(GLbitfield barriers);
+
+inline PFNGLGETPROGRAMBINARYPROC_CG cg_glGetProgramBinary = nullptr;
+inline PFNGLPROGRAMBINARYPROC_CG cg_glProgramBinary = nullptr;
+inline PFNGLPROGRAMPARAMETERIPROC_CG cg_glProgramParameteri = nullptr;
+inline PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_CG cg_glMaxShaderCompilerThreadsKHR = nullptr;
+inline PFNGLTEXSTORAGE2DPROC_CG cg_glTexStorage2D = nullptr;
+inline PFNGLBUFFERSTORAGEPROC_CG cg_glBufferStorage = nullptr;
+inline PFNGLMULTIDRAWELEMENTSINDIRECTPROC_CG cg_glMultiDrawElementsIndirect = nullptr;
+inline PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC_CG cg_glMultiDrawElementsIndirectCount = nullptr;
+inline PFNGLDISPATCHCOMPUTEPROC_CG cg_glDispatchCompute = nullptr;
+inline PFNGLMEMORYBARRIERPROC_CG cg_glMemoryBarrier = nullptr;
+
+#ifndef glGetProgramBinary
+#define glGetProgramBinary cg_glGetProgramBinary
+#endif
+#ifndef glProgramBinary
+#define glProgramBinary cg_glProgramBinary
+#endif
+#ifndef glProgramParameteri
+#define glProgramParameteri cg_glProgramParameteri
+#endif
+#ifndef glMaxShaderCompilerThreadsKHR
+#define glMaxShaderCompilerThreadsKHR cg_glMaxShaderCompilerThreadsKHR
+#endif
+#ifndef glTexStorage2D
+#define glTexStorage2D cg_glTexStorage2D
+#endif
+#ifndef glBufferStorage
+#define glBufferStorage cg_glBufferStorage
+#endif
+#ifndef glMultiDrawElementsIndirect
+#define glMultiDrawElementsIndirect cg_glMultiDrawElementsIndirect
+#endif
+#ifndef glMultiDrawElementsIndirectCount
+#define glMultiDrawElementsIndirectCount cg_glMultiDrawElementsIndirectCount
+#endif
+#ifndef glDispatchCompute
+#define glDispatchCompute cg_glDispatchCompute
+#endif
+#ifndef glMemoryBarrier
+#define glMemoryBarrier cg_glMemoryBarrier
+#endif
+
+// ----------------------------------------------------------------------------
+// Carregamento
+// ----------------------------------------------------------------------------
+
+struct GLExtensionSupport
+{
+	bool loaded = false;
+	int major = 0, minor = 0;
+	bool programBinary = false;         // GL 4.1 ou ARB_get_program_binary, com ao menos 1 formato
+	bool parallelShaderCompile = false; // KHR/ARB_parallel_shader_compile
+	bool textureCompressionS3TC = false; // EXT_texture_compression_s3tc (BC1/BC3 no glCompressedTexImage2D)
+	bool textureStorage = false;        // GL 4.2 ou ARB_texture_storage (glTexStorage2D)
+	bool bufferStorage = false;         // GL 4.4 ou ARB_buffer_storage (buffers mapeados persistentemente)
+	bool multiDrawIndirect = false;     // GL 4.3 (glMultiDrawElementsIndirect, com baseInstance respeitado)
+	bool computeShader = false;         // GL 4.3 (compute shaders e SSBOs)
+	bool indirectCount = false;         // GL 4.6 ou ARB_indirect_parameters (número de comandos lido de um buffer)
+};
+
+inline GLExtensionSupport& glExtensions()
+{
+	static GLExtensionSupport support;
+	return support;
+}
+
+inline bool hasGLExtension(const char* name)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++)
+	{
+		const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+		if (ext && strcmp(ext, name) == 0)
+			return true;
+	}
+	return false;
+}
+
+inline bool hasGLVersion(int major, int minor)
+{
+	const GLExtensionSupport& s = glExtensions();
+	return s.major > major || (s.major == major && s.minor >= minor);
+}
+
+// Precisa de um contexto OpenGL corrente
+inline const GLExtensionSupport& loadGLExtensions()
+{
+	GLExtensionSupport& s = glExtensions();
+	if (s.loaded)
+		return s;
+	s.loaded = true;
+	glGetIntegerv(GL_MAJOR_VERSION, &s.major);
+	glGetIntegerv(GL_MINOR_VERSION, &s.minor);
+
+	auto load = [](const char* name) { return (void*)glfwGetProcAddress(name); };
+
+	if (hasGLVersion(4, 1) || hasGLExtension("GL_ARB_get_program_binary"))
+	{
+		cg_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC_CG)load("glGetProgramBinary");
+		cg_glProgramBinary = (PFNGLPROGRAMBINARYPROC_CG)load("glProgramBinary");
+		cg_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC_CG)load("glProgramParameteri");
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		s.programBinary = cg_glGetProgramBinary && cg_glProgramBinary && cg_glProgramParameteri && formats > 0;
+	}
+
+	if (hasGLExtension("GL_KHR_parallel_shader_compile"))
+		cg_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_CG)load("glMaxShaderCompilerThreadsKHR");
+	else if (hasGLExtension("GL_ARB_parallel_shader_compile"))
+		cg_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_CG)load("glMaxShaderCompilerThreadsARB");
+	s.parallelShaderCompile = cg_glMaxShaderCompilerThreadsKHR != nullptr;
+
+	s.textureCompressionS3TC = hasGLExtension("GL_EXT_texture_compression_s3tc");
+
+	if (hasGLVersion(4, 2) || hasGLExtension("GL_ARB_texture_storage"))
+		cg_glTexStorage2D = (PFNGLTEXSTORAGE2DPROC_CG)load("glTexStorage2D");
+	s.textureStorage = cg_glTexStorage2D != nullptr;
+
+	if (hasGLVersion(4, 4) || hasGLExtension("GL_ARB_buffer_storage"))
+		cg_glBufferStorage = (PFNGLBUFFERSTORAGEPROC_CG)load("glBufferStorage");
+	s.bufferStorage = cg_glBufferStorage != nullptr;
+
+	// baseInstance nos comandos indiretos vem do GL 4.2 / ARB_base_instance
+	if (hasGLVersion(4, 3) || (hasGLExtension("GL_ARB_multi_draw_indirect") && hasGLExtension("GL_ARB_base_instance")))
+		cg_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC_CG)load("glMultiDrawElementsIndirect");
+	s.multiDrawIndirect = cg_glMultiDrawElementsIndirect != nullptr;
+
+	if (hasGLVersion(4, 3) || (hasGLExtension("GL_ARB_compute_shader") && hasGLExtension("GL_ARB_shader_storage_buffer_object")))
+	{
+		cg_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC_CG)load("glDispatchCompute");
+		cg_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC_CG)load("glMemoryBarrier");
+	}
+	s.computeShader = cg_glDispatchCompute && cg_glMemoryBarrier;
+
+	if (s.multiDrawIndirect && hasGLVersion(4, 6))
+		cg_glMultiDrawElementsIndirectCount = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC_CG)load("glMultiDrawElementsIndirectCount");
+	else if (s.multiDrawIndirect && hasGLExtension("GL_ARB_indirect_parameters"))
+		cg_glMultiDrawElementsIndirectCount = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC_CG)load("glMultiDrawElementsIndirectCountARB");
+	s.indirectCount = cg_glMultiDrawElementsIndirectCount != nullptr;
+
+	return s;
+}
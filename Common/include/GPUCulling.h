@@ -0,0 +1,165 @@
+// Culling na GPU: a cena inteira em uma glMultiDrawElementsIndirect
+// As malhas ficam em um único VBO/EBO (addMesh devolve a faixa de cada uma) e cada
+// submesh de cada objeto vira um desenho, com a caixa em coordenadas de mundo, a faixa
+// de índices e um InstanceData (matriz, material e camada do texture array, nos
+// atributos por instância de InstancedRenderer.h). Tudo isso vai para a GPU uma vez,
+// em upload(). A cada frame:
+//   1. buildHiZ: a profundidade de um frame já desenhado vira uma pirâmide Hi-Z (cada
+//      texel com a maior profundidade dos 2 x 2 de baixo), um nível por dispatch de
+//      hiz.cs. Os níveis ficam um depois do outro em um SSBO de floats, não nos mipmaps
+//      de uma textura: no llvmpipe, texelFetch com um nível diferente em cada invocação
+//      lê o nível errado.
+//   2. cull: cull.cs, uma invocação por desenho, testa a caixa contra os planos do
+//      frustum e depois contra a pirâmide (o mesmo teste de OcclusionBuffer::isOccluded
+//      em OcclusionCulling.h) e escreve os comandos dos visíveis no buffer indireto,
+//      compactados por um contador atômico
+//   3. submit: uma glMultiDrawElementsIndirectCount, que lê o número de comandos do
+//      contador na GPU. Sem GL 4.6 / ARB_indirect_parameters, cada desenho tem um
+//      comando fixo e os descartados ficam com instanceCount 0.
+// Nenhum passo percorre os objetos na CPU; ela só envia os planos e a matriz da câmera.
+//
+// A pirâmide normalmente vem do frame anterior: com a câmera andando rápido, um objeto
+// que acabou de aparecer atrás de uma borda pode surgir um frame atrasado.
+//
+// cullReference repete o teste na CPU, a partir do nível 0 da pirâmide lido de volta,
+// e readStatus lê o resultado da GPU (as duas funções esperam a GPU; são para
+// conferência, não para o laço de desenho).
+//
+// Uso:
+//   GPUCulling culling;
+//   culling.create("cull.cs", "hiz.cs");
+//   int desk = culling.addMesh(deskMesh);    // CachedMesh
+//   culling.addObject(desk, model, materials);
+//   culling.upload();
+//   // a cada frame, com a profundidade do frame anterior em depthTexture:
+//   culling.buildHiZ(depthTexture, width, height);
+//   culling.cull(projection * view);
+//   culling.submit(shader);                   // programa com os atributos de phong-array.vs
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "Frustum.h"
+#include "MeshCache.h"
+#include "DrawList.h"
+#include "GLExtensions.h"
+#include "InstancedRenderer.h"
+
+// Pontos de ligação dos SSBOs de cull.cs
+const GLuint GPU_CULL_DRAWS_BINDING = 0;
+const GLuint GPU_CULL_COMMANDS_BINDING = 1;
+const GLuint GPU_CULL_COUNT_BINDING = 2;
+const GLuint GPU_CULL_STATUS_BINDING = 3;
+const GLuint GPU_CULL_HIZ_BINDING = 4;  // também em hiz.cs
+const GLuint GPU_CULL_TEXTURE_UNIT = 1; // unidade da textura de profundidade em hiz.cs (a 0 fica com o texture array)
+const int GPU_HIZ_MAX_LEVELS = 16;      // tamanho dos vetores de uniforms dos shaders
+const int GPU_CULL_GROUP_SIZE = 64; // local_size_x de cull.cs
+const int GPU_HIZ_GROUP_SIZE = 8;   // local_size_x e local_size_y de hiz.cs
+
+// Resultado de um desenho, em readStatus e cullReference
+enum GPUCullStatus
+{
+	GPU_CULL_FRUSTUM = 0,  // fora do frustum
+	GPU_CULL_OCCLUDED = 1, // atrás da pirâmide Hi-Z
+	GPU_CULL_VISIBLE = 2
+};
+
+// Um desenho no SSBO de cull.cs (layout std430, 48 bytes)
+struct GPUDrawRecord
+{
+	glm::vec4 boxMin; // caixa em coordenadas de mundo (w sem uso)
+	glm::vec4 boxMax;
+	GLuint count;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint padding;
+};
+
+static_assert(sizeof(GPUDrawRecord) == 48, "GPUDrawRecord deve seguir o layout std430");
+
+class GPUCulling
+{
+public:
+	bool occlusion = true; // false: só o frustum
+	bool compact = true;   // false: um comando por desenho mesmo com ARB_indirect_parameters
+
+	// Compila os dois compute shaders (precisa de glExtensions().computeShader e
+	// multiDrawIndirect; devolve false sem eles)
+	bool create(const char* cullPath, const char* hizPath);
+
+	// Acrescenta a geometria de uma malha e devolve o índice dela (antes de upload)
+	int addMesh(const CachedMesh& mesh);
+
+	// Um desenho por submesh. layers[i] é a camada do material i no texture array
+	// (-1 ou ausente: sem textura, a cor Kd multiplica whiteLayer).
+	void addObject(int mesh, const glm::mat4& model, const std::vector<Material>& materials,
+		const std::vector<int>& layers = std::vector<int>(), GLuint whiteLayer = 0);
+
+	// Cria o VAO e os buffers com tudo o que foi acrescentado
+	void upload();
+
+	// Monta a pirâmide a partir de uma textura de profundidade width x height
+	void buildHiZ(GLuint depthTexture, int width, int height);
+
+	// Testa todos os desenhos e escreve os comandos. Sem buildHiZ antes, só o frustum.
+	void cull(const glm::mat4& viewProjection);
+
+	// Desenha os comandos escritos pelo último cull com shader (um programa e um VAO)
+	DrawStats submit(const Shader& shader);
+
+	int nDraws() const { return (int)this->records.size(); }
+	int nMeshes() const { return (int)this->meshes.size(); }
+	bool usesIndirectCount() const { return this->compact && glExtensions().indirectCount; }
+
+	// Conferência (esperam a GPU): status de cada desenho no último cull e número de
+	// comandos compactados
+	void readStatus(std::vector<uint8_t>& status);
+	int readVisibleCount();
+	// O mesmo teste do último cull feito na CPU, com a pirâmide montada aqui a partir
+	// do nível 0 da GPU
+	void cullReference(std::vector<uint8_t>& status);
+
+	void destroy();
+
+private:
+	struct MeshRange
+	{
+		GLuint firstIndex;
+		GLint baseVertex;
+		std::vector<Submesh> submeshes;
+		MeshBounds bounds;
+	};
+
+	std::unique_ptr<Shader> cullProgram, hizProgram;
+	GLuint VAO = 0, vertexBuffer = 0, indexBuffer = 0, instanceBuffer = 0;
+	GLuint drawBuffer = 0, commandBuffer = 0, countBuffer = 0, statusBuffer = 0;
+	GLuint hizBuffer = 0;
+	int hizWidth = 0, hizHeight = 0, hizLevels = 0;
+	GLint hizOffsets[GPU_HIZ_MAX_LEVELS] = {};  // primeiro float de cada nível no SSBO
+	glm::ivec2 hizSizes[GPU_HIZ_MAX_LEVELS] = {};
+	bool hizReady = false;
+	MaterialTable materials;
+
+	// Montados na CPU e enviados em upload()
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	std::vector<MeshRange> meshes;
+	std::vector<GPUDrawRecord> records;
+	std::vector<InstanceData> instances;
+
+	glm::mat4 lastViewProjection = glm::mat4(1.0f);
+	bool lastOcclusion = false;
+
+	// Índice na MaterialTable (materiais iguais depois da conversão dividem a entrada)
+	GLuint materialFor(const Material& material, bool textured);
+};
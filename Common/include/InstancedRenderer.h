@@ -0,0 +1,361 @@
+// Desenho instanciado: todas as cópias de uma malha em uma única chamada
+// Cada InstancedMesh guarda, em um buffer de instâncias, a matriz de modelo e o índice
+// de material de cada cópia, e desenha todas com glDrawElementsInstanced. Os materiais
+// ficam em um Uniform Buffer Object (MaterialTable) ligado ao ponto
+// Shader::MATERIALS_BINDING, indexado no shader pelo índice da instância.
+//
+// Com drawLOD, cada cópia usa o nível de detalhe (ver buildLODs em MeshOptimizer.h)
+// adequado ao tamanho dela na tela: as instâncias são separadas por nível em um
+// segundo buffer e cada nível é desenhado com uma glDrawElementsInstanced.
+//
+// Declarações correspondentes no vertex shader:
+//   layout (location = 4) in mat4 instanceModel;   // ocupa as locations 4, 5, 6 e 7
+//   layout (location = 8) in uint instanceMaterial;
+//   layout (location = 9) in uint instanceLayer;    // só com texture array (ver DrawBatches em DrawList.h)
+// e em qualquer estágio que leia os materiais:
+//   struct Material { vec4 color; vec4 coefficients; }; // rgb; ka, kd, ks, q
+//   layout (std140) uniform Materials { Material materials[MAX_INSTANCE_MATERIALS]; };
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "MeshCache.h"
+#include "MeshBuffers.h"
+#include "MeshOptimizer.h"
+
+const GLuint INSTANCE_MODEL_LOCATION = 4;
+const GLuint INSTANCE_MATERIAL_LOCATION = 8;
+const GLuint INSTANCE_LAYER_LOCATION = 9;
+const int MAX_INSTANCE_MATERIALS = 64;
+
+// Dados de uma cópia, na ordem em que ficam no buffer de instâncias
+struct InstanceData
+{
+	glm::mat4 model;
+	GLuint material;
+	GLuint layer;      // camada do texture array (ver TextureArray.h)
+	GLuint padding[2]; // mantém cada instância alinhada em 16 bytes
+};
+
+static_assert(sizeof(InstanceData) == 80, "InstanceData deve ter 80 bytes");
+
+// Espelho em C++ de um elemento do bloco std140 Materials
+struct InstanceMaterial
+{
+	glm::vec4 color = glm::vec4(1.0f);                           // rgb multiplica a textura
+	glm::vec4 coefficients = glm::vec4(0.2f, 0.5f, 0.5f, 10.0f); // ka, kd, ks, q
+};
+
+static_assert(sizeof(InstanceMaterial) == 32, "InstanceMaterial deve seguir o layout std140");
+
+class MaterialTable
+{
+public:
+	GLuint UBO = 0;
+	std::vector<InstanceMaterial> materials;
+
+	// Cria o buffer e o liga ao ponto MATERIALS_BINDING (precisa de contexto OpenGL)
+	void create()
+	{
+		glGenBuffers(1, &this->UBO);
+		glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+		glBufferData(GL_UNIFORM_BUFFER, MAX_INSTANCE_MATERIALS * sizeof(InstanceMaterial), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glBindBufferBase(GL_UNIFORM_BUFFER, Shader::MATERIALS_BINDING, this->UBO);
+	}
+
+	int overflow = 0; // materiais que não couberam na tabela (desenhados com o material 0)
+
+	// Devolve o índice do material. Com a tabela cheia nenhuma entrada é sobrescrita (ela
+	// pode estar em uso por outras instâncias): o material é contado em overflow e o
+	// índice devolvido é 0.
+	GLuint add(const InstanceMaterial& material)
+	{
+		if ((int)this->materials.size() >= MAX_INSTANCE_MATERIALS)
+		{
+			this->overflow++;
+			return 0;
+		}
+		this->materials.push_back(material);
+		return (GLuint)this->materials.size() - 1;
+	}
+
+	// Envia a tabela (depois de adicionar ou alterar materiais)
+	void update()
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, this->materials.size() * sizeof(InstanceMaterial), this->materials.data());
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	void destroy()
+	{
+		glDeleteBuffers(1, &this->UBO);
+		this->UBO = 0;
+	}
+};
+
+class InstancedMesh
+{
+public:
+	GLuint VAO = 0;
+	GLuint instanceVBO = 0;
+	int nIndices = 0;
+	std::vector<MeshLOD> lods; // vazio se a malha não veio de load()
+	glm::vec4 bounds = glm::vec4(0.0f); // esfera envolvente no espaço do modelo (centro, raio)
+
+	// Carrega um .obj (pelo cache binário, ver MeshCache.h) no layout de
+	// OBJ_FLOATS_PER_VERTEX floats e prepara o buffer de instâncias
+	bool load(const std::string& objPath)
+	{
+		CachedMesh mesh;
+		if (!mesh.load(objPath))
+			return false;
+
+		glGenVertexArrays(1, &this->VAO);
+		glBindVertexArray(this->VAO);
+
+		glGenBuffers(1, &this->meshVBO);
+		glBindBuffer(GL_ARRAY_BUFFER, this->meshVBO);
+		glBufferData(GL_ARRAY_BUFFER, mesh.vertexBytes(), mesh.vertexData(), GL_STATIC_DRAW);
+
+		// Níveis de detalhe logo depois dos índices da malha completa, no mesmo buffer
+		glGenBuffers(1, &this->meshEBO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->meshEBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBytes() + mesh.lodIndexBytes(), nullptr, GL_STATIC_DRAW);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, mesh.indexBytes(), mesh.indexData());
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBytes(), mesh.lodIndexBytes(), mesh.lodIndexData());
+		this->lods = mesh.lods();
+		this->bounds = computeBoundingSphere(mesh.vertexData(), mesh.nVertices());
+
+		setupMeshAttributes(this->VAO, this->meshVBO, this->meshEBO);
+		attach(this->VAO, mesh.nIndices());
+		return true;
+	}
+
+	// Triângulos desenhados pelo último draw ou drawLOD, e cópias em cada nível
+	// (instancesPerLevel[0] é a malha completa) no último drawLOD
+	size_t trianglesDrawn = 0;
+	std::vector<int> instancesPerLevel;
+
+	// Acrescenta os atributos por instância a um VAO já configurado (com EBO de GLuint)
+	void attach(GLuint vao, int indexCount)
+	{
+		this->VAO = vao;
+		this->nIndices = indexCount;
+		glBindVertexArray(this->VAO);
+		if (this->instanceVBO == 0)
+			glGenBuffers(1, &this->instanceVBO);
+		for (GLuint location = INSTANCE_MODEL_LOCATION; location <= INSTANCE_MATERIAL_LOCATION; location++)
+		{
+			glEnableVertexAttribArray(location);
+			glVertexAttribDivisor(location, 1); // avança uma vez por instância, não por vértice
+		}
+		pointInstanceAttributes(this->instanceVBO, 0);
+		glBindVertexArray(0);
+	}
+
+	// Devolve o índice da nova instância
+	int add(const glm::mat4& model, GLuint material = 0)
+	{
+		InstanceData data = {};
+		data.model = model;
+		data.material = material;
+		this->instances.push_back(data);
+		markDirty((int)this->instances.size() - 1);
+		return (int)this->instances.size() - 1;
+	}
+
+	void setModel(int index, const glm::mat4& model)
+	{
+		this->instances[index].model = model;
+		markDirty(index);
+	}
+
+	void setMaterial(int index, GLuint material)
+	{
+		this->instances[index].material = material;
+		markDirty(index);
+	}
+
+	const InstanceData& instance(int index) const { return this->instances[index]; }
+	int nInstances() const { return (int)this->instances.size(); }
+
+	void clear()
+	{
+		this->instances.clear();
+		this->dirtyBegin = this->dirtyEnd = 0;
+	}
+
+	// Envia ao buffer só o trecho alterado desde o último envio. Quando as instâncias
+	// não cabem mais, o buffer é realocado com o dobro da capacidade.
+	void upload()
+	{
+		if (this->dirtyBegin >= this->dirtyEnd)
+			return;
+		glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+		if (this->instances.size() > this->capacity)
+		{
+			this->capacity = std::max(this->instances.size(), this->capacity * 2);
+			glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(InstanceData), nullptr, GL_DYNAMIC_DRAW);
+			this->dirtyBegin = 0;
+			this->dirtyEnd = this->instances.size();
+		}
+		glBufferSubData(GL_ARRAY_BUFFER, this->dirtyBegin * sizeof(InstanceData),
+			(this->dirtyEnd - this->dirtyBegin) * sizeof(InstanceData), &this->instances[this->dirtyBegin]);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		this->dirtyBegin = this->dirtyEnd = 0;
+	}
+
+	// Envia o que mudou e desenha todas as instâncias com uma única chamada
+	void draw()
+	{
+		upload();
+		if (this->instances.empty())
+			return;
+		glBindVertexArray(this->VAO);
+		glDrawElementsInstanced(GL_TRIANGLES, this->nIndices, GL_UNSIGNED_INT, 0, (GLsizei)this->instances.size());
+		glBindVertexArray(0);
+		this->trianglesDrawn = (size_t)this->nIndices / 3 * this->instances.size();
+	}
+
+	// Desenha cada instância no nível de detalhe mais simples cujo erro projetado não
+	// passa de pixelError pixels (ver selectLOD). As instâncias são agrupadas por nível
+	// em lodVBO e cada nível é uma glDrawElementsInstanced, com os atributos por
+	// instância apontando para o início do seu grupo. Sem níveis, faz o mesmo que draw().
+	void drawLOD(const glm::mat4& view, const glm::mat4& projection, float viewportHeight,
+		float pixelError = LOD_PIXEL_ERROR)
+	{
+		if (this->lods.empty())
+		{
+			draw();
+			return;
+		}
+		upload();
+		int nLevels = (int)this->lods.size() + 1;
+		this->instancesPerLevel.assign(nLevels, 0);
+		this->trianglesDrawn = 0;
+		if (this->instances.empty())
+			return;
+
+		// Escolhe o nível de cada cópia pela esfera envolvente transformada
+		this->instanceLevels.resize(this->instances.size());
+		glm::vec3 center = glm::vec3(this->bounds);
+		for (size_t i = 0; i < this->instances.size(); i++)
+		{
+			const glm::mat4& model = this->instances[i].model;
+			glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+			float scale = std::max(glm::length(glm::vec3(model[0])),
+				std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+			float screenRadius = projectedSphereRadius(worldCenter, this->bounds.w * scale, view, projection, viewportHeight);
+			int level = selectLOD(this->lods, screenRadius, pixelError);
+			this->instanceLevels[i] = (uint8_t)level;
+			this->instancesPerLevel[level]++;
+		}
+
+		// Agrupa as cópias por nível (ordenação por contagem, estável)
+		std::vector<size_t> start(nLevels + 1, 0);
+		for (int level = 0; level < nLevels; level++)
+			start[level + 1] = start[level] + this->instancesPerLevel[level];
+		this->sortedInstances.resize(this->instances.size());
+		std::vector<size_t> next(start.begin(), start.end() - 1);
+		for (size_t i = 0; i < this->instances.size(); i++)
+			this->sortedInstances[next[this->instanceLevels[i]]++] = this->instances[i];
+
+		if (this->lodVBO == 0)
+			glGenBuffers(1, &this->lodVBO);
+		glBindBuffer(GL_ARRAY_BUFFER, this->lodVBO);
+		if (this->sortedInstances.size() > this->lodCapacity)
+		{
+			this->lodCapacity = std::max(this->sortedInstances.size(), this->lodCapacity * 2);
+			glBufferData(GL_ARRAY_BUFFER, this->lodCapacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+		}
+		glBufferSubData(GL_ARRAY_BUFFER, 0, this->sortedInstances.size() * sizeof(InstanceData), this->sortedInstances.data());
+
+		glBindVertexArray(this->VAO);
+		for (int level = 0; level < nLevels; level++)
+		{
+			GLsizei count = (GLsizei)this->instancesPerLevel[level];
+			if (count == 0)
+				continue;
+			GLuint firstIndex = level == 0 ? 0 : this->lods[level - 1].firstIndex;
+			GLsizei indexCount = level == 0 ? this->nIndices : (GLsizei)this->lods[level - 1].indexCount;
+			pointInstanceAttributes(this->lodVBO, start[level]);
+			glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, (GLvoid*)(firstIndex * sizeof(GLuint)), count);
+			this->trianglesDrawn += (size_t)indexCount / 3 * count;
+		}
+		// draw() continua lendo o buffer principal
+		pointInstanceAttributes(this->instanceVBO, 0);
+		glBindVertexArray(0);
+	}
+
+	void destroy()
+	{
+		glDeleteBuffers(1, &this->instanceVBO);
+		if (this->lodVBO != 0)
+			glDeleteBuffers(1, &this->lodVBO);
+		if (this->meshVBO != 0)
+		{
+			// Só apaga a geometria que o próprio load() criou
+			glDeleteBuffers(1, &this->meshVBO);
+			glDeleteBuffers(1, &this->meshEBO);
+			glDeleteVertexArrays(1, &this->VAO);
+		}
+		this->VAO = this->instanceVBO = this->meshVBO = this->meshEBO = this->lodVBO = 0;
+		this->capacity = this->lodCapacity = 0;
+		this->lods.clear();
+		clear();
+	}
+
+private:
+	std::vector<InstanceData> instances;
+	size_t capacity = 0; // instâncias que cabem no buffer
+	size_t dirtyBegin = 0, dirtyEnd = 0; // trecho [begin, end) a enviar
+	GLuint meshVBO = 0, meshEBO = 0;
+	GLuint lodVBO = 0; // instâncias agrupadas por nível (drawLOD)
+	size_t lodCapacity = 0;
+	std::vector<uint8_t> instanceLevels;
+	std::vector<InstanceData> sortedInstances;
+
+	// Aponta os atributos por instância do VAO ligado para buffer, a partir da
+	// instância first
+	void pointInstanceAttributes(GLuint buffer, size_t first)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		size_t base = first * sizeof(InstanceData);
+		// Uma mat4 ocupa 4 locations consecutivas, uma coluna em cada
+		for (GLuint c = 0; c < 4; c++)
+			glVertexAttribPointer(INSTANCE_MODEL_LOCATION + c, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+				(GLvoid*)(base + offsetof(InstanceData, model) + c * sizeof(glm::vec4)));
+		// Índice inteiro: glVertexAttribIPointer, para não ser convertido em float
+		glVertexAttribIPointer(INSTANCE_MATERIAL_LOCATION, 1, GL_UNSIGNED_INT, sizeof(InstanceData),
+			(GLvoid*)(base + offsetof(InstanceData, material)));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void markDirty(int index)
+	{
+		if (this->dirtyBegin >= this->dirtyEnd)
+		{
+			this->dirtyBegin = index;
+			this->dirtyEnd = index + 1;
+		}
+		else
+		{
+			this->dirtyBegin = std::min(this->dirtyBegin, (size_t)index);
+			this->dirtyEnd = std::max(this->dirtyEnd, (size_t)index + 1);
+		}
+	}
+};
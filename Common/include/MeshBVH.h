@@ -0,0 +1,142 @@
+// Hierarquia de volumes envolventes (BVH) dos triângulos de uma malha, para consultas
+// de raio: seleção com o mouse (picking), linha de visada, sombras na CPU...
+// A montagem usa SAH em caixas (bins) sobre os centros dos triângulos. Os níveis de
+// cima são divididos na thread que chama e as subárvores de baixo são montadas em
+// paralelo no ThreadPool global. A árvore binária resultante é achatada em nós de 4
+// filhos, com as caixas dos filhos em estrutura de arrays, e cada folha guarda até 4
+// triângulos (vértice 0 e duas arestas, também em arrays): um raio testa as 4 caixas
+// de um nó, ou os 4 triângulos de uma folha, com uma instrução SSE por operação.
+//
+// Consultas:
+//   - intersect: o triângulo mais próximo (closest hit), com a distância e as
+//     coordenadas baricêntricas
+//   - occluded: se algum triângulo corta o raio (any hit), parando no primeiro
+//   - as duas também em lote (um vetor de raios), divididas entre as threads do pool
+// A distância t de um acerto é medida em múltiplos de ray.direction: a direção não
+// precisa ser unitária, e um raio levado para o espaço do modelo com transformRay
+// devolve o mesmo t do raio em coordenadas de mundo.
+//
+// Uso:
+//   MeshBVH bvh;
+//   bvh.build(mesh); // CachedMesh, ou ponteiros de vértices e índices
+//   Ray ray = transformRay(screenRay(x, y, width, height, projection, view), glm::inverse(model));
+//   RayHit hit;
+//   if (bvh.intersect(ray, hit)) ... // hit.triangle: índices 3 * triangle a 3 * triangle + 2
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Frustum.h"
+#include "MeshCache.h"
+
+const int MESH_BVH_BINS = 16;
+const int MESH_BVH_LEAF_SIZE = 4;   // triângulos por folha (um bloco SIMD)
+const int MESH_BVH_MAX_DEPTH = 64;  // abaixo disso a divisão é pela mediana, sem SAH
+const int MESH_BVH_MIN_TASK = 1024; // triângulos mínimos de uma subárvore montada em paralelo
+
+struct Ray
+{
+	glm::vec3 origin = glm::vec3(0.0f);
+	glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+	float tMin = 0.0f;
+	float tMax = INFINITY;
+
+	Ray() {}
+	Ray(const glm::vec3& origin, const glm::vec3& direction, float tMax = INFINITY)
+		: origin(origin), direction(direction), tMax(tMax) {}
+
+	glm::vec3 at(float t) const { return this->origin + t * this->direction; }
+};
+
+struct RayHit
+{
+	float t = INFINITY;
+	int triangle = -1; // -1: nenhum acerto
+	float u = 0.0f, v = 0.0f; // ponto = (1 - u - v) * v0 + u * v1 + v * v2
+};
+
+// Raio que sai da câmera e passa pelo ponto (x, y) da janela, em pixels, com a origem
+// no canto superior esquerdo (como em glfwGetCursorPos). A origem fica no plano near.
+inline Ray screenRay(double x, double y, int width, int height, const glm::mat4& projection, const glm::mat4& view)
+{
+	glm::vec2 ndc(2.0 * x / width - 1.0, 1.0 - 2.0 * y / height);
+	glm::mat4 inverse = glm::inverse(projection * view);
+	glm::vec4 nearPoint = inverse * glm::vec4(ndc, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+	glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+	return Ray(origin, glm::normalize(glm::vec3(farPoint) / farPoint.w - origin));
+}
+
+// Raio em outro espaço (por exemplo, inverse(model) leva do mundo para o modelo). A
+// direção não é normalizada, para as distâncias t continuarem valendo nos dois espaços.
+inline Ray transformRay(const Ray& ray, const glm::mat4& transform)
+{
+	Ray result(glm::vec3(transform * glm::vec4(ray.origin, 1.0f)), glm::vec3(transform * glm::vec4(ray.direction, 0.0f)), ray.tMax);
+	result.tMin = ray.tMin;
+	return result;
+}
+
+class MeshBVH
+{
+public:
+	bool simd = true;     // false testa caixas e triângulos um a um (referência para os benchmarks)
+	double buildMs = 0.0; // tempo da última montagem
+
+	// Monta a árvore dos triângulos de indices (3 por triângulo). vertices tem
+	// floatsPerVertex floats por vértice, com a posição nos 3 primeiros. maxThreads
+	// limita as threads do pool usadas (0: todas).
+	bool build(const float* vertices, size_t floatsPerVertex, size_t nVertices, const unsigned int* indices, size_t nIndices,
+		unsigned maxThreads = 0);
+	bool build(const CachedMesh& mesh, unsigned maxThreads = 0);
+	void clear();
+
+	// Triângulo mais próximo entre ray.tMin e ray.tMax (false se nenhum)
+	bool intersect(const Ray& ray, RayHit& hit) const;
+
+	// Se algum triângulo corta o raio entre ray.tMin e ray.tMax
+	bool occluded(const Ray& ray) const;
+
+	// Consultas em lote, divididas entre as threads do pool
+	void intersect(const Ray* rays, RayHit* hits, size_t count, unsigned maxThreads = 0) const;
+	void occluded(const Ray* rays, uint8_t* results, size_t count, unsigned maxThreads = 0) const;
+
+	const AABB& bounds() const { return this->rootBounds; }
+	int nTriangles() const { return this->triangleCount; }
+	int nNodes() const { return (int)this->nodes.size(); }
+	int nLeaves() const { return (int)this->blocks.size(); }
+
+private:
+	// Nó de 4 filhos. child >= 0: outro nó; child < 0: folha com o bloco ~child.
+	// Filhos que não existem têm a caixa invertida (min > max), que nenhum raio acerta.
+	struct alignas(16) Node
+	{
+		float minX[4], minY[4], minZ[4];
+		float maxX[4], maxY[4], maxZ[4];
+		int child[4];
+	};
+
+	// Até 4 triângulos: vértice 0 e as arestas v1 - v0 e v2 - v0. Posições sem
+	// triângulo ficam com arestas nulas (determinante zero, nunca acertadas).
+	struct alignas(16) TriangleBlock
+	{
+		float v0x[4], v0y[4], v0z[4];
+		float e1x[4], e1y[4], e1z[4];
+		float e2x[4], e2y[4], e2z[4];
+		int ids[4];
+	};
+
+	std::vector<Node> nodes; // nodes[0] é a raiz
+	std::vector<TriangleBlock> blocks;
+	AABB rootBounds;
+	int triangleCount = 0;
+
+	template <bool anyHit>
+	bool traverse(const Ray& ray, RayHit& hit) const;
+};
@@ -0,0 +1,85 @@
+// Buffers de malhas no layout de OBJ_FLOATS_PER_VERTEX floats por vértice
+// setupMeshAttributes registra no VAO o VBO, o EBO e os atributos de vértice nas
+// mesmas locations dos exemplos:
+//   layout (location = 0) in vec3 position;
+//   layout (location = 1) in vec3 color;
+//   layout (location = 2) in vec2 texc;
+//   layout (location = 3) in vec3 normal;
+// loadSceneMesh carrega um .obj pelo cache (ver MeshCache.h) e envia o nível 0 para
+// um VAO novo, com as submeshes e os materiais, como nas cenas dos benchmarks.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//GLAD
+#include <glad/glad.h>
+
+#include "OBJLoader.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+
+// Deixa o VAO desligado e nenhum GL_ARRAY_BUFFER ligado ao terminar
+inline void setupMeshAttributes(GLuint VAO, GLuint VBO, GLuint EBO)
+{
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	// posição, cor, coordenada de textura e normal
+	const GLsizei stride = OBJ_FLOATS_PER_VERTEX * sizeof(GLfloat);
+	const int sizes[4] = { 3, 3, 2, 3 };
+	const int offsets[4] = { 0, 3, 6, 8 };
+	for (GLuint i = 0; i < 4; i++)
+	{
+		glVertexAttribPointer(i, sizes[i], GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offsets[i] * sizeof(GLfloat)));
+		glEnableVertexAttribArray(i);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Malha enviada uma vez e desenhada em várias posições
+struct SceneMesh
+{
+	GLuint VAO = 0;
+	GLuint VBO = 0;
+	GLuint EBO = 0;
+	std::vector<Submesh> submeshes;
+	std::vector<Material> materials; // na ordem de CachedMesh::materialNames (Submesh::material)
+	MeshBounds bounds;
+	int nTriangles = 0;
+
+	void destroy()
+	{
+		glDeleteVertexArrays(1, &this->VAO);
+		glDeleteBuffers(1, &this->VBO);
+		glDeleteBuffers(1, &this->EBO);
+		this->VAO = this->VBO = this->EBO = 0;
+	}
+};
+
+// Carrega objPath em mesh e envia vértices e índices do nível 0. mesh continua com os
+// dados da malha para quem precisar de mais do que o VAO (oclusores, GPUCulling...).
+inline bool loadSceneMesh(const std::string& objPath, CachedMesh& mesh, SceneMesh& sceneMesh, bool useCache = true)
+{
+	if (!mesh.load(objPath, useCache))
+		return false;
+
+	glGenVertexArrays(1, &sceneMesh.VAO);
+	glGenBuffers(1, &sceneMesh.VBO);
+	glGenBuffers(1, &sceneMesh.EBO);
+	glBindBuffer(GL_ARRAY_BUFFER, sceneMesh.VBO);
+	glBufferData(GL_ARRAY_BUFFER, mesh.vertexBytes(), mesh.vertexData(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(sceneMesh.VAO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sceneMesh.EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBytes(), mesh.indexData(), GL_STATIC_DRAW);
+	setupMeshAttributes(sceneMesh.VAO, sceneMesh.VBO, sceneMesh.EBO);
+
+	loadMaterials(objPath, mesh.materialLibs(), mesh.materialNames(), sceneMesh.materials);
+	sceneMesh.submeshes = mesh.submeshes();
+	sceneMesh.bounds = mesh.bounds();
+	sceneMesh.nTriangles = mesh.nIndices() / 3;
+	return true;
+}
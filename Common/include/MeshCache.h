@@ -0,0 +1,133 @@
+// Cache binário de malhas
+// Depois do primeiro carregamento de um .obj, a malha indexada e otimizada, com os
+// níveis de detalhe (ver MeshOptimizer.h), é gravada ao lado dele (modelo.obj ->
+// modelo.obj.cgmesh). Nas execuções seguintes o arquivo binário é mapeado em memória e
+// os ponteiros vão direto para o glBufferData, sem parsing.
+//
+// Layout do arquivo (little-endian):
+//   MeshCacheHeader
+//   MeshCacheSection[nSections]
+//   dados das seções, cada uma alinhada em 16 bytes
+// O cache é válido se o tamanho e a data de modificação do .obj forem os mesmos;
+// se só a data mudou, o hash do conteúdo decide (e o cabeçalho é atualizado).
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "OBJLoader.h"
+#include "MeshOptimizer.h"
+
+const uint32_t MESH_CACHE_MAGIC = 0x48534D43; // "CMSH"
+const uint32_t MESH_CACHE_VERSION = 5;
+
+// Tipos de seção conhecidos
+enum MeshCacheSectionType : uint32_t
+{
+	MESH_SECTION_VERTICES = 1,       // floats, OBJ_FLOATS_PER_VERTEX por vértice
+	MESH_SECTION_INDICES = 2,        // uint32, 3 por triângulo
+	MESH_SECTION_SUBMESHES = 3,      // Submesh, uma por material usado
+	MESH_SECTION_MATERIAL_NAMES = 4, // nomes de usemtl, cada um terminado em '\0'
+	MESH_SECTION_MATERIAL_LIBS = 5,  // nomes de mtllib, cada um terminado em '\0'
+	MESH_SECTION_LOD_INDICES = 6,    // uint32, índices dos níveis de detalhe
+	MESH_SECTION_LODS = 7            // MeshCacheLOD, uma por submesh de cada nível
+};
+
+struct MeshCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceSize;   // tamanho do .obj em bytes
+	int64_t sourceMTime;   // data de modificação do .obj (ticks do filesystem)
+	uint64_t sourceHash;   // hash do conteúdo do .obj
+	uint32_t floatsPerVertex;
+	uint32_t nSections;
+};
+
+struct MeshCacheSection
+{
+	uint32_t type;
+	uint32_t reserved;
+	uint64_t offset; // a partir do início do arquivo
+	uint64_t size;   // em bytes
+};
+
+// Registro de uma submesh de um nível de detalhe (MESH_SECTION_LODS)
+struct MeshCacheLOD
+{
+	uint32_t level; // 1, 2...
+	float error;
+	Submesh submesh;
+};
+
+// Hash de 64 bits rápido (8 bytes por passo) usado para identificar o conteúdo do .obj
+uint64_t hashBytes(const void* data, size_t size);
+
+// Tamanho e data de modificação de um arquivo de origem (validação dos caches)
+bool sourceStats(const std::string& path, uint64_t& size, int64_t& mtime);
+
+// Caminho do arquivo de cache de um .obj
+std::string meshCachePath(const std::string& objPath);
+
+// Grava o cache da malha indexada gerada a partir de objPath
+bool writeMeshCache(const std::string& objPath, const IndexedMesh& mesh);
+
+// Malha pronta para upload. Os ponteiros apontam para o arquivo de cache mapeado
+// (quando ele é válido) ou para a IndexedMesh gerada a partir do texto.
+class CachedMesh
+{
+public:
+	// Abre o cache se ele for válido; senão faz o parsing do .obj, indexa, otimiza
+	// (optimizeMesh), gera os níveis de detalhe (buildLODs) e grava o cache.
+	// Com useCache == false sempre usa o caminho de texto (e não grava nada).
+	bool load(const std::string& objPath, bool useCache = true);
+
+	// Só tenta o cache, sem cair para o parsing do texto
+	bool openCache(const std::string& objPath);
+
+	const float* vertexData() const { return this->vertices; }
+	const unsigned int* indexData() const { return this->indices; }
+	int nVertices() const { return (int)this->vertexCount; }
+	int nIndices() const { return (int)this->indexCount; }
+	size_t vertexBytes() const { return this->vertexCount * OBJ_FLOATS_PER_VERTEX * sizeof(float); }
+	size_t indexBytes() const { return this->indexCount * sizeof(unsigned int); }
+	bool fromCache() const { return this->cacheHit; }
+
+	// Faixas do buffer de índices por material e os nomes lidos do .obj
+	const std::vector<Submesh>& submeshes() const { return this->parts; }
+	const std::vector<std::string>& materialNames() const { return this->names; }
+	const std::vector<std::string>& materialLibs() const { return this->libs; }
+
+	// Caixa e esfera envolventes no espaço do modelo, calculadas no carregamento
+	const MeshBounds& bounds() const { return this->meshBounds; }
+
+	// Níveis de detalhe (ver buildLODs). Os índices deles vêm depois dos do nível 0:
+	// envie indexData() e lodIndexData() em sequência para o mesmo buffer.
+	const std::vector<MeshLOD>& lods() const { return this->levels; }
+	const unsigned int* lodIndexData() const { return this->lodIndices; }
+	int nLodIndices() const { return (int)this->lodIndexCount; }
+	size_t lodIndexBytes() const { return this->lodIndexCount * sizeof(unsigned int); }
+
+	// Seção extra do arquivo de cache (nullptr se não existir ou se a malha veio do texto)
+	const void* section(uint32_t type, uint64_t* size = nullptr) const;
+
+private:
+	void setFromMesh();
+
+	MappedFile cacheFile;
+	IndexedMesh mesh;
+	const float* vertices = nullptr;
+	const unsigned int* indices = nullptr;
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	bool cacheHit = false;
+	std::vector<Submesh> parts;
+	std::vector<std::string> names;
+	std::vector<std::string> libs;
+	std::vector<MeshLOD> levels;
+	const unsigned int* lodIndices = nullptr;
+	size_t lodIndexCount = 0;
+	MeshBounds meshBounds;
+};
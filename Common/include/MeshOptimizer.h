@@ -0,0 +1,117 @@
+// Otimização da ordem de triângulos e vértices de uma malha indexada
+// A ordem das faces no .obj é arbitrária para a GPU. Depois da indexação, três passos
+// reordenam a malha sem mudar a geometria desenhada:
+//   1. cache de vértices: triângulos em ordem Tipsify (Sander, Nehab e Barczak 2007),
+//      para que o vertex shader reaproveite vértices já transformados
+//   2. overdraw: os trechos gerados pelo Tipsify são reordenados de fora para dentro
+//      (quem tende a ocultar os outros é desenhado antes), perdendo no máximo
+//      OVERDRAW_THRESHOLD no ACMR do passo 1
+//   3. busca de vértices: o buffer de vértices segue a ordem do primeiro uso nos
+//      índices, para leituras de memória sequenciais
+// Os passos 1 e 2 atuam dentro de cada Submesh; as faixas por material não mudam.
+//
+// Níveis de detalhe (buildLODs): cada nível é gerado por colapsos de aresta guiados
+// por quádricas de erro (Garland e Heckbert 1997). O vértice que some é trocado por
+// um vizinho que já existe, então todos os níveis usam o mesmo buffer de vértices.
+// Costuras de UV e quinas de normal são preservadas: um colapso só é aceito se cada
+// variação (uv, normal) do vértice removido tiver a variação correspondente no
+// vértice que fica, e bordas, costuras e divisas entre materiais recebem planos
+// extras na quádrica. Em tempo de execução, selectLOD escolhe o nível pelo tamanho
+// da esfera envolvente projetada na tela (projectedSphereRadius).
+//
+// Também há simuladores em CPU para medir o resultado:
+//   ACMR: vértices transformados por triângulo (cache FIFO de VERTEX_CACHE_SIZE)
+//   ATVR: vértices transformados por vértice único (1.0 é o ideal)
+//   overdraw: fragmentos sombreados por pixel coberto, rasterizando a malha em seis
+//             vistas ortográficas com teste de profundidade (early-z)
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "OBJLoader.h"
+
+// Tamanho do cache pós-transformação suposto pela otimização e pelo simulador
+const int VERTEX_CACHE_SIZE = 16;
+
+// Perda máxima de ACMR aceita ao reordenar para overdraw (1.05 = 5%)
+const float OVERDRAW_THRESHOLD = 1.05f;
+
+// Níveis gerados além do original, cada um com metade dos triângulos do anterior
+const int MAX_MESH_LODS = 4;
+
+// Erro de simplificação tolerado na tela, em pixels, ao escolher o nível
+const float LOD_PIXEL_ERROR = 1.0f;
+
+// Reordena os triângulos de indices (nIndices múltiplo de 3) para o cache de vértices
+void optimizeVertexCache(unsigned int* indices, size_t nIndices, size_t nVertices, int cacheSize = VERTEX_CACHE_SIZE);
+
+// Reordena trechos de triângulos já otimizados para o cache, reduzindo o overdraw.
+// vertices tem OBJ_FLOATS_PER_VERTEX floats por vértice (posição nos 3 primeiros).
+void optimizeOverdraw(unsigned int* indices, size_t nIndices, const float* vertices, size_t nVertices,
+	float threshold = OVERDRAW_THRESHOLD, int cacheSize = VERTEX_CACHE_SIZE);
+
+// Reordena mesh.vertices na ordem do primeiro uso em mesh.indices e reescreve os
+// índices. Vértices não usados vão para o final.
+void optimizeVertexFetch(IndexedMesh& mesh);
+
+// Os três passos acima, cada submesh separadamente
+void optimizeMesh(IndexedMesh& mesh);
+
+struct VertexCacheStats
+{
+	double acmr = 0.0;
+	double atvr = 0.0;
+};
+
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t nIndices, size_t nVertices,
+	int cacheSize = VERTEX_CACHE_SIZE);
+
+struct OverdrawStats
+{
+	size_t pixelsCovered = 0;
+	size_t pixelsShaded = 0;
+	double overdraw = 0.0; // shaded / covered
+};
+
+// Soma das seis vistas (±x, ±y, ±z) com resolution x resolution pixels cada
+OverdrawStats analyzeOverdraw(const unsigned int* indices, size_t nIndices, const float* vertices, size_t nVertices,
+	int resolution = 256);
+
+// Simplifica os triângulos de indices até targetCount índices ou até o erro passar de
+// maxError (distância nas unidades do modelo). Só usa vértices já existentes.
+// resultError recebe o erro atingido.
+std::vector<unsigned int> simplifyMesh(const unsigned int* indices, size_t nIndices, const float* vertices, size_t nVertices,
+	size_t targetCount, float maxError, float* resultError = nullptr);
+
+// Gera até maxLevels níveis de detalhe em mesh.lods / mesh.lodIndices. Cada nível e
+// cada submesh é simplificado em uma tarefa do ThreadPool global, a partir da malha
+// original. Para quando um nível não consegue reduzir a malha de forma significativa.
+void buildLODs(IndexedMesh& mesh, int maxLevels = MAX_MESH_LODS);
+
+// Caixa alinhada aos eixos e esfera envolvente de uma malha, no espaço do modelo
+struct MeshBounds
+{
+	glm::vec3 min = glm::vec3(0.0f);
+	glm::vec3 max = glm::vec3(0.0f);
+	glm::vec4 sphere = glm::vec4(0.0f); // centro em xyz, raio em w
+};
+
+// Caixa e esfera dos vértices (a esfera é centrada na caixa)
+MeshBounds computeMeshBounds(const float* vertices, size_t nVertices);
+
+// Esfera envolvente (centro em xyz, raio em w) dos vértices
+glm::vec4 computeBoundingSphere(const float* vertices, size_t nVertices);
+
+// Raio em pixels de uma esfera (em coordenadas de mundo) vista pela câmera; infinito
+// se a câmera estiver dentro dela
+float projectedSphereRadius(const glm::vec3& center, float radius, const glm::mat4& view,
+	const glm::mat4& projection, float viewportHeight);
+
+// Nível mais simples cujo erro projetado (MeshLOD::error * screenRadius) não passa de
+// pixelError. Devolve 0 para a malha completa, i + 1 para lods[i].
+int selectLOD(const std::vector<MeshLOD>& lods, float screenRadius, float pixelError = LOD_PIXEL_ERROR);
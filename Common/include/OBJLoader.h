@@ -0,0 +1,170 @@
+// Leitor de arquivos OBJ compartilhado pelos exemplos
+// O arquivo é mapeado em memória (mmap / MapViewOfFile) e interpretado no lugar,
+// com um scanner próprio de floats e inteiros: nenhuma string ou istringstream
+// é criada por linha, como acontecia no loadSimpleOBJ original.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+//GLM
+#include <glm/glm.hpp>
+
+// Quantidade de floats por vértice no buffer intercalado gerado pelo leitor:
+// posição (3), cor (3), coordenada de textura (2) e normal (3)
+const int OBJ_FLOATS_PER_VERTEX = 11;
+
+// Arquivo somente leitura mapeado em memória
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const std::string& filePath);
+	void close();
+
+	const char* data() const { return this->ptr; }
+	size_t size() const { return this->length; }
+	bool isOpen() const { return this->opened; }
+
+private:
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* ptr;
+	size_t length;
+	bool opened; // arquivos vazios ficam abertos sem mapeamento
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fd;
+#endif
+};
+
+// Trecho de triângulos que usa um material (registro usemtl)
+struct OBJMaterialRun
+{
+	int material;         // índice em OBJData::materialNames
+	size_t firstTriangle; // vale até o início do próximo trecho
+};
+
+// Resultado do parsing de um OBJ
+struct OBJData
+{
+	std::vector<glm::vec3> vertices;  // registros v
+	std::vector<glm::vec2> texCoords; // registros vt
+	std::vector<glm::vec3> normals;   // registros vn
+	std::vector<float> vBuffer;       // OBJ_FLOATS_PER_VERTEX floats por canto de triângulo
+	std::vector<glm::ivec3> corners;  // índices (v, vt, vn) 0-based de cada canto; -1 se ausente
+	size_t nFaces = 0;                // faces lidas (antes da triangulação)
+	std::vector<std::string> materialLibs;   // registros mtllib, na ordem do arquivo
+	std::vector<std::string> materialNames;  // nomes distintos de usemtl, na ordem da primeira ocorrência
+	std::vector<OBJMaterialRun> materialRuns; // triângulos antes do primeiro trecho não têm material
+
+	int nVertices() const { return (int)(vBuffer.size() / OBJ_FLOATS_PER_VERTEX); }
+	int nTriangles() const { return (int)(corners.size() / 3); }
+};
+
+// Faixa contígua do buffer de índices desenhada com um único material
+struct Submesh
+{
+	int material;             // índice em materialNames (-1: sem material)
+	unsigned int firstIndex;
+	unsigned int indexCount;
+};
+
+// Nível de detalhe simplificado (ver buildLODs em MeshOptimizer.h). Usa os mesmos
+// vértices da malha; os índices ficam em IndexedMesh::lodIndices, numerados como se
+// viessem logo depois de IndexedMesh::indices no mesmo buffer de índices.
+struct MeshLOD
+{
+	float error;                    // distância à malha original, relativa ao raio da esfera envolvente
+	unsigned int firstIndex;        // faixa do nível inteiro (todas as submeshes)
+	unsigned int indexCount;
+	std::vector<Submesh> submeshes; // mesmos materiais das submeshes do nível 0
+};
+
+// Geometria indexada: vértices únicos (mesmo layout de OBJ_FLOATS_PER_VERTEX floats)
+// e um índice por canto de triângulo, para desenhar com glDrawElements
+struct IndexedMesh
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	std::vector<Submesh> submeshes;          // os triângulos ficam agrupados por material
+	std::vector<std::string> materialNames;
+	std::vector<std::string> materialLibs;
+	std::vector<unsigned int> lodIndices;    // índices dos níveis de detalhe 1, 2...
+	std::vector<MeshLOD> lods;               // o nível 0 (a malha completa) não entra aqui
+
+	int nVertices() const { return (int)(vertices.size() / OBJ_FLOATS_PER_VERTEX); }
+	int nIndices() const { return (int)indices.size(); }
+	size_t sizeInBytes() const { return vertices.size() * sizeof(float) + (indices.size() + lodIndices.size()) * sizeof(unsigned int); }
+};
+
+// Faz o parsing de um bloco de texto OBJ já em memória.
+// Aceita faces nas formas v, v/vt, v//vn e v/vt/vn (componentes ausentes ficam -1 em
+// corners e zerados em vBuffer). Polígonos com mais de 3 vértices são triangulados em leque.
+bool parseOBJ(const char* begin, const char* end, OBJData& out,
+	glm::vec3 color = glm::vec3(1.0, 0.0, 0.0));
+
+// Versão paralela de parseOBJ: o texto é dividido em blocos nas quebras de linha,
+// cada bloco é lido em uma thread do pool e os resultados são unidos com somas de
+// prefixo, de modo que o buffer gerado é idêntico ao da versão sequencial.
+// nThreads == 0 usa todas as threads do pool global.
+bool parseOBJParallel(const char* begin, const char* end, OBJData& out, unsigned nThreads,
+	glm::vec3 color = glm::vec3(1.0, 0.0, 0.0));
+
+// Gera a geometria indexada: cada trinca (v, vt, vn) distinta vira um único vértice.
+// A ordem dos vértices segue a primeira ocorrência de cada trinca nas faces.
+// Os triângulos são reagrupados por material (mantendo a ordem dentro de cada um),
+// gerando uma Submesh por material usado.
+void buildIndexedMesh(const OBJData& data, IndexedMesh& mesh);
+
+// Ângulo, em graus, a partir do qual duas faces vizinhas deixam de suavizar a normal
+// uma da outra (quina dura) em generateNormals
+const float OBJ_CREASE_ANGLE = 60.0f;
+
+// Calcula normais suaves para os cantos de triângulo sem vn (faces "v" ou "v/vt").
+// A normal de um canto soma as normais das faces que tocam a mesma posição e formam
+// com a face dele um ângulo menor que creaseAngle, pesadas pela área e pelo ângulo
+// de cada face naquele vértice. Cantos de uma posição com o mesmo resultado recebem
+// a mesma normal em data.normals; data.corners e data.vBuffer são atualizados.
+// As faces são processadas em paralelo no pool global (nThreads == 0: todas as threads).
+// Devolve a quantidade de cantos que receberam normal.
+size_t generateNormals(OBJData& data, float creaseAngle = OBJ_CREASE_ANGLE, unsigned nThreads = 0);
+
+// Mapeia o arquivo e faz o parsing. Retorna false se o arquivo não puder ser aberto.
+// Com nThreads != 1 usa parseOBJParallel. Cantos sem normal recebem normais
+// suaves (generateNormals) com as mesmas threads.
+bool loadOBJ(const std::string& filePath, OBJData& out, unsigned nThreads = 1,
+	glm::vec3 color = glm::vec3(1.0, 0.0, 0.0));
+
+// ----------------------------------------------------------------------------
+// Materiais (.mtl)
+// ----------------------------------------------------------------------------
+
+// Material no modelo de iluminação de Phong, como descrito no .mtl
+struct Material
+{
+	std::string name;
+	glm::vec3 ka = glm::vec3(1.0f); // Ka: refletância ambiente
+	glm::vec3 kd = glm::vec3(0.8f); // Kd: refletância difusa
+	glm::vec3 ks = glm::vec3(0.0f); // Ks: refletância especular
+	float ns = 10.0f;               // Ns: expoente especular (q no phong.fs)
+	float d = 1.0f;                 // d (ou 1 - Tr): opacidade
+	std::string mapKd;              // map_Kd, resolvido para um caminho existente (vazio se não houver)
+};
+
+// Lê todos os materiais de um .mtl (acrescentando em out). Caminhos de map_Kd são
+// procurados como escritos, depois pelo nome do arquivo na pasta do .mtl e nas
+// subpastas dela (exportadores costumam gravar caminhos absolutos de outra máquina).
+bool loadMTL(const std::string& mtlPath, std::vector<Material>& out);
+
+// Materiais na mesma ordem de names, lidos das bibliotecas libs (relativas à pasta
+// do .obj). Nomes não encontrados recebem um Material padrão com o mesmo nome.
+void loadMaterials(const std::string& objPath, const std::vector<std::string>& libs,
+	const std::vector<std::string>& names, std::vector<Material>& out);
@@ -0,0 +1,123 @@
+// Oclusão na CPU: objetos escondidos atrás de outros não são enviados à GPU
+// Os oclusores (versões simplificadas das malhas grandes, ver OccluderMesh) são
+// rasterizados só em profundidade em um buffer pequeno (OCCLUSION_WIDTH x
+// OCCLUSION_HEIGHT). Depois, a caixa envolvente de cada objeto é projetada e comparada
+// com a profundidade mais distante do retângulo que ela cobre na tela: se até o canto
+// mais próximo da caixa está atrás de tudo o que foi desenhado ali, o objeto está
+// oculto. O resultado é uma máscara por objeto que vai para DrawList::submit.
+//
+// Rasterização:
+//   1. transformação: os triângulos dos oclusores vão para o espaço de recorte, são
+//      recortados no plano near e guardados em coordenadas de tela (um oclusor por
+//      item do parallelFor)
+//   2. distribuição: cada triângulo entra na lista dos blocos (tiles) de
+//      OCCLUSION_TILE_WIDTH x OCCLUSION_TILE_HEIGHT que a sua caixa toca
+//   3. rasterização: um bloco por item do parallelFor, cada um escrevendo só na sua
+//      parte do buffer. Funções de aresta avaliadas em 8 pixels por instrução com AVX2
+//      (escolhido em tempo de execução se a CPU tiver), 4 com SSE2 ou 1 a 1
+//   4. Hi-Z: pirâmide com a profundidade máxima de cada 2 x 2 pixels do nível anterior
+// O teste de uma caixa lê no máximo 4 x 4 valores do nível da pirâmide em que o
+// retângulo dela cabe.
+//
+// Profundidade: z / w da OpenGL levado para [0, 1] (0 no near, 1 no far), com a linha
+// 0 embaixo, como no framebuffer. Oclusores não são descartados pela orientação
+// (malhas abertas também escondem o que está atrás delas).
+//
+// Uso, a cada frame:
+//   occlusion.begin(projection * view);
+//   occlusion.addOccluder(deskOccluder, model); // OccluderMesh montada uma vez por malha
+//   occlusion.rasterize();
+//   visible[i] = !occlusion.isOccluded(transformBounds(bounds, model));
+//   drawList.submit(visible.data()); // itens com item.object = i
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Frustum.h"
+#include "MeshCache.h"
+
+const int OCCLUSION_WIDTH = 256;
+const int OCCLUSION_HEIGHT = 128;
+const int OCCLUSION_TILE_WIDTH = 64; // múltiplo de 8 (um grupo AVX2)
+const int OCCLUSION_TILE_HEIGHT = 32;
+const float OCCLUDER_MAX_ERROR = 0.02f; // erro do nível de detalhe usado como oclusor, relativo ao raio
+
+// Geometria de um oclusor: só posições, com os vértices usados pelo nível escolhido
+struct OccluderMesh
+{
+	std::vector<glm::vec3> positions;
+	std::vector<unsigned int> indices;
+
+	// Usa o nível de detalhe mais simples com erro até maxError (ver buildLODs)
+	bool build(const CachedMesh& mesh, float maxError = OCCLUDER_MAX_ERROR);
+	int nTriangles() const { return (int)this->indices.size() / 3; }
+};
+
+// Tempos (ms) e contagens do último rasterize e dos testes feitos depois dele
+struct OcclusionStats
+{
+	int occluders = 0;
+	int triangles = 0;       // triângulos dos oclusores
+	int trianglesBinned = 0; // depois do recorte e do descarte fora da tela
+	double setupMs = 0.0;    // transformação, recorte e distribuição nos blocos
+	double rasterMs = 0.0;
+	double hizMs = 0.0;
+	int tested = 0;
+	int occluded = 0;
+};
+
+class OcclusionBuffer
+{
+public:
+	bool simd = true;       // false: rasterização pixel a pixel (referência)
+	bool useAVX2 = true;    // false: SSE2 mesmo se a CPU tiver AVX2
+	unsigned maxThreads = 0; // threads do pool usadas (0: todas)
+
+	OcclusionBuffer();
+
+	// Limpa o buffer e guarda a matriz da câmera do frame
+	void begin(const glm::mat4& viewProjection);
+
+	// O oclusor precisa continuar existindo até rasterize()
+	void addOccluder(const OccluderMesh& mesh, const glm::mat4& model);
+
+	// Rasteriza os oclusores acrescentados desde begin() e monta a pirâmide Hi-Z
+	void rasterize();
+
+	// true se a caixa (em coordenadas de mundo) com certeza está atrás dos oclusores.
+	// Caixas que cruzam o plano near ou ficam fora da tela nunca são ocultas (o
+	// frustum culling cuida das de fora).
+	bool isOccluded(const AABB& box);
+
+	// Profundidade rasterizada (nível 0), OCCLUSION_WIDTH x OCCLUSION_HEIGHT
+	const float* depth() const { return this->levels[0].data(); }
+	const OcclusionStats& stats() const { return this->lastStats; }
+	const char* kernelName() const;
+	static bool cpuHasAVX2();
+
+private:
+	struct Occluder
+	{
+		const OccluderMesh* mesh;
+		glm::mat4 transform; // viewProjection * model
+	};
+
+	// Triângulo em coordenadas de tela (pixels) com a profundidade em [0, 1]
+	struct ScreenTriangle
+	{
+		glm::vec3 v[3];
+	};
+
+	glm::mat4 viewProjection;
+	std::vector<Occluder> occluders;
+	std::vector<std::vector<ScreenTriangle>> triangles; // por oclusor
+	std::vector<std::vector<glm::ivec2>> bins;          // por bloco: (oclusor, triângulo)
+	std::vector<std::vector<float>> levels;             // pirâmide Hi-Z; levels[0] é o buffer
+	std::vector<glm::ivec2> levelSizes;
+	OcclusionStats lastStats;
+};
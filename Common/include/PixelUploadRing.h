@@ -0,0 +1,155 @@
+// Anel de Pixel Buffer Objects para enviar texturas sem cópia síncrona no driver
+// Um glTexSubImage2D com ponteiro para a memória do programa obriga o driver a copiar os
+// pixels antes de retornar. Com um GL_PIXEL_UNPACK_BUFFER mapeado persistentemente
+// (glBufferStorage com GL_MAP_PERSISTENT_BIT), o programa escreve os pixels direto na
+// memória do buffer e o glTexSubImage2D só registra a cópia, feita pela GPU depois.
+//
+// O buffer é usado como um anel: cada allocate() pega o próximo pedaço livre, e
+// endFrame() coloca um fence (glFenceSync) atrás dos pedaços do frame. Um pedaço só é
+// reaproveitado quando o fence dele sinaliza, ou seja, quando a GPU terminou de ler.
+// Com capacidade para uns 3 frames de envio, o programa nunca espera pela GPU.
+//
+// Uso (na thread do contexto):
+//   PixelUploadRing ring;
+//   ring.create(12 * 1024 * 1024);
+//   size_t offset;
+//   if (unsigned char* dst = ring.allocate(bytes, offset)) {
+//       memcpy(dst, pixels, bytes);
+//       glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring.PBO);
+//       glTexSubImage2D(..., (const void*)offset);  // offset no lugar do ponteiro
+//   }
+//   ring.endFrame();                                // uma vez por frame
+//   ring.destroy();
+
+#pragma once
+
+#include <deque>
+#include <cstddef>
+#include <cstdint>
+
+//GLAD
+#include <glad/glad.h>
+
+#include "GLExtensions.h"
+
+class PixelUploadRing
+{
+public:
+	GLuint PBO = 0;
+
+	bool valid() const { return this->mapped != nullptr; }
+	size_t capacity() const { return this->size; }
+
+	// Precisa de glExtensions().bufferStorage; devolve false se o buffer não puder ser mapeado
+	bool create(size_t capacity)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &this->PBO);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, this->PBO);
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)capacity, nullptr, flags);
+		this->mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)capacity, flags);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		if (!this->mapped)
+		{
+			destroy();
+			return false;
+		}
+		this->size = capacity;
+		this->head = this->used = this->frameBytes = 0;
+		return true;
+	}
+
+	// Reserva bytes contíguos (alinhados em 16) e devolve o ponteiro para escrever, com o
+	// offset a passar no lugar do ponteiro de dados. Se o anel estiver cheio devolve
+	// nullptr, ou, com wait, espera a GPU liberar os pedaços mais antigos.
+	unsigned char* allocate(size_t bytes, size_t& offset, bool wait = false)
+	{
+		bytes = (bytes + 15) & ~(size_t)15;
+		if (!this->mapped || bytes > this->size)
+			return nullptr;
+		retire(false);
+		while (!fits(bytes))
+		{
+			if (!wait)
+				return nullptr;
+			if (this->frameBytes > 0)
+				endFrame();
+			if (this->inFlight.empty())
+				return nullptr;
+			retire(true);
+		}
+		size_t padding = 0;
+		if (this->head + bytes > this->size)
+		{
+			padding = this->size - this->head; // pode ser 0 se head estiver no fim
+			this->head = 0;
+		}
+		offset = this->head;
+		this->head += bytes;
+		this->used += padding + bytes;
+		this->frameBytes += padding + bytes;
+		return this->mapped + offset;
+	}
+
+	// Protege com um fence tudo o que foi reservado desde o último endFrame
+	void endFrame()
+	{
+		if (this->frameBytes == 0)
+			return;
+		this->inFlight.push_back(Pending{ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), this->frameBytes });
+		this->frameBytes = 0;
+	}
+
+	void destroy()
+	{
+		for (const Pending& pending : this->inFlight)
+			glDeleteSync(pending.fence);
+		this->inFlight.clear();
+		if (this->mapped)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, this->PBO);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &this->PBO);
+		this->PBO = 0;
+		this->mapped = nullptr;
+		this->size = this->head = this->used = this->frameBytes = 0;
+	}
+
+private:
+	struct Pending
+	{
+		GLsync fence;
+		size_t bytes; // do anel, incluindo o espaço pulado ao dar a volta
+	};
+
+	unsigned char* mapped = nullptr;
+	size_t size = 0;
+	size_t head = 0;       // próximo byte livre
+	size_t used = 0;       // bytes entre o pedaço mais antigo ainda em uso e head
+	size_t frameBytes = 0; // reservados desde o último endFrame
+	std::deque<Pending> inFlight;
+
+	bool fits(size_t bytes) const
+	{
+		size_t padding = this->head + bytes > this->size ? this->size - this->head : 0;
+		return this->used + padding + bytes <= this->size;
+	}
+
+	// Libera os pedaços cujo fence já sinalizou (com block, espera pelo mais antigo)
+	void retire(bool block)
+	{
+		while (!this->inFlight.empty())
+		{
+			Pending& oldest = this->inFlight.front();
+			GLenum status = glClientWaitSync(oldest.fence, block ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, block ? 1000000000ull : 0);
+			if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+				return;
+			glDeleteSync(oldest.fence);
+			this->used -= oldest.bytes;
+			this->inFlight.pop_front();
+			block = false;
+		}
+	}
+};
@@ -0,0 +1,178 @@
+// Fila de desenho com chaves de ordenação de 64 bits
+// Cada desenho do frame vira um RenderPacket (programa, VAO, material, primitiva e
+// faixa de vértices ou índices, matriz de modelo opcional) gravado com push, em
+// qualquer ordem. sort monta uma chave por pacote e ordena as chaves com um radix sort
+// (LSD, 8 bits por passada, pulando as passadas em que todas as chaves têm o mesmo
+// byte); submit percorre a ordem resultante e só envia à OpenGL o que mudou em relação
+// ao pacote anterior.
+//
+// Chave, do bit mais alto para o mais baixo:
+//   passe     4 bits   ordem de desenho explícita (fundo, cena, sobreposição...)
+//   programa 12 bits   posição do programa na fila (ordem do primeiro uso)
+//   material 16 bits   índice de addMaterial (textura e cor)
+//   VAO      12 bits   posição do VAO na fila (ordem do primeiro uso)
+//   profund. 20 bits   [0, 1] quantizada; de trás para a frente nos passes marcados
+//                      com setBackToFront
+// Dentro de um passe, o programa pesa mais que o material e o material mais que o VAO,
+// como em DrawList::sort. Pacotes com a mesma chave mantêm a ordem do push (o radix sort
+// é estável). Mais de 4096 programas ou VAOs (ou 65536 materiais) só repetem posições na
+// chave: a ordem piora, mas submit compara o estado de verdade e o desenho continua certo.
+//
+// O material é uma textura (ligada em GL_TEXTURE_2D na unidade ativa; 0 desliga), uma
+// cor enviada ao uniform colorUniform e a largura das linhas e o tamanho dos pontos.
+// As posições dos uniforms colorUniform e modelUniform são lidas uma vez por programa,
+// quando ele aparece na fila, e o último valor enviado a cada programa fica guardado
+// durante o submit: a cor e a matriz só são reenviadas quando mudam.
+//
+// RenderQueueStats conta as trocas feitas e as evitadas em relação a ligar tudo a cada
+// desenho (como faziam drawGrid, drawAxesVAO e drawTriangle de HelloCurves-Movement.cpp)
+// e quantas trocas a ordem do push teria feito sem a ordenação.
+//
+// Uso, a cada frame:
+//   int gray = queue.addMaterial(glm::vec4(0.5f, 0.5f, 0.5f, 1.0f)); // uma vez
+//   queue.begin();
+//   queue.drawElements(PASS_GRID, &shader, grid.VAO, gray, GL_LINES, 0, nIndices);
+//   queue.drawArrays(PASS_OVERLAY, &shaderTri, VAO, blue, GL_TRIANGLES, 0, 3, &model);
+//   queue.sort();
+//   RenderQueueStats stats = queue.submit();
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+
+const int RENDER_QUEUE_PASS_BITS = 4;
+const int RENDER_QUEUE_PROGRAM_BITS = 12;
+const int RENDER_QUEUE_MATERIAL_BITS = 16;
+const int RENDER_QUEUE_VAO_BITS = 12;
+const int RENDER_QUEUE_DEPTH_BITS = 20;
+const int RENDER_QUEUE_MAX_PASSES = 1 << RENDER_QUEUE_PASS_BITS;
+
+static_assert(RENDER_QUEUE_PASS_BITS + RENDER_QUEUE_PROGRAM_BITS + RENDER_QUEUE_MATERIAL_BITS
+	+ RENDER_QUEUE_VAO_BITS + RENDER_QUEUE_DEPTH_BITS == 64, "a chave deve ocupar os 64 bits");
+
+struct RenderMaterial
+{
+	glm::vec4 color;
+	GLuint texture;
+	float lineWidth; // 0: mantém a largura atual
+	float pointSize; // 0: mantém o tamanho atual
+};
+
+struct RenderPacket
+{
+	int pass = 0;             // 0 a RENDER_QUEUE_MAX_PASSES - 1
+	Shader* shader = nullptr;
+	GLuint VAO = 0;
+	int material = -1;        // índice de addMaterial (-1: não mexe na textura nem na cor)
+	GLenum mode = GL_TRIANGLES;
+	GLint first = 0;          // primeiro vértice, ou primeiro índice com indexed
+	GLsizei count = 0;
+	bool indexed = false;     // glDrawElements com índices GL_UNSIGNED_INT do EBO do VAO
+	float depth = 0.0f;       // [0, 1], só para a ordem dentro do passe
+	bool hasModel = false;
+	glm::mat4 model = glm::mat4(1.0f);
+};
+
+// Contagem de um submit. As trocas evitadas são em relação a um desenho que liga o
+// programa, a textura e o VAO a cada pacote; as "na ordem do push" são as que a fila
+// faria sem sort, só pulando o estado repetido.
+struct RenderQueueStats
+{
+	int packets = 0;
+	int programChanges = 0;
+	int textureChanges = 0;
+	int vaoChanges = 0;
+	int uniformUploads = 0;   // glUniform de cor e matriz enviados
+	int programChangesInOrder = 0;
+	int textureChangesInOrder = 0;
+	int vaoChangesInOrder = 0;
+	double sortMs = 0.0;      // tempo do último sort
+
+	int programChangesAvoided() const { return this->packets - this->programChanges; }
+	int textureChangesAvoided() const { return this->packets - this->textureChanges; }
+	int vaoChangesAvoided() const { return this->packets - this->vaoChanges; }
+};
+
+class RenderQueue
+{
+public:
+	const char* colorUniform = "finalColor";
+	const char* modelUniform = "model";
+
+	// Registra um material e devolve o índice usado nos pacotes (os materiais valem
+	// para todos os frames)
+	int addMaterial(const glm::vec4& color, GLuint texture = 0, float lineWidth = 0.0f, float pointSize = 0.0f);
+	const RenderMaterial& material(int index) const { return this->materials[index]; }
+
+	// Passes desenhados de trás para a frente (transparência); os demais vão da frente
+	// para trás
+	void setBackToFront(int pass, bool backToFront);
+
+	// Descarta os pacotes do frame anterior (os buffers continuam alocados)
+	void begin();
+
+	void push(const RenderPacket& packet);
+	void drawArrays(int pass, Shader* shader, GLuint VAO, int material, GLenum mode, GLint first, GLsizei count,
+		const glm::mat4* model = nullptr, float depth = 0.0f);
+	void drawElements(int pass, Shader* shader, GLuint VAO, int material, GLenum mode, GLint firstIndex, GLsizei count,
+		const glm::mat4* model = nullptr, float depth = 0.0f);
+
+	// Monta as chaves e ordena. Sem sort, submit desenha na ordem do push.
+	void sort();
+
+	// Desenha os pacotes do frame e devolve as trocas de estado. Os pacotes continuam
+	// na fila até o próximo begin (podem ser desenhados de novo).
+	RenderQueueStats submit();
+
+	int nPackets() const { return (int)this->packets.size(); }
+	// Pacote e chave na posição sortedIndex da ordem do último sort
+	uint64_t key(int sortedIndex) const { return this->keys[sortedIndex].key; }
+	const RenderPacket& packet(int sortedIndex) const { return this->packets[this->keys[sortedIndex].packet]; }
+
+	// Esquece os programas e VAOs vistos (depois de apagar algum deles)
+	void clearSlots();
+
+private:
+	struct SortEntry
+	{
+		uint64_t key;
+		uint32_t packet;
+	};
+
+	// Estado de um programa: posições dos uniforms e último valor enviado
+	struct ProgramSlot
+	{
+		GLuint program;
+		GLint colorLocation;
+		GLint modelLocation;
+		bool colorSent;
+		bool modelSent;
+		glm::vec4 color;
+		glm::mat4 model;
+	};
+
+	std::vector<RenderMaterial> materials;
+	std::vector<RenderPacket> packets;
+	std::vector<SortEntry> keys, scratch;
+	std::vector<ProgramSlot> programs;
+	std::vector<int> packetProgram, packetVAO; // posições do programa e do VAO de cada pacote
+	std::unordered_map<GLuint, int> programIndex, vaoIndex;
+	uint16_t backToFront = 0;                  // um bit por passe
+	bool sorted = false;
+	double sortMs = 0.0;
+
+	int programSlot(Shader* shader);
+	int vaoSlot(GLuint VAO);
+	uint64_t makeKey(const RenderPacket& packet, int program, int vao) const;
+	void radixSort();
+};
@@ -0,0 +1,107 @@
+// Hierarquia de volumes envolventes (BVH) dos objetos da cena, para frustum culling
+// Cada objeto entra com a sua caixa em coordenadas de mundo (ver transformBounds em
+// Frustum.h) e recebe um id. A árvore é montada com SAH em caixas (bins) sobre os
+// centros das caixas, com até SCENE_BVH_LEAF_SIZE objetos por folha. As folhas guardam
+// as caixas em estrutura de arrays (todos os min.x juntos, todos os min.y...), para o
+// teste contra os planos do frustum sair com 8 caixas por instrução AVX (ou 2 x 4 com
+// SSE2).
+//
+// A árvore é dinâmica:
+//   - update() troca a caixa de um objeto que se moveu; no próximo cull as caixas dos
+//     nós são recalculadas de baixo para cima (refit), sem mudar a estrutura
+//   - insert() e remove() marcam a estrutura para ser remontada no próximo cull; o
+//     refit também remonta a árvore quando as caixas dos nós já cresceram demais
+//     (SCENE_BVH_REBUILD_RATIO), e rebuild() remonta na hora
+//
+// Na descida, os planos dos quais um nó fica inteiro do lado de dentro não são testados
+// nos filhos, e um nó inteiro dentro do frustum aceita todas as folhas sem teste.
+//
+// Uso:
+//   SceneBVH bvh;
+//   int id = bvh.insert(transformBounds(mesh.bounds(), model));
+//   bvh.update(id, transformBounds(mesh.bounds(), newModel)); // quando o objeto se mover
+//   std::vector<int> visible;
+//   bvh.cull(Frustum(projection * view), visible);            // ids dos objetos a desenhar
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "Frustum.h"
+
+const int SCENE_BVH_LEAF_SIZE = 8;
+const int SCENE_BVH_BINS = 16;
+const float SCENE_BVH_REBUILD_RATIO = 1.5f; // soma das áreas dos nós depois do refit / depois da montagem
+
+// Contagem do último cull
+struct CullStats
+{
+	int nodesVisited = 0;
+	int leavesTested = 0;   // folhas testadas caixa a caixa
+	int leavesAccepted = 0; // folhas aceitas sem teste (nó inteiro dentro do frustum)
+	int visible = 0;
+	int culled = 0;         // objetos (drawcalls) descartados
+};
+
+class SceneBVH
+{
+public:
+	bool simd = true; // false testa as caixas das folhas uma a uma (referência para os benchmarks)
+
+	// Devolve o id do objeto (ids de objetos removidos são reaproveitados)
+	int insert(const AABB& bounds);
+	void update(int id, const AABB& bounds);
+	void remove(int id);
+	void clear();
+
+	const AABB& bounds(int id) const { return this->objectBounds[id]; }
+	int size() const { return this->nAlive; }
+	int nNodes() const { return (int)this->nodes.size(); }
+	int nLeaves() const { return (int)this->leaves.size(); }
+	int nRebuilds() const { return this->rebuilds; }
+
+	// Monta a árvore de novo a partir das caixas atuais
+	void rebuild();
+
+	// Recalcula as caixas dos nós depois de update() (remonta se elas cresceram demais)
+	void refit();
+
+	// Ids dos objetos cuja caixa não está inteira fora do frustum. Faz antes o rebuild ou
+	// o refit pendente.
+	void cull(const Frustum& frustum, std::vector<int>& visible, CullStats* stats = nullptr);
+
+private:
+	struct Node
+	{
+		AABB box;
+		int left = -1, right = -1; // filhos (-1 nas folhas)
+		int firstLeaf = 0;         // folhas da subárvore: [firstLeaf, firstLeaf + leafCount)
+		int leafCount = 0;
+	};
+
+	struct alignas(32) Leaf
+	{
+		float minX[SCENE_BVH_LEAF_SIZE], minY[SCENE_BVH_LEAF_SIZE], minZ[SCENE_BVH_LEAF_SIZE];
+		float maxX[SCENE_BVH_LEAF_SIZE], maxY[SCENE_BVH_LEAF_SIZE], maxZ[SCENE_BVH_LEAF_SIZE];
+		int ids[SCENE_BVH_LEAF_SIZE]; // -1: posição vazia ou objeto removido
+		int count;
+	};
+
+	std::vector<AABB> objectBounds;
+	std::vector<int> objectSlot; // folha * SCENE_BVH_LEAF_SIZE + posição, -1 se fora da árvore
+	std::vector<uint8_t> alive;
+	std::vector<int> freeIds;
+	int nAlive = 0;
+
+	std::vector<Node> nodes; // em pré-ordem: os filhos vêm sempre depois do pai
+	std::vector<Leaf> leaves;
+	bool structureDirty = false;
+	bool boundsDirty = false;
+	float builtArea = 0.0f;
+	int rebuilds = 0;
+
+	int build(std::vector<int>& ids, std::vector<glm::vec3>& centers, int begin, int end);
+	void setLeafSlot(Leaf& leaf, int slot, const AABB& box);
+	unsigned testLeaf(const Leaf& leaf, const Frustum& frustum, unsigned planeMask) const;
+};
@@ -7,6 +7,14 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
 
 //GLAD
 #include <glad/glad.h>
@@ -14,128 +22,551 @@
 // GLFW
 #include <GLFW/glfw3.h>
 
+#include "GLExtensions.h"
+#include "FileWatcher.h"
+
 using namespace std;
 
+// Where the startup time went while building shader programs
+struct ShaderStartupStats
+{
+	double compileMs = 0.0;   // glCompileShader of every stage (cache misses)
+	double linkMs = 0.0;      // glLinkProgram (cache misses)
+	double cacheHitMs = 0.0;  // glProgramBinary of the programs found in the cache
+	int compiled = 0;         // programs built from source
+	int cacheHits = 0;        // programs loaded from the cache
+	int cacheRejected = 0;    // binaries found on disk but refused by the driver
+};
+
 class Shader
 {
 public:
+	// Binding points of the uniform blocks shared by every program (see FrameData.h
+	// and InstancedRenderer.h)
+	static const GLuint FRAME_DATA_BINDING = 0;
+	static const GLuint MATERIALS_BINDING = 1;
+
 	GLuint ID;
+
+	// Directory of the program binary cache (empty disables the cache)
+	static inline std::string cacheDirectory = "shader_cache/";
+
+	// Startup timing, accumulated over every Shader built so far
+	static inline ShaderStartupStats startupStats;
+
 	// Constructor generates the shader on the fly
 	Shader(const GLchar* vertexPath, const GLchar* fragmentPath)
+		: vertexPath(vertexPath), fragmentPath(fragmentPath)
 	{
 		// 1. Retrieve the vertex/fragment source code from filePath
-		std::string vertexCode;
-		std::string fragmentCode;
-		std::ifstream vShaderFile;
-		std::ifstream fShaderFile;
+		std::string vertexCode = readSource(vertexPath);
+		std::string fragmentCode = readSource(fragmentPath);
+		// 2. Load the program from the binary cache or compile and link it
+		this->ID = buildProgram(vertexCode, fragmentCode);
+		// Cache the location of every active uniform, so setters never query the driver
+		reflectUniforms();
+		// Attach shared uniform blocks to their fixed binding points
+		bindUniformBlocks();
+	}
+
+	// Compute program from a single source file (no binary cache or hot reload).
+	// Needs GL 4.3 (see glExtensions().computeShader).
+	explicit Shader(const GLchar* computePath)
+	{
+		GLuint compute = compileStage(GL_COMPUTE_SHADER, readSource(computePath));
+		this->ID = glCreateProgram();
+		glAttachShader(this->ID, compute);
+		glLinkProgram(this->ID);
+		checkLink(this->ID);
+		glDetachShader(this->ID, compute);
+		glDeleteShader(compute);
+		reflectUniforms();
+		bindUniformBlocks();
+	}
+
+	// Prints how the startup time was spent building shaders
+	static void printStartupReport()
+	{
+		const ShaderStartupStats& s = startupStats;
+		std::cout << "Shaders: " << s.compiled << " compiled (compile " << s.compileMs << " ms, link " << s.linkMs
+			<< " ms), " << s.cacheHits << " from cache (" << s.cacheHitMs << " ms)";
+		if (s.cacheRejected > 0)
+			std::cout << ", " << s.cacheRejected << " cached binaries rejected";
+		std::cout << std::endl;
+	}
+
+	static std::string readSource(const GLchar* path)
+	{
+		std::ifstream file;
 		// ensures ifstream objects can throw exceptions:
-		vShaderFile.exceptions(std::ifstream::badbit);
-		fShaderFile.exceptions(std::ifstream::badbit);
+		file.exceptions(std::ifstream::badbit);
 		try
 		{
-			// Open files
-			vShaderFile.open(vertexPath);
-			fShaderFile.open(fragmentPath);
-			std::stringstream vShaderStream, fShaderStream;
-			// Read file's buffer contents into streams
-			vShaderStream << vShaderFile.rdbuf();
-			fShaderStream << fShaderFile.rdbuf();
-			// close file handlers
-			vShaderFile.close();
-			fShaderFile.close();
-			// Convert stream into string
-			vertexCode = vShaderStream.str();
-			fragmentCode = fShaderStream.str();
+			file.open(path);
+			std::stringstream stream;
+			stream << file.rdbuf();
+			file.close();
+			return stream.str();
 		}
 		catch (std::ifstream::failure e)
 		{
 			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
 		}
-		const GLchar* vShaderCode = vertexCode.c_str();
-		const GLchar * fShaderCode = fragmentCode.c_str();
-		// 2. Compile shaders
-		GLuint vertex, fragment;
+		return std::string();
+	}
+
+	// Starts compiling one stage. Querying any status afterwards waits for the compiler.
+	static GLuint startStage(GLenum type, const std::string& source)
+	{
+		const GLchar* code = source.c_str();
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, 1, &code, NULL);
+		glCompileShader(shader);
+		return shader;
+	}
+
+	// Print compile errors if any
+	static bool checkStage(GLuint shader, GLenum type)
+	{
 		GLint success;
-		GLchar infoLog[512];
-		// Vertex Shader
-		vertex = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertex, 1, &vShaderCode, NULL);
-		glCompileShader(vertex);
-		// Print compile errors if any
-		glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 		if (!success)
 		{
-			glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+			GLchar infoLog[512];
+			glGetShaderInfoLog(shader, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::" << (type == GL_VERTEX_SHADER ? "VERTEX" : type == GL_COMPUTE_SHADER ? "COMPUTE" : "FRAGMENT")
+				<< "::COMPILATION_FAILED\n" << infoLog << std::endl;
 		}
-		// Fragment Shader
-		fragment = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragment, 1, &fShaderCode, NULL);
-		glCompileShader(fragment);
-		// Print compile errors if any
-		glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+		return success == GL_TRUE;
+	}
+
+	// Compiles one stage, printing compile errors if any
+	static GLuint compileStage(GLenum type, const std::string& source)
+	{
+		GLuint shader = startStage(type, source);
+		checkStage(shader, type);
+		return shader;
+	}
+
+	// Starts linking a new program from the two stages
+	static GLuint startLink(GLuint vertex, GLuint fragment, bool retrievable)
+	{
+		GLuint program = glCreateProgram();
+		if (retrievable)
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glAttachShader(program, vertex);
+		glAttachShader(program, fragment);
+		glLinkProgram(program);
+		return program;
+	}
+
+	// Print linking errors if any
+	static bool checkLink(GLuint program)
+	{
+		GLint success;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
 		if (!success)
 		{
-			glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+			GLchar infoLog[512];
+			glGetProgramInfoLog(program, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
 		}
-		// Shader Program
-		this->ID = glCreateProgram();
-		glAttachShader(this->ID, vertex);
-		glAttachShader(this->ID, fragment);
-		glLinkProgram(this->ID);
-		// Print linking errors if any
-		glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
-		if (!success)
+		return success == GL_TRUE;
+	}
+
+	// Links a new program from the two stages, printing linking errors if any
+	static GLuint linkProgram(GLuint vertex, GLuint fragment, bool retrievable)
+	{
+		GLuint program = startLink(vertex, fragment, retrievable);
+		checkLink(program);
+		glDetachShader(program, vertex);
+		glDetachShader(program, fragment);
+		return program;
+	}
+
+	// Program from the binary cache when possible, from source otherwise
+	static GLuint buildProgram(const std::string& vertexCode, const std::string& fragmentCode)
+	{
+		using Clock = std::chrono::steady_clock;
+		bool useCache = !cacheDirectory.empty() && loadGLExtensions().programBinary;
+		std::string cachePath;
+		if (useCache)
 		{
-			glGetProgramInfoLog(this->ID, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+			cachePath = programCachePath(vertexCode, fragmentCode);
+			auto t0 = Clock::now();
+			bool rejected = false;
+			GLuint program = loadProgramBinary(cachePath, rejected);
+			if (program != 0)
+			{
+				startupStats.cacheHitMs += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+				startupStats.cacheHits++;
+				return program;
+			}
+			if (rejected)
+				startupStats.cacheRejected++;
 		}
+
+		auto t0 = Clock::now();
+		GLuint vertex = compileStage(GL_VERTEX_SHADER, vertexCode);
+		GLuint fragment = compileStage(GL_FRAGMENT_SHADER, fragmentCode);
+		auto t1 = Clock::now();
+		GLuint program = linkProgram(vertex, fragment, useCache);
+		auto t2 = Clock::now();
 		// Delete the shaders as they're linked into our program now and no longer necessery
 		glDeleteShader(vertex);
 		glDeleteShader(fragment);
+		startupStats.compileMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+		startupStats.linkMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+		startupStats.compiled++;
+
+		if (useCache)
+			saveProgramBinary(program, cachePath);
+		return program;
+	}
 
+	// Watches the source files and rebuilds the program when they change (see update())
+	void enableHotReload()
+	{
+		this->vertexWatch = FileWatcher::global().watch(this->vertexPath);
+		this->fragmentWatch = FileWatcher::global().watch(this->fragmentPath);
+		// Let the driver compile on its own threads, so update() can poll for completion
+		if (loadGLExtensions().parallelShaderCompile)
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
 	}
+
+	// Call once per frame. Starts rebuilding the program when a source file changed and
+	// swaps it in once it linked; until then (or if it fails) the old program keeps
+	// drawing. With KHR_parallel_shader_compile the compile runs in the background and
+	// this call never waits for it; without it, the rebuild blocks the frame it starts on.
+	// Returns true when ID changed: uniform locations and values must be set again.
+	bool update()
+	{
+		if (this->pendingProgram != 0)
+		{
+			GLint done = GL_TRUE;
+			if (glExtensions().parallelShaderCompile)
+				glGetProgramiv(this->pendingProgram, GL_COMPLETION_STATUS_KHR, &done);
+			return done == GL_TRUE && finishReload();
+		}
+		if (this->vertexWatch < 0 && this->fragmentWatch < 0)
+			return false;
+		// Both flags must be consumed, hence no short-circuit
+		bool changed = FileWatcher::global().changed(this->vertexWatch) | FileWatcher::global().changed(this->fragmentWatch);
+		if (!changed)
+			return false;
+		startReload();
+		if (!glExtensions().parallelShaderCompile)
+			return finishReload();
+		return false;
+	}
+
 	// Uses the current shader
 	void Use()
 	{
 		glUseProgram(this->ID);
 	}
 
+	// Location of an active uniform (-1 if it doesn't exist or was optimized out).
+	// Look it up once, outside the render loop, and pass it to the handle-based setters.
+	GLint uniform(const std::string& name) const
+	{
+		return findUniform(name.c_str(), name.size());
+	}
+
+	// Rebuilds the uniform cache from the program (called after linking)
+	void reflectUniforms()
+	{
+		uniformNames.clear();
+		uniformLocations.clear();
+		uniformSlots.assign(16, -1);
+
+		GLint count = 0, maxLength = 0;
+		glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+		std::vector<GLchar> name(std::max(maxLength, 1));
+		for (GLint i = 0; i < count; i++)
+		{
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveUniform(this->ID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+			GLint location = glGetUniformLocation(this->ID, name.data());
+			if (location < 0) // uniforms inside uniform blocks have no location
+				continue;
+			std::string uniformName(name.data(), length);
+			insertUniform(uniformName, location);
+			// Arrays are reported as "name[0]": also register "name" and every element
+			size_t bracket = uniformName.rfind("[0]");
+			if (bracket != std::string::npos && bracket + 3 == uniformName.size())
+			{
+				std::string base = uniformName.substr(0, bracket);
+				insertUniform(base, location);
+				for (GLint e = 1; e < size; e++)
+				{
+					std::string element = base + "[" + std::to_string(e) + "]";
+					insertUniform(element, glGetUniformLocation(this->ID, element.c_str()));
+				}
+			}
+		}
+	}
+
+	// Binds every known shared uniform block declared by the program
+	void bindUniformBlocks()
+	{
+		GLuint frameData = glGetUniformBlockIndex(this->ID, "FrameData");
+		if (frameData != GL_INVALID_INDEX)
+			glUniformBlockBinding(this->ID, frameData, FRAME_DATA_BINDING);
+		GLuint materials = glGetUniformBlockIndex(this->ID, "Materials");
+		if (materials != GL_INVALID_INDEX)
+			glUniformBlockBinding(this->ID, materials, MATERIALS_BINDING);
+	}
+
 	void setBool(const std::string& name, bool value) const
 	{
-		glUniform1i(glGetUniformLocation(this->ID, name.c_str()), (int)value);
+		glUniform1i(uniform(name), (int)value);
 	}
 	// ------------------------------------------------------------------------
 	void setInt(const std::string& name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(this->ID, name.c_str()), value);
+		glUniform1i(uniform(name), value);
 	}
 	// ------------------------------------------------------------------------
 	void setFloat(const std::string& name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(this->ID, name.c_str()), value);
+		glUniform1f(uniform(name), value);
 	}
 	// ------------------------------------------------------------------------
 	void setVec2(const std::string& name, float v1, float v2) const
 	{
-		glUniform2f(glGetUniformLocation(this->ID, name.c_str()), v1, v2);
+		glUniform2f(uniform(name), v1, v2);
 	}
 
 	// ------------------------------------------------------------------------
 	void setVec3(const std::string& name, float v1, float v2, float v3) const
 	{
-		glUniform3f(glGetUniformLocation(this->ID, name.c_str()), v1, v2, v3);
+		glUniform3f(uniform(name), v1, v2, v3);
 	}
 
 	void setVec4(const std::string& name, float v1, float v2, float v3, float v4) const
 	{
-		glUniform4f(glGetUniformLocation(this->ID, name.c_str()), v1, v2, v3,v4);
+		glUniform4f(uniform(name), v1, v2, v3,v4);
 	}
 
 	void setMat4(const std::string& name, float *v) const
 	{
-		glUniformMatrix4fv(glGetUniformLocation(this->ID, name.c_str()), 1, GL_FALSE, v);
+		glUniformMatrix4fv(uniform(name), 1, GL_FALSE, v);
+	}
+
+	// Handle-based setters: no string hashing, meant for the render loop
+	// ------------------------------------------------------------------------
+	void setBool(GLint location, bool value) const { glUniform1i(location, (int)value); }
+	void setInt(GLint location, int value) const { glUniform1i(location, value); }
+	void setFloat(GLint location, float value) const { glUniform1f(location, value); }
+	void setVec2(GLint location, float v1, float v2) const { glUniform2f(location, v1, v2); }
+	void setVec3(GLint location, float v1, float v2, float v3) const { glUniform3f(location, v1, v2, v3); }
+	void setVec4(GLint location, float v1, float v2, float v3, float v4) const { glUniform4f(location, v1, v2, v3, v4); }
+	void setMat4(GLint location, const float *v) const { glUniformMatrix4fv(location, 1, GL_FALSE, v); }
+
+private:
+	// Hot-reload state
+	std::string vertexPath, fragmentPath;
+	int vertexWatch = -1, fragmentWatch = -1;
+	GLuint pendingProgram = 0, pendingVertex = 0, pendingFragment = 0;
+	std::string pendingCachePath;
+
+	void startReload()
+	{
+		std::string vertexCode = readSource(this->vertexPath.c_str());
+		std::string fragmentCode = readSource(this->fragmentPath.c_str());
+		bool useCache = !cacheDirectory.empty() && loadGLExtensions().programBinary;
+		this->pendingCachePath = useCache ? programCachePath(vertexCode, fragmentCode) : std::string();
+		// No status query here: with parallel compile the driver works while we keep drawing
+		this->pendingVertex = startStage(GL_VERTEX_SHADER, vertexCode);
+		this->pendingFragment = startStage(GL_FRAGMENT_SHADER, fragmentCode);
+		this->pendingProgram = startLink(this->pendingVertex, this->pendingFragment, useCache);
+	}
+
+	bool finishReload()
+	{
+		bool success = checkStage(this->pendingVertex, GL_VERTEX_SHADER);
+		success = checkStage(this->pendingFragment, GL_FRAGMENT_SHADER) && success;
+		success = success && checkLink(this->pendingProgram);
+		glDetachShader(this->pendingProgram, this->pendingVertex);
+		glDetachShader(this->pendingProgram, this->pendingFragment);
+		glDeleteShader(this->pendingVertex);
+		glDeleteShader(this->pendingFragment);
+		if (success)
+		{
+			// Keep the program bound if the old one was in use
+			GLint current = 0;
+			glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+			if ((GLuint)current == this->ID)
+				glUseProgram(this->pendingProgram);
+			glDeleteProgram(this->ID);
+			this->ID = this->pendingProgram;
+			reflectUniforms();
+			bindUniformBlocks();
+			if (!this->pendingCachePath.empty())
+				saveProgramBinary(this->ID, this->pendingCachePath);
+			std::cout << "Shader reloaded: " << this->vertexPath << ", " << this->fragmentPath << std::endl;
+		}
+		else
+		{
+			glDeleteProgram(this->pendingProgram);
+			std::cout << "Shader reload failed, keeping the previous program" << std::endl;
+		}
+		this->pendingProgram = this->pendingVertex = this->pendingFragment = 0;
+		return success;
+	}
+
+	static const uint32_t PROGRAM_CACHE_MAGIC = 0x42505343; // "CSPB"
+
+	// Header of each file in cacheDirectory, followed by the driver's binary blob
+	struct ProgramCacheHeader
+	{
+		uint32_t magic;
+		uint32_t format; // binaryFormat returned by glGetProgramBinary
+		uint64_t length;
+	};
+
+	static uint64_t hashSource(uint64_t h, const char* s, size_t length)
+	{
+		for (size_t i = 0; i < length; i++)
+			h = (h ^ (unsigned char)s[i]) * 0x100000001B3ull;
+		// Separator, so ("ab", "c") and ("a", "bc") don't collide
+		return (h ^ 0xFF) * 0x100000001B3ull;
+	}
+
+	// Binaries are only valid for the driver that produced them: the key covers the
+	// sources plus GL_RENDERER and GL_VERSION (which carries the driver version)
+	static std::string programCachePath(const std::string& vertexCode, const std::string& fragmentCode)
+	{
+		const char* renderer = (const char*)glGetString(GL_RENDERER);
+		const char* version = (const char*)glGetString(GL_VERSION);
+		uint64_t h = 0xCBF29CE484222325ull;
+		h = hashSource(h, vertexCode.data(), vertexCode.size());
+		h = hashSource(h, fragmentCode.data(), fragmentCode.size());
+		h = hashSource(h, renderer ? renderer : "", renderer ? strlen(renderer) : 0);
+		h = hashSource(h, version ? version : "", version ? strlen(version) : 0);
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)h);
+		std::string dir = cacheDirectory;
+		if (dir.back() != '/' && dir.back() != '\\')
+			dir += '/';
+		return dir + name;
+	}
+
+	// Returns 0 when there is no usable binary; rejected tells if the driver refused one
+	static GLuint loadProgramBinary(const std::string& path, bool& rejected)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return 0;
+		ProgramCacheHeader header;
+		if (!file.read((char*)&header, sizeof(header)) || header.magic != PROGRAM_CACHE_MAGIC || header.length == 0)
+			return 0;
+		std::vector<char> binary((size_t)header.length);
+		if (!file.read(binary.data(), (std::streamsize)binary.size()))
+			return 0;
+
+		GLuint program = glCreateProgram();
+		glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+		GLint success = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			// Driver updated or format no longer supported: rebuild from source
+			glDeleteProgram(program);
+			glGetError();
+			rejected = true;
+			return 0;
+		}
+		return program;
+	}
+
+	static void saveProgramBinary(GLuint program, const std::string& path)
+	{
+		GLint success = GL_FALSE, length = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (!success || length <= 0)
+			return;
+		std::vector<char> binary((size_t)length);
+		GLenum format = 0;
+		glGetProgramBinary(program, length, &length, &format, binary.data());
+		if (length <= 0)
+			return;
+
+		std::error_code ec;
+		std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+		// Write to a temporary file and rename, so a crash never leaves half a binary behind
+		std::string tmpPath = path + ".tmp";
+		{
+			std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!file)
+				return;
+			ProgramCacheHeader header = { PROGRAM_CACHE_MAGIC, format, (uint64_t)length };
+			file.write((const char*)&header, sizeof(header));
+			file.write(binary.data(), length);
+			if (!file)
+				return;
+		}
+		std::filesystem::rename(tmpPath, path, ec);
+		if (ec)
+			std::filesystem::remove(tmpPath, ec);
+	}
+
+	// Flat open-addressing table: uniformSlots holds indices into the parallel
+	// uniformNames/uniformLocations vectors (-1 = empty slot)
+	std::vector<std::string> uniformNames;
+	std::vector<GLint> uniformLocations;
+	std::vector<int> uniformSlots;
+
+	static size_t hashName(const char* s, size_t length)
+	{
+		size_t h = 2166136261u;
+		for (size_t i = 0; i < length; i++)
+			h = (h ^ (unsigned char)s[i]) * 16777619u;
+		return h;
+	}
+
+	GLint findUniform(const char* name, size_t length) const
+	{
+		if (uniformSlots.empty())
+			return -1;
+		size_t mask = uniformSlots.size() - 1;
+		for (size_t slot = hashName(name, length) & mask; uniformSlots[slot] >= 0; slot = (slot + 1) & mask)
+		{
+			const std::string& candidate = uniformNames[uniformSlots[slot]];
+			if (candidate.size() == length && memcmp(candidate.data(), name, length) == 0)
+				return uniformLocations[uniformSlots[slot]];
+		}
+		return -1;
+	}
+
+	void insertUniform(const std::string& name, GLint location)
+	{
+		if (location < 0 || findUniform(name.c_str(), name.size()) >= 0)
+			return;
+		// Keep the load factor at or below 50%
+		if ((uniformNames.size() + 1) * 2 > uniformSlots.size())
+		{
+			uniformSlots.assign(uniformSlots.size() * 2, -1);
+			for (size_t i = 0; i < uniformNames.size(); i++)
+				placeSlot(uniformNames[i], (int)i);
+		}
+		uniformNames.push_back(name);
+		uniformLocations.push_back(location);
+		placeSlot(name, (int)uniformNames.size() - 1);
+	}
+
+	void placeSlot(const std::string& name, int index)
+	{
+		size_t mask = uniformSlots.size() - 1;
+		size_t slot = hashName(name.c_str(), name.size()) & mask;
+		while (uniformSlots[slot] >= 0)
+			slot = (slot + 1) & mask;
+		uniformSlots[slot] = index;
 	}
 };
 
@@ -0,0 +1,199 @@
+// Texture array: várias texturas pequenas em um único objeto de textura
+// Cada textura de material vira uma camada de um GL_TEXTURE_2D_ARRAY, então desenhos
+// com texturas diferentes não precisam de glBindTexture entre eles: o shader recebe o
+// índice da camada (por desenho, ver InstanceData::layer) e lê com
+//   uniform sampler2DArray texArray;
+//   texture(texArray, vec3(texCoord, layer))
+// Diferente de um atlas, as coordenadas de textura não mudam e o GL_REPEAT continua
+// valendo dentro de cada camada, sem vazamento entre vizinhas nos mipmaps.
+//
+// Todas as camadas têm o mesmo tamanho: o da maior imagem (arredondado para potência
+// de 2 e limitado a maxSize). As menores são ampliadas e as maiores reduzidas com o
+// filtro de TextureMips.h, em espaço linear, e cada camada recebe a sua cadeia de
+// mipmaps. Materiais sem textura usam uma camada de cor sólida (addColor), para serem
+// desenhados pelo mesmo programa que os texturizados.
+//
+// Uso (create e destroy na thread do contexto):
+//   TextureArray textures;
+//   int atlas = textures.addImage("../Modelos3D/Novos/TexturasOffice.png");
+//   int white = textures.addColor(255, 255, 255);
+//   textures.create();
+//   glBindTexture(GL_TEXTURE_2D_ARRAY, textures.ID);
+//   textures.destroy();
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+
+//GLAD
+#include <glad/glad.h>
+
+//STB_IMAGE
+#include <stb_image.h>
+
+#include "ThreadPool.h"
+#include "TextureMips.h"
+
+const int TEXTURE_ARRAY_MAX_SIZE = 1024;
+
+class TextureArray
+{
+public:
+	GLuint ID = 0;
+	int width = 0, height = 0; // de cada camada
+	int nLevels = 0;
+	size_t bytes = 0;          // todas as camadas e níveis
+	double buildMs = 0.0;      // leitura, redimensionamento e mipmaps, na CPU
+	double uploadMs = 0.0;     // glTexImage3D/glTexSubImage3D
+
+	// Devolve a camada da imagem (a mesma camada para o mesmo caminho). A imagem só é
+	// lida em create(); se não puder ser lida, a camada fica branca.
+	int addImage(const std::string& path)
+	{
+		return addLayer("imagem:" + path, path, 0xffffffffu);
+	}
+
+	// Camada de cor sólida (para materiais sem textura)
+	int addColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a = 255)
+	{
+		unsigned int rgba = (unsigned int)r | (unsigned int)g << 8 | (unsigned int)b << 16 | (unsigned int)a << 24;
+		char key[16];
+		snprintf(key, sizeof(key), "cor:%08x", rgba);
+		return addLayer(key, "", rgba);
+	}
+
+	int nLayers() const { return (int)this->layers.size(); }
+	const std::string& layerPath(int layer) const { return this->layers[layer].path; }
+	bool layerLoaded(int layer) const { return this->layers[layer].loaded; }
+
+	// Lê as imagens (em paralelo, no ThreadPool global), deixa todas com o mesmo tamanho,
+	// gera os mipmaps e envia o array. Depois de create, novas camadas exigem destroy
+	// e create de novo.
+	bool create(int maxSize = TEXTURE_ARRAY_MAX_SIZE, const MipSettings& settings = MipSettings())
+	{
+		if (this->layers.empty())
+			return false;
+		auto t0 = std::chrono::high_resolution_clock::now();
+
+		// Leitura: guarda a imagem original de cada camada
+		std::vector<std::vector<unsigned char>> images(this->layers.size());
+		std::vector<int> widths(this->layers.size(), 1), heights(this->layers.size(), 1);
+		ThreadPool::global().parallelFor(this->layers.size(), [&](size_t i)
+		{
+			Layer& layer = this->layers[i];
+			int w = 0, h = 0, channels = 0;
+			unsigned char* pixels = layer.path.empty() ? nullptr : stbi_load(layer.path.c_str(), &w, &h, &channels, 4);
+			layer.loaded = pixels != nullptr;
+			if (pixels)
+			{
+				images[i].assign(pixels, pixels + (size_t)w * h * 4);
+				widths[i] = w;
+				heights[i] = h;
+				stbi_image_free(pixels);
+			}
+		});
+
+		// Tamanho comum: a maior imagem, em potência de 2 (imagens sólidas não contam)
+		this->width = this->height = 1;
+		for (size_t i = 0; i < this->layers.size(); i++)
+		{
+			if (!this->layers[i].loaded)
+				continue;
+			this->width = std::max(this->width, std::min(maxSize, nextPowerOfTwo(widths[i])));
+			this->height = std::max(this->height, std::min(maxSize, nextPowerOfTwo(heights[i])));
+		}
+
+		// Redimensiona e gera a cadeia de cada camada
+		std::vector<TextureLevels> chains(this->layers.size());
+		ThreadPool::global().parallelFor(this->layers.size(), [&](size_t i)
+		{
+			const Layer& layer = this->layers[i];
+			std::vector<unsigned char> pixels;
+			if (layer.loaded)
+			{
+				resizeRGBA8(images[i].data(), widths[i], heights[i], this->width, this->height, settings, pixels);
+			}
+			else
+			{
+				pixels.resize((size_t)this->width * this->height * 4);
+				for (size_t p = 0; p < pixels.size(); p += 4)
+					for (int c = 0; c < 4; c++)
+						pixels[p + c] = (unsigned char)(layer.color >> (8 * c));
+			}
+			std::vector<unsigned char>().swap(images[i]);
+			generateMipChain(pixels.data(), this->width, this->height, settings, chains[i]);
+		});
+		auto t1 = std::chrono::high_resolution_clock::now();
+
+		// Envio: aloca todos os níveis e copia camada por camada
+		this->nLevels = (int)chains[0].levels.size();
+		glGenTextures(1, &this->ID);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, this->ID);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, this->nLevels - 1);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		GLsizei depth = (GLsizei)this->layers.size();
+		this->bytes = 0;
+		for (int level = 0; level < this->nLevels; level++)
+		{
+			const TextureCacheLevel& info = chains[0].levels[level];
+			GLsizei w = (GLsizei)info.width, h = (GLsizei)info.height;
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, w, h, depth, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			for (GLsizei layer = 0; layer < depth; layer++)
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, w, h, 1, GL_RGBA, GL_UNSIGNED_BYTE, chains[layer].level(level));
+			this->bytes += (size_t)info.size * depth;
+		}
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		auto t2 = std::chrono::high_resolution_clock::now();
+		this->buildMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+		this->uploadMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+		return true;
+	}
+
+	void destroy()
+	{
+		glDeleteTextures(1, &this->ID);
+		this->ID = 0;
+		this->width = this->height = this->nLevels = 0;
+		this->bytes = 0;
+	}
+
+private:
+	struct Layer
+	{
+		std::string path;   // vazio: cor sólida
+		unsigned int color; // RGBA, um byte por canal (R no byte menos significativo)
+		bool loaded = false;
+	};
+	std::vector<Layer> layers;
+	std::map<std::string, int> layerByKey;
+
+	int addLayer(const std::string& key, const std::string& path, unsigned int color)
+	{
+		auto found = this->layerByKey.find(key);
+		if (found != this->layerByKey.end())
+			return found->second;
+		Layer layer;
+		layer.path = path;
+		layer.color = color;
+		this->layers.push_back(layer);
+		this->layerByKey[key] = (int)this->layers.size() - 1;
+		return (int)this->layers.size() - 1;
+	}
+
+	static int nextPowerOfTwo(int value)
+	{
+		int size = 1;
+		while (size < value)
+			size *= 2;
+		return size;
+	}
+};
@@ -0,0 +1,144 @@
+// Cache de texturas por caminho, com contagem de referências
+// Vários materiais costumam apontar para a mesma imagem (TexturasOffice.png é o atlas
+// de todo o conjunto Modelos3D/Novos): acquire() devolve o mesmo TextureAsset para o
+// mesmo arquivo, então cada imagem é decodificada e enviada à OpenGL uma vez só. A
+// decodificação roda nas threads do pool (AssetLoader::loadTexture), então pedir
+// várias texturas seguidas e chamar finish() decodifica todas em paralelo.
+//
+// release() devolve uma referência; a textura é apagada quando a última sai.
+// acquire, release e report são chamados na thread do contexto OpenGL.
+//
+// Uso:
+//   AssetLoader loader;
+//   TextureCache textures(loader);
+//   for (const Material& material : materials)
+//       handles.push_back(textures.acquire(material.mapKd));
+//   textures.finish();                   // ou loader.update() a cada frame
+//   ... handles[i]->texID ...
+//   textures.report();
+
+#pragma once
+
+#include <string>
+#include <map>
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+
+#include "AssetLoader.h"
+
+class TextureCache
+{
+public:
+	explicit TextureCache(AssetLoader& loader) : loader(loader) {}
+
+	~TextureCache() { clear(); }
+
+	TextureCache(const TextureCache&) = delete;
+	TextureCache& operator=(const TextureCache&) = delete;
+
+	// Texturas que falharam continuam no cache (com texID 0) até a última referência
+	// sair, para não tentar ler o mesmo arquivo de novo a cada material
+	TextureHandle acquire(const std::string& filePath)
+	{
+		Entry& entry = this->entries[key(filePath)];
+		if (!entry.texture)
+		{
+			entry.texture = this->loader.loadTexture(filePath);
+			this->misses++;
+		}
+		else
+			this->hits++;
+		entry.references++;
+		return entry.texture;
+	}
+
+	void release(const TextureHandle& texture)
+	{
+		if (!texture)
+			return;
+		auto found = this->entries.find(key(texture->path));
+		if (found == this->entries.end() || found->second.texture != texture)
+			return;
+		if (--found->second.references == 0)
+		{
+			// Se ainda estiver decodificando ou na fila de envio, o AssetLoader descarta
+			found->second.texture->destroy();
+			this->entries.erase(found);
+		}
+	}
+
+	// Bloqueia até todas as texturas pedidas estarem prontas (ver AssetLoader::finish)
+	void finish() { this->loader.finish(); }
+
+	// Texturas distintas no cache e a memória de vídeo das que já estão prontas
+	size_t size() const { return this->entries.size(); }
+
+	size_t residentBytes() const
+	{
+		size_t total = 0;
+		for (const auto& entry : this->entries)
+			if (entry.second.texture->ready())
+				total += entry.second.texture->residentBytes;
+		return total;
+	}
+
+	// Uma linha por textura: referências, tamanho, decodificação, envio e memória. Os
+	// campos de uma textura só são lidos depois de ready(): antes disso uma thread do
+	// pool ainda pode estar escrevendo neles.
+	void report(std::ostream& out = std::cout) const
+	{
+		std::ios::fmtflags flags = out.flags();
+		std::streamsize precision = out.precision();
+		out << std::fixed << std::setprecision(1);
+		out << "Texturas: " << this->entries.size() << " carregadas para " << this->hits + this->misses << " pedidos ("
+			<< this->hits << " reaproveitadas), " << residentBytes() / 1024 << " KB na GPU" << std::endl;
+		for (const auto& entry : this->entries)
+		{
+			const TextureAsset& texture = *entry.second.texture;
+			out << "  " << entry.first << ": ";
+			if (texture.failed())
+				out << "falhou";
+			else if (!texture.ready())
+				out << "carregando, " << entry.second.references << " ref";
+			else
+				out << texture.width << "x" << texture.height << " " << formatName(texture.blockFormat) << ", "
+					<< entry.second.references << " ref, decodificacao "
+					<< texture.decodeMs << " ms, mipmaps " << texture.mipMs << " ms, envio " << texture.uploadMs << " ms, " << texture.residentBytes / 1024 << " KB";
+			out << std::endl;
+		}
+		out.flags(flags);
+		out.precision(precision);
+	}
+
+	// Apaga todas as texturas, mesmo as que ainda têm referências
+	void clear()
+	{
+		for (auto& entry : this->entries)
+			entry.second.texture->destroy();
+		this->entries.clear();
+	}
+
+private:
+	struct Entry
+	{
+		TextureHandle texture;
+		int references = 0;
+	};
+
+	AssetLoader& loader;
+	std::map<std::string, Entry> entries;
+	size_t hits = 0, misses = 0;
+
+	static const char* formatName(uint32_t blockFormat)
+	{
+		return blockFormat == BLOCK_BC1 ? "BC1" : blockFormat == BLOCK_BC3 ? "BC3" : "RGBA8";
+	}
+
+	// "../Modelos3D/Novos/./TexturasOffice.png" e "../Modelos3D/Novos/TexturasOffice.png"
+	// são o mesmo arquivo
+	static std::string key(const std::string& filePath)
+	{
+		return std::filesystem::path(filePath).lexically_normal().generic_string();
+	}
+};
@@ -0,0 +1,110 @@
+// Compressão de texturas em blocos (BC1 e BC3, as S3TC/DXT da OpenGL) e cache binário
+// das cadeias de mipmaps
+// Uma imagem RGBA8 ocupa 4 bytes por pixel na GPU; em BC1 cada bloco de 4x4 pixels vira
+// 8 bytes (0,5 byte por pixel) e em BC3 16 bytes (1 byte por pixel, com alfa). A
+// compressão é cara demais para fazer a cada execução, então a ferramenta TextureBake
+// grava a cadeia de mipmaps já comprimida ao lado da imagem (textura.png ->
+// textura.png.cgtex), e o AssetLoader envia esses níveis com glCompressedTexImage2D
+// quando a extensão GL_EXT_texture_compression_s3tc existe. O mesmo arquivo guarda
+// cadeias RGBA8 sem compressão: o AssetLoader grava uma na primeira carga de uma imagem
+// sem cache, com os mipmaps filtrados na CPU (ver TextureMips.h).
+//
+// Layout do arquivo (little-endian), no mesmo espírito do KTX:
+//   TextureCacheHeader
+//   TextureCacheLevel[nLevels]
+//   dados dos níveis, cada um alinhado em 16 bytes
+// O cache é válido se o tamanho e a data de modificação da imagem forem os mesmos; se só
+// a data mudou, o hash do conteúdo decide (como em MeshCache.h).
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+const uint32_t TEXTURE_CACHE_MAGIC = 0x58455443; // "CTEX"
+const uint32_t TEXTURE_CACHE_VERSION = 2;
+
+// Formato dos níveis, com os valores da OpenGL (os de GL_EXT_texture_compression_s3tc
+// estão aqui para não depender de um GLAD com a extensão)
+enum BlockFormat : uint32_t
+{
+	BLOCK_RGBA8 = 0x8058, // GL_RGBA8: sem compressão, 4 bytes por pixel
+	BLOCK_BC1 = 0x83F0,   // GL_COMPRESSED_RGB_S3TC_DXT1_EXT: duas cores 5:6:5 e 2 bits por pixel
+	BLOCK_BC3 = 0x83F3    // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: cor de BC1 + alfa em 8 bits interpolado
+};
+
+struct TextureCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceSize;  // tamanho da imagem em bytes
+	int64_t sourceMTime;  // data de modificação da imagem (ticks do filesystem)
+	uint64_t sourceHash;  // hash do conteúdo da imagem
+	uint32_t format;      // BlockFormat
+	uint32_t width, height;
+	uint32_t nLevels;
+	uint32_t mipFilter;   // MipFilter usado nos níveis 1 em diante
+	uint32_t srgb;        // 1 se os mipmaps foram filtrados em espaço linear
+};
+
+struct TextureCacheLevel
+{
+	uint32_t width, height;
+	uint64_t offset; // a partir do início do arquivo
+	uint64_t size;   // em bytes
+};
+
+// Cadeia de mipmaps, do nível 0 (width x height) até 1x1, em um só bloco de memória
+struct TextureLevels
+{
+	uint32_t format = BLOCK_RGBA8;
+	int width = 0, height = 0;
+	uint32_t mipFilter = 0;
+	bool srgb = true;
+	std::vector<TextureCacheLevel> levels; // offset relativo a data
+	std::vector<unsigned char> data;
+
+	size_t bytes() const { return this->data.size(); }
+	const unsigned char* level(size_t i) const { return this->data.data() + this->levels[i].offset; }
+	unsigned char* level(size_t i) { return this->data.data() + this->levels[i].offset; }
+	bool compressed() const { return this->format != BLOCK_RGBA8; }
+
+	// Reserva os níveis de width x height até 1x1 no formato dado
+	void allocate(uint32_t format, int width, int height);
+};
+
+// Bytes por bloco de 4x4 (BC1/BC3) e tamanho de um nível; nos formatos comprimidos as
+// bordas são completadas até múltiplos de 4
+size_t blockBytes(uint32_t format);
+size_t levelBytes(uint32_t format, int width, int height);
+
+// Bytes de uma cadeia RGBA8 completa (nível 0 e mipmaps), para comparar com a comprimida
+size_t rgba8ChainBytes(int width, int height);
+
+// Comprime um bloco de 4x4 pixels RGBA8 (64 bytes, linha a linha)
+void compressBlockBC1(const unsigned char* rgba, unsigned char* out);
+void compressBlockBC3(const unsigned char* rgba, unsigned char* out);
+
+// Descomprime um bloco para 64 bytes RGBA8, com as fórmulas da especificação da extensão
+void decompressBlock(uint32_t format, const unsigned char* in, unsigned char* rgba);
+
+// Comprime um nível RGBA8 inteiro, com os blocos repartidos entre as threads do pool
+void compressImage(const unsigned char* rgba, int width, int height, uint32_t format, unsigned char* out, unsigned nThreads = 0);
+void decompressImage(const unsigned char* in, int width, int height, uint32_t format, std::vector<unsigned char>& rgba);
+
+// Comprime todos os níveis de uma cadeia RGBA8 (ver generateMipChain em TextureMips.h).
+// BC1 se todos os pixels do nível 0 forem opacos e BC3 caso contrário.
+void compressTexture(const TextureLevels& mips, TextureLevels& out, unsigned nThreads = 0);
+
+// PSNR em dB entre duas imagens RGBA8 do mesmo tamanho (canais RGB, ou RGBA se withAlpha)
+double computePSNR(const unsigned char* a, const unsigned char* b, int width, int height, bool withAlpha);
+
+// Caminho do arquivo de cache de uma imagem
+std::string textureCachePath(const std::string& imagePath);
+
+bool writeTextureCache(const std::string& imagePath, const TextureLevels& texture);
+
+// Lê o cache se ele for válido para a imagem atual
+bool readTextureCache(const std::string& imagePath, TextureLevels& texture);
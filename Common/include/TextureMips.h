@@ -0,0 +1,59 @@
+// Geração de mipmaps na CPU
+// Substitui o glGenerateMipmap: cada nível é filtrado a partir do anterior em ponto
+// flutuante, em espaço de cor linear (as imagens são sRGB, e a média de valores sRGB
+// escurece os detalhes finos), com alfa pré-multiplicado quando a imagem tem
+// transparência. O filtro é separável (linhas e depois colunas) e repete a imagem nas
+// bordas, como o GL_REPEAT usado pelos exemplos:
+//   - MIP_BOX: média de 2x2, o mesmo suporte do glGenerateMipmap
+//   - MIP_KAISER: sinc com janela de Kaiser (raio 3, alfa 4), mais nítido sem serrilhado
+//   - MIP_LANCZOS: Lanczos de raio 3
+// As somas ponderadas usam SSE2 (um pixel RGBA por registrador) nas linhas e AVX2 com
+// FMA (8 floats por instrução, escolhido em tempo de execução se a CPU tiver) ou SSE2
+// nas colunas, e as linhas de cada passada são repartidas entre as threads do pool.
+//
+// O resultado vai para o cache .cgtex (ver TextureCompression.h), então o filtro só
+// roda na primeira vez que a textura é carregada.
+
+#pragma once
+
+#include <vector>
+
+#include "TextureCompression.h"
+
+enum MipFilter : uint32_t
+{
+	MIP_BOX = 0,
+	MIP_KAISER = 1,
+	MIP_LANCZOS = 2
+};
+
+struct MipSettings
+{
+	MipFilter filter = MIP_KAISER;
+	bool srgb = true;     // filtra em espaço linear (false: direto nos valores de 8 bits)
+	bool simd = true;     // false usa os laços escalares (referência para os benchmarks)
+	bool useAVX2 = true;  // false: colunas com SSE2 mesmo se a CPU tiver AVX2 e FMA
+	unsigned nThreads = 0; // 0: todas as threads do pool
+};
+
+const char* mipFilterName(MipFilter filter);
+
+// Conjunto de instruções usado nas colunas com estas configurações ("AVX2", "SSE2" ou
+// "escalar")
+const char* mipSimdLevel(const MipSettings& settings = MipSettings());
+
+// true se a CPU (e o sistema) tiverem AVX2 e FMA
+bool mipCpuHasAVX2();
+
+// Cadeia completa em RGBA8 (format BLOCK_RGBA8), do nível 0 (cópia de rgba) até 1x1
+void generateMipChain(const unsigned char* rgba, int width, int height, const MipSettings& settings, TextureLevels& out);
+
+// Redimensiona para newWidth x newHeight com o mesmo filtro (ampliando ou reduzindo),
+// também em espaço linear; usado para deixar imagens de tamanhos diferentes com o
+// tamanho das camadas de um texture array (ver TextureArray.h)
+void resizeRGBA8(const unsigned char* rgba, int width, int height, int newWidth, int newHeight,
+	const MipSettings& settings, std::vector<unsigned char>& out);
+
+// Redução ingênua à metade: média de 2x2 em 8 bits, sem correção de gama (com lado ímpar
+// a última coluna ou linha fica de fora, como no filtro de caixa do glGenerateMipmap)
+void downsampleRGBA8(const unsigned char* src, int width, int height, std::vector<unsigned char>& dst);
@@ -0,0 +1,135 @@
+// Pool de threads simples, compartilhado pelos utilitários de Common
+// Tarefas avulsas são enviadas com submit() (devolve um std::future) e laços
+// paralelos com parallelFor(). A thread que chama parallelFor também processa
+// itens, então chamadas aninhadas (de dentro de uma tarefa do pool) não travam.
+
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+
+class ThreadPool
+{
+public:
+	// nThreads == 0 usa o número de núcleos da máquina
+	explicit ThreadPool(unsigned nThreads = 0)
+	{
+		if (nThreads == 0)
+			nThreads = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned i = 0; i < nThreads; i++)
+			workers.emplace_back([this]() { this->workerLoop(); });
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->stopping = true;
+		}
+		this->wakeUp.notify_all();
+		for (std::thread& t : this->workers)
+			t.join();
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned size() const { return (unsigned)this->workers.size(); }
+
+	// Enfileira uma tarefa e devolve o future com o seu resultado
+	template <typename F>
+	auto submit(F&& f) -> std::future<decltype(f())>
+	{
+		typedef decltype(f()) R;
+		auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+		std::future<R> result = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->tasks.push([task]() { (*task)(); });
+		}
+		this->wakeUp.notify_one();
+		return result;
+	}
+
+	// Executa body(i) para i em [0, count) e só retorna quando todos terminarem.
+	// maxThreads limita quantas threads (incluindo a que chama) participam.
+	void parallelFor(size_t count, const std::function<void(size_t)>& body, unsigned maxThreads = 0)
+	{
+		if (count == 0)
+			return;
+		unsigned helpers = std::min<size_t>(this->size(), count - 1);
+		if (maxThreads > 0)
+			helpers = std::min(helpers, maxThreads - 1);
+		if (helpers == 0)
+		{
+			for (size_t i = 0; i < count; i++)
+				body(i);
+			return;
+		}
+
+		struct Shared
+		{
+			std::atomic<size_t> next{ 0 };
+			std::atomic<size_t> done{ 0 };
+			std::mutex mutex;
+			std::condition_variable finished;
+		};
+		auto shared = std::make_shared<Shared>();
+		auto run = [shared, count, &body]() {
+			size_t i;
+			while ((i = shared->next.fetch_add(1)) < count)
+			{
+				body(i);
+				if (shared->done.fetch_add(1) + 1 == count)
+				{
+					std::lock_guard<std::mutex> lock(shared->mutex);
+					shared->finished.notify_all();
+				}
+			}
+		};
+		for (unsigned h = 0; h < helpers; h++)
+			submit(run);
+		run();
+		std::unique_lock<std::mutex> lock(shared->mutex);
+		shared->finished.wait(lock, [&]() { return shared->done.load() == count; });
+	}
+
+	// Pool global, criado no primeiro uso
+	static ThreadPool& global()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+private:
+	void workerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->wakeUp.wait(lock, [this]() { return this->stopping || !this->tasks.empty(); });
+				if (this->stopping && this->tasks.empty())
+					return;
+				task = std::move(this->tasks.front());
+				this->tasks.pop();
+			}
+			task();
+		}
+	}
+
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	bool stopping = false;
+};
@@ -0,0 +1,11 @@
+// Medida de tempo dos benchmarks, das ferramentas e das estatísticas de frame
+
+#pragma once
+
+#include <chrono>
+
+// Milissegundos desde since
+inline double elapsedMs(std::chrono::high_resolution_clock::time_point since)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - since).count();
+}
@@ -0,0 +1,145 @@
+// Formato de vértice compacto (opcional) para malhas carregadas de OBJ
+// Em vez de 11 floats (44 bytes: posição, cor constante, uv e normal), cada vértice
+// ocupa 20 bytes:
+//   posição  -> 3 floats                      (12 bytes, location 0)
+//   uv       -> 2 half-floats (GL_HALF_FLOAT) ( 4 bytes, location 2)
+//   normal   -> GL_INT_2_10_10_10_REV         ( 4 bytes, location 3)
+// A cor (location 1) é descartada: o phong.fs não a usa.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "OBJLoader.h"
+
+struct PackedVertex
+{
+	float position[3];
+	uint16_t texCoord[2]; // half-float
+	uint32_t normal;      // x, y, z snorm de 10 bits + w de 2 bits
+};
+
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex deve ter 20 bytes");
+
+// Float (32 bits) -> half (16 bits), com arredondamento para o par mais próximo
+inline uint16_t floatToHalf(float value)
+{
+	uint32_t f;
+	memcpy(&f, &value, sizeof(f));
+	uint32_t sign = (f >> 16) & 0x8000u;
+	uint32_t absF = f & 0x7FFFFFFFu;
+
+	if (absF >= 0x7F800000u) // Inf ou NaN
+		return (uint16_t)(sign | 0x7C00u | (absF > 0x7F800000u ? 0x200u : 0u));
+	if (absF >= 0x477FF000u) // estoura o maior half (65504) -> Inf
+		return (uint16_t)(sign | 0x7C00u);
+	if (absF < 0x38800000u) // subnormal do half (ou zero)
+	{
+		if (absF < 0x33000000u)
+			return (uint16_t)sign;
+		uint32_t mantissa = (absF & 0x007FFFFFu) | 0x00800000u;
+		int shift = 126 - (int)(absF >> 23); // entre 14 e 24
+		uint32_t half = mantissa >> shift;
+		uint32_t rest = mantissa & ((1u << shift) - 1u);
+		uint32_t halfway = 1u << (shift - 1);
+		if (rest > halfway || (rest == halfway && (half & 1u)))
+			half++;
+		return (uint16_t)(sign | half);
+	}
+	uint32_t half = ((absF - 0x38000000u) >> 13);
+	uint32_t rest = absF & 0x1FFFu;
+	if (rest > 0x1000u || (rest == 0x1000u && (half & 1u)))
+		half++;
+	return (uint16_t)(sign | half);
+}
+
+// Half (16 bits) -> float (32 bits)
+inline float halfToFloat(uint16_t half)
+{
+	uint32_t sign = (uint32_t)(half & 0x8000u) << 16;
+	uint32_t exponent = (half >> 10) & 0x1Fu;
+	uint32_t mantissa = half & 0x3FFu;
+	uint32_t f;
+	if (exponent == 0)
+	{
+		if (mantissa == 0)
+			f = sign;
+		else
+		{
+			// Normaliza o subnormal
+			exponent = 127 - 15 + 1;
+			while ((mantissa & 0x400u) == 0)
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+			f = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+		}
+	}
+	else if (exponent == 0x1F)
+		f = sign | 0x7F800000u | (mantissa << 13);
+	else
+		f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	float value;
+	memcpy(&value, &f, sizeof(value));
+	return value;
+}
+
+// Normal em [-1, 1]^3 -> GL_INT_2_10_10_10_REV (x nos bits 0-9, y 10-19, z 20-29, w 30-31)
+inline uint32_t packNormal(glm::vec3 n)
+{
+	float len = glm::length(n);
+	if (len > 0.0f)
+		n /= len;
+	uint32_t packed = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		float c = glm::clamp(n[i], -1.0f, 1.0f);
+		int q = (int)std::lround(c * 511.0f);
+		packed |= ((uint32_t)q & 0x3FFu) << (10 * i);
+	}
+	return packed;
+}
+
+// Decodificação igual à da OpenGL 4.2+ para snorm: max(q / 511, -1)
+inline glm::vec3 unpackNormal(uint32_t packed)
+{
+	glm::vec3 n;
+	for (int i = 0; i < 3; i++)
+	{
+		int q = (int)((packed >> (10 * i)) & 0x3FFu);
+		if (q & 0x200)
+			q -= 0x400; // extensão de sinal
+		n[i] = std::max(q / 511.0f, -1.0f);
+	}
+	return n;
+}
+
+// Converte vértices no layout de OBJ_FLOATS_PER_VERTEX floats para o formato compacto
+inline void packVertices(const float* vertices, int nVertices, std::vector<PackedVertex>& packed)
+{
+	packed.resize(nVertices);
+	for (int i = 0; i < nVertices; i++)
+	{
+		const float* v = &vertices[(size_t)i * OBJ_FLOATS_PER_VERTEX];
+		PackedVertex& p = packed[i];
+		p.position[0] = v[0];
+		p.position[1] = v[1];
+		p.position[2] = v[2];
+		p.texCoord[0] = floatToHalf(v[6]);
+		p.texCoord[1] = floatToHalf(v[7]);
+		p.normal = packNormal(glm::vec3(v[8], v[9], v[10]));
+	}
+}
+
+inline void packVertices(const IndexedMesh& mesh, std::vector<PackedVertex>& packed)
+{
+	packVertices(mesh.vertices.data(), mesh.nVertices(), packed);
+}
@@ -0,0 +1,383 @@
+#include "GPUCulling.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+//GLM
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace std;
+
+static bool linked(const Shader& program)
+{
+	GLint success = GL_FALSE;
+	glGetProgramiv(program.ID, GL_LINK_STATUS, &success);
+	return success == GL_TRUE;
+}
+
+bool GPUCulling::create(const char* cullPath, const char* hizPath)
+{
+	const GLExtensionSupport& support = loadGLExtensions();
+	if (!support.computeShader || !support.multiDrawIndirect)
+		return false;
+	this->cullProgram = make_unique<Shader>(cullPath);
+	this->hizProgram = make_unique<Shader>(hizPath);
+	if (!linked(*this->cullProgram) || !linked(*this->hizProgram))
+		return false;
+	this->materials.create();
+	return true;
+}
+
+int GPUCulling::addMesh(const CachedMesh& mesh)
+{
+	MeshRange range;
+	range.firstIndex = (GLuint)this->indices.size();
+	range.baseVertex = (GLint)(this->vertices.size() / OBJ_FLOATS_PER_VERTEX);
+	range.submeshes = mesh.submeshes();
+	range.bounds = mesh.bounds();
+	this->vertices.insert(this->vertices.end(), mesh.vertexData(), mesh.vertexData() + (size_t)mesh.nVertices() * OBJ_FLOATS_PER_VERTEX);
+	this->indices.insert(this->indices.end(), mesh.indexData(), mesh.indexData() + mesh.nIndices());
+	this->meshes.push_back(range);
+	return (int)this->meshes.size() - 1;
+}
+
+void GPUCulling::addObject(int mesh, const glm::mat4& model, const vector<Material>& materials,
+	const vector<int>& layers, GLuint whiteLayer)
+{
+	const MeshRange& range = this->meshes[mesh];
+	AABB box = transformBounds(range.bounds, model);
+	for (const Submesh& submesh : range.submeshes)
+	{
+		GPUDrawRecord record;
+		record.boxMin = glm::vec4(box.min, 0.0f);
+		record.boxMax = glm::vec4(box.max, 0.0f);
+		record.count = submesh.indexCount;
+		record.firstIndex = range.firstIndex + submesh.firstIndex;
+		record.baseVertex = range.baseVertex;
+		record.padding = 0;
+		this->records.push_back(record);
+
+		bool hasMaterial = submesh.material >= 0 && submesh.material < (int)materials.size();
+		int layer = hasMaterial && submesh.material < (int)layers.size() ? layers[submesh.material] : -1;
+		InstanceData data = {};
+		data.model = model;
+		data.material = materialFor(hasMaterial ? materials[submesh.material] : DrawList::defaultMaterial(), layer >= 0);
+		data.layer = layer >= 0 ? (GLuint)layer : whiteLayer;
+		this->instances.push_back(data);
+	}
+}
+
+GLuint GPUCulling::materialFor(const Material& material, bool textured)
+{
+	InstanceMaterial converted = DrawList::instanceMaterial(material, textured);
+	for (size_t i = 0; i < this->materials.materials.size(); i++)
+		if (memcmp(&this->materials.materials[i], &converted, sizeof(InstanceMaterial)) == 0)
+			return (GLuint)i;
+	return this->materials.add(converted);
+}
+
+void GPUCulling::upload()
+{
+	if (this->VAO == 0)
+	{
+		glGenVertexArrays(1, &this->VAO);
+		GLuint buffers[7];
+		glGenBuffers(7, buffers);
+		this->vertexBuffer = buffers[0];
+		this->indexBuffer = buffers[1];
+		this->instanceBuffer = buffers[2];
+		this->drawBuffer = buffers[3];
+		this->commandBuffer = buffers[4];
+		this->countBuffer = buffers[5];
+		this->statusBuffer = buffers[6];
+	}
+
+	glBindVertexArray(this->VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(float), this->vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(unsigned int), this->indices.data(), GL_STATIC_DRAW);
+	setupMeshAttributes(this->VAO, this->vertexBuffer, this->indexBuffer);
+
+	// Atributos por instância: o baseInstance de cada comando é o índice do desenho
+	glBindVertexArray(this->VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, this->instances.size() * sizeof(InstanceData), this->instances.data(), GL_STATIC_DRAW);
+	for (GLuint c = 0; c < 4; c++)
+		glVertexAttribPointer(INSTANCE_MODEL_LOCATION + c, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+			(GLvoid*)(offsetof(InstanceData, model) + c * sizeof(glm::vec4)));
+	glVertexAttribIPointer(INSTANCE_MATERIAL_LOCATION, 1, GL_UNSIGNED_INT, sizeof(InstanceData), (GLvoid*)offsetof(InstanceData, material));
+	glVertexAttribIPointer(INSTANCE_LAYER_LOCATION, 1, GL_UNSIGNED_INT, sizeof(InstanceData), (GLvoid*)offsetof(InstanceData, layer));
+	for (GLuint location = INSTANCE_MODEL_LOCATION; location <= INSTANCE_LAYER_LOCATION; location++)
+	{
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisor(location, 1);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->drawBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, this->records.size() * sizeof(GPUDrawRecord), this->records.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->commandBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, this->records.size() * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->countBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->statusBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, this->records.size() * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	this->materials.update();
+
+	// A geometria já está na GPU; os desenhos ficam para nDraws e cullReference
+	this->vertices = vector<float>();
+	this->indices = vector<unsigned int>();
+}
+
+void GPUCulling::buildHiZ(GLuint depthTexture, int width, int height)
+{
+	if (width != this->hizWidth || height != this->hizHeight)
+	{
+		this->hizWidth = width;
+		this->hizHeight = height;
+		this->hizLevels = 0;
+		GLint total = 0;
+		glm::ivec2 size(width, height);
+		while (this->hizLevels < GPU_HIZ_MAX_LEVELS)
+		{
+			this->hizOffsets[this->hizLevels] = total;
+			this->hizSizes[this->hizLevels] = size;
+			this->hizLevels++;
+			total += size.x * size.y;
+			if (size.x == 1 && size.y == 1)
+				break;
+			size = glm::max(glm::ivec2(1), size / 2);
+		}
+		if (this->hizBuffer == 0)
+			glGenBuffers(1, &this->hizBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->hizBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, total * sizeof(float), nullptr, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	const Shader& program = *this->hizProgram;
+	glUseProgram(program.ID);
+	glActiveTexture(GL_TEXTURE0 + GPU_CULL_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, depthTexture);
+	program.setInt(program.uniform("depthTexture"), GPU_CULL_TEXTURE_UNIT);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_CULL_HIZ_BINDING, this->hizBuffer);
+	GLint levelLocation = program.uniform("level");
+	GLint belowOffset = program.uniform("belowOffset"), belowSize = program.uniform("belowSize");
+	GLint offset = program.uniform("offset"), size = program.uniform("size");
+	for (int level = 0; level < this->hizLevels; level++)
+	{
+		program.setInt(levelLocation, level);
+		if (level > 0)
+		{
+			program.setInt(belowOffset, this->hizOffsets[level - 1]);
+			glUniform2i(belowSize, this->hizSizes[level - 1].x, this->hizSizes[level - 1].y);
+		}
+		program.setInt(offset, this->hizOffsets[level]);
+		glUniform2i(size, this->hizSizes[level].x, this->hizSizes[level].y);
+		glDispatchCompute((this->hizSizes[level].x + GPU_HIZ_GROUP_SIZE - 1) / GPU_HIZ_GROUP_SIZE,
+			(this->hizSizes[level].y + GPU_HIZ_GROUP_SIZE - 1) / GPU_HIZ_GROUP_SIZE, 1);
+		// O próximo nível (e o cull) lê este
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+	this->hizReady = true;
+}
+
+void GPUCulling::cull(const glm::mat4& viewProjection)
+{
+	this->lastViewProjection = viewProjection;
+	this->lastOcclusion = this->occlusion && this->hizReady;
+	if (this->records.empty())
+		return;
+
+	const Shader& program = *this->cullProgram;
+	glUseProgram(program.ID);
+	Frustum frustum(viewProjection);
+	glUniform4fv(program.uniform("planes"), FRUSTUM_PLANES, glm::value_ptr(frustum.planes[0]));
+	program.setMat4(program.uniform("viewProjection"), glm::value_ptr(viewProjection));
+	glUniform1ui(program.uniform("drawCount"), (GLuint)this->records.size());
+	program.setBool(program.uniform("occlusion"), this->lastOcclusion);
+	program.setBool(program.uniform("compact"), usesIndirectCount());
+	program.setInt(program.uniform("hizLevels"), this->hizLevels);
+	glUniform1iv(program.uniform("hizOffsets"), GPU_HIZ_MAX_LEVELS, this->hizOffsets);
+	glUniform2iv(program.uniform("hizSizes"), GPU_HIZ_MAX_LEVELS, glm::value_ptr(this->hizSizes[0]));
+
+	// Único dado por frame que não é uniform: o contador dos comandos compactados
+	const GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->countBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_CULL_DRAWS_BINDING, this->drawBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_CULL_COMMANDS_BINDING, this->commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_CULL_COUNT_BINDING, this->countBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_CULL_STATUS_BINDING, this->statusBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_CULL_HIZ_BINDING, this->hizBuffer);
+
+	glDispatchCompute((GLuint)(this->records.size() + GPU_CULL_GROUP_SIZE - 1) / GPU_CULL_GROUP_SIZE, 1, 1);
+	// Os comandos e o contador são lidos pela glMultiDrawElementsIndirect(Count)
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+DrawStats GPUCulling::submit(const Shader& shader)
+{
+	DrawStats stats;
+	if (this->records.empty())
+		return stats;
+	glUseProgram(shader.ID);
+	glBindVertexArray(this->VAO);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, this->commandBuffer);
+	if (usesIndirectCount())
+	{
+		glBindBuffer(GL_PARAMETER_BUFFER, this->countBuffer);
+		glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, (GLsizei)this->records.size(), 0);
+		glBindBuffer(GL_PARAMETER_BUFFER, 0);
+	}
+	else
+	{
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)this->records.size(), 0);
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindVertexArray(0);
+	stats.draws = 1;
+	stats.programChanges = 1;
+	stats.vaoChanges = 1;
+	stats.commands = (int)this->records.size(); // máximo: quantos sobraram só a GPU sabe
+	return stats;
+}
+
+void GPUCulling::readStatus(vector<uint8_t>& status)
+{
+	vector<GLuint> values(this->records.size());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->statusBuffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, values.size() * sizeof(GLuint), values.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	status.assign(values.begin(), values.end());
+}
+
+int GPUCulling::readVisibleCount()
+{
+	if (!usesIndirectCount())
+	{
+		vector<uint8_t> status;
+		readStatus(status);
+		return (int)count(status.begin(), status.end(), (uint8_t)GPU_CULL_VISIBLE);
+	}
+	GLuint visible = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->countBuffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &visible);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	return (int)visible;
+}
+
+// Mesmo teste de cull.cs (e de OcclusionBuffer::isOccluded), com a pirâmide na CPU
+static bool occludedByHiZ(const vector<float>& hiz, const GLint* offsets, const glm::ivec2* sizes, int nLevels,
+	const glm::mat4& viewProjection, const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+	glm::ivec2 size = sizes[0];
+	glm::vec2 lo(1e30f), hi(-1e30f);
+	float nearest = 1e30f;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 p((corner & 1) ? boxMax.x : boxMin.x, (corner & 2) ? boxMax.y : boxMin.y, (corner & 4) ? boxMax.z : boxMin.z);
+		glm::vec4 clip = viewProjection * glm::vec4(p, 1.0f);
+		if (clip.w <= 1e-6f || clip.z < -clip.w)
+			return false;
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		glm::vec2 xy = (glm::vec2(ndc) * 0.5f + 0.5f) * glm::vec2(size);
+		lo = glm::min(lo, xy);
+		hi = glm::max(hi, xy);
+		nearest = min(nearest, ndc.z * 0.5f + 0.5f);
+	}
+	glm::ivec2 p0 = glm::max(glm::ivec2(0), glm::ivec2(glm::floor(lo)));
+	glm::ivec2 p1 = glm::min(size - 1, glm::ivec2(glm::floor(hi)));
+	if (p0.x > p1.x || p0.y > p1.y)
+		return false;
+	int level = 0;
+	while (level + 1 < nLevels && ((p1.x >> level) - (p0.x >> level) >= 4 || (p1.y >> level) - (p0.y >> level) >= 4))
+		level++;
+	glm::ivec2 levelSize = sizes[level];
+	const float* texels = hiz.data() + offsets[level];
+	float farthest = 0.0f;
+	for (int y = min(p0.y >> level, levelSize.y - 1); y <= min(p1.y >> level, levelSize.y - 1); y++)
+		for (int x = min(p0.x >> level, levelSize.x - 1); x <= min(p1.x >> level, levelSize.x - 1); x++)
+			farthest = max(farthest, texels[(size_t)y * levelSize.x + x]);
+	return nearest > farthest;
+}
+
+void GPUCulling::cullReference(vector<uint8_t>& status)
+{
+	vector<float> hiz;
+	if (this->lastOcclusion)
+	{
+		// Nível 0 da GPU; os outros montados aqui com a regra de hiz.cs
+		int last = this->hizLevels - 1;
+		hiz.resize((size_t)this->hizOffsets[last] + this->hizSizes[last].x * this->hizSizes[last].y);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->hizBuffer);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, (size_t)this->hizWidth * this->hizHeight * sizeof(float), hiz.data());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		for (int level = 1; level < this->hizLevels; level++)
+		{
+			glm::ivec2 below = this->hizSizes[level - 1], size = this->hizSizes[level];
+			const float* in = hiz.data() + this->hizOffsets[level - 1];
+			float* out = hiz.data() + this->hizOffsets[level];
+			for (int y = 0; y < size.y; y++)
+			{
+				// Nas dimensões ímpares, o último texel também cobre a sobra
+				int lastY = min(2 * y + 1 + (y == size.y - 1 ? below.y & 1 : 0), below.y - 1);
+				for (int x = 0; x < size.x; x++)
+				{
+					int lastX = min(2 * x + 1 + (x == size.x - 1 ? below.x & 1 : 0), below.x - 1);
+					float depth = 0.0f;
+					for (int by = 2 * y; by <= lastY; by++)
+						for (int bx = 2 * x; bx <= lastX; bx++)
+							depth = max(depth, in[(size_t)by * below.x + bx]);
+					out[(size_t)y * size.x + x] = depth;
+				}
+			}
+		}
+	}
+
+	Frustum frustum(this->lastViewProjection);
+	status.resize(this->records.size());
+	for (size_t i = 0; i < this->records.size(); i++)
+	{
+		const GPUDrawRecord& record = this->records[i];
+		AABB box;
+		box.min = glm::vec3(record.boxMin);
+		box.max = glm::vec3(record.boxMax);
+		if (frustum.testAABB(box) == FRUSTUM_OUTSIDE)
+			status[i] = GPU_CULL_FRUSTUM;
+		else if (this->lastOcclusion && occludedByHiZ(hiz, this->hizOffsets, this->hizSizes, this->hizLevels, this->lastViewProjection,
+			box.min, box.max))
+			status[i] = GPU_CULL_OCCLUDED;
+		else
+			status[i] = GPU_CULL_VISIBLE;
+	}
+}
+
+void GPUCulling::destroy()
+{
+	GLuint buffers[8] = { this->vertexBuffer, this->indexBuffer, this->instanceBuffer, this->drawBuffer,
+		this->commandBuffer, this->countBuffer, this->statusBuffer, this->hizBuffer };
+	glDeleteBuffers(8, buffers);
+	glDeleteVertexArrays(1, &this->VAO);
+	this->materials.destroy();
+	if (this->cullProgram)
+		glDeleteProgram(this->cullProgram->ID);
+	if (this->hizProgram)
+		glDeleteProgram(this->hizProgram->ID);
+	this->cullProgram.reset();
+	this->hizProgram.reset();
+	this->VAO = this->vertexBuffer = this->indexBuffer = this->instanceBuffer = 0;
+	this->drawBuffer = this->commandBuffer = this->countBuffer = this->statusBuffer = this->hizBuffer = 0;
+	this->hizWidth = this->hizHeight = this->hizLevels = 0;
+	this->hizReady = false;
+	this->meshes.clear();
+	this->records.clear();
+	this->instances.clear();
+}
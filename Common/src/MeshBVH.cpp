@@ -0,0 +1,590 @@
+#include "MeshBVH.h"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+#include "ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MESH_BVH_SSE2 1
+#endif
+
+using namespace std;
+
+namespace
+{
+	// Nó da árvore binária usada durante a montagem (depois é achatada em nós de 4 filhos)
+	struct BuildNode
+	{
+		AABB box;
+		int left = -1, right = -1; // -1 nas folhas
+		int begin = 0, end = 0;    // triângulos da folha: order[begin, end)
+	};
+
+	struct BuildContext
+	{
+		vector<AABB> boxes;        // caixa de cada triângulo
+		vector<glm::vec3> centers; // centro da caixa de cada triângulo
+		vector<int> order;         // triângulos na ordem das folhas
+	};
+
+	// Subárvore que fica para as threads do pool: node é o nó já criado que vira a raiz dela
+	struct BuildTask
+	{
+		int node;
+		int begin, end;
+		int depth;
+	};
+
+	void rangeBounds(const BuildContext& context, int begin, int end, AABB& box, AABB& centerBox)
+	{
+		box = AABB::empty();
+		centerBox = AABB::empty();
+		for (int i = begin; i < end; i++)
+		{
+			int triangle = context.order[i];
+			box.grow(context.boxes[triangle]);
+			centerBox.min = glm::min(centerBox.min, context.centers[triangle]);
+			centerBox.max = glm::max(centerBox.max, context.centers[triangle]);
+		}
+	}
+
+	// Divide order[begin, end) em dois e devolve o meio: SAH com MESH_BVH_BINS caixas por
+	// eixo ou, se o SAH não separar nada (ou a árvore já estiver funda demais), a mediana
+	// no eixo mais longo dos centros
+	int splitRange(BuildContext& context, int begin, int end, const AABB& centerBox, int depth)
+	{
+		glm::vec3 extent = centerBox.extent();
+		int bestAxis = -1, bestSplit = 0;
+		float bestCost = INFINITY;
+		for (int axis = 0; axis < 3 && depth < MESH_BVH_MAX_DEPTH; axis++)
+		{
+			if (extent[axis] <= 0.0f)
+				continue;
+			AABB binBox[MESH_BVH_BINS];
+			int binCount[MESH_BVH_BINS] = {};
+			for (AABB& b : binBox)
+				b = AABB::empty();
+			float scale = MESH_BVH_BINS / extent[axis];
+			for (int i = begin; i < end; i++)
+			{
+				int triangle = context.order[i];
+				int bin = min(MESH_BVH_BINS - 1, (int)((context.centers[triangle][axis] - centerBox.min[axis]) * scale));
+				binBox[bin].grow(context.boxes[triangle]);
+				binCount[bin]++;
+			}
+			float rightArea[MESH_BVH_BINS];
+			int rightCount[MESH_BVH_BINS];
+			AABB right = AABB::empty();
+			int n = 0;
+			for (int b = MESH_BVH_BINS - 1; b > 0; b--)
+			{
+				right.grow(binBox[b]);
+				n += binCount[b];
+				rightArea[b] = n > 0 ? right.halfArea() : 0.0f;
+				rightCount[b] = n;
+			}
+			AABB left = AABB::empty();
+			n = 0;
+			for (int b = 1; b < MESH_BVH_BINS; b++)
+			{
+				left.grow(binBox[b - 1]);
+				n += binCount[b - 1];
+				if (n == 0 || rightCount[b] == 0)
+					continue;
+				float cost = left.halfArea() * n + rightArea[b] * rightCount[b];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = b;
+				}
+			}
+		}
+
+		if (bestAxis >= 0)
+		{
+			float scale = MESH_BVH_BINS / extent[bestAxis];
+			float origin = centerBox.min[bestAxis];
+			auto middle = partition(context.order.begin() + begin, context.order.begin() + end, [&](int triangle)
+			{
+				return min(MESH_BVH_BINS - 1, (int)((context.centers[triangle][bestAxis] - origin) * scale)) < bestSplit;
+			});
+			int mid = (int)(middle - context.order.begin());
+			if (mid > begin && mid < end)
+				return mid;
+		}
+
+		int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+		int mid = begin + (end - begin) / 2;
+		nth_element(context.order.begin() + begin, context.order.begin() + mid, context.order.begin() + end, [&](int a, int b)
+		{
+			return context.centers[a][axis] < context.centers[b][axis];
+		});
+		return mid;
+	}
+
+	// Monta a subárvore de order[begin, end) em nodes e devolve o índice da raiz dela
+	int buildSubtree(BuildContext& context, vector<BuildNode>& nodes, int begin, int end, int depth)
+	{
+		int index = (int)nodes.size();
+		nodes.emplace_back();
+		AABB box, centerBox;
+		rangeBounds(context, begin, end, box, centerBox);
+		nodes[index].box = box;
+		nodes[index].begin = begin;
+		nodes[index].end = end;
+		if (end - begin <= MESH_BVH_LEAF_SIZE)
+			return index;
+
+		int mid = splitRange(context, begin, end, centerBox, depth);
+		int left = buildSubtree(context, nodes, begin, mid, depth + 1);
+		int right = buildSubtree(context, nodes, mid, end, depth + 1);
+		nodes[index].left = left;
+		nodes[index].right = right;
+		return index;
+	}
+
+	// Níveis de cima, na thread que chama: subárvores com até grain triângulos viram tarefas
+	int buildTop(BuildContext& context, vector<BuildNode>& nodes, vector<BuildTask>& tasks, int begin, int end, int depth, int grain)
+	{
+		if (end - begin <= grain)
+		{
+			int index = (int)nodes.size();
+			nodes.emplace_back();
+			tasks.push_back({ index, begin, end, depth });
+			return index;
+		}
+		int index = (int)nodes.size();
+		nodes.emplace_back();
+		AABB box, centerBox;
+		rangeBounds(context, begin, end, box, centerBox);
+		nodes[index].box = box;
+		nodes[index].begin = begin;
+		nodes[index].end = end;
+
+		int mid = splitRange(context, begin, end, centerBox, depth);
+		int left = buildTop(context, nodes, tasks, begin, mid, depth + 1, grain);
+		int right = buildTop(context, nodes, tasks, mid, end, depth + 1, grain);
+		nodes[index].left = left;
+		nodes[index].right = right;
+		return index;
+	}
+}
+
+bool MeshBVH::build(const CachedMesh& mesh, unsigned maxThreads)
+{
+	return build(mesh.vertexData(), OBJ_FLOATS_PER_VERTEX, mesh.nVertices(), mesh.indexData(), mesh.nIndices(), maxThreads);
+}
+
+bool MeshBVH::build(const float* vertices, size_t floatsPerVertex, size_t nVertices, const unsigned int* indices, size_t nIndices,
+	unsigned maxThreads)
+{
+	auto t0 = chrono::high_resolution_clock::now();
+	clear();
+	int nTriangles = (int)(nIndices / 3);
+	if (!vertices || !indices || nTriangles == 0)
+		return false;
+	for (size_t i = 0; i < (size_t)nTriangles * 3; i++)
+		if (indices[i] >= nVertices)
+			return false;
+	ThreadPool& pool = ThreadPool::global();
+	unsigned threads = maxThreads > 0 ? maxThreads : pool.size() + 1;
+
+	// Caixa e centro de cada triângulo, em blocos nas threads do pool
+	auto position = [&](unsigned int index)
+	{
+		const float* p = vertices + (size_t)index * floatsPerVertex;
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+	BuildContext context;
+	context.boxes.resize(nTriangles);
+	context.centers.resize(nTriangles);
+	context.order.resize(nTriangles);
+	iota(context.order.begin(), context.order.end(), 0);
+	const int chunk = 4096;
+	pool.parallelFor((nTriangles + chunk - 1) / chunk, [&](size_t c)
+	{
+		int end = min(nTriangles, (int)(c + 1) * chunk);
+		for (int t = (int)c * chunk; t < end; t++)
+		{
+			glm::vec3 a = position(indices[3 * t]), b = position(indices[3 * t + 1]), d = position(indices[3 * t + 2]);
+			AABB& box = context.boxes[t];
+			box.min = glm::min(a, glm::min(b, d));
+			box.max = glm::max(a, glm::max(b, d));
+			context.centers[t] = box.center();
+		}
+	}, maxThreads);
+
+	// Árvore binária: os níveis de cima aqui, as subárvores em paralelo, cada uma no seu
+	// vetor, e depois tudo emendado em bin (a raiz de cada subárvore ocupa o nó reservado)
+	vector<BuildNode> bin;
+	bin.reserve(nTriangles / 2 + 1);
+	vector<BuildTask> tasks;
+	int grain = max(MESH_BVH_MIN_TASK, nTriangles / (int)(4 * threads));
+	buildTop(context, bin, tasks, 0, nTriangles, 0, grain);
+	vector<vector<BuildNode>> subtrees(tasks.size());
+	pool.parallelFor(tasks.size(), [&](size_t i)
+	{
+		subtrees[i].reserve((tasks[i].end - tasks[i].begin) / 2 + 1);
+		buildSubtree(context, subtrees[i], tasks[i].begin, tasks[i].end, tasks[i].depth);
+	}, maxThreads);
+	for (size_t i = 0; i < tasks.size(); i++)
+	{
+		const vector<BuildNode>& subtree = subtrees[i];
+		int offset = (int)bin.size() - 1; // nó local k > 0 vai para offset + k
+		auto relocate = [&](BuildNode node)
+		{
+			if (node.left >= 0)
+			{
+				node.left += offset;
+				node.right += offset;
+			}
+			return node;
+		};
+		bin[tasks[i].node] = relocate(subtree[0]);
+		for (size_t k = 1; k < subtree.size(); k++)
+			bin.push_back(relocate(subtree[k]));
+	}
+	vector<vector<BuildNode>>().swap(subtrees);
+
+	// Achatamento em nós de 4 filhos: cada nó recebe os netos da árvore binária,
+	// abrindo primeiro o filho de maior área, e as folhas viram blocos de triângulos
+	struct Collapse
+	{
+		MeshBVH& bvh;
+		const vector<BuildNode>& bin;
+		const vector<int>& order;
+		const float* vertices;
+		size_t floatsPerVertex;
+		const unsigned int* indices;
+
+		glm::vec3 position(unsigned int index) const
+		{
+			const float* p = this->vertices + (size_t)index * this->floatsPerVertex;
+			return glm::vec3(p[0], p[1], p[2]);
+		}
+
+		int leaf(const BuildNode& node)
+		{
+			TriangleBlock block;
+			for (int slot = 0; slot < 4; slot++)
+			{
+				glm::vec3 v0(0.0f), e1(0.0f), e2(0.0f);
+				block.ids[slot] = -1;
+				if (node.begin + slot < node.end)
+				{
+					int triangle = this->order[node.begin + slot];
+					v0 = position(this->indices[3 * triangle]);
+					e1 = position(this->indices[3 * triangle + 1]) - v0;
+					e2 = position(this->indices[3 * triangle + 2]) - v0;
+					block.ids[slot] = triangle;
+				}
+				block.v0x[slot] = v0.x; block.v0y[slot] = v0.y; block.v0z[slot] = v0.z;
+				block.e1x[slot] = e1.x; block.e1y[slot] = e1.y; block.e1z[slot] = e1.z;
+				block.e2x[slot] = e2.x; block.e2y[slot] = e2.y; block.e2z[slot] = e2.z;
+			}
+			this->bvh.blocks.push_back(block);
+			return ~((int)this->bvh.blocks.size() - 1);
+		}
+
+		int node(int b)
+		{
+			int candidates[4];
+			int n = 0;
+			if (this->bin[b].left < 0)
+			{
+				candidates[n++] = b;
+			}
+			else
+			{
+				candidates[n++] = this->bin[b].left;
+				candidates[n++] = this->bin[b].right;
+			}
+			while (n < 4)
+			{
+				int best = -1;
+				float bestArea = -1.0f;
+				for (int i = 0; i < n; i++)
+				{
+					const BuildNode& candidate = this->bin[candidates[i]];
+					if (candidate.left >= 0 && candidate.box.halfArea() > bestArea)
+					{
+						best = i;
+						bestArea = candidate.box.halfArea();
+					}
+				}
+				if (best < 0)
+					break;
+				int opened = candidates[best];
+				candidates[best] = this->bin[opened].left;
+				candidates[n++] = this->bin[opened].right;
+			}
+
+			int index = (int)this->bvh.nodes.size();
+			this->bvh.nodes.emplace_back();
+			int children[4];
+			for (int i = 0; i < n; i++)
+			{
+				const BuildNode& candidate = this->bin[candidates[i]];
+				children[i] = candidate.left < 0 ? leaf(candidate) : node(candidates[i]);
+			}
+			Node& out = this->bvh.nodes[index];
+			for (int slot = 0; slot < 4; slot++)
+			{
+				AABB box;
+				box.min = glm::vec3(1e30f);
+				box.max = glm::vec3(-1e30f);
+				out.child[slot] = 0;
+				if (slot < n)
+				{
+					box = this->bin[candidates[slot]].box;
+					out.child[slot] = children[slot];
+				}
+				out.minX[slot] = box.min.x; out.minY[slot] = box.min.y; out.minZ[slot] = box.min.z;
+				out.maxX[slot] = box.max.x; out.maxY[slot] = box.max.y; out.maxZ[slot] = box.max.z;
+			}
+			return index;
+		}
+	};
+	this->nodes.reserve(bin.size() / 2 + 1);
+	this->blocks.reserve(bin.size() / 2 + 1);
+	Collapse collapse{ *this, bin, context.order, vertices, floatsPerVertex, indices };
+	collapse.node(0);
+
+	this->rootBounds = bin[0].box;
+	this->triangleCount = nTriangles;
+	this->buildMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - t0).count();
+	return true;
+}
+
+void MeshBVH::clear()
+{
+	this->nodes.clear();
+	this->blocks.clear();
+	this->rootBounds = AABB();
+	this->triangleCount = 0;
+}
+
+// ----------------------------------------------------------------------------
+// Travessia
+// ----------------------------------------------------------------------------
+
+// Descida com pilha: dos 4 filhos de um nó, os acertados entram na pilha do mais longe
+// para o mais perto, com a distância de entrada na caixa; um filho cuja entrada já está
+// além do acerto mais próximo encontrado é descartado ao sair da pilha. As caixas usam
+// o teste de placas (slabs) com a placa de entrada escolhida pelo sinal da direção, o
+// que faz as caixas invertidas dos filhos vazios nunca serem acertadas. Os triângulos
+// usam o teste de Möller e Trumbore.
+template <bool anyHit>
+bool MeshBVH::traverse(const Ray& ray, RayHit& hit) const
+{
+	if (this->nodes.empty())
+		return false;
+
+	// Componentes nulas da direção viram um valor minúsculo (evita 0 * infinito = NaN)
+	glm::vec3 inverse;
+	for (int a = 0; a < 3; a++)
+	{
+		float d = ray.direction[a];
+		inverse[a] = 1.0f / (fabs(d) > 1e-20f ? d : (d >= 0.0f ? 1e-20f : -1e-20f));
+	}
+	const bool negX = ray.direction.x < 0.0f, negY = ray.direction.y < 0.0f, negZ = ray.direction.z < 0.0f;
+	float tBest = ray.tMax;
+	bool found = false;
+
+	struct Entry
+	{
+		int node;
+		float tNear;
+	};
+	// Até 3 irmãos pendentes por nível; abaixo de MESH_BVH_MAX_DEPTH as divisões pela
+	// mediana somam no máximo 32 níveis
+	Entry stack[3 * (MESH_BVH_MAX_DEPTH + 32) + 1];
+	int top = 0;
+	stack[top++] = { 0, ray.tMin };
+
+#if defined(MESH_BVH_SSE2)
+	const __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+	const __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+	const __m128 ix = _mm_set1_ps(inverse.x), iy = _mm_set1_ps(inverse.y), iz = _mm_set1_ps(inverse.z);
+	const __m128 tMin = _mm_set1_ps(ray.tMin), zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+#endif
+
+	while (top > 0)
+	{
+		Entry entry = stack[--top];
+		if (entry.tNear > tBest)
+			continue;
+
+		if (entry.node < 0)
+		{
+			// Folha: até 4 triângulos
+			const TriangleBlock& block = this->blocks[~entry.node];
+			float t[4], u[4], v[4];
+			unsigned mask = 0;
+#if defined(MESH_BVH_SSE2)
+			if (this->simd)
+			{
+				__m128 e1x = _mm_load_ps(block.e1x), e1y = _mm_load_ps(block.e1y), e1z = _mm_load_ps(block.e1z);
+				__m128 e2x = _mm_load_ps(block.e2x), e2y = _mm_load_ps(block.e2y), e2z = _mm_load_ps(block.e2z);
+				__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+				__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+				__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+				__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+				__m128 invDet = _mm_div_ps(one, det);
+				__m128 sx = _mm_sub_ps(ox, _mm_load_ps(block.v0x)), sy = _mm_sub_ps(oy, _mm_load_ps(block.v0y)),
+					sz = _mm_sub_ps(oz, _mm_load_ps(block.v0z));
+				__m128 uu = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+				__m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+				__m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+				__m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+				__m128 vv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+				__m128 tt = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+				__m128 valid = _mm_cmpneq_ps(det, zero);
+				valid = _mm_and_ps(valid, _mm_cmpge_ps(uu, zero));
+				valid = _mm_and_ps(valid, _mm_cmpge_ps(vv, zero));
+				valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(uu, vv), one));
+				valid = _mm_and_ps(valid, _mm_cmpgt_ps(tt, tMin));
+				valid = _mm_and_ps(valid, _mm_cmplt_ps(tt, _mm_set1_ps(tBest)));
+				mask = (unsigned)_mm_movemask_ps(valid);
+				if (mask)
+				{
+					_mm_storeu_ps(t, tt);
+					_mm_storeu_ps(u, uu);
+					_mm_storeu_ps(v, vv);
+				}
+			}
+			else
+#endif
+			{
+				for (int slot = 0; slot < 4; slot++)
+				{
+					glm::vec3 e1(block.e1x[slot], block.e1y[slot], block.e1z[slot]);
+					glm::vec3 e2(block.e2x[slot], block.e2y[slot], block.e2z[slot]);
+					glm::vec3 p = glm::cross(ray.direction, e2);
+					float det = glm::dot(e1, p);
+					if (det == 0.0f)
+						continue;
+					float invDet = 1.0f / det;
+					glm::vec3 s = ray.origin - glm::vec3(block.v0x[slot], block.v0y[slot], block.v0z[slot]);
+					u[slot] = glm::dot(s, p) * invDet;
+					glm::vec3 q = glm::cross(s, e1);
+					v[slot] = glm::dot(ray.direction, q) * invDet;
+					t[slot] = glm::dot(e2, q) * invDet;
+					if (u[slot] >= 0.0f && v[slot] >= 0.0f && u[slot] + v[slot] <= 1.0f && t[slot] > ray.tMin && t[slot] < tBest)
+						mask |= 1u << slot;
+				}
+			}
+			if (mask && anyHit)
+				return true;
+			for (int slot = 0; slot < 4; slot++)
+			{
+				if (!(mask & (1u << slot)) || t[slot] >= tBest)
+					continue;
+				tBest = t[slot];
+				hit.t = t[slot];
+				hit.u = u[slot];
+				hit.v = v[slot];
+				hit.triangle = block.ids[slot];
+				found = true;
+			}
+			continue;
+		}
+
+		// Nó interno: entrada e saída do raio nas 4 caixas
+		const Node& node = this->nodes[entry.node];
+		float tNear[4];
+		unsigned mask = 0;
+#if defined(MESH_BVH_SSE2)
+		if (this->simd)
+		{
+			__m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(negX ? node.maxX : node.minX), ox), ix);
+			__m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(negX ? node.minX : node.maxX), ox), ix);
+			__m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(negY ? node.maxY : node.minY), oy), iy);
+			__m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(negY ? node.minY : node.maxY), oy), iy);
+			__m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(negZ ? node.maxZ : node.minZ), oz), iz);
+			__m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(negZ ? node.minZ : node.maxZ), oz), iz);
+			__m128 enter = _mm_max_ps(_mm_max_ps(x0, y0), _mm_max_ps(z0, tMin));
+			__m128 leave = _mm_min_ps(_mm_min_ps(x1, y1), _mm_min_ps(z1, _mm_set1_ps(tBest)));
+			mask = (unsigned)_mm_movemask_ps(_mm_cmple_ps(enter, leave));
+			_mm_storeu_ps(tNear, enter);
+		}
+		else
+#endif
+		{
+			for (int slot = 0; slot < 4; slot++)
+			{
+				float x0 = ((negX ? node.maxX : node.minX)[slot] - ray.origin.x) * inverse.x;
+				float x1 = ((negX ? node.minX : node.maxX)[slot] - ray.origin.x) * inverse.x;
+				float y0 = ((negY ? node.maxY : node.minY)[slot] - ray.origin.y) * inverse.y;
+				float y1 = ((negY ? node.minY : node.maxY)[slot] - ray.origin.y) * inverse.y;
+				float z0 = ((negZ ? node.maxZ : node.minZ)[slot] - ray.origin.z) * inverse.z;
+				float z1 = ((negZ ? node.minZ : node.maxZ)[slot] - ray.origin.z) * inverse.z;
+				tNear[slot] = max(max(x0, y0), max(z0, ray.tMin));
+				float tFar = min(min(x1, y1), min(z1, tBest));
+				if (tNear[slot] <= tFar)
+					mask |= 1u << slot;
+			}
+		}
+		if (!mask)
+			continue;
+
+		// Filhos acertados em ordem de distância (ordenação por inserção de até 4)
+		int order[4];
+		int n = 0;
+		for (int slot = 0; slot < 4; slot++)
+		{
+			if (!(mask & (1u << slot)))
+				continue;
+			int i = n++;
+			while (i > 0 && tNear[order[i - 1]] < tNear[slot])
+			{
+				order[i] = order[i - 1];
+				i--;
+			}
+			order[i] = slot;
+		}
+		// order vai do mais longe para o mais perto: o mais perto sai primeiro da pilha
+		for (int i = 0; i < n; i++)
+			stack[top++] = { node.child[order[i]], tNear[order[i]] };
+	}
+	return found;
+}
+
+bool MeshBVH::intersect(const Ray& ray, RayHit& hit) const
+{
+	hit = RayHit();
+	return traverse<false>(ray, hit);
+}
+
+bool MeshBVH::occluded(const Ray& ray) const
+{
+	RayHit hit;
+	return traverse<true>(ray, hit);
+}
+
+// Lotes de BATCH raios por item do parallelFor
+const size_t BATCH = 256;
+
+void MeshBVH::intersect(const Ray* rays, RayHit* hits, size_t count, unsigned maxThreads) const
+{
+	ThreadPool::global().parallelFor((count + BATCH - 1) / BATCH, [&](size_t b)
+	{
+		size_t end = min(count, (b + 1) * BATCH);
+		for (size_t i = b * BATCH; i < end; i++)
+			intersect(rays[i], hits[i]);
+	}, maxThreads);
+}
+
+void MeshBVH::occluded(const Ray* rays, uint8_t* results, size_t count, unsigned maxThreads) const
+{
+	ThreadPool::global().parallelFor((count + BATCH - 1) / BATCH, [&](size_t b)
+	{
+		size_t end = min(count, (b + 1) * BATCH);
+		for (size_t i = b * BATCH; i < end; i++)
+			results[i] = occluded(rays[i]) ? 1 : 0;
+	}, maxThreads);
+}
@@ -0,0 +1,356 @@
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+using namespace std;
+
+uint64_t hashBytes(const void* data, size_t size)
+{
+	const unsigned char* p = (const unsigned char*)data;
+	const uint64_t prime = 0x9E3779B97F4A7C15ull;
+	uint64_t h = 0xCBF29CE484222325ull ^ (size * prime);
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		uint64_t k;
+		memcpy(&k, p + i, 8);
+		k *= 0xFF51AFD7ED558CCDull;
+		k ^= k >> 32;
+		h = (h ^ k) * prime;
+		h ^= h >> 29;
+	}
+	for (; i < size; i++)
+		h = (h ^ p[i]) * 0x100000001B3ull;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+string meshCachePath(const string& objPath)
+{
+	return objPath + ".cgmesh";
+}
+
+bool sourceStats(const string& path, uint64_t& size, int64_t& mtime)
+{
+	error_code ec;
+	size = (uint64_t)filesystem::file_size(path, ec);
+	if (ec)
+		return false;
+	auto time = filesystem::last_write_time(path, ec);
+	if (ec)
+		return false;
+	mtime = (int64_t)time.time_since_epoch().count();
+	return true;
+}
+
+static size_t align16(size_t offset)
+{
+	return (offset + 15) & ~(size_t)15;
+}
+
+// Lista de strings terminadas em '\0', uma após a outra
+static string joinNames(const vector<string>& names)
+{
+	string joined;
+	for (const string& name : names)
+	{
+		joined += name;
+		joined += '\0';
+	}
+	return joined;
+}
+
+static void splitNames(const char* data, uint64_t size, vector<string>& names)
+{
+	names.clear();
+	const char* end = data + size;
+	while (data < end)
+	{
+		const char* stop = (const char*)memchr(data, '\0', (size_t)(end - data));
+		if (stop == nullptr)
+			stop = end;
+		names.emplace_back(data, stop);
+		data = stop + 1;
+	}
+}
+
+bool writeMeshCache(const string& objPath, const IndexedMesh& mesh)
+{
+	MappedFile source;
+	if (!source.open(objPath))
+		return false;
+
+	MeshCacheHeader header;
+	header.magic = MESH_CACHE_MAGIC;
+	header.version = MESH_CACHE_VERSION;
+	if (!sourceStats(objPath, header.sourceSize, header.sourceMTime))
+		return false;
+	header.sourceHash = hashBytes(source.data(), source.size());
+	header.floatsPerVertex = OBJ_FLOATS_PER_VERTEX;
+
+	string names = joinNames(mesh.materialNames);
+	string libs = joinNames(mesh.materialLibs);
+	vector<MeshCacheLOD> lods;
+	for (size_t l = 0; l < mesh.lods.size(); l++)
+		for (const Submesh& submesh : mesh.lods[l].submeshes)
+			lods.push_back({ (uint32_t)l + 1, mesh.lods[l].error, submesh });
+	const int nSections = 7;
+	header.nSections = nSections;
+	MeshCacheSection sections[nSections];
+	sections[0].type = MESH_SECTION_VERTICES;
+	sections[0].size = mesh.vertices.size() * sizeof(float);
+	sections[1].type = MESH_SECTION_INDICES;
+	sections[1].size = mesh.indices.size() * sizeof(unsigned int);
+	sections[2].type = MESH_SECTION_SUBMESHES;
+	sections[2].size = mesh.submeshes.size() * sizeof(Submesh);
+	sections[3].type = MESH_SECTION_MATERIAL_NAMES;
+	sections[3].size = names.size();
+	sections[4].type = MESH_SECTION_MATERIAL_LIBS;
+	sections[4].size = libs.size();
+	sections[5].type = MESH_SECTION_LOD_INDICES;
+	sections[5].size = mesh.lodIndices.size() * sizeof(unsigned int);
+	sections[6].type = MESH_SECTION_LODS;
+	sections[6].size = lods.size() * sizeof(MeshCacheLOD);
+	const void* payload[nSections] = { mesh.vertices.data(), mesh.indices.data(), mesh.submeshes.data(), names.data(), libs.data(),
+		mesh.lodIndices.data(), lods.data() };
+
+	size_t offset = align16(sizeof(header) + sizeof(sections));
+	for (int i = 0; i < nSections; i++)
+	{
+		sections[i].reserved = 0;
+		sections[i].offset = offset;
+		offset = align16(offset + (size_t)sections[i].size);
+	}
+
+	// Grava em um arquivo temporário e renomeia, para que uma execução interrompida
+	// nunca deixe um cache pela metade
+	string path = meshCachePath(objPath);
+	string tmpPath = path + ".tmp";
+	{
+		ofstream out(tmpPath, ios::binary | ios::trunc);
+		if (!out)
+			return false;
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)sections, sizeof(sections));
+		static const char zeros[16] = {};
+		size_t written = sizeof(header) + sizeof(sections);
+		for (int i = 0; i < nSections; i++)
+		{
+			out.write(zeros, sections[i].offset - written);
+			out.write((const char*)payload[i], sections[i].size);
+			written = sections[i].offset + sections[i].size;
+		}
+		if (!out)
+			return false;
+	}
+	error_code ec;
+	filesystem::rename(tmpPath, path, ec);
+	if (ec)
+	{
+		filesystem::remove(tmpPath, ec);
+		return false;
+	}
+	return true;
+}
+
+// Faixa [first, first + count) dentro de [begin, begin + size), sem somar (a soma
+// pode dar a volta com valores de um cache estragado)
+static bool rangeInside(const Submesh& part, uint64_t begin, uint64_t size)
+{
+	return part.firstIndex >= begin && part.firstIndex - begin <= size && part.indexCount <= size - (part.firstIndex - begin);
+}
+
+static bool indicesBelow(const unsigned int* indices, uint64_t count, uint64_t nVertices)
+{
+	unsigned int maxIndex = 0;
+	for (uint64_t k = 0; k < count; k++)
+		maxIndex = max(maxIndex, indices[k]);
+	return count == 0 || maxIndex < nVertices;
+}
+
+bool CachedMesh::openCache(const string& objPath)
+{
+	this->cacheFile.close();
+	this->cacheHit = false;
+
+	uint64_t size;
+	int64_t mtime;
+	if (!sourceStats(objPath, size, mtime))
+		return false;
+
+	string path = meshCachePath(objPath);
+	if (!this->cacheFile.open(path) || this->cacheFile.size() < sizeof(MeshCacheHeader))
+		return false;
+
+	const char* base = this->cacheFile.data();
+	MeshCacheHeader header;
+	memcpy(&header, base, sizeof(header));
+	if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION ||
+		header.floatsPerVertex != OBJ_FLOATS_PER_VERTEX || header.sourceSize != size ||
+		sizeof(header) + header.nSections * sizeof(MeshCacheSection) > this->cacheFile.size())
+	{
+		this->cacheFile.close();
+		return false;
+	}
+
+	if (header.sourceMTime != mtime)
+	{
+		// Arquivo tocado (cópia, checkout...): confere o conteúdo antes de descartar o cache
+		MappedFile source;
+		if (!source.open(objPath) || hashBytes(source.data(), source.size()) != header.sourceHash)
+		{
+			this->cacheFile.close();
+			return false;
+		}
+		this->cacheFile.close();
+		header.sourceMTime = mtime;
+		{
+			fstream patch(path, ios::binary | ios::in | ios::out);
+			patch.write((const char*)&header, sizeof(header));
+		}
+		if (!this->cacheFile.open(path))
+			return false;
+		base = this->cacheFile.data();
+	}
+
+	uint64_t vSize = 0, iSize = 0, sSize = 0, nSize = 0, lSize = 0, liSize = 0, ldSize = 0;
+	const void* v = section(MESH_SECTION_VERTICES, &vSize);
+	const void* i = section(MESH_SECTION_INDICES, &iSize);
+	const void* s = section(MESH_SECTION_SUBMESHES, &sSize);
+	const void* n = section(MESH_SECTION_MATERIAL_NAMES, &nSize);
+	const void* l = section(MESH_SECTION_MATERIAL_LIBS, &lSize);
+	const void* li = section(MESH_SECTION_LOD_INDICES, &liSize);
+	const void* ld = section(MESH_SECTION_LODS, &ldSize);
+	// Seções com tamanho que não é múltiplo do elemento: cache estragado
+	if (v == nullptr || i == nullptr || s == nullptr || n == nullptr || l == nullptr || li == nullptr || ld == nullptr ||
+		vSize % (OBJ_FLOATS_PER_VERTEX * sizeof(float)) != 0 || iSize % sizeof(unsigned int) != 0 ||
+		sSize % sizeof(Submesh) != 0)
+	{
+		this->cacheFile.close();
+		return false;
+	}
+	uint64_t nVertices = vSize / (OBJ_FLOATS_PER_VERTEX * sizeof(float));
+	uint64_t nIndices = iSize / sizeof(unsigned int);
+	uint64_t nLodIndices = liSize / sizeof(unsigned int);
+	this->parts.resize((size_t)(sSize / sizeof(Submesh)));
+	memcpy(this->parts.data(), s, this->parts.size() * sizeof(Submesh));
+	splitNames((const char*)n, nSize, this->names);
+	splitNames((const char*)l, lSize, this->libs);
+	this->levels.clear();
+	// As faixas e os índices são usados sem conferência (BVH, oclusores, glDrawElements):
+	// um cache truncado ou de outra versão da malha tem que ser recusado aqui
+	bool valid = liSize % sizeof(unsigned int) == 0 && ldSize % sizeof(MeshCacheLOD) == 0 &&
+		indicesBelow((const unsigned int*)i, nIndices, nVertices) &&
+		indicesBelow((const unsigned int*)li, nLodIndices, nVertices);
+	for (size_t p = 0; valid && p < this->parts.size(); p++)
+		valid = rangeInside(this->parts[p], 0, nIndices);
+	for (uint64_t r = 0; valid && r < ldSize / sizeof(MeshCacheLOD); r++)
+	{
+		MeshCacheLOD record;
+		memcpy(&record, (const char*)ld + r * sizeof(MeshCacheLOD), sizeof(record));
+		// Os níveis vêm em ordem (1, 2...), cada um com as suas submeshes seguidas na
+		// faixa dos índices dos LODs, que começa depois dos índices do nível 0: um
+		// registro que não continua o nível atual nem abre o próximo é cache estragado
+		bool opensLevel = record.level == this->levels.size() + 1;
+		bool continuesLevel = !this->levels.empty() && record.level == this->levels.size() &&
+			record.submesh.firstIndex == (uint64_t)this->levels.back().firstIndex + this->levels.back().indexCount;
+		if ((!opensLevel && !continuesLevel) || !rangeInside(record.submesh, nIndices, nLodIndices))
+		{
+			valid = false;
+			break;
+		}
+		if (opensLevel)
+		{
+			MeshLOD lod;
+			lod.error = record.error;
+			lod.firstIndex = record.submesh.firstIndex;
+			lod.indexCount = 0;
+			this->levels.push_back(lod);
+		}
+		this->levels.back().submeshes.push_back(record.submesh);
+		this->levels.back().indexCount += record.submesh.indexCount;
+	}
+	if (!valid)
+	{
+		this->levels.clear();
+		this->parts.clear();
+		this->names.clear();
+		this->libs.clear();
+		this->cacheFile.close();
+		return false;
+	}
+	this->lodIndices = (const unsigned int*)li;
+	this->lodIndexCount = (size_t)nLodIndices;
+	this->vertices = (const float*)v;
+	this->indices = (const unsigned int*)i;
+	this->vertexCount = (size_t)nVertices;
+	this->indexCount = (size_t)nIndices;
+	this->meshBounds = computeMeshBounds(this->vertices, this->vertexCount);
+	this->cacheHit = true;
+	return true;
+}
+
+const void* CachedMesh::section(uint32_t type, uint64_t* size) const
+{
+	if (!this->cacheFile.isOpen() || this->cacheFile.size() < sizeof(MeshCacheHeader))
+		return nullptr;
+	const char* base = this->cacheFile.data();
+	uint64_t fileSize = this->cacheFile.size();
+	MeshCacheHeader header;
+	memcpy(&header, base, sizeof(header));
+	if ((fileSize - sizeof(header)) / sizeof(MeshCacheSection) < header.nSections)
+		return nullptr;
+	for (uint32_t s = 0; s < header.nSections; s++)
+	{
+		MeshCacheSection sec;
+		memcpy(&sec, base + sizeof(header) + s * sizeof(MeshCacheSection), sizeof(sec));
+		// Sem somar offset + size: num cache estragado a soma pode dar a volta
+		if (sec.type == type && sec.offset <= fileSize && sec.size <= fileSize - sec.offset)
+		{
+			if (size)
+				*size = sec.size;
+			return base + sec.offset;
+		}
+	}
+	return nullptr;
+}
+
+void CachedMesh::setFromMesh()
+{
+	this->vertices = this->mesh.vertices.data();
+	this->indices = this->mesh.indices.data();
+	this->vertexCount = (size_t)this->mesh.nVertices();
+	this->indexCount = this->mesh.indices.size();
+	this->cacheHit = false;
+	this->parts = this->mesh.submeshes;
+	this->names = this->mesh.materialNames;
+	this->libs = this->mesh.materialLibs;
+	this->levels = this->mesh.lods;
+	this->lodIndices = this->mesh.lodIndices.data();
+	this->lodIndexCount = this->mesh.lodIndices.size();
+	this->meshBounds = computeMeshBounds(this->vertices, this->vertexCount);
+}
+
+bool CachedMesh::load(const string& objPath, bool useCache)
+{
+	if (useCache && openCache(objPath))
+		return true;
+
+	OBJData data;
+	if (!loadOBJ(objPath, data, 0))
+		return false;
+	buildIndexedMesh(data, this->mesh);
+	optimizeMesh(this->mesh);
+	buildLODs(this->mesh);
+	setFromMesh();
+	if (useCache)
+		writeMeshCache(objPath, this->mesh);
+	return true;
+}
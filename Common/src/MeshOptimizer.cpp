@@ -0,0 +1,826 @@
+#include "MeshOptimizer.h"
+#include "ThreadPool.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <unordered_map>
+
+using namespace std;
+
+static glm::vec3 positionOf(const float* vertices, unsigned int v)
+{
+	const float* p = vertices + (size_t)v * OBJ_FLOATS_PER_VERTEX;
+	return glm::vec3(p[0], p[1], p[2]);
+}
+
+// ----------------------------------------------------------------------------
+// Cache de vértices (Tipsify)
+// ----------------------------------------------------------------------------
+
+void optimizeVertexCache(unsigned int* indices, size_t nIndices, size_t nVertices, int cacheSize)
+{
+	size_t nTriangles = nIndices / 3;
+	if (nTriangles == 0)
+		return;
+
+	// Adjacência vértice -> triângulos em formato compacto (offsets + lista)
+	vector<unsigned int> live(nVertices, 0);
+	for (size_t i = 0; i < nTriangles * 3; i++)
+		live[indices[i]]++;
+	vector<size_t> adjacencyStart(nVertices + 1, 0);
+	for (size_t v = 0; v < nVertices; v++)
+		adjacencyStart[v + 1] = adjacencyStart[v] + live[v];
+	vector<unsigned int> adjacency(nTriangles * 3);
+	{
+		vector<size_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+		for (size_t i = 0; i < nTriangles * 3; i++)
+			adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+	}
+
+	vector<unsigned int> output;
+	output.reserve(nTriangles * 3);
+	vector<unsigned int> cacheTime(nVertices, 0);
+	vector<char> emitted(nTriangles, 0);
+	vector<unsigned int> deadEnd; // vértices recentes, para recomeçar perto de onde parou
+	vector<unsigned int> candidates;
+	unsigned int timestamp = cacheSize + 1;
+	size_t cursor = 0; // próximo índice da varredura sequencial, quando todo o resto falha
+
+	int fanning = (int)indices[0];
+	while (fanning >= 0)
+	{
+		// Emite todos os triângulos ainda não desenhados em volta do vértice atual
+		candidates.clear();
+		for (size_t a = adjacencyStart[fanning]; a < adjacencyStart[fanning + 1]; a++)
+		{
+			unsigned int t = adjacency[a];
+			if (emitted[t])
+				continue;
+			emitted[t] = 1;
+			for (int k = 0; k < 3; k++)
+			{
+				unsigned int v = indices[t * 3 + k];
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (timestamp - cacheTime[v] > (unsigned int)cacheSize)
+					cacheTime[v] = timestamp++;
+			}
+		}
+
+		// Próximo vértice: o que ainda estará no cache depois de emitir seus triângulos
+		// e que esteja há mais tempo nele
+		int best = -1, bestPriority = -1;
+		for (unsigned int v : candidates)
+		{
+			if (live[v] == 0)
+				continue;
+			int priority = 0;
+			if (timestamp - cacheTime[v] + 2 * live[v] <= (unsigned int)cacheSize)
+				priority = (int)(timestamp - cacheTime[v]);
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				best = (int)v;
+			}
+		}
+		// Beco sem saída: volta para vértices emitidos recentemente e, por último,
+		// procura o próximo triângulo pendente na ordem original
+		while (best < 0 && !deadEnd.empty())
+		{
+			unsigned int v = deadEnd.back();
+			deadEnd.pop_back();
+			if (live[v] > 0)
+				best = (int)v;
+		}
+		while (best < 0 && cursor < nTriangles * 3)
+		{
+			unsigned int v = indices[cursor++];
+			if (live[v] > 0)
+				best = (int)v;
+		}
+		fanning = best;
+	}
+
+	copy(output.begin(), output.end(), indices);
+}
+
+// ----------------------------------------------------------------------------
+// Overdraw
+// ----------------------------------------------------------------------------
+
+// Simula o cache FIFO e devolve quantos vértices do triângulo t foram transformados
+static int cacheMisses(const unsigned int* indices, size_t t, vector<unsigned int>& cacheTime, unsigned int& timestamp, int cacheSize)
+{
+	int misses = 0;
+	for (int k = 0; k < 3; k++)
+	{
+		unsigned int v = indices[t * 3 + k];
+		if (timestamp - cacheTime[v] > (unsigned int)cacheSize)
+		{
+			cacheTime[v] = timestamp++;
+			misses++;
+		}
+	}
+	return misses;
+}
+
+void optimizeOverdraw(unsigned int* indices, size_t nIndices, const float* vertices, size_t nVertices,
+	float threshold, int cacheSize)
+{
+	size_t nTriangles = nIndices / 3;
+	if (nTriangles < 2)
+		return;
+
+	// Fronteiras rígidas: triângulos em que o cache não aproveitou nenhum vértice
+	// (o Tipsify recomeçou em outro ponto da malha)
+	vector<size_t> hard;
+	{
+		vector<unsigned int> cacheTime(nVertices, 0);
+		unsigned int timestamp = cacheSize + 1;
+		for (size_t t = 0; t < nTriangles; t++)
+			if (cacheMisses(indices, t, cacheTime, timestamp, cacheSize) == 3)
+				hard.push_back(t);
+	}
+	hard.push_back(nTriangles);
+
+	// Fronteiras suaves: dentro de cada trecho rígido, corta assim que o ACMR do pedaço
+	// desde o último corte fica abaixo de threshold vezes o ACMR do trecho inteiro. O
+	// cache é esvaziado no início de cada pedaço (somar cacheSize + 1 ao timestamp
+	// invalida todas as entradas), porque depois da reordenação nada garante o que
+	// foi desenhado antes dele.
+	vector<size_t> clusters;
+	{
+		vector<unsigned int> cacheTime(nVertices, 0);
+		unsigned int timestamp = cacheSize + 1;
+		for (size_t h = 0; h + 1 < hard.size(); h++)
+		{
+			size_t first = hard[h], last = hard[h + 1];
+			timestamp += cacheSize + 1;
+			int clusterMisses = 0;
+			for (size_t t = first; t < last; t++)
+				clusterMisses += cacheMisses(indices, t, cacheTime, timestamp, cacheSize);
+			double limit = threshold * clusterMisses / (double)(last - first);
+
+			timestamp += cacheSize + 1;
+			size_t start = first;
+			int misses = 0;
+			clusters.push_back(first);
+			for (size_t t = first; t < last; t++)
+			{
+				misses += cacheMisses(indices, t, cacheTime, timestamp, cacheSize);
+				if (t + 1 < last && misses / (double)(t + 1 - start) <= limit)
+				{
+					clusters.push_back(t + 1);
+					start = t + 1;
+					misses = 0;
+					timestamp += cacheSize + 1;
+				}
+			}
+		}
+	}
+	clusters.push_back(nTriangles);
+	size_t nClusters = clusters.size() - 1;
+	if (nClusters < 2)
+		return;
+
+	// Centro da malha e, por trecho, centro e normal média (ponderados pela área)
+	glm::dvec3 meshCenter(0.0);
+	double meshArea = 0.0;
+	vector<glm::dvec3> centers(nClusters), normals(nClusters);
+	for (size_t c = 0; c < nClusters; c++)
+	{
+		glm::dvec3 center(0.0), normal(0.0);
+		double area = 0.0;
+		for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			glm::dvec3 a = positionOf(vertices, indices[t * 3]);
+			glm::dvec3 b = positionOf(vertices, indices[t * 3 + 1]);
+			glm::dvec3 d = positionOf(vertices, indices[t * 3 + 2]);
+			glm::dvec3 n = glm::cross(b - a, d - a); // |n| = 2 * área
+			double w = glm::length(n);
+			center += (a + b + d) * (w / 3.0);
+			normal += n;
+			area += w;
+		}
+		meshCenter += center;
+		meshArea += area;
+		centers[c] = area > 0.0 ? center / area : glm::dvec3(positionOf(vertices, indices[clusters[c] * 3]));
+		double length = glm::length(normal);
+		normals[c] = length > 0.0 ? normal / length : glm::dvec3(0.0);
+	}
+	if (meshArea > 0.0)
+		meshCenter /= meshArea;
+
+	// Trechos voltados para fora e longe do centro tendem a ocultar os demais
+	vector<double> sortKey(nClusters);
+	vector<size_t> order(nClusters);
+	for (size_t c = 0; c < nClusters; c++)
+	{
+		sortKey[c] = glm::dot(centers[c] - meshCenter, normals[c]);
+		order[c] = c;
+	}
+	stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+	vector<unsigned int> sorted;
+	sorted.reserve(nTriangles * 3);
+	for (size_t c : order)
+		sorted.insert(sorted.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+	copy(sorted.begin(), sorted.end(), indices);
+}
+
+// ----------------------------------------------------------------------------
+// Busca de vértices e malha inteira
+// ----------------------------------------------------------------------------
+
+void optimizeVertexFetch(IndexedMesh& mesh)
+{
+	size_t nVertices = (size_t)mesh.nVertices();
+	const unsigned int unused = numeric_limits<unsigned int>::max();
+	vector<unsigned int> remap(nVertices, unused);
+	unsigned int next = 0;
+	for (unsigned int& index : mesh.indices)
+	{
+		if (remap[index] == unused)
+			remap[index] = next++;
+		index = remap[index];
+	}
+	for (size_t v = 0; v < nVertices; v++)
+		if (remap[v] == unused)
+			remap[v] = next++;
+
+	vector<float> reordered(mesh.vertices.size());
+	for (size_t v = 0; v < nVertices; v++)
+		copy(mesh.vertices.begin() + v * OBJ_FLOATS_PER_VERTEX, mesh.vertices.begin() + (v + 1) * OBJ_FLOATS_PER_VERTEX,
+			reordered.begin() + (size_t)remap[v] * OBJ_FLOATS_PER_VERTEX);
+	mesh.vertices.swap(reordered);
+}
+
+void optimizeMesh(IndexedMesh& mesh)
+{
+	size_t nVertices = (size_t)mesh.nVertices();
+	for (const Submesh& submesh : mesh.submeshes)
+	{
+		unsigned int* indices = mesh.indices.data() + submesh.firstIndex;
+		optimizeVertexCache(indices, submesh.indexCount, nVertices);
+		optimizeOverdraw(indices, submesh.indexCount, mesh.vertices.data(), nVertices);
+	}
+	if (mesh.submeshes.empty() && !mesh.indices.empty())
+	{
+		optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), nVertices);
+		optimizeOverdraw(mesh.indices.data(), mesh.indices.size(), mesh.vertices.data(), nVertices);
+	}
+	optimizeVertexFetch(mesh);
+}
+
+// ----------------------------------------------------------------------------
+// Simuladores
+// ----------------------------------------------------------------------------
+
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t nIndices, size_t nVertices, int cacheSize)
+{
+	VertexCacheStats stats;
+	size_t nTriangles = nIndices / 3;
+	if (nTriangles == 0)
+		return stats;
+
+	vector<unsigned int> cacheTime(nVertices, 0);
+	vector<char> used(nVertices, 0);
+	unsigned int timestamp = cacheSize + 1;
+	size_t misses = 0, unique = 0;
+	for (size_t t = 0; t < nTriangles; t++)
+		misses += cacheMisses(indices, t, cacheTime, timestamp, cacheSize);
+	for (size_t i = 0; i < nTriangles * 3; i++)
+		if (!used[indices[i]])
+		{
+			used[indices[i]] = 1;
+			unique++;
+		}
+	stats.acmr = misses / (double)nTriangles;
+	stats.atvr = misses / (double)unique;
+	return stats;
+}
+
+// Rasteriza os triângulos em ordem com teste de profundidade, contando os fragmentos
+// que passam no teste (seriam sombreados com early-z)
+static void rasterizeView(const unsigned int* indices, size_t nTriangles, const vector<glm::vec3>& projected,
+	int resolution, vector<float>& depth, size_t& shaded)
+{
+	fill(depth.begin(), depth.end(), numeric_limits<float>::max());
+	for (size_t t = 0; t < nTriangles; t++)
+	{
+		glm::vec3 a = projected[indices[t * 3]];
+		glm::vec3 b = projected[indices[t * 3 + 1]];
+		glm::vec3 c = projected[indices[t * 3 + 2]];
+		float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+		if (area == 0.0f)
+			continue;
+		if (area < 0.0f) // sem culling de faces: as duas orientações são desenhadas
+		{
+			swap(b, c);
+			area = -area;
+		}
+
+		int minX = max(0, (int)floor(min(a.x, min(b.x, c.x))));
+		int maxX = min(resolution - 1, (int)ceil(max(a.x, max(b.x, c.x))));
+		int minY = max(0, (int)floor(min(a.y, min(b.y, c.y))));
+		int maxY = min(resolution - 1, (int)ceil(max(a.y, max(b.y, c.y))));
+		for (int y = minY; y <= maxY; y++)
+		{
+			float py = y + 0.5f;
+			for (int x = minX; x <= maxX; x++)
+			{
+				float px = x + 0.5f;
+				float w0 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+				float w1 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+				float w2 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+					continue;
+				float z = (w0 * a.z + w1 * b.z + w2 * c.z) / area;
+				float& stored = depth[(size_t)y * resolution + x];
+				if (z < stored)
+				{
+					stored = z;
+					shaded++;
+				}
+			}
+		}
+	}
+}
+
+OverdrawStats analyzeOverdraw(const unsigned int* indices, size_t nIndices, const float* vertices, size_t nVertices,
+	int resolution)
+{
+	OverdrawStats stats;
+	size_t nTriangles = nIndices / 3;
+	if (nTriangles == 0 || nVertices == 0)
+		return stats;
+
+	glm::vec3 lo(numeric_limits<float>::max()), hi(-numeric_limits<float>::max());
+	for (size_t v = 0; v < nVertices; v++)
+	{
+		glm::vec3 p = positionOf(vertices, (unsigned int)v);
+		lo = glm::min(lo, p);
+		hi = glm::max(hi, p);
+	}
+	glm::vec3 extent = hi - lo;
+	float scale = (resolution - 1) / max(max(extent.x, extent.y), max(extent.z, 1e-12f));
+
+	vector<glm::vec3> projected(nVertices);
+	vector<float> depth((size_t)resolution * resolution);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		int u = (axis + 1) % 3, w = (axis + 2) % 3;
+		for (int side = -1; side <= 1; side += 2)
+		{
+			// Observador em +axis (side = 1) ou -axis olhando para o centro
+			for (size_t v = 0; v < nVertices; v++)
+			{
+				glm::vec3 p = (positionOf(vertices, (unsigned int)v) - lo) * scale;
+				projected[v] = glm::vec3(p[u], p[w], -side * p[axis]);
+			}
+			rasterizeView(indices, nTriangles, projected, resolution, depth, stats.pixelsShaded);
+			for (float z : depth)
+				if (z != numeric_limits<float>::max())
+					stats.pixelsCovered++;
+		}
+	}
+	stats.overdraw = stats.pixelsCovered > 0 ? stats.pixelsShaded / (double)stats.pixelsCovered : 0.0;
+	return stats;
+}
+
+// ----------------------------------------------------------------------------
+// Simplificação (níveis de detalhe)
+// ----------------------------------------------------------------------------
+
+// Peso dos planos que prendem bordas, costuras e divisas entre materiais
+const double BOUNDARY_WEIGHT = 10.0;
+
+// Quádrica de erro: soma ponderada de (n·p + d)² dos planos acumulados (matriz 4x4
+// simétrica guardada em 10 coeficientes) e a soma dos pesos, para normalizar o erro
+struct Quadric
+{
+	double a00 = 0, a01 = 0, a02 = 0, a03 = 0, a11 = 0, a12 = 0, a13 = 0, a22 = 0, a23 = 0, a33 = 0;
+	double weight = 0;
+
+	void addPlane(const glm::dvec3& n, double d, double w)
+	{
+		a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z; a03 += w * n.x * d;
+		a11 += w * n.y * n.y; a12 += w * n.y * n.z; a13 += w * n.y * d;
+		a22 += w * n.z * n.z; a23 += w * n.z * d;
+		a33 += w * d * d;
+		weight += w;
+	}
+
+	void add(const Quadric& q)
+	{
+		a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+		a11 += q.a11; a12 += q.a12; a13 += q.a13;
+		a22 += q.a22; a23 += q.a23;
+		a33 += q.a33;
+		weight += q.weight;
+	}
+
+	// Distância quadrática média de p aos planos
+	double error(const glm::dvec3& p) const
+	{
+		double e = a00 * p.x * p.x + 2 * a01 * p.x * p.y + 2 * a02 * p.x * p.z + 2 * a03 * p.x
+			+ a11 * p.y * p.y + 2 * a12 * p.y * p.z + 2 * a13 * p.y
+			+ a22 * p.z * p.z + 2 * a23 * p.z
+			+ a33;
+		return weight > 0 ? fabs(e) / weight : 0.0;
+	}
+};
+
+static uint64_t edgeKey(unsigned int a, unsigned int b)
+{
+	return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+}
+
+vector<unsigned int> simplifyMesh(const unsigned int* indices, size_t nIndices, const float* vertices, size_t nVertices,
+	size_t targetCount, float maxError, float* resultError)
+{
+	if (resultError)
+		*resultError = 0.0f;
+	nIndices -= nIndices % 3;
+	if (nIndices <= targetCount || nIndices == 0)
+		return vector<unsigned int>(indices, indices + nIndices);
+
+	// Variações: os vértices usados (cada combinação de posição, uv e normal). Elas são
+	// soldadas por posição; os colapsos acontecem entre posições.
+	vector<unsigned int> wedgeVertex;
+	vector<int> wedgeOf(nVertices, -1);
+	vector<unsigned int> tris(nIndices);
+	for (size_t i = 0; i < nIndices; i++)
+	{
+		unsigned int v = indices[i];
+		if (wedgeOf[v] < 0)
+		{
+			wedgeOf[v] = (int)wedgeVertex.size();
+			wedgeVertex.push_back(v);
+		}
+		tris[i] = (unsigned int)wedgeOf[v];
+	}
+	size_t nWedges = wedgeVertex.size();
+
+	vector<unsigned int> byPosition(nWedges);
+	for (size_t w = 0; w < nWedges; w++)
+		byPosition[w] = (unsigned int)w;
+	auto positionLess = [&](unsigned int a, unsigned int b)
+	{
+		const float* pa = vertices + (size_t)wedgeVertex[a] * OBJ_FLOATS_PER_VERTEX;
+		const float* pb = vertices + (size_t)wedgeVertex[b] * OBJ_FLOATS_PER_VERTEX;
+		return lexicographical_compare(pa, pa + 3, pb, pb + 3);
+	};
+	sort(byPosition.begin(), byPosition.end(), positionLess);
+	vector<unsigned int> wedgePos(nWedges);
+	vector<glm::dvec3> positions;
+	for (size_t i = 0; i < nWedges; i++)
+	{
+		if (i == 0 || positionLess(byPosition[i - 1], byPosition[i]))
+			positions.push_back(glm::dvec3(positionOf(vertices, wedgeVertex[byPosition[i]])));
+		wedgePos[byPosition[i]] = (unsigned int)positions.size() - 1;
+	}
+	size_t nPositions = positions.size();
+
+	// Quádricas: plano de cada triângulo (ponderado pela área) e, nas arestas que
+	// não podem se mover livremente, um plano perpendicular ao triângulo pela aresta
+	vector<Quadric> quadrics(nPositions);
+	struct EdgeUse { unsigned int count; unsigned int wa, wb; bool seam; };
+	unordered_map<uint64_t, EdgeUse> edges;
+	edges.reserve(nIndices);
+	for (size_t t = 0; t < nIndices / 3; t++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			unsigned int wa = tris[t * 3 + k], wb = tris[t * 3 + (k + 1) % 3];
+			auto inserted = edges.emplace(edgeKey(wedgePos[wa], wedgePos[wb]), EdgeUse{ 1, wa, wb, false });
+			if (!inserted.second)
+			{
+				EdgeUse& use = inserted.first->second;
+				use.count++;
+				// A mesma aresta vista pelo outro triângulo: costura se as variações diferem
+				if (!((use.wa == wb && use.wb == wa) || (use.wa == wa && use.wb == wb)))
+					use.seam = true;
+			}
+		}
+	}
+	for (size_t t = 0; t < nIndices / 3; t++)
+	{
+		unsigned int p[3] = { wedgePos[tris[t * 3]], wedgePos[tris[t * 3 + 1]], wedgePos[tris[t * 3 + 2]] };
+		glm::dvec3 n = glm::cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]);
+		double area = glm::length(n);
+		if (area <= 0.0)
+			continue;
+		n /= area;
+		for (int k = 0; k < 3; k++)
+			quadrics[p[k]].addPlane(n, -glm::dot(n, positions[p[0]]), area * 0.5);
+
+		for (int k = 0; k < 3; k++)
+		{
+			const EdgeUse& use = edges[edgeKey(p[k], p[(k + 1) % 3])];
+			if (use.count == 2 && !use.seam)
+				continue;
+			glm::dvec3 edge = positions[p[(k + 1) % 3]] - positions[p[k]];
+			glm::dvec3 side = glm::cross(edge, n);
+			double length = glm::length(side);
+			if (length <= 0.0)
+				continue;
+			side /= length;
+			double w = BOUNDARY_WEIGHT * glm::dot(edge, edge);
+			quadrics[p[k]].addPlane(side, -glm::dot(side, positions[p[k]]), w);
+			quadrics[p[(k + 1) % 3]].addPlane(side, -glm::dot(side, positions[p[k]]), w);
+		}
+	}
+
+	size_t targetTriangles = targetCount / 3;
+	double errorLimit = (double)maxError * maxError;
+	double worst = 0.0;
+	vector<size_t> adjacencyStart(nPositions + 1);
+	vector<unsigned int> adjacency;
+	vector<unsigned int> wedgeRemap(nWedges);
+	vector<char> locked(nPositions);
+	struct Collapse { unsigned int from, to; double cost; };
+	vector<Collapse> candidates;
+	vector<pair<unsigned int, unsigned int>> mapping;
+
+	// Verifica o colapso from -> to e preenche mapping (variação removida -> variação
+	// que fica). Falha se alguma variação não tiver par ou se algum triângulo virar.
+	auto tryCollapse = [&](unsigned int from, unsigned int to) -> bool
+	{
+		mapping.clear();
+		for (size_t a = adjacencyStart[from]; a < adjacencyStart[from + 1]; a++)
+		{
+			const unsigned int* t = &tris[adjacency[a] * 3];
+			int kf = -1, kt = -1;
+			for (int k = 0; k < 3; k++)
+			{
+				if (wedgePos[t[k]] == from) kf = k;
+				if (wedgePos[t[k]] == to) kt = k;
+			}
+			if (kt < 0)
+				continue;
+			bool known = false;
+			for (const auto& m : mapping)
+				if (m.first == t[kf])
+				{
+					if (m.second != t[kt])
+						return false; // mesma variação indo para duas diferentes
+					known = true;
+				}
+			if (!known)
+				mapping.push_back({ t[kf], t[kt] });
+		}
+		for (size_t a = adjacencyStart[from]; a < adjacencyStart[from + 1]; a++)
+		{
+			const unsigned int* t = &tris[adjacency[a] * 3];
+			int kf = -1;
+			bool hasTo = false;
+			for (int k = 0; k < 3; k++)
+			{
+				if (wedgePos[t[k]] == from) kf = k;
+				if (wedgePos[t[k]] == to) hasTo = true;
+			}
+			if (hasTo)
+				continue;
+			bool paired = false;
+			for (const auto& m : mapping)
+				paired = paired || m.first == t[kf];
+			if (!paired)
+				return false; // a variação não encosta na aresta: cruzaria uma costura
+			glm::dvec3 p[3], q[3];
+			for (int k = 0; k < 3; k++)
+				p[k] = q[k] = positions[wedgePos[t[k]]];
+			q[kf] = positions[to];
+			glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+			glm::dvec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+			double lengths = glm::length(before) * glm::length(after);
+			if (lengths <= 0.0 || glm::dot(before, after) < 0.25 * lengths)
+				return false; // triângulo virado ou degenerado
+		}
+		return true;
+	};
+
+	while (tris.size() / 3 > targetTriangles)
+	{
+		// Triângulos em volta de cada posição
+		size_t nTriangles = tris.size() / 3;
+		fill(adjacencyStart.begin(), adjacencyStart.end(), 0);
+		for (unsigned int w : tris)
+			adjacencyStart[wedgePos[w] + 1]++;
+		for (size_t p = 0; p < nPositions; p++)
+			adjacencyStart[p + 1] += adjacencyStart[p];
+		adjacency.resize(tris.size());
+		{
+			vector<size_t> fillAt(adjacencyStart.begin(), adjacencyStart.end() - 1);
+			for (size_t i = 0; i < tris.size(); i++)
+				adjacency[fillAt[wedgePos[tris[i]]]++] = (unsigned int)(i / 3);
+		}
+
+		// Custo de cada aresta, na direção mais barata que for válida
+		vector<uint64_t> keys;
+		keys.reserve(tris.size());
+		for (size_t t = 0; t < nTriangles; t++)
+			for (int k = 0; k < 3; k++)
+				keys.push_back(edgeKey(wedgePos[tris[t * 3 + k]], wedgePos[tris[t * 3 + (k + 1) % 3]]));
+		sort(keys.begin(), keys.end());
+		keys.erase(unique(keys.begin(), keys.end()), keys.end());
+		candidates.clear();
+		for (uint64_t key : keys)
+		{
+			unsigned int a = (unsigned int)(key >> 32), b = (unsigned int)key;
+			if (a == b)
+				continue;
+			double costAB = quadrics[a].error(positions[b]);
+			double costBA = quadrics[b].error(positions[a]);
+			if (costBA < costAB)
+			{
+				swap(a, b);
+				swap(costAB, costBA);
+			}
+			if (costAB <= errorLimit)
+				candidates.push_back({ a, b, costAB });
+			if (costBA <= errorLimit)
+				candidates.push_back({ b, a, costBA });
+		}
+		sort(candidates.begin(), candidates.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+		// Colapsos gulosos do mais barato ao mais caro. Os triângulos em volta da posição
+		// removida ficam travados até a próxima passada (junto com a posição que fica),
+		// para que as verificações de tryCollapse continuem valendo
+		fill(locked.begin(), locked.end(), 0);
+		for (size_t w = 0; w < nWedges; w++)
+			wedgeRemap[w] = (unsigned int)w;
+		// Cada colapso remove cerca de dois triângulos. Os candidatos além dos mais baratos
+		// que bastariam para a meta ficam para a próxima passada: com parte dos baratos
+		// travada, a passada atual aceitaria colapsos caros no lugar deles.
+		size_t removed = 0, needed = nTriangles - targetTriangles;
+		if (candidates.empty())
+			break;
+		double passLimit = candidates[min(candidates.size() - 1, needed / 2)].cost;
+		int collapses = 0;
+		for (const Collapse& c : candidates)
+		{
+			if (removed >= needed || c.cost > passLimit)
+				break;
+			if (locked[c.from] || locked[c.to] || !tryCollapse(c.from, c.to))
+				continue;
+			for (const auto& m : mapping)
+				wedgeRemap[m.first] = m.second;
+			quadrics[c.to].add(quadrics[c.from]);
+			worst = max(worst, c.cost);
+			for (size_t a = adjacencyStart[c.from]; a < adjacencyStart[c.from + 1]; a++)
+			{
+				const unsigned int* t = &tris[adjacency[a] * 3];
+				bool shared = false;
+				for (int k = 0; k < 3; k++)
+				{
+					locked[wedgePos[t[k]]] = 1;
+					shared = shared || wedgePos[t[k]] == c.to;
+				}
+				removed += shared ? 1 : 0;
+			}
+			collapses++;
+		}
+		if (collapses == 0)
+			break;
+
+		// Aplica os colapsos e descarta os triângulos que ficaram degenerados
+		size_t out = 0;
+		for (size_t t = 0; t < nTriangles; t++)
+		{
+			unsigned int a = wedgeRemap[tris[t * 3]], b = wedgeRemap[tris[t * 3 + 1]], c = wedgeRemap[tris[t * 3 + 2]];
+			if (wedgePos[a] == wedgePos[b] || wedgePos[b] == wedgePos[c] || wedgePos[a] == wedgePos[c])
+				continue;
+			tris[out++] = a;
+			tris[out++] = b;
+			tris[out++] = c;
+		}
+		tris.resize(out);
+	}
+
+	vector<unsigned int> result(tris.size());
+	for (size_t i = 0; i < tris.size(); i++)
+		result[i] = wedgeVertex[tris[i]];
+	if (resultError)
+		*resultError = (float)sqrt(worst);
+	return result;
+}
+
+void buildLODs(IndexedMesh& mesh, int maxLevels)
+{
+	mesh.lods.clear();
+	mesh.lodIndices.clear();
+	if (mesh.indices.empty() || maxLevels <= 0)
+		return;
+
+	size_t nVertices = (size_t)mesh.nVertices();
+	float radius = computeBoundingSphere(mesh.vertices.data(), nVertices).w;
+	vector<Submesh> parts = mesh.submeshes;
+	if (parts.empty())
+		parts.push_back({ -1, 0, (unsigned int)mesh.indices.size() });
+
+	// Uma tarefa por (nível, submesh), todas a partir da malha original
+	size_t nJobs = (size_t)maxLevels * parts.size();
+	vector<vector<unsigned int>> results(nJobs);
+	vector<float> errors(nJobs, 0.0f);
+	ThreadPool::global().parallelFor(nJobs, [&](size_t job)
+	{
+		int level = (int)(job / parts.size()) + 1;
+		const Submesh& part = parts[job % parts.size()];
+		size_t target = ((size_t)part.indexCount / 3 >> level) * 3;
+		results[job] = simplifyMesh(mesh.indices.data() + part.firstIndex, part.indexCount, mesh.vertices.data(), nVertices,
+			target, numeric_limits<float>::max(), &errors[job]);
+		optimizeVertexCache(results[job].data(), results[job].size(), nVertices);
+	});
+
+	size_t base = mesh.indices.size();
+	size_t previous = mesh.indices.size();
+	float previousError = 0.0f;
+	for (int level = 1; level <= maxLevels; level++)
+	{
+		size_t total = 0;
+		float error = previousError;
+		for (size_t p = 0; p < parts.size(); p++)
+		{
+			total += results[(level - 1) * parts.size() + p].size();
+			error = max(error, errors[(level - 1) * parts.size() + p] / max(radius, 1e-12f));
+		}
+		// Nível que quase não reduz (bordas e costuras travadas) não vale o buffer extra
+		if (total == 0 || total > previous * 85 / 100)
+			break;
+
+		MeshLOD lod;
+		lod.error = error;
+		lod.firstIndex = (unsigned int)(base + mesh.lodIndices.size());
+		lod.indexCount = (unsigned int)total;
+		for (size_t p = 0; p < parts.size(); p++)
+		{
+			const vector<unsigned int>& part = results[(level - 1) * parts.size() + p];
+			if (part.empty())
+				continue;
+			lod.submeshes.push_back({ parts[p].material, (unsigned int)(base + mesh.lodIndices.size()), (unsigned int)part.size() });
+			mesh.lodIndices.insert(mesh.lodIndices.end(), part.begin(), part.end());
+		}
+		mesh.lods.push_back(lod);
+		previous = total;
+		previousError = error;
+	}
+}
+
+MeshBounds computeMeshBounds(const float* vertices, size_t nVertices)
+{
+	MeshBounds bounds;
+	if (nVertices == 0)
+		return bounds;
+	glm::vec3 lo = positionOf(vertices, 0), hi = lo;
+	for (size_t v = 1; v < nVertices; v++)
+	{
+		glm::vec3 p = positionOf(vertices, (unsigned int)v);
+		lo = glm::min(lo, p);
+		hi = glm::max(hi, p);
+	}
+	glm::vec3 center = 0.5f * (lo + hi);
+	float radius2 = 0.0f;
+	for (size_t v = 0; v < nVertices; v++)
+	{
+		glm::vec3 d = positionOf(vertices, (unsigned int)v) - center;
+		radius2 = max(radius2, glm::dot(d, d));
+	}
+	bounds.min = lo;
+	bounds.max = hi;
+	bounds.sphere = glm::vec4(center, sqrt(radius2));
+	return bounds;
+}
+
+glm::vec4 computeBoundingSphere(const float* vertices, size_t nVertices)
+{
+	return computeMeshBounds(vertices, nVertices).sphere;
+}
+
+float projectedSphereRadius(const glm::vec3& center, float radius, const glm::mat4& view,
+	const glm::mat4& projection, float viewportHeight)
+{
+	glm::vec4 viewCenter = view * glm::vec4(center, 1.0f);
+	float distance = -viewCenter.z;
+	if (distance <= radius)
+		return numeric_limits<float>::infinity();
+	// projection[1][1] = 1 / tan(fovy / 2): converte a altura no plano z = -1 em NDC
+	return radius * projection[1][1] / distance * 0.5f * viewportHeight;
+}
+
+int selectLOD(const vector<MeshLOD>& lods, float screenRadius, float pixelError)
+{
+	int level = 0;
+	for (size_t i = 0; i < lods.size(); i++)
+	{
+		if (lods[i].error * screenRadius > pixelError)
+			break;
+		level = (int)i + 1;
+	}
+	return level;
+}
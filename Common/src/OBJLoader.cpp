@@ -0,0 +1,1103 @@
+#include "OBJLoader.h"
+#include "ThreadPool.h"
+
+#include <cstring>
+#include <climits>
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// ----------------------------------------------------------------------------
+// MappedFile
+// ----------------------------------------------------------------------------
+
+MappedFile::MappedFile() : ptr(nullptr), length(0), opened(false)
+#ifdef _WIN32
+	, fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#else
+	, fd(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const string& filePath)
+{
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	this->fileHandle = file;
+	this->length = (size_t)fileSize.QuadPart;
+	this->opened = true;
+	if (this->length == 0)
+		return true;
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		close();
+		return false;
+	}
+	this->mappingHandle = mapping;
+	this->ptr = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (this->ptr == nullptr)
+	{
+		close();
+		return false;
+	}
+#else
+	int file = ::open(filePath.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+	struct stat st;
+	if (fstat(file, &st) != 0)
+	{
+		::close(file);
+		return false;
+	}
+	this->fd = file;
+	this->length = (size_t)st.st_size;
+	this->opened = true;
+	if (this->length == 0)
+		return true;
+	void* p = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, file, 0);
+	if (p == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+	madvise(p, this->length, MADV_SEQUENTIAL);
+	this->ptr = (const char*)p;
+#endif
+	return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (this->ptr)
+		UnmapViewOfFile(this->ptr);
+	if (this->mappingHandle)
+		CloseHandle((HANDLE)this->mappingHandle);
+	if (this->fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle((HANDLE)this->fileHandle);
+	this->mappingHandle = nullptr;
+	this->fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (this->ptr)
+		munmap((void*)this->ptr, this->length);
+	if (this->fd >= 0)
+		::close(this->fd);
+	this->fd = -1;
+#endif
+	this->ptr = nullptr;
+	this->length = 0;
+	this->opened = false;
+}
+
+// ----------------------------------------------------------------------------
+// Scanner: funções que avançam o ponteiro p sem alocar memória
+// ----------------------------------------------------------------------------
+
+static inline bool isBlank(char c)
+{
+	return c == ' ' || c == '\t';
+}
+
+static inline bool isDigit(char c)
+{
+	return (unsigned)(c - '0') < 10u;
+}
+
+static inline void skipBlanks(const char*& p, const char* end)
+{
+	while (p < end && isBlank(*p))
+		p++;
+}
+
+static inline void skipLine(const char*& p, const char* end)
+{
+	while (p < end && *p != '\n')
+		p++;
+	if (p < end)
+		p++;
+}
+
+// true se p começa com a palavra-chave seguida de espaço ou tab
+static inline bool matchKeyword(const char* p, const char* end, const char* keyword, size_t length)
+{
+	return (size_t)(end - p) > length && memcmp(p, keyword, length) == 0 && isBlank(p[length]);
+}
+
+// Resto da linha a partir de p, sem os brancos das pontas (nem o '\r' do Windows).
+// Não avança p: o skipLine do laço principal continua responsável por isso.
+static inline void restOfLine(const char* p, const char* end, const char*& text, size_t& length)
+{
+	skipBlanks(p, end);
+	const char* stop = p;
+	while (stop < end && *stop != '\n')
+		stop++;
+	while (stop > p && (isBlank(stop[-1]) || stop[-1] == '\r'))
+		stop--;
+	text = p;
+	length = (size_t)(stop - p);
+}
+
+// Potências de 10 usadas na montagem do float (cobre os expoentes de arquivos OBJ)
+static const double POW10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline double pow10i(int e)
+{
+	double r = 1.0;
+	bool negative = e < 0;
+	if (negative)
+		e = -e;
+	while (e > 22)
+	{
+		r *= 1e22;
+		e -= 22;
+	}
+	r *= POW10[e];
+	return negative ? 1.0 / r : r;
+}
+
+// Lê um float no formato [-+]ddd[.ddd][(e|E)[-+]ddd]
+static inline float scanFloat(const char*& p, const char* end)
+{
+	skipBlanks(p, end);
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = (*p == '-');
+		p++;
+	}
+	unsigned long long mantissa = 0;
+	int exponent = 0;
+	int digits = 0;
+	while (p < end && isDigit(*p))
+	{
+		if (digits < 19)
+		{
+			mantissa = mantissa * 10 + (unsigned)(*p - '0');
+			digits++;
+		}
+		else
+			exponent++;
+		p++;
+	}
+	if (p < end && *p == '.')
+	{
+		p++;
+		while (p < end && isDigit(*p))
+		{
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + (unsigned)(*p - '0');
+				digits++;
+				exponent--;
+			}
+			p++;
+		}
+	}
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		p++;
+		bool expNegative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			expNegative = (*p == '-');
+			p++;
+		}
+		int e = 0;
+		while (p < end && isDigit(*p))
+		{
+			if (e < 10000)
+				e = e * 10 + (*p - '0');
+			p++;
+		}
+		exponent += expNegative ? -e : e;
+	}
+	double value = (double)mantissa;
+	if (exponent != 0)
+		value = exponent < 0 ? value / pow10i(-exponent) : value * pow10i(exponent);
+	return (float)(negative ? -value : value);
+}
+
+// Lê um inteiro com sinal (índices negativos do OBJ são relativos)
+static inline int scanInt(const char*& p, const char* end)
+{
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = (*p == '-');
+		p++;
+	}
+	// Uma sequência longa demais de dígitos (linha estragada) para em INT_MAX em vez de
+	// estourar o int; o índice fica fora da faixa e é tratado como os outros inválidos
+	int value = 0;
+	while (p < end && isDigit(*p))
+	{
+		int digit = *p - '0';
+		value = value > (INT_MAX - digit) / 10 ? INT_MAX : value * 10 + digit;
+		p++;
+	}
+	return negative ? -value : value;
+}
+
+// Converte um índice do OBJ (1-based ou negativo/relativo) para 0-based.
+// Zero indica componente ausente e vira -1.
+static inline int resolveIndex(int index, size_t count)
+{
+	if (index > 0)
+		return index - 1;
+	if (index == 0)
+		return -1;
+	return (int)count + index;
+}
+
+// ----------------------------------------------------------------------------
+// Parsing
+// ----------------------------------------------------------------------------
+
+struct FaceCorner
+{
+	int vi, ti, ni;
+};
+
+// Percorre os registros v/vt/vn/f de [begin, end) e repassa para o "sink".
+// O sink decide como os índices das faces são resolvidos, o que permite usar o
+// mesmo scanner no parsing sequencial e no parsing por blocos (paralelo).
+template <typename Sink>
+static void scanRecords(const char* begin, const char* end, Sink& sink)
+{
+	const char* p = begin;
+	while (p < end)
+	{
+		skipBlanks(p, end);
+		if (p >= end)
+			break;
+
+		if (p[0] == 'v')
+		{
+			char kind = (p + 1 < end) ? p[1] : '\n';
+			if (isBlank(kind))
+			{
+				p += 2;
+				glm::vec3 v;
+				v.x = scanFloat(p, end);
+				v.y = scanFloat(p, end);
+				v.z = scanFloat(p, end);
+				sink.vertex(v);
+			}
+			else if (kind == 't' && p + 2 < end && isBlank(p[2]))
+			{
+				p += 3;
+				glm::vec2 vt;
+				vt.s = scanFloat(p, end);
+				vt.t = scanFloat(p, end);
+				sink.texCoord(vt);
+			}
+			else if (kind == 'n' && p + 2 < end && isBlank(p[2]))
+			{
+				p += 3;
+				glm::vec3 vn;
+				vn.x = scanFloat(p, end);
+				vn.y = scanFloat(p, end);
+				vn.z = scanFloat(p, end);
+				sink.normal(vn);
+			}
+		}
+		else if (p[0] == 'f' && p + 1 < end && isBlank(p[1]))
+		{
+			p += 2;
+			typename Sink::Corner first = {}, prev = {};
+			int n = 0;
+			while (true)
+			{
+				skipBlanks(p, end);
+				if (p >= end || !(isDigit(*p) || *p == '-' || *p == '+'))
+					break;
+
+				// Formato v/vt/vn
+				int vi = scanInt(p, end), ti = 0, ni = 0;
+				if (p < end && *p == '/')
+				{
+					p++;
+					ti = scanInt(p, end);
+					if (p < end && *p == '/')
+					{
+						p++;
+						ni = scanInt(p, end);
+					}
+				}
+				typename Sink::Corner c = sink.corner(vi, ti, ni);
+
+				// Triangulação em leque: (0, i-1, i)
+				if (n == 0)
+					first = c;
+				else if (n >= 2)
+					sink.triangle(first, prev, c);
+				prev = c;
+				n++;
+			}
+			if (n >= 3)
+				sink.face();
+		}
+		else if (p[0] == 'u' && matchKeyword(p, end, "usemtl", 6))
+		{
+			const char* name;
+			size_t length;
+			restOfLine(p + 6, end, name, length);
+			sink.useMaterial(name, length);
+		}
+		else if (p[0] == 'm' && matchKeyword(p, end, "mtllib", 6))
+		{
+			const char* name;
+			size_t length;
+			restOfLine(p + 6, end, name, length);
+			if (length > 0)
+				sink.materialLib(name, length);
+		}
+		skipLine(p, end);
+	}
+}
+
+// Índice de name em names, acrescentando se ainda não existir (poucos materiais por arquivo)
+static int findOrAddName(vector<string>& names, const char* name, size_t length)
+{
+	for (size_t i = 0; i < names.size(); i++)
+		if (names[i].size() == length && memcmp(names[i].data(), name, length) == 0)
+			return (int)i;
+	names.emplace_back(name, length);
+	return (int)names.size() - 1;
+}
+
+// Registra a troca de material no triângulo "triangle", juntando trechos vazios ou repetidos
+static void addMaterialRun(vector<OBJMaterialRun>& runs, int material, size_t triangle)
+{
+	if (!runs.empty() && runs.back().firstTriangle == triangle)
+	{
+		runs.back().material = material;
+		if (runs.size() >= 2 && runs[runs.size() - 2].material == material)
+			runs.pop_back();
+		return;
+	}
+	if (!runs.empty() && runs.back().material == material)
+		return;
+	runs.push_back({ material, triangle });
+}
+
+// Escreve os OBJ_FLOATS_PER_VERTEX floats de um canto de triângulo em dst.
+// Índices inválidos viram zero, assim um arquivo malformado não derruba o programa.
+static inline void writeCorner(float* dst, const OBJData& data, const FaceCorner& c, const glm::vec3& color)
+{
+	static const glm::vec3 zero3(0.0f);
+	static const glm::vec2 zero2(0.0f);
+
+	const glm::vec3& v = (c.vi >= 0 && c.vi < (int)data.vertices.size()) ? data.vertices[c.vi] : zero3;
+	const glm::vec2& t = (c.ti >= 0 && c.ti < (int)data.texCoords.size()) ? data.texCoords[c.ti] : zero2;
+	const glm::vec3& n = (c.ni >= 0 && c.ni < (int)data.normals.size()) ? data.normals[c.ni] : zero3;
+
+	dst[0] = v.x; dst[1] = v.y; dst[2] = v.z;
+	dst[3] = color.r; dst[4] = color.g; dst[5] = color.b;
+	dst[6] = t.s; dst[7] = t.t;
+	dst[8] = n.x; dst[9] = n.y; dst[10] = n.z;
+}
+
+// Sink sequencial: escreve direto no OBJData, resolvendo os índices com os
+// tamanhos atuais das listas (como o loadSimpleOBJ original)
+struct SequentialSink
+{
+	typedef FaceCorner Corner;
+
+	OBJData& out;
+	glm::vec3 color;
+
+	void vertex(const glm::vec3& v) { out.vertices.push_back(v); }
+	void texCoord(const glm::vec2& vt) { out.texCoords.push_back(vt); }
+	void normal(const glm::vec3& vn) { out.normals.push_back(vn); }
+	void face() { out.nFaces++; }
+	void materialLib(const char* name, size_t length) { out.materialLibs.emplace_back(name, length); }
+
+	void useMaterial(const char* name, size_t length)
+	{
+		addMaterialRun(out.materialRuns, findOrAddName(out.materialNames, name, length), out.corners.size() / 3);
+	}
+
+	Corner corner(int vi, int ti, int ni)
+	{
+		Corner c;
+		c.vi = resolveIndex(vi, out.vertices.size());
+		c.ti = resolveIndex(ti, out.texCoords.size());
+		c.ni = resolveIndex(ni, out.normals.size());
+		return c;
+	}
+
+	void triangle(const Corner& a, const Corner& b, const Corner& c)
+	{
+		size_t offset = out.vBuffer.size();
+		out.vBuffer.resize(offset + 3 * OBJ_FLOATS_PER_VERTEX);
+		float* dst = out.vBuffer.data() + offset;
+		writeCorner(dst, out, a, color);
+		writeCorner(dst + OBJ_FLOATS_PER_VERTEX, out, b, color);
+		writeCorner(dst + 2 * OBJ_FLOATS_PER_VERTEX, out, c, color);
+		out.corners.push_back(glm::ivec3(a.vi, a.ti, a.ni));
+		out.corners.push_back(glm::ivec3(b.vi, b.ti, b.ni));
+		out.corners.push_back(glm::ivec3(c.vi, c.ti, c.ni));
+	}
+};
+
+bool parseOBJ(const char* begin, const char* end, OBJData& out, glm::vec3 color)
+{
+	// Estimativa grosseira para evitar realocações: ~30 bytes por linha
+	size_t estimatedLines = (size_t)(end - begin) / 30;
+	out.vertices.reserve(estimatedLines / 3);
+	out.texCoords.reserve(estimatedLines / 3);
+	out.normals.reserve(estimatedLines / 3);
+	out.vBuffer.reserve(estimatedLines / 3 * 3 * OBJ_FLOATS_PER_VERTEX);
+	out.corners.reserve(estimatedLines / 3 * 3);
+
+	SequentialSink sink = { out, color };
+	scanRecords(begin, end, sink);
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+// Parsing paralelo
+// ----------------------------------------------------------------------------
+
+// Canto de face lido dentro de um bloco. Índices negativos (relativos) só podem
+// ser resolvidos com a contagem local do bloco; o bit correspondente em "local"
+// indica que o índice guardado ainda precisa somar a base global do bloco.
+// (Faces que referenciam vértices declarados depois delas, inválidas no formato,
+// são resolvidas aqui contra a lista completa, e não zeradas.)
+struct ChunkCorner
+{
+	int vi, ti, ni;
+	unsigned char local;
+};
+
+struct ChunkSink
+{
+	typedef ChunkCorner Corner;
+
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> texCoords;
+	std::vector<glm::vec3> normals;
+	std::vector<ChunkCorner> corners; // 3 por triângulo
+	size_t nFaces = 0;
+	std::vector<std::string> materialLibs;
+	std::vector<std::string> materialNames;   // nomes locais do bloco
+	std::vector<OBJMaterialRun> materialRuns; // material e triângulo locais do bloco
+
+	void vertex(const glm::vec3& v) { vertices.push_back(v); }
+	void texCoord(const glm::vec2& vt) { texCoords.push_back(vt); }
+	void normal(const glm::vec3& vn) { normals.push_back(vn); }
+	void face() { nFaces++; }
+	void materialLib(const char* name, size_t length) { materialLibs.emplace_back(name, length); }
+
+	void useMaterial(const char* name, size_t length)
+	{
+		addMaterialRun(materialRuns, findOrAddName(materialNames, name, length), corners.size() / 3);
+	}
+
+	static inline int resolveLocal(int index, size_t count, unsigned char bit, unsigned char& local)
+	{
+		if (index > 0)
+			return index - 1;
+		if (index == 0)
+			return -1;
+		local |= bit;
+		return (int)count + index;
+	}
+
+	Corner corner(int vi, int ti, int ni)
+	{
+		Corner c;
+		c.local = 0;
+		c.vi = resolveLocal(vi, vertices.size(), 1, c.local);
+		c.ti = resolveLocal(ti, texCoords.size(), 2, c.local);
+		c.ni = resolveLocal(ni, normals.size(), 4, c.local);
+		return c;
+	}
+
+	void triangle(const Corner& a, const Corner& b, const Corner& c)
+	{
+		corners.push_back(a);
+		corners.push_back(b);
+		corners.push_back(c);
+	}
+};
+
+// Divide [begin, end) em pedaços de tamanho parecido, sempre cortando logo após um '\n'
+static vector<pair<const char*, const char*>> splitAtLines(const char* begin, const char* end, size_t nChunks)
+{
+	vector<pair<const char*, const char*>> chunks;
+	size_t length = (size_t)(end - begin);
+	const char* start = begin;
+	for (size_t i = 1; i <= nChunks && start < end; i++)
+	{
+		const char* stop = (i == nChunks) ? end : begin + length * i / nChunks;
+		if (stop < start)
+			stop = start;
+		while (stop < end && stop[-1] != '\n')
+			stop++;
+		if (stop > start)
+			chunks.push_back(make_pair(start, stop));
+		start = stop;
+	}
+	return chunks;
+}
+
+bool parseOBJParallel(const char* begin, const char* end, OBJData& out, unsigned nThreads, glm::vec3 color)
+{
+	ThreadPool& pool = ThreadPool::global();
+	if (nThreads == 0)
+		nThreads = pool.size() + 1;
+
+	// Blocos pequenos não compensam o custo de sincronização
+	const size_t minChunkBytes = 256 * 1024;
+	size_t length = (size_t)(end - begin);
+	size_t nChunks = min<size_t>((size_t)nThreads * 4, length / minChunkBytes);
+	if (nThreads <= 1 || nChunks <= 1)
+		return parseOBJ(begin, end, out, color);
+
+	vector<pair<const char*, const char*>> ranges = splitAtLines(begin, end, nChunks);
+	vector<ChunkSink> chunks(ranges.size());
+
+	// 1. Parsing de cada bloco de forma independente
+	pool.parallelFor(ranges.size(), [&](size_t i) {
+		scanRecords(ranges[i].first, ranges[i].second, chunks[i]);
+	}, nThreads);
+
+	// 2. Somas de prefixo: posição global de cada bloco
+	vector<size_t> vBase(chunks.size()), tBase(chunks.size()), nBase(chunks.size()), cBase(chunks.size());
+	size_t nv = 0, nt = 0, nn = 0, nc = 0;
+	out.nFaces = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		vBase[i] = nv; nv += chunks[i].vertices.size();
+		tBase[i] = nt; nt += chunks[i].texCoords.size();
+		nBase[i] = nn; nn += chunks[i].normals.size();
+		cBase[i] = nc; nc += chunks[i].corners.size();
+		out.nFaces += chunks[i].nFaces;
+
+		// Materiais: nomes locais viram globais na ordem dos blocos, a mesma da leitura sequencial
+		const ChunkSink& c = chunks[i];
+		out.materialLibs.insert(out.materialLibs.end(), c.materialLibs.begin(), c.materialLibs.end());
+		for (const OBJMaterialRun& run : c.materialRuns)
+		{
+			const string& name = c.materialNames[run.material];
+			int material = findOrAddName(out.materialNames, name.data(), name.size());
+			addMaterialRun(out.materialRuns, material, cBase[i] / 3 + run.firstTriangle);
+		}
+	}
+
+	// 3. Junta os atributos nas listas globais
+	out.vertices.resize(nv);
+	out.texCoords.resize(nt);
+	out.normals.resize(nn);
+	pool.parallelFor(chunks.size(), [&](size_t i) {
+		const ChunkSink& c = chunks[i];
+		copy(c.vertices.begin(), c.vertices.end(), out.vertices.begin() + vBase[i]);
+		copy(c.texCoords.begin(), c.texCoords.end(), out.texCoords.begin() + tBase[i]);
+		copy(c.normals.begin(), c.normals.end(), out.normals.begin() + nBase[i]);
+	}, nThreads);
+
+	// 4. Monta o buffer intercalado: cada bloco escreve na sua própria faixa
+	out.vBuffer.resize(nc * OBJ_FLOATS_PER_VERTEX);
+	out.corners.resize(nc);
+	pool.parallelFor(chunks.size(), [&](size_t i) {
+		float* dst = out.vBuffer.data() + cBase[i] * OBJ_FLOATS_PER_VERTEX;
+		glm::ivec3* dstCorner = out.corners.data() + cBase[i];
+		for (const ChunkCorner& cc : chunks[i].corners)
+		{
+			FaceCorner c;
+			c.vi = (cc.local & 1) ? cc.vi + (int)vBase[i] : cc.vi;
+			c.ti = (cc.local & 2) ? cc.ti + (int)tBase[i] : cc.ti;
+			c.ni = (cc.local & 4) ? cc.ni + (int)nBase[i] : cc.ni;
+			writeCorner(dst, out, c, color);
+			*dstCorner++ = glm::ivec3(c.vi, c.ti, c.ni);
+			dst += OBJ_FLOATS_PER_VERTEX;
+		}
+	}, nThreads);
+
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+// Normais
+// ----------------------------------------------------------------------------
+
+// Itens (triângulos ou posições) por tarefa nos laços paralelos de generateNormals
+static const size_t NORMAL_BLOCK = 16 * 1024;
+
+size_t generateNormals(OBJData& data, float creaseAngle, unsigned nThreads)
+{
+	size_t nCorners = data.corners.size() / 3 * 3;
+	size_t nTriangles = nCorners / 3;
+	size_t nPositions = data.vertices.size();
+	size_t missing = 0;
+	for (size_t c = 0; c < nCorners; c++)
+		if (data.corners[c].z < 0)
+			missing++;
+	if (missing == 0)
+		return 0;
+
+	ThreadPool& pool = ThreadPool::global();
+	if (nThreads == 0)
+		nThreads = pool.size() + 1;
+	auto forBlocks = [&](size_t count, const function<void(size_t, size_t)>& body)
+	{
+		size_t nBlocks = (count + NORMAL_BLOCK - 1) / NORMAL_BLOCK;
+		pool.parallelFor(nBlocks, [&](size_t b) { body(b * NORMAL_BLOCK, min(count, (b + 1) * NORMAL_BLOCK)); }, nThreads);
+	};
+	auto position = [&](size_t c) -> int
+	{
+		int p = data.corners[c].x;
+		return (p >= 0 && p < (int)nPositions) ? p : -1;
+	};
+
+	// 1. Normal de cada face (o produto vetorial tem o dobro da área como módulo) e
+	//    ângulo de cada canto
+	vector<glm::vec3> faceNormals(nTriangles), faceUnits(nTriangles);
+	vector<float> cornerAngles(nCorners);
+	forBlocks(nTriangles, [&](size_t first, size_t last)
+	{
+		for (size_t t = first; t < last; t++)
+		{
+			glm::vec3 v[3];
+			for (int k = 0; k < 3; k++)
+			{
+				int p = position(t * 3 + k);
+				v[k] = p >= 0 ? data.vertices[p] : glm::vec3(0.0f);
+			}
+			glm::vec3 n = glm::cross(v[1] - v[0], v[2] - v[0]);
+			float length = glm::length(n);
+			faceNormals[t] = n;
+			faceUnits[t] = length > 0.0f ? n / length : glm::vec3(0.0f);
+			for (int k = 0; k < 3; k++)
+			{
+				glm::vec3 e1 = v[(k + 1) % 3] - v[k], e2 = v[(k + 2) % 3] - v[k];
+				float l1 = glm::length(e1), l2 = glm::length(e2);
+				float cosine = (l1 > 0.0f && l2 > 0.0f) ? glm::dot(e1, e2) / (l1 * l2) : 1.0f;
+				cornerAngles[t * 3 + k] = acos(glm::clamp(cosine, -1.0f, 1.0f));
+			}
+		}
+	});
+
+	// 2. Cantos agrupados por posição (ordenação por contagem): contagem e
+	//    distribuição com incrementos atômicos, sem travas
+	unique_ptr<atomic<unsigned>[]> counts(new atomic<unsigned>[nPositions + 1]);
+	for (size_t p = 0; p <= nPositions; p++)
+		counts[p].store(0, memory_order_relaxed);
+	forBlocks(nCorners, [&](size_t first, size_t last)
+	{
+		for (size_t c = first; c < last; c++)
+		{
+			int p = position(c);
+			if (p >= 0)
+				counts[p].fetch_add(1, memory_order_relaxed);
+		}
+	});
+	vector<unsigned> start(nPositions + 1);
+	unsigned total = 0;
+	for (size_t p = 0; p < nPositions; p++)
+	{
+		start[p] = total;
+		total += counts[p].load(memory_order_relaxed);
+		counts[p].store(start[p], memory_order_relaxed); // vira o cursor de escrita
+	}
+	start[nPositions] = total;
+	vector<unsigned> adjacency(total);
+	forBlocks(nCorners, [&](size_t first, size_t last)
+	{
+		for (size_t c = first; c < last; c++)
+		{
+			int p = position(c);
+			if (p >= 0)
+				adjacency[counts[p].fetch_add(1, memory_order_relaxed)] = (unsigned)c;
+		}
+	});
+	// A ordem da distribuição depende das threads; ordenar cada grupo deixa as somas
+	// (e o cache gerado a partir delas) iguais em toda execução
+	forBlocks(nPositions, [&](size_t first, size_t last)
+	{
+		for (size_t p = first; p < last; p++)
+			sort(adjacency.begin() + start[p], adjacency.begin() + start[p + 1]);
+	});
+
+	// 3. Normal de cada canto sem vn: faces da mesma posição dentro do ângulo de quina,
+	//    pesadas por área e ângulo
+	const float cosCrease = cos(glm::radians(creaseAngle));
+	vector<glm::vec3> cornerNormals(nCorners);
+	forBlocks(nTriangles, [&](size_t first, size_t last)
+	{
+		for (size_t t = first; t < last; t++)
+		{
+			for (size_t c = t * 3; c < t * 3 + 3; c++)
+			{
+				if (data.corners[c].z >= 0)
+					continue;
+				glm::vec3 sum(0.0f);
+				int p = position(c);
+				if (p >= 0)
+				{
+					for (unsigned a = start[p]; a < start[p + 1]; a++)
+					{
+						size_t other = adjacency[a] / 3;
+						if (other == t || glm::dot(faceUnits[other], faceUnits[t]) >= cosCrease)
+							sum += faceNormals[other] * cornerAngles[adjacency[a]];
+					}
+				}
+				float length = glm::length(sum);
+				cornerNormals[c] = length > 0.0f ? sum / length : faceUnits[t];
+			}
+		}
+	});
+
+	// 4. Normais distintas de cada posição: cantos com o mesmo resultado dividem a
+	//    mesma entrada em data.normals (e o mesmo vértice em buildIndexedMesh)
+	vector<unsigned> cornerSlots(nCorners, 0);
+	vector<unsigned> uniqueCounts(nPositions, 0);
+	forBlocks(nPositions, [&](size_t first, size_t last)
+	{
+		for (size_t p = first; p < last; p++)
+		{
+			for (unsigned a = start[p]; a < start[p + 1]; a++)
+			{
+				unsigned c = adjacency[a];
+				if (data.corners[c].z >= 0)
+					continue;
+				unsigned slot = uniqueCounts[p];
+				for (unsigned b = start[p]; b < a; b++)
+				{
+					unsigned earlier = adjacency[b];
+					if (data.corners[earlier].z < 0 && memcmp(&cornerNormals[earlier], &cornerNormals[c], sizeof(glm::vec3)) == 0)
+					{
+						slot = cornerSlots[earlier];
+						break;
+					}
+				}
+				cornerSlots[c] = slot;
+				if (slot == uniqueCounts[p])
+					uniqueCounts[p]++;
+			}
+		}
+	});
+	vector<size_t> normalBase(nPositions);
+	size_t nNormals = data.normals.size();
+	for (size_t p = 0; p < nPositions; p++)
+	{
+		normalBase[p] = nNormals;
+		nNormals += uniqueCounts[p];
+	}
+	data.normals.resize(nNormals);
+
+	// 5. Grava as normais e atualiza os cantos e o buffer intercalado; cada canto
+	//    está no grupo de uma única posição, então as threads não se cruzam
+	auto assign = [&](size_t c, size_t index)
+	{
+		data.normals[index] = cornerNormals[c];
+		data.corners[c].z = (int)index;
+		float* dst = data.vBuffer.data() + c * OBJ_FLOATS_PER_VERTEX;
+		dst[8] = cornerNormals[c].x;
+		dst[9] = cornerNormals[c].y;
+		dst[10] = cornerNormals[c].z;
+	};
+	forBlocks(nPositions, [&](size_t first, size_t last)
+	{
+		for (size_t p = first; p < last; p++)
+			for (unsigned a = start[p]; a < start[p + 1]; a++)
+				if (data.corners[adjacency[a]].z < 0)
+					assign(adjacency[a], normalBase[p] + cornerSlots[adjacency[a]]);
+	});
+	// Cantos com posição inválida ficam com a normal da própria face
+	for (size_t c = 0; c < nCorners; c++)
+	{
+		if (data.corners[c].z < 0)
+		{
+			data.normals.push_back(glm::vec3(0.0f));
+			assign(c, data.normals.size() - 1);
+		}
+	}
+	return missing;
+}
+
+// ----------------------------------------------------------------------------
+// Indexação
+// ----------------------------------------------------------------------------
+
+static inline unsigned int hashCorner(const glm::ivec3& c)
+{
+	unsigned int h = (unsigned int)c.x * 0x9E3779B1u;
+	h ^= (unsigned int)c.y * 0x85EBCA77u + (h << 6) + (h >> 2);
+	h ^= (unsigned int)c.z * 0xC2B2AE3Du + (h << 6) + (h >> 2);
+	return h ^ (h >> 15);
+}
+
+// Reordena os triângulos de mesh.indices para que cada material ocupe uma faixa
+// contígua: primeiro os sem material, depois na ordem de materialNames
+static void groupByMaterial(const OBJData& data, IndexedMesh& mesh)
+{
+	mesh.materialNames = data.materialNames;
+	mesh.materialLibs = data.materialLibs;
+	mesh.submeshes.clear();
+	size_t nTriangles = mesh.indices.size() / 3;
+	if (nTriangles == 0)
+		return;
+
+	// Trechos [first, last) de triângulos e o grupo de cada um (grupo 0 = sem material)
+	struct Span { size_t first, last; int group; };
+	vector<Span> spans;
+	size_t firstRun = data.materialRuns.empty() ? nTriangles : min(data.materialRuns[0].firstTriangle, nTriangles);
+	if (firstRun > 0)
+		spans.push_back({ 0, firstRun, 0 });
+	for (size_t r = 0; r < data.materialRuns.size(); r++)
+	{
+		size_t first = min(data.materialRuns[r].firstTriangle, nTriangles);
+		size_t last = r + 1 < data.materialRuns.size() ? min(data.materialRuns[r + 1].firstTriangle, nTriangles) : nTriangles;
+		if (last > first)
+			spans.push_back({ first, last, data.materialRuns[r].material + 1 });
+	}
+
+	size_t nGroups = data.materialNames.size() + 1;
+	vector<size_t> groupTriangles(nGroups, 0);
+	for (const Span& span : spans)
+		groupTriangles[span.group] += span.last - span.first;
+
+	vector<size_t> groupStart(nGroups, 0);
+	size_t offset = 0;
+	for (size_t g = 0; g < nGroups; g++)
+	{
+		groupStart[g] = offset;
+		if (groupTriangles[g] > 0)
+			mesh.submeshes.push_back({ (int)g - 1, (unsigned int)(offset * 3), (unsigned int)(groupTriangles[g] * 3) });
+		offset += groupTriangles[g];
+	}
+	if (mesh.submeshes.size() == 1)
+		return; // um único material: a ordem já é a do arquivo
+
+	vector<unsigned int> grouped(mesh.indices.size());
+	for (const Span& span : spans)
+	{
+		size_t count = (span.last - span.first) * 3;
+		copy(mesh.indices.begin() + span.first * 3, mesh.indices.begin() + span.first * 3 + count,
+			grouped.begin() + groupStart[span.group] * 3);
+		groupStart[span.group] += span.last - span.first;
+	}
+	mesh.indices.swap(grouped);
+}
+
+void buildIndexedMesh(const OBJData& data, IndexedMesh& mesh)
+{
+	size_t nCorners = data.corners.size();
+	mesh.vertices.clear();
+	mesh.indices.resize(nCorners);
+	mesh.vertices.reserve(nCorners / 2 * OBJ_FLOATS_PER_VERTEX);
+
+	// Tabela hash com endereçamento aberto (capacidade potência de 2, carga <= 50%),
+	// guardando o índice do primeiro canto que gerou cada vértice único
+	size_t capacity = 16;
+	while (capacity < nCorners * 2)
+		capacity <<= 1;
+	const unsigned int EMPTY = 0xFFFFFFFFu;
+	vector<unsigned int> slotCorner(capacity, EMPTY);
+	vector<unsigned int> slotVertex(capacity);
+	size_t mask = capacity - 1;
+
+	unsigned int nUnique = 0;
+	for (size_t i = 0; i < nCorners; i++)
+	{
+		const glm::ivec3& key = data.corners[i];
+		size_t slot = hashCorner(key) & mask;
+		while (slotCorner[slot] != EMPTY && data.corners[slotCorner[slot]] != key)
+			slot = (slot + 1) & mask;
+
+		if (slotCorner[slot] == EMPTY)
+		{
+			slotCorner[slot] = (unsigned int)i;
+			slotVertex[slot] = nUnique++;
+			const float* src = data.vBuffer.data() + i * OBJ_FLOATS_PER_VERTEX;
+			mesh.vertices.insert(mesh.vertices.end(), src, src + OBJ_FLOATS_PER_VERTEX);
+		}
+		mesh.indices[i] = slotVertex[slot];
+	}
+
+	groupByMaterial(data, mesh);
+}
+
+bool loadOBJ(const string& filePath, OBJData& out, unsigned nThreads, glm::vec3 color)
+{
+	MappedFile file;
+	if (!file.open(filePath))
+		return false;
+	bool ok = nThreads == 1 ? parseOBJ(file.data(), file.data() + file.size(), out, color)
+		: parseOBJParallel(file.data(), file.data() + file.size(), out, nThreads, color);
+	if (ok)
+		generateNormals(out, OBJ_CREASE_ANGLE, nThreads);
+	return ok;
+}
+
+// ----------------------------------------------------------------------------
+// Materiais (.mtl)
+// ----------------------------------------------------------------------------
+
+static glm::vec3 scanVec3(const char*& p, const char* end)
+{
+	glm::vec3 v;
+	v.x = scanFloat(p, end);
+	v.y = scanFloat(p, end);
+	v.z = scanFloat(p, end);
+	return v;
+}
+
+// Caminho existente para uma textura citada no .mtl (vazio se não encontrar)
+static string resolveTexturePath(const filesystem::path& mtlDir, const string& texture)
+{
+	error_code ec;
+	filesystem::path given(texture);
+	if (given.is_relative())
+		given = mtlDir / given;
+	if (filesystem::is_regular_file(given, ec))
+		return given.string();
+
+	// Caminho de outra máquina (C:/Users/...): procura só pelo nome do arquivo
+	size_t slash = texture.find_last_of("/\\");
+	string fileName = slash == string::npos ? texture : texture.substr(slash + 1);
+	filesystem::path candidate = mtlDir / fileName;
+	if (filesystem::is_regular_file(candidate, ec))
+		return candidate.string();
+	for (filesystem::directory_iterator it(mtlDir, ec), last; !ec && it != last; it.increment(ec))
+	{
+		if (!it->is_directory(ec))
+			continue;
+		candidate = it->path() / fileName;
+		if (filesystem::is_regular_file(candidate, ec))
+			return candidate.string();
+	}
+	return string();
+}
+
+bool loadMTL(const string& mtlPath, vector<Material>& out)
+{
+	MappedFile file;
+	if (!file.open(mtlPath))
+		return false;
+	filesystem::path mtlDir = filesystem::path(mtlPath).parent_path();
+
+	const char* p = file.data();
+	const char* end = p + file.size();
+	Material* current = nullptr;
+	while (p < end)
+	{
+		skipBlanks(p, end);
+		if (p >= end)
+			break;
+		const char* text;
+		size_t length;
+		if (matchKeyword(p, end, "newmtl", 6))
+		{
+			restOfLine(p + 6, end, text, length);
+			out.emplace_back();
+			current = &out.back();
+			current->name.assign(text, length);
+		}
+		else if (current != nullptr)
+		{
+			if (matchKeyword(p, end, "Ka", 2))
+			{
+				p += 2;
+				current->ka = scanVec3(p, end);
+			}
+			else if (matchKeyword(p, end, "Kd", 2))
+			{
+				p += 2;
+				current->kd = scanVec3(p, end);
+			}
+			else if (matchKeyword(p, end, "Ks", 2))
+			{
+				p += 2;
+				current->ks = scanVec3(p, end);
+			}
+			else if (matchKeyword(p, end, "Ns", 2))
+			{
+				p += 2;
+				current->ns = scanFloat(p, end);
+			}
+			else if (matchKeyword(p, end, "d", 1))
+			{
+				p += 1;
+				current->d = scanFloat(p, end);
+			}
+			else if (matchKeyword(p, end, "Tr", 2))
+			{
+				p += 2;
+				current->d = 1.0f - scanFloat(p, end);
+			}
+			else if (matchKeyword(p, end, "map_Kd", 6))
+			{
+				// Opções como "-s 1 1 1" antes do nome do arquivo não são suportadas
+				restOfLine(p + 6, end, text, length);
+				current->mapKd = resolveTexturePath(mtlDir, string(text, length));
+			}
+		}
+		skipLine(p, end);
+	}
+	return true;
+}
+
+void loadMaterials(const string& objPath, const vector<string>& libs, const vector<string>& names, vector<Material>& out)
+{
+	vector<Material> library;
+	filesystem::path objDir = filesystem::path(objPath).parent_path();
+	for (const string& lib : libs)
+		loadMTL((objDir / lib).string(), library);
+
+	out.clear();
+	out.reserve(names.size());
+	for (const string& name : names)
+	{
+		auto found = find_if(library.begin(), library.end(), [&](const Material& m) { return m.name == name; });
+		if (found != library.end())
+			out.push_back(*found);
+		else
+		{
+			out.emplace_back();
+			out.back().name = name;
+		}
+	}
+}
@@ -0,0 +1,436 @@
+#include "OcclusionCulling.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "ThreadPool.h"
+#include "Timing.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_SSE2 1
+#endif
+
+// O caminho AVX2 é compilado mesmo sem -mavx2 (atributo target no GCC/Clang; o MSVC
+// aceita os intrínsecos em qualquer função) e só é usado se a CPU tiver AVX2 e FMA
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define OCCLUSION_AVX2 1
+#define OCCLUSION_AVX2_TARGET __attribute__((target("avx2,fma")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#include <intrin.h>
+#define OCCLUSION_AVX2 1
+#define OCCLUSION_AVX2_TARGET
+#endif
+
+using namespace std;
+
+typedef chrono::high_resolution_clock Clock;
+
+bool OccluderMesh::build(const CachedMesh& mesh, float maxError)
+{
+	this->positions.clear();
+	this->indices.clear();
+	if (mesh.nIndices() == 0)
+		return false;
+
+	// Nível mais simples dentro do erro (os índices dos níveis vêm depois dos do nível 0)
+	const unsigned int* source = mesh.indexData();
+	size_t count = mesh.nIndices();
+	for (const MeshLOD& lod : mesh.lods())
+	{
+		if (lod.error > maxError || lod.indexCount >= count || !mesh.lodIndexData())
+			continue;
+		source = mesh.lodIndexData() + (lod.firstIndex - mesh.nIndices());
+		count = lod.indexCount;
+	}
+
+	// Só os vértices usados, na ordem do primeiro uso
+	vector<int> remap(mesh.nVertices(), -1);
+	this->indices.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		unsigned int vertex = source[i];
+		if (remap[vertex] < 0)
+		{
+			remap[vertex] = (int)this->positions.size();
+			const float* p = mesh.vertexData() + (size_t)vertex * OBJ_FLOATS_PER_VERTEX;
+			this->positions.push_back(glm::vec3(p[0], p[1], p[2]));
+		}
+		this->indices[i] = (unsigned int)remap[vertex];
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+// Rasterização de um triângulo dentro de um bloco
+// ----------------------------------------------------------------------------
+
+namespace
+{
+	// Funções de aresta e plano de profundidade: E_i(x, y) = a[i] * x + b[i] * y + c[i]
+	// (>= 0 dentro do triângulo) e z(x, y) = za * x + zb * y + zc
+	struct TriangleSetup
+	{
+		float a[3], b[3], c[3];
+		float za, zb, zc;
+		int x0, x1, y0, y1; // pixels da caixa do triângulo dentro do bloco
+	};
+
+	bool setupTriangle(const glm::vec3* v, int tileX0, int tileY0, int tileX1, int tileY1, TriangleSetup& setup)
+	{
+		// Aresta i vai de v[i] para v[i + 1]; E_0 em v[2] vale a área (com sinal) dobrada
+		for (int i = 0; i < 3; i++)
+		{
+			const glm::vec3& from = v[i];
+			const glm::vec3& to = v[(i + 1) % 3];
+			setup.a[i] = -(to.y - from.y);
+			setup.b[i] = to.x - from.x;
+			setup.c[i] = -(setup.a[i] * from.x + setup.b[i] * from.y);
+		}
+		float area = setup.a[0] * v[2].x + setup.b[0] * v[2].y + setup.c[0];
+		if (!(fabs(area) > 1e-8f))
+			return false;
+		if (area < 0.0f)
+		{
+			// Sentido horário: inverte as arestas para o lado de dentro ficar positivo
+			for (int i = 0; i < 3; i++)
+			{
+				setup.a[i] = -setup.a[i];
+				setup.b[i] = -setup.b[i];
+				setup.c[i] = -setup.c[i];
+			}
+			area = -area;
+		}
+		// Peso de v[2] é E_0 / área, de v[0] é E_1 / área e de v[1] é E_2 / área
+		float inverse = 1.0f / area;
+		setup.za = (setup.a[1] * v[0].z + setup.a[2] * v[1].z + setup.a[0] * v[2].z) * inverse;
+		setup.zb = (setup.b[1] * v[0].z + setup.b[2] * v[1].z + setup.b[0] * v[2].z) * inverse;
+		setup.zc = (setup.c[1] * v[0].z + setup.c[2] * v[1].z + setup.c[0] * v[2].z) * inverse;
+
+		// Pixel x é coberto se o centro (x + 0.5) estiver dentro
+		float minX = min(v[0].x, min(v[1].x, v[2].x)), maxX = max(v[0].x, max(v[1].x, v[2].x));
+		float minY = min(v[0].y, min(v[1].y, v[2].y)), maxY = max(v[0].y, max(v[1].y, v[2].y));
+		setup.x0 = max(tileX0, (int)ceil(minX - 0.5f));
+		setup.x1 = min(tileX1 - 1, (int)floor(maxX - 0.5f));
+		setup.y0 = max(tileY0, (int)ceil(minY - 0.5f));
+		setup.y1 = min(tileY1 - 1, (int)floor(maxY - 0.5f));
+		return setup.x0 <= setup.x1 && setup.y0 <= setup.y1;
+	}
+
+	void rasterScalar(const TriangleSetup& s, float* depth)
+	{
+		for (int y = s.y0; y <= s.y1; y++)
+		{
+			float py = y + 0.5f;
+			float* row = depth + (size_t)y * OCCLUSION_WIDTH;
+			for (int x = s.x0; x <= s.x1; x++)
+			{
+				float px = x + 0.5f;
+				if (s.a[0] * px + s.b[0] * py + s.c[0] < 0.0f || s.a[1] * px + s.b[1] * py + s.c[1] < 0.0f ||
+					s.a[2] * px + s.b[2] * py + s.c[2] < 0.0f)
+					continue;
+				row[x] = min(row[x], s.za * px + s.zb * py + s.zc);
+			}
+		}
+	}
+
+	// Os grupos de 4 ou 8 pixels começam alinhados e não saem do bloco (a largura do
+	// bloco é múltipla de 8); os pixels do grupo fora do triângulo são descartados
+	// pelas funções de aresta
+#if defined(OCCLUSION_SSE2)
+	void rasterSSE2(const TriangleSetup& s, float* depth)
+	{
+		const __m128 lanes = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f), zero = _mm_setzero_ps();
+		const __m128 a0 = _mm_set1_ps(s.a[0]), a1 = _mm_set1_ps(s.a[1]), a2 = _mm_set1_ps(s.a[2]), za = _mm_set1_ps(s.za);
+		int start = s.x0 & ~3;
+		for (int y = s.y0; y <= s.y1; y++)
+		{
+			float py = y + 0.5f;
+			__m128 r0 = _mm_set1_ps(s.b[0] * py + s.c[0]), r1 = _mm_set1_ps(s.b[1] * py + s.c[1]);
+			__m128 r2 = _mm_set1_ps(s.b[2] * py + s.c[2]), rz = _mm_set1_ps(s.zb * py + s.zc);
+			float* row = depth + (size_t)y * OCCLUSION_WIDTH;
+			for (int x = start; x <= s.x1; x += 4)
+			{
+				__m128 px = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+				__m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), r0);
+				__m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), r1);
+				__m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), r2);
+				__m128 outside = _mm_cmplt_ps(_mm_min_ps(e0, _mm_min_ps(e1, e2)), zero);
+				if (_mm_movemask_ps(outside) == 0xF)
+					continue;
+				__m128 current = _mm_loadu_ps(row + x);
+				__m128 z = _mm_min_ps(current, _mm_add_ps(_mm_mul_ps(za, px), rz));
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(outside, current), _mm_andnot_ps(outside, z)));
+			}
+		}
+	}
+#endif
+
+#if defined(OCCLUSION_AVX2)
+	OCCLUSION_AVX2_TARGET void rasterAVX2(const TriangleSetup& s, float* depth)
+	{
+		const __m256 lanes = _mm256_set_ps(7.5f, 6.5f, 5.5f, 4.5f, 3.5f, 2.5f, 1.5f, 0.5f);
+		const __m256 a0 = _mm256_set1_ps(s.a[0]), a1 = _mm256_set1_ps(s.a[1]), a2 = _mm256_set1_ps(s.a[2]);
+		const __m256 za = _mm256_set1_ps(s.za);
+		int start = s.x0 & ~7;
+		for (int y = s.y0; y <= s.y1; y++)
+		{
+			float py = y + 0.5f;
+			__m256 r0 = _mm256_set1_ps(s.b[0] * py + s.c[0]), r1 = _mm256_set1_ps(s.b[1] * py + s.c[1]);
+			__m256 r2 = _mm256_set1_ps(s.b[2] * py + s.c[2]), rz = _mm256_set1_ps(s.zb * py + s.zc);
+			float* row = depth + (size_t)y * OCCLUSION_WIDTH;
+			for (int x = start; x <= s.x1; x += 8)
+			{
+				__m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), lanes);
+				__m256 e0 = _mm256_fmadd_ps(a0, px, r0);
+				__m256 e1 = _mm256_fmadd_ps(a1, px, r1);
+				__m256 e2 = _mm256_fmadd_ps(a2, px, r2);
+				// Bit de sinal de min(e0, e1, e2): pixel fora de alguma aresta
+				__m256 outside = _mm256_min_ps(e0, _mm256_min_ps(e1, e2));
+				if (_mm256_movemask_ps(outside) == 0xFF)
+					continue;
+				__m256 current = _mm256_loadu_ps(row + x);
+				__m256 z = _mm256_min_ps(current, _mm256_fmadd_ps(za, px, rz));
+				_mm256_storeu_ps(row + x, _mm256_blendv_ps(z, current, outside));
+			}
+		}
+	}
+#endif
+}
+
+bool OcclusionBuffer::cpuHasAVX2()
+{
+#if defined(OCCLUSION_AVX2) && defined(__GNUC__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(OCCLUSION_AVX2) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	bool fma = (info[2] & (1 << 12)) != 0, osxsave = (info[2] & (1 << 27)) != 0;
+	if (!fma || !osxsave || (_xgetbv(0) & 6) != 6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+const char* OcclusionBuffer::kernelName() const
+{
+	if (!this->simd)
+		return "escalar";
+	if (this->useAVX2 && cpuHasAVX2())
+		return "AVX2";
+#if defined(OCCLUSION_SSE2)
+	return "SSE2";
+#else
+	return "escalar";
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Buffer
+// ----------------------------------------------------------------------------
+
+OcclusionBuffer::OcclusionBuffer()
+{
+	glm::ivec2 size(OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+	while (true)
+	{
+		this->levelSizes.push_back(size);
+		this->levels.emplace_back((size_t)size.x * size.y, 1.0f);
+		if (size.x == 1 && size.y == 1)
+			break;
+		size = glm::max(size / 2, glm::ivec2(1));
+	}
+	this->bins.resize((OCCLUSION_WIDTH / OCCLUSION_TILE_WIDTH) * (OCCLUSION_HEIGHT / OCCLUSION_TILE_HEIGHT));
+}
+
+void OcclusionBuffer::begin(const glm::mat4& viewProjection)
+{
+	this->viewProjection = viewProjection;
+	this->occluders.clear();
+	this->lastStats = OcclusionStats();
+}
+
+void OcclusionBuffer::addOccluder(const OccluderMesh& mesh, const glm::mat4& model)
+{
+	this->occluders.push_back({ &mesh, this->viewProjection * model });
+	this->lastStats.occluders++;
+	this->lastStats.triangles += mesh.nTriangles();
+}
+
+void OcclusionBuffer::rasterize()
+{
+	ThreadPool& pool = ThreadPool::global();
+	const int tilesX = OCCLUSION_WIDTH / OCCLUSION_TILE_WIDTH;
+	const int nTiles = (int)this->bins.size();
+
+	// 1. Transformação e recorte no plano near (z >= -w), um oclusor por item
+	auto t0 = Clock::now();
+	this->triangles.resize(this->occluders.size());
+	pool.parallelFor(this->occluders.size(), [&](size_t o)
+	{
+		const Occluder& occluder = this->occluders[o];
+		const OccluderMesh& mesh = *occluder.mesh;
+		vector<ScreenTriangle>& out = this->triangles[o];
+		out.clear();
+		vector<glm::vec4> clip(mesh.positions.size());
+		for (size_t i = 0; i < clip.size(); i++)
+			clip[i] = occluder.transform * glm::vec4(mesh.positions[i], 1.0f);
+
+		auto toScreen = [](const glm::vec4& c)
+		{
+			glm::vec3 ndc = glm::vec3(c) / c.w;
+			return glm::vec3((ndc.x * 0.5f + 0.5f) * OCCLUSION_WIDTH, (ndc.y * 0.5f + 0.5f) * OCCLUSION_HEIGHT,
+				ndc.z * 0.5f + 0.5f);
+		};
+		for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+		{
+			glm::vec4 v[3] = { clip[mesh.indices[t]], clip[mesh.indices[t + 1]], clip[mesh.indices[t + 2]] };
+			// Inteiro fora de um dos planos laterais ou do far
+			bool rejected = false;
+			for (int axis = 0; axis < 3 && !rejected; axis++)
+			{
+				rejected = (v[0][axis] > v[0].w && v[1][axis] > v[1].w && v[2][axis] > v[2].w) ||
+					(axis < 2 && v[0][axis] < -v[0].w && v[1][axis] < -v[1].w && v[2][axis] < -v[2].w);
+			}
+			if (rejected)
+				continue;
+
+			float d[3] = { v[0].z + v[0].w, v[1].z + v[1].w, v[2].z + v[2].w };
+			if (d[0] >= 0.0f && d[1] >= 0.0f && d[2] >= 0.0f)
+			{
+				out.push_back({ { toScreen(v[0]), toScreen(v[1]), toScreen(v[2]) } });
+				continue;
+			}
+			// Sutherland-Hodgman contra o near: até 4 vértices, depois um leque
+			glm::vec4 polygon[4];
+			int n = 0;
+			for (int i = 0; i < 3; i++)
+			{
+				int j = (i + 1) % 3;
+				if (d[i] >= 0.0f)
+					polygon[n++] = v[i];
+				if ((d[i] >= 0.0f) != (d[j] >= 0.0f))
+					polygon[n++] = v[i] + (v[j] - v[i]) * (d[i] / (d[i] - d[j]));
+			}
+			for (int i = 1; i + 1 < n; i++)
+				out.push_back({ { toScreen(polygon[0]), toScreen(polygon[i]), toScreen(polygon[i + 1]) } });
+		}
+	}, this->maxThreads);
+
+	// 2. Distribuição nos blocos pela caixa de cada triângulo
+	for (vector<glm::ivec2>& bin : this->bins)
+		bin.clear();
+	for (size_t o = 0; o < this->triangles.size(); o++)
+	{
+		for (size_t t = 0; t < this->triangles[o].size(); t++)
+		{
+			const glm::vec3* v = this->triangles[o][t].v;
+			float minX = min(v[0].x, min(v[1].x, v[2].x)), maxX = max(v[0].x, max(v[1].x, v[2].x));
+			float minY = min(v[0].y, min(v[1].y, v[2].y)), maxY = max(v[0].y, max(v[1].y, v[2].y));
+			int x0 = max(0, (int)ceil(minX - 0.5f)), x1 = min(OCCLUSION_WIDTH - 1, (int)floor(maxX - 0.5f));
+			int y0 = max(0, (int)ceil(minY - 0.5f)), y1 = min(OCCLUSION_HEIGHT - 1, (int)floor(maxY - 0.5f));
+			if (x0 > x1 || y0 > y1)
+				continue;
+			for (int ty = y0 / OCCLUSION_TILE_HEIGHT; ty <= y1 / OCCLUSION_TILE_HEIGHT; ty++)
+				for (int tx = x0 / OCCLUSION_TILE_WIDTH; tx <= x1 / OCCLUSION_TILE_WIDTH; tx++)
+					this->bins[ty * tilesX + tx].push_back(glm::ivec2((int)o, (int)t));
+			this->lastStats.trianglesBinned++;
+		}
+	}
+	this->lastStats.setupMs = elapsedMs(t0);
+
+	// 3. Rasterização, um bloco por item
+	auto t1 = Clock::now();
+	float* depth = this->levels[0].data();
+	void (*kernel)(const TriangleSetup&, float*) = rasterScalar;
+#if defined(OCCLUSION_SSE2)
+	if (this->simd)
+		kernel = rasterSSE2;
+#endif
+#if defined(OCCLUSION_AVX2)
+	if (this->simd && this->useAVX2 && cpuHasAVX2())
+		kernel = rasterAVX2;
+#endif
+	pool.parallelFor(nTiles, [&](size_t tile)
+	{
+		int tileX0 = (int)(tile % tilesX) * OCCLUSION_TILE_WIDTH, tileY0 = (int)(tile / tilesX) * OCCLUSION_TILE_HEIGHT;
+		int tileX1 = tileX0 + OCCLUSION_TILE_WIDTH, tileY1 = tileY0 + OCCLUSION_TILE_HEIGHT;
+		for (int y = tileY0; y < tileY1; y++)
+			fill(depth + (size_t)y * OCCLUSION_WIDTH + tileX0, depth + (size_t)y * OCCLUSION_WIDTH + tileX1, 1.0f);
+		for (const glm::ivec2& entry : this->bins[tile])
+		{
+			TriangleSetup setup;
+			if (setupTriangle(this->triangles[entry.x][entry.y].v, tileX0, tileY0, tileX1, tileY1, setup))
+				kernel(setup, depth);
+		}
+	}, this->maxThreads);
+	this->lastStats.rasterMs = elapsedMs(t1);
+
+	// 4. Pirâmide Hi-Z: cada texel guarda a maior profundidade dos 2 x 2 de baixo
+	auto t2 = Clock::now();
+	for (size_t level = 1; level < this->levels.size(); level++)
+	{
+		const vector<float>& below = this->levels[level - 1];
+		glm::ivec2 belowSize = this->levelSizes[level - 1], size = this->levelSizes[level];
+		vector<float>& out = this->levels[level];
+		for (int y = 0; y < size.y; y++)
+		{
+			int y0 = min(2 * y, belowSize.y - 1), y1 = min(2 * y + 1, belowSize.y - 1);
+			for (int x = 0; x < size.x; x++)
+			{
+				int x0 = min(2 * x, belowSize.x - 1), x1 = min(2 * x + 1, belowSize.x - 1);
+				out[(size_t)y * size.x + x] = max(max(below[(size_t)y0 * belowSize.x + x0], below[(size_t)y0 * belowSize.x + x1]),
+					max(below[(size_t)y1 * belowSize.x + x0], below[(size_t)y1 * belowSize.x + x1]));
+			}
+		}
+	}
+	this->lastStats.hizMs = elapsedMs(t2);
+}
+
+bool OcclusionBuffer::isOccluded(const AABB& box)
+{
+	this->lastStats.tested++;
+
+	// Retângulo na tela e profundidade mais próxima dos 8 cantos
+	float minX = INFINITY, maxX = -INFINITY, minY = INFINITY, maxY = -INFINITY, nearest = INFINITY;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 p((corner & 1) ? box.max.x : box.min.x, (corner & 2) ? box.max.y : box.min.y, (corner & 4) ? box.max.z : box.min.z);
+		glm::vec4 clip = this->viewProjection * glm::vec4(p, 1.0f);
+		if (clip.w <= 1e-6f || clip.z < -clip.w)
+			return false; // cruza o near: pode estar na frente de tudo
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		float x = (ndc.x * 0.5f + 0.5f) * OCCLUSION_WIDTH, y = (ndc.y * 0.5f + 0.5f) * OCCLUSION_HEIGHT;
+		minX = min(minX, x);
+		maxX = max(maxX, x);
+		minY = min(minY, y);
+		maxY = max(maxY, y);
+		nearest = min(nearest, ndc.z * 0.5f + 0.5f);
+	}
+	int x0 = max(0, (int)floor(minX)), x1 = min(OCCLUSION_WIDTH - 1, (int)floor(maxX));
+	int y0 = max(0, (int)floor(minY)), y1 = min(OCCLUSION_HEIGHT - 1, (int)floor(maxY));
+	if (x0 > x1 || y0 > y1)
+		return false;
+
+	// Nível em que o retângulo cobre no máximo 4 x 4 texels
+	size_t level = 0;
+	while (level + 1 < this->levels.size() && ((x1 >> level) - (x0 >> level) >= 4 || (y1 >> level) - (y0 >> level) >= 4))
+		level++;
+	const vector<float>& hiz = this->levels[level];
+	int width = this->levelSizes[level].x;
+	float farthest = 0.0f;
+	for (int y = y0 >> level; y <= (y1 >> level); y++)
+		for (int x = x0 >> level; x <= (x1 >> level); x++)
+			farthest = max(farthest, hiz[(size_t)y * width + x]);
+	if (nearest <= farthest)
+		return false;
+	this->lastStats.occluded++;
+	return true;
+}
@@ -0,0 +1,298 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+//GLM
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace std;
+
+typedef chrono::high_resolution_clock Clock;
+
+int RenderQueue::addMaterial(const glm::vec4& color, GLuint texture, float lineWidth, float pointSize)
+{
+	RenderMaterial material;
+	material.color = color;
+	material.texture = texture;
+	material.lineWidth = lineWidth;
+	material.pointSize = pointSize;
+	this->materials.push_back(material);
+	return (int)this->materials.size() - 1;
+}
+
+void RenderQueue::setBackToFront(int pass, bool backToFront)
+{
+	uint16_t bit = (uint16_t)(1u << (pass & (RENDER_QUEUE_MAX_PASSES - 1)));
+	if (backToFront)
+		this->backToFront |= bit;
+	else
+		this->backToFront &= (uint16_t)~bit;
+}
+
+void RenderQueue::begin()
+{
+	this->packets.clear();
+	this->packetProgram.clear();
+	this->packetVAO.clear();
+	this->keys.clear();
+	this->sorted = false;
+}
+
+void RenderQueue::push(const RenderPacket& packet)
+{
+	this->packets.push_back(packet);
+	this->packetProgram.push_back(programSlot(packet.shader));
+	this->packetVAO.push_back(vaoSlot(packet.VAO));
+	this->sorted = false;
+}
+
+void RenderQueue::drawArrays(int pass, Shader* shader, GLuint VAO, int material, GLenum mode, GLint first, GLsizei count,
+	const glm::mat4* model, float depth)
+{
+	RenderPacket packet;
+	packet.pass = pass;
+	packet.shader = shader;
+	packet.VAO = VAO;
+	packet.material = material;
+	packet.mode = mode;
+	packet.first = first;
+	packet.count = count;
+	packet.depth = depth;
+	if (model)
+	{
+		packet.hasModel = true;
+		packet.model = *model;
+	}
+	push(packet);
+}
+
+void RenderQueue::drawElements(int pass, Shader* shader, GLuint VAO, int material, GLenum mode, GLint firstIndex, GLsizei count,
+	const glm::mat4* model, float depth)
+{
+	RenderPacket packet;
+	packet.pass = pass;
+	packet.shader = shader;
+	packet.VAO = VAO;
+	packet.material = material;
+	packet.mode = mode;
+	packet.first = firstIndex;
+	packet.count = count;
+	packet.indexed = true;
+	packet.depth = depth;
+	if (model)
+	{
+		packet.hasModel = true;
+		packet.model = *model;
+	}
+	push(packet);
+}
+
+int RenderQueue::programSlot(Shader* shader)
+{
+	auto found = this->programIndex.find(shader->ID);
+	if (found != this->programIndex.end())
+		return found->second;
+	ProgramSlot slot = {};
+	slot.program = shader->ID;
+	slot.colorLocation = shader->uniform(this->colorUniform);
+	slot.modelLocation = shader->uniform(this->modelUniform);
+	this->programs.push_back(slot);
+	int index = (int)this->programs.size() - 1;
+	this->programIndex.emplace(shader->ID, index);
+	return index;
+}
+
+int RenderQueue::vaoSlot(GLuint VAO)
+{
+	auto found = this->vaoIndex.find(VAO);
+	if (found != this->vaoIndex.end())
+		return found->second;
+	int index = (int)this->vaoIndex.size();
+	this->vaoIndex.emplace(VAO, index);
+	return index;
+}
+
+void RenderQueue::clearSlots()
+{
+	begin();
+	this->programs.clear();
+	this->programIndex.clear();
+	this->vaoIndex.clear();
+}
+
+uint64_t RenderQueue::makeKey(const RenderPacket& packet, int program, int vao) const
+{
+	const uint32_t maxDepth = (1u << RENDER_QUEUE_DEPTH_BITS) - 1;
+	int pass = packet.pass & (RENDER_QUEUE_MAX_PASSES - 1);
+	uint32_t depth = (uint32_t)(glm::clamp(packet.depth, 0.0f, 1.0f) * maxDepth + 0.5f);
+	if (this->backToFront & (1u << pass))
+		depth = maxDepth - depth;
+
+	// material + 1: pacotes sem material (-1) vêm antes dos demais
+	uint64_t key = (uint64_t)pass;
+	key = (key << RENDER_QUEUE_PROGRAM_BITS) | ((uint64_t)program & ((1u << RENDER_QUEUE_PROGRAM_BITS) - 1));
+	key = (key << RENDER_QUEUE_MATERIAL_BITS) | ((uint64_t)(packet.material + 1) & ((1u << RENDER_QUEUE_MATERIAL_BITS) - 1));
+	key = (key << RENDER_QUEUE_VAO_BITS) | ((uint64_t)vao & ((1u << RENDER_QUEUE_VAO_BITS) - 1));
+	key = (key << RENDER_QUEUE_DEPTH_BITS) | depth;
+	return key;
+}
+
+void RenderQueue::sort()
+{
+	auto t0 = Clock::now();
+	size_t n = this->packets.size();
+	this->keys.resize(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		this->keys[i].key = makeKey(this->packets[i], this->packetProgram[i], this->packetVAO[i]);
+		this->keys[i].packet = (uint32_t)i;
+	}
+	radixSort();
+	this->sorted = true;
+	this->sortMs = chrono::duration<double, milli>(Clock::now() - t0).count();
+}
+
+// LSD: uma passada estável por byte, do menos para o mais significativo. Os oito
+// histogramas saem de uma única leitura das chaves; um byte igual em todas as chaves
+// (por exemplo, os bits altos da profundidade quando ela não é usada) não precisa de
+// passada.
+void RenderQueue::radixSort()
+{
+	size_t n = this->keys.size();
+	if (n < 2)
+		return;
+	this->scratch.resize(n);
+
+	static const int DIGITS = 8;
+	uint32_t counts[DIGITS][256];
+	memset(counts, 0, sizeof(counts));
+	for (const SortEntry& entry : this->keys)
+		for (int d = 0; d < DIGITS; d++)
+			counts[d][(entry.key >> (8 * d)) & 0xFF]++;
+
+	SortEntry* source = this->keys.data();
+	SortEntry* target = this->scratch.data();
+	for (int d = 0; d < DIGITS; d++)
+	{
+		int shift = 8 * d;
+		if (counts[d][(source[0].key >> shift) & 0xFF] == n)
+			continue;
+		uint32_t offsets[256];
+		uint32_t sum = 0;
+		for (int b = 0; b < 256; b++)
+		{
+			offsets[b] = sum;
+			sum += counts[d][b];
+		}
+		for (size_t i = 0; i < n; i++)
+			target[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+		swap(source, target);
+	}
+	if (source != this->keys.data())
+		this->keys.swap(this->scratch);
+}
+
+RenderQueueStats RenderQueue::submit()
+{
+	RenderQueueStats stats;
+	size_t n = this->packets.size();
+	stats.packets = (int)n;
+	stats.sortMs = this->sorted ? this->sortMs : 0.0;
+
+	// Trocas da ordem do push, só para comparação
+	for (size_t i = 0; i < n; i++)
+	{
+		const RenderPacket& packet = this->packets[i];
+		const RenderPacket* previous = i > 0 ? &this->packets[i - 1] : nullptr;
+		if (!previous || packet.shader->ID != previous->shader->ID)
+			stats.programChangesInOrder++;
+		if (!previous || packet.VAO != previous->VAO)
+			stats.vaoChangesInOrder++;
+	}
+	bool anyTexture = false;
+	GLuint lastTexture = 0;
+	for (const RenderPacket& packet : this->packets)
+	{
+		if (packet.material < 0)
+			continue;
+		GLuint texture = this->materials[packet.material].texture;
+		if (!anyTexture || texture != lastTexture)
+			stats.textureChangesInOrder++;
+		anyTexture = true;
+		lastTexture = texture;
+	}
+
+	// Os uniforms podem ter sido mudados fora da fila desde o último submit
+	for (ProgramSlot& slot : this->programs)
+		slot.colorSent = slot.modelSent = false;
+
+	GLuint program = 0, VAO = 0, texture = 0;
+	bool programBound = false, vaoBound = false, textureBound = false;
+	float lineWidth = 0.0f, pointSize = 0.0f;
+	for (size_t i = 0; i < n; i++)
+	{
+		size_t index = this->sorted ? this->keys[i].packet : i;
+		const RenderPacket& packet = this->packets[index];
+		ProgramSlot& slot = this->programs[this->packetProgram[index]];
+
+		if (!programBound || packet.shader->ID != program)
+		{
+			program = packet.shader->ID;
+			glUseProgram(program);
+			programBound = true;
+			stats.programChanges++;
+		}
+		if (packet.material >= 0)
+		{
+			const RenderMaterial& material = this->materials[packet.material];
+			if (!textureBound || material.texture != texture)
+			{
+				texture = material.texture;
+				glBindTexture(GL_TEXTURE_2D, texture);
+				textureBound = true;
+				stats.textureChanges++;
+			}
+			if (slot.colorLocation >= 0 && (!slot.colorSent || slot.color != material.color))
+			{
+				slot.color = material.color;
+				slot.colorSent = true;
+				glUniform4fv(slot.colorLocation, 1, glm::value_ptr(material.color));
+				stats.uniformUploads++;
+			}
+			if (material.lineWidth > 0.0f && material.lineWidth != lineWidth)
+			{
+				lineWidth = material.lineWidth;
+				glLineWidth(lineWidth);
+			}
+			if (material.pointSize > 0.0f && material.pointSize != pointSize)
+			{
+				pointSize = material.pointSize;
+				glPointSize(pointSize);
+			}
+		}
+		if (packet.hasModel && slot.modelLocation >= 0
+			&& (!slot.modelSent || memcmp(&slot.model, &packet.model, sizeof(glm::mat4)) != 0))
+		{
+			slot.model = packet.model;
+			slot.modelSent = true;
+			glUniformMatrix4fv(slot.modelLocation, 1, GL_FALSE, glm::value_ptr(packet.model));
+			stats.uniformUploads++;
+		}
+		if (!vaoBound || packet.VAO != VAO)
+		{
+			VAO = packet.VAO;
+			glBindVertexArray(VAO);
+			vaoBound = true;
+			stats.vaoChanges++;
+		}
+
+		if (packet.indexed)
+			glDrawElements(packet.mode, packet.count, GL_UNSIGNED_INT, (GLvoid*)(packet.first * sizeof(GLuint)));
+		else
+			glDrawArrays(packet.mode, packet.first, packet.count);
+	}
+	glBindVertexArray(0);
+	return stats;
+}
@@ -0,0 +1,427 @@
+#include "SceneBVH.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCENE_BVH_SSE2 1
+#endif
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SCENE_BVH_AVX 1
+#endif
+
+using namespace std;
+
+// Caixa que nenhum plano aceita: posições vazias das folhas e objetos removidos
+const float EMPTY_MIN = 1e30f, EMPTY_MAX = -1e30f;
+
+int SceneBVH::insert(const AABB& bounds)
+{
+	int id;
+	if (!this->freeIds.empty())
+	{
+		id = this->freeIds.back();
+		this->freeIds.pop_back();
+		this->objectBounds[id] = bounds;
+		this->alive[id] = 1;
+	}
+	else
+	{
+		id = (int)this->objectBounds.size();
+		this->objectBounds.push_back(bounds);
+		this->objectSlot.push_back(-1);
+		this->alive.push_back(1);
+	}
+	this->objectSlot[id] = -1;
+	this->nAlive++;
+	this->structureDirty = true;
+	return id;
+}
+
+void SceneBVH::update(int id, const AABB& bounds)
+{
+	this->objectBounds[id] = bounds;
+	int slot = this->objectSlot[id];
+	if (slot >= 0)
+	{
+		setLeafSlot(this->leaves[slot / SCENE_BVH_LEAF_SIZE], slot % SCENE_BVH_LEAF_SIZE, bounds);
+		this->boundsDirty = true;
+	}
+}
+
+void SceneBVH::remove(int id)
+{
+	if (!this->alive[id])
+		return;
+	int slot = this->objectSlot[id];
+	if (slot >= 0)
+	{
+		Leaf& leaf = this->leaves[slot / SCENE_BVH_LEAF_SIZE];
+		AABB empty;
+		empty.min = glm::vec3(EMPTY_MIN);
+		empty.max = glm::vec3(EMPTY_MAX);
+		setLeafSlot(leaf, slot % SCENE_BVH_LEAF_SIZE, empty);
+		leaf.ids[slot % SCENE_BVH_LEAF_SIZE] = -1;
+		this->boundsDirty = true;
+	}
+	this->alive[id] = 0;
+	this->objectSlot[id] = -1;
+	this->freeIds.push_back(id);
+	this->nAlive--;
+}
+
+void SceneBVH::clear()
+{
+	this->objectBounds.clear();
+	this->objectSlot.clear();
+	this->alive.clear();
+	this->freeIds.clear();
+	this->nAlive = 0;
+	this->nodes.clear();
+	this->leaves.clear();
+	this->structureDirty = this->boundsDirty = false;
+	this->builtArea = 0.0f;
+}
+
+void SceneBVH::setLeafSlot(Leaf& leaf, int slot, const AABB& box)
+{
+	leaf.minX[slot] = box.min.x;
+	leaf.minY[slot] = box.min.y;
+	leaf.minZ[slot] = box.min.z;
+	leaf.maxX[slot] = box.max.x;
+	leaf.maxY[slot] = box.max.y;
+	leaf.maxZ[slot] = box.max.z;
+}
+
+// ----------------------------------------------------------------------------
+// Montagem e refit
+// ----------------------------------------------------------------------------
+
+void SceneBVH::rebuild()
+{
+	this->nodes.clear();
+	this->leaves.clear();
+	this->structureDirty = this->boundsDirty = false;
+	this->rebuilds++;
+
+	vector<int> ids;
+	vector<glm::vec3> centers;
+	ids.reserve(this->nAlive);
+	centers.reserve(this->nAlive);
+	for (size_t id = 0; id < this->alive.size(); id++)
+	{
+		if (!this->alive[id])
+			continue;
+		ids.push_back((int)id);
+		centers.push_back(this->objectBounds[id].center());
+	}
+	this->nodes.reserve(2 * (ids.size() / SCENE_BVH_LEAF_SIZE + 1));
+	this->leaves.reserve(ids.size() / (SCENE_BVH_LEAF_SIZE / 2) + 1);
+	this->builtArea = 0.0f;
+	if (ids.empty())
+		return;
+	build(ids, centers, 0, (int)ids.size());
+	for (const Node& node : this->nodes)
+		this->builtArea += node.box.halfArea();
+}
+
+// Monta a subárvore dos objetos ids[begin, end) e devolve o índice do nó
+int SceneBVH::build(vector<int>& ids, vector<glm::vec3>& centers, int begin, int end)
+{
+	int index = (int)this->nodes.size();
+	this->nodes.emplace_back();
+
+	AABB box = AABB::empty(), centerBox = AABB::empty();
+	for (int i = begin; i < end; i++)
+	{
+		box.grow(this->objectBounds[ids[i]]);
+		centerBox.min = glm::min(centerBox.min, centers[i]);
+		centerBox.max = glm::max(centerBox.max, centers[i]);
+	}
+	this->nodes[index].box = box;
+
+	int count = end - begin;
+	if (count <= SCENE_BVH_LEAF_SIZE)
+	{
+		Leaf leaf;
+		leaf.count = count;
+		for (int slot = 0; slot < SCENE_BVH_LEAF_SIZE; slot++)
+		{
+			AABB slotBox;
+			slotBox.min = glm::vec3(EMPTY_MIN);
+			slotBox.max = glm::vec3(EMPTY_MAX);
+			leaf.ids[slot] = -1;
+			if (slot < count)
+			{
+				int id = ids[begin + slot];
+				slotBox = this->objectBounds[id];
+				leaf.ids[slot] = id;
+				this->objectSlot[id] = (int)this->leaves.size() * SCENE_BVH_LEAF_SIZE + slot;
+			}
+			setLeafSlot(leaf, slot, slotBox);
+		}
+		this->nodes[index].firstLeaf = (int)this->leaves.size();
+		this->nodes[index].leafCount = 1;
+		this->leaves.push_back(leaf);
+		return index;
+	}
+
+	// SAH com SCENE_BVH_BINS caixas por eixo: custo = área * objetos de cada lado
+	int bestAxis = -1, bestSplit = 0;
+	float bestCost = INFINITY;
+	glm::vec3 extent = centerBox.extent();
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (extent[axis] <= 0.0f)
+			continue;
+		AABB binBox[SCENE_BVH_BINS];
+		int binCount[SCENE_BVH_BINS] = {};
+		for (AABB& b : binBox)
+			b = AABB::empty();
+		float scale = SCENE_BVH_BINS / extent[axis];
+		for (int i = begin; i < end; i++)
+		{
+			int bin = min(SCENE_BVH_BINS - 1, (int)((centers[i][axis] - centerBox.min[axis]) * scale));
+			binBox[bin].grow(this->objectBounds[ids[i]]);
+			binCount[bin]++;
+		}
+		// Área e contagem à direita de cada divisão, depois a varredura da esquerda
+		float rightArea[SCENE_BVH_BINS];
+		int rightCount[SCENE_BVH_BINS];
+		AABB right = AABB::empty();
+		int n = 0;
+		for (int b = SCENE_BVH_BINS - 1; b > 0; b--)
+		{
+			right.grow(binBox[b]);
+			n += binCount[b];
+			rightArea[b] = n > 0 ? right.halfArea() : 0.0f;
+			rightCount[b] = n;
+		}
+		AABB left = AABB::empty();
+		n = 0;
+		for (int b = 1; b < SCENE_BVH_BINS; b++)
+		{
+			left.grow(binBox[b - 1]);
+			n += binCount[b - 1];
+			if (n == 0 || rightCount[b] == 0)
+				continue;
+			float cost = left.halfArea() * n + rightArea[b] * rightCount[b];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = b;
+			}
+		}
+	}
+
+	int mid = begin + count / 2;
+	if (bestAxis >= 0)
+	{
+		float scale = SCENE_BVH_BINS / extent[bestAxis];
+		float origin = centerBox.min[bestAxis];
+		int i = begin, j = end - 1;
+		while (i <= j)
+		{
+			int bin = min(SCENE_BVH_BINS - 1, (int)((centers[i][bestAxis] - origin) * scale));
+			if (bin < bestSplit)
+			{
+				i++;
+			}
+			else
+			{
+				swap(ids[i], ids[j]);
+				swap(centers[i], centers[j]);
+				j--;
+			}
+		}
+		mid = i;
+	}
+	if (mid == begin || mid == end)
+	{
+		// Centros todos iguais: divide ao meio na ordem em que estão
+		mid = begin + count / 2;
+	}
+
+	int left = build(ids, centers, begin, mid);
+	int right = build(ids, centers, mid, end);
+	Node& node = this->nodes[index];
+	node.left = left;
+	node.right = right;
+	node.firstLeaf = this->nodes[left].firstLeaf;
+	node.leafCount = this->nodes[left].leafCount + this->nodes[right].leafCount;
+	return index;
+}
+
+void SceneBVH::refit()
+{
+	if (this->structureDirty)
+	{
+		rebuild();
+		return;
+	}
+	this->boundsDirty = false;
+	float area = 0.0f;
+	// Pré-ordem ao contrário: os filhos são recalculados antes do pai
+	for (int n = (int)this->nodes.size() - 1; n >= 0; n--)
+	{
+		Node& node = this->nodes[n];
+		if (node.left < 0)
+		{
+			const Leaf& leaf = this->leaves[node.firstLeaf];
+			AABB box = AABB::empty();
+			for (int slot = 0; slot < leaf.count; slot++)
+			{
+				if (leaf.ids[slot] < 0)
+					continue;
+				box.grow(this->objectBounds[leaf.ids[slot]]);
+			}
+			node.box = box;
+		}
+		else
+		{
+			node.box = this->nodes[node.left].box;
+			node.box.grow(this->nodes[node.right].box);
+		}
+		if (node.box.min.x <= node.box.max.x)
+			area += node.box.halfArea();
+	}
+	if (area > this->builtArea * SCENE_BVH_REBUILD_RATIO)
+		rebuild();
+}
+
+// ----------------------------------------------------------------------------
+// Culling
+// ----------------------------------------------------------------------------
+
+// Bits das posições da folha cuja caixa não está inteira fora de nenhum dos planos
+// de planeMask. Para cada plano o canto mais à frente na direção da normal é o mesmo
+// para todas as caixas (max onde a normal é positiva, min onde é negativa), então
+// basta escolher o array de cada eixo e fazer 3 multiplicações e somas por 8 caixas.
+unsigned SceneBVH::testLeaf(const Leaf& leaf, const Frustum& frustum, unsigned planeMask) const
+{
+	unsigned valid = (1u << leaf.count) - 1;
+	if (this->simd)
+	{
+#if defined(SCENE_BVH_AVX)
+		__m256 outside = _mm256_setzero_ps(), zero = _mm256_setzero_ps();
+		for (int p = 0; p < FRUSTUM_PLANES; p++)
+		{
+			if (!(planeMask & (1u << p)))
+				continue;
+			const glm::vec4& plane = frustum.planes[p];
+			__m256 x = _mm256_load_ps(plane.x > 0.0f ? leaf.maxX : leaf.minX);
+			__m256 y = _mm256_load_ps(plane.y > 0.0f ? leaf.maxY : leaf.minY);
+			__m256 z = _mm256_load_ps(plane.z > 0.0f ? leaf.maxZ : leaf.minZ);
+			__m256 d = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), x), _mm256_set1_ps(plane.w));
+			d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(plane.y), y));
+			d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(plane.z), z));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, zero, _CMP_LT_OQ));
+		}
+		return ~(unsigned)_mm256_movemask_ps(outside) & valid;
+#elif defined(SCENE_BVH_SSE2)
+		__m128 outside0 = _mm_setzero_ps(), outside1 = _mm_setzero_ps(), zero = _mm_setzero_ps();
+		for (int p = 0; p < FRUSTUM_PLANES; p++)
+		{
+			if (!(planeMask & (1u << p)))
+				continue;
+			const glm::vec4& plane = frustum.planes[p];
+			const float* xs = plane.x > 0.0f ? leaf.maxX : leaf.minX;
+			const float* ys = plane.y > 0.0f ? leaf.maxY : leaf.minY;
+			const float* zs = plane.z > 0.0f ? leaf.maxZ : leaf.minZ;
+			__m128 nx = _mm_set1_ps(plane.x), ny = _mm_set1_ps(plane.y), nz = _mm_set1_ps(plane.z), w = _mm_set1_ps(plane.w);
+			__m128 d0 = _mm_add_ps(_mm_mul_ps(nx, _mm_load_ps(xs)), w);
+			__m128 d1 = _mm_add_ps(_mm_mul_ps(nx, _mm_load_ps(xs + 4)), w);
+			d0 = _mm_add_ps(d0, _mm_mul_ps(ny, _mm_load_ps(ys)));
+			d1 = _mm_add_ps(d1, _mm_mul_ps(ny, _mm_load_ps(ys + 4)));
+			d0 = _mm_add_ps(d0, _mm_mul_ps(nz, _mm_load_ps(zs)));
+			d1 = _mm_add_ps(d1, _mm_mul_ps(nz, _mm_load_ps(zs + 4)));
+			outside0 = _mm_or_ps(outside0, _mm_cmplt_ps(d0, zero));
+			outside1 = _mm_or_ps(outside1, _mm_cmplt_ps(d1, zero));
+		}
+		unsigned outside = (unsigned)_mm_movemask_ps(outside0) | (unsigned)_mm_movemask_ps(outside1) << 4;
+		return ~outside & valid;
+#endif
+	}
+	unsigned visible = 0;
+	for (int slot = 0; slot < leaf.count; slot++)
+	{
+		bool inside = true;
+		for (int p = 0; p < FRUSTUM_PLANES && inside; p++)
+		{
+			if (!(planeMask & (1u << p)))
+				continue;
+			const glm::vec4& plane = frustum.planes[p];
+			float d = plane.x * (plane.x > 0.0f ? leaf.maxX[slot] : leaf.minX[slot])
+				+ plane.y * (plane.y > 0.0f ? leaf.maxY[slot] : leaf.minY[slot])
+				+ plane.z * (plane.z > 0.0f ? leaf.maxZ[slot] : leaf.minZ[slot]) + plane.w;
+			inside = d >= 0.0f;
+		}
+		if (inside)
+			visible |= 1u << slot;
+	}
+	return visible;
+}
+
+void SceneBVH::cull(const Frustum& frustum, vector<int>& visible, CullStats* stats)
+{
+	if (this->structureDirty)
+		rebuild();
+	else if (this->boundsDirty)
+		refit();
+
+	CullStats local;
+	visible.clear();
+	if (!this->nodes.empty())
+	{
+		struct Entry
+		{
+			int node;
+			unsigned planeMask;
+		};
+		vector<Entry> stack;
+		stack.reserve(64);
+		stack.push_back({ 0, (1u << FRUSTUM_PLANES) - 1 });
+		while (!stack.empty())
+		{
+			Entry entry = stack.back();
+			stack.pop_back();
+			const Node& node = this->nodes[entry.node];
+			local.nodesVisited++;
+			unsigned planeMask = entry.planeMask;
+			FrustumTest test = frustum.testAABB(node.box, planeMask);
+			if (test == FRUSTUM_OUTSIDE)
+				continue;
+			if (test == FRUSTUM_INSIDE)
+			{
+				// Subárvore inteira dentro: todas as folhas, sem testar caixa por caixa
+				for (int l = node.firstLeaf; l < node.firstLeaf + node.leafCount; l++)
+				{
+					const Leaf& leaf = this->leaves[l];
+					for (int slot = 0; slot < leaf.count; slot++)
+						if (leaf.ids[slot] >= 0)
+							visible.push_back(leaf.ids[slot]);
+				}
+				local.leavesAccepted += node.leafCount;
+				continue;
+			}
+			if (node.left < 0)
+			{
+				const Leaf& leaf = this->leaves[node.firstLeaf];
+				unsigned bits = testLeaf(leaf, frustum, planeMask);
+				for (int slot = 0; slot < leaf.count; slot++)
+					if ((bits & (1u << slot)) && leaf.ids[slot] >= 0)
+						visible.push_back(leaf.ids[slot]);
+				local.leavesTested++;
+				continue;
+			}
+			stack.push_back({ node.right, planeMask });
+			stack.push_back({ node.left, planeMask });
+		}
+	}
+	local.visible = (int)visible.size();
+	local.culled = this->nAlive - local.visible;
+	if (stats)
+		*stats = local;
+}
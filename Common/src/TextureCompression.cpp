@@ -0,0 +1,653 @@
+#include "TextureCompression.h"
+#include "MeshCache.h"
+#include "ThreadPool.h"
+
+#include <fstream>
+#include <cstring>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTURE_COMPRESSION_SSE2 1
+#endif
+
+using namespace std;
+
+size_t blockBytes(uint32_t format)
+{
+	return format == BLOCK_BC3 ? 16 : 8;
+}
+
+size_t levelBytes(uint32_t format, int width, int height)
+{
+	if (format == BLOCK_RGBA8)
+		return (size_t)width * height * 4;
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+void TextureLevels::allocate(uint32_t format, int width, int height)
+{
+	this->format = format;
+	this->width = width;
+	this->height = height;
+	this->levels.clear();
+	size_t offset = 0;
+	for (int w = width, h = height; ; w = max(1, w / 2), h = max(1, h / 2))
+	{
+		TextureCacheLevel level;
+		level.width = (uint32_t)w;
+		level.height = (uint32_t)h;
+		level.offset = offset;
+		level.size = levelBytes(format, w, h);
+		offset += (size_t)level.size;
+		this->levels.push_back(level);
+		if (w == 1 && h == 1)
+			break;
+	}
+	this->data.resize(offset);
+}
+
+size_t rgba8ChainBytes(int width, int height)
+{
+	size_t bytes = 0;
+	for (int w = width, h = height; ; w = max(1, w / 2), h = max(1, h / 2))
+	{
+		bytes += (size_t)w * h * 4;
+		if (w == 1 && h == 1)
+			break;
+	}
+	return bytes;
+}
+
+// ----------------------------------------------------------------------------
+// Cores 5:6:5
+// ----------------------------------------------------------------------------
+
+// Extremos do bloco já quantizados: r e b em 0..31, g em 0..63
+struct Endpoint
+{
+	int c[3];
+};
+
+static inline uint16_t pack565(const Endpoint& e)
+{
+	return (uint16_t)((e.c[0] << 11) | (e.c[1] << 5) | e.c[2]);
+}
+
+static inline Endpoint unpack565(uint16_t v)
+{
+	return Endpoint{ { (v >> 11) & 31, (v >> 5) & 63, v & 31 } };
+}
+
+// 5:6:5 -> 8 bits replicando os bits altos, como o decodificador
+static inline void expand565(const Endpoint& e, int rgb[3])
+{
+	rgb[0] = (e.c[0] << 3) | (e.c[0] >> 2);
+	rgb[1] = (e.c[1] << 2) | (e.c[1] >> 4);
+	rgb[2] = (e.c[2] << 3) | (e.c[2] >> 2);
+}
+
+static inline Endpoint quantize565(float r, float g, float b)
+{
+	auto q = [](float v, int maxValue) { return min(maxValue, max(0, (int)lround(v / 255.0f * maxValue))); };
+	return Endpoint{ { q(r, 31), q(g, 63), q(b, 31) } };
+}
+
+// Paleta de 4 cores do modo c0 > c1: c0, c1, 2/3 c0 + 1/3 c1 e 1/3 c0 + 2/3 c1
+static void palette4(const Endpoint& e0, const Endpoint& e1, int colors[4][3])
+{
+	expand565(e0, colors[0]);
+	expand565(e1, colors[1]);
+	for (int k = 0; k < 3; k++)
+	{
+		colors[2][k] = (2 * colors[0][k] + colors[1][k]) / 3;
+		colors[3][k] = (colors[0][k] + 2 * colors[1][k]) / 3;
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Busca dos extremos de BC1
+// ----------------------------------------------------------------------------
+
+// Bloco em estrutura de arrays, para o erro de 4 pixels por instrução
+struct ColorBlock
+{
+	alignas(16) float r[16];
+	alignas(16) float g[16];
+	alignas(16) float b[16];
+};
+
+// Erro quadrático do bloco com cada pixel na cor mais próxima da paleta e, se indices
+// não for nulo, o índice dessa cor. É a parte que roda dezenas de vezes por bloco durante
+// a busca dos extremos, então tem versão SSE2 (4 pixels por instrução).
+static float paletteError(const ColorBlock& block, const int colors[4][3], int* indices = nullptr)
+{
+#ifdef TEXTURE_COMPRESSION_SSE2
+	__m128 pr[4], pg[4], pb[4];
+	for (int k = 0; k < 4; k++)
+	{
+		pr[k] = _mm_set1_ps((float)colors[k][0]);
+		pg[k] = _mm_set1_ps((float)colors[k][1]);
+		pb[k] = _mm_set1_ps((float)colors[k][2]);
+	}
+	__m128 total = _mm_setzero_ps();
+	for (int i = 0; i < 16; i += 4)
+	{
+		__m128 r = _mm_load_ps(block.r + i), g = _mm_load_ps(block.g + i), b = _mm_load_ps(block.b + i);
+		__m128 best = _mm_set1_ps(1e30f);
+		__m128i bestIndex = _mm_setzero_si128();
+		for (int k = 0; k < 4; k++)
+		{
+			__m128 dr = _mm_sub_ps(r, pr[k]), dg = _mm_sub_ps(g, pg[k]), db = _mm_sub_ps(b, pb[k]);
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+			if (indices)
+			{
+				__m128i closer = _mm_castps_si128(_mm_cmplt_ps(d, best));
+				bestIndex = _mm_or_si128(_mm_andnot_si128(closer, bestIndex), _mm_and_si128(closer, _mm_set1_epi32(k)));
+			}
+			best = _mm_min_ps(best, d);
+		}
+		total = _mm_add_ps(total, best);
+		if (indices)
+			_mm_storeu_si128((__m128i*)(indices + i), bestIndex);
+	}
+	alignas(16) float lanes[4];
+	_mm_store_ps(lanes, total);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+	float total = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		float best = 1e30f;
+		int bestIndex = 0;
+		for (int k = 0; k < 4; k++)
+		{
+			float dr = block.r[i] - colors[k][0], dg = block.g[i] - colors[k][1], db = block.b[i] - colors[k][2];
+			float d = dr * dr + dg * dg + db * db;
+			if (d < best)
+			{
+				best = d;
+				bestIndex = k;
+			}
+		}
+		total += best;
+		if (indices)
+			indices[i] = bestIndex;
+	}
+	return total;
+#endif
+}
+
+static float endpointError(const ColorBlock& block, const Endpoint& e0, const Endpoint& e1, int* indices = nullptr)
+{
+	int colors[4][3];
+	palette4(e0, e1, colors);
+	return paletteError(block, colors, indices);
+}
+
+// Extremos iniciais: pontas da projeção dos pixels no eixo principal (maior autovetor
+// da covariância, por iteração de potência)
+static void principalEndpoints(const ColorBlock& block, Endpoint& e0, Endpoint& e1)
+{
+	float mean[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++)
+	{
+		mean[0] += block.r[i];
+		mean[1] += block.g[i];
+		mean[2] += block.b[i];
+	}
+	for (float& m : mean)
+		m /= 16.0f;
+	float cov[6] = { 0, 0, 0, 0, 0, 0 }; // rr rg rb gg gb bb
+	for (int i = 0; i < 16; i++)
+	{
+		float r = block.r[i] - mean[0], g = block.g[i] - mean[1], b = block.b[i] - mean[2];
+		cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+		cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+	}
+	float axis[3] = { cov[0], cov[3], cov[5] }; // começa pelo canal de maior variância
+	for (int it = 0; it < 6; it++)
+	{
+		float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+		float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+		float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+		float length = max(max(fabs(x), fabs(y)), fabs(z));
+		if (length < 1e-6f)
+			break;
+		axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+	}
+	float lengthSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+	if (lengthSq < 1e-12f)
+	{
+		e0 = e1 = quantize565(mean[0], mean[1], mean[2]);
+		return;
+	}
+	float tMin = 1e30f, tMax = -1e30f;
+	for (int i = 0; i < 16; i++)
+	{
+		float t = ((block.r[i] - mean[0]) * axis[0] + (block.g[i] - mean[1]) * axis[1] + (block.b[i] - mean[2]) * axis[2]) / lengthSq;
+		tMin = min(tMin, t);
+		tMax = max(tMax, t);
+	}
+	e0 = quantize565(mean[0] + axis[0] * tMax, mean[1] + axis[1] * tMax, mean[2] + axis[2] * tMax);
+	e1 = quantize565(mean[0] + axis[0] * tMin, mean[1] + axis[1] * tMin, mean[2] + axis[2] * tMin);
+}
+
+// Mínimos quadrados: com os índices fixos, os extremos que minimizam o erro
+static bool refineEndpoints(const ColorBlock& block, const int indices[16], Endpoint& e0, Endpoint& e1)
+{
+	static const float weight0[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	float aa = 0, ab = 0, bb = 0, ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++)
+	{
+		float a = weight0[indices[i]], b = 1.0f - a;
+		float x[3] = { block.r[i], block.g[i], block.b[i] };
+		aa += a * a; ab += a * b; bb += b * b;
+		for (int k = 0; k < 3; k++)
+		{
+			ax[k] += a * x[k];
+			bx[k] += b * x[k];
+		}
+	}
+	float det = aa * bb - ab * ab;
+	if (fabs(det) < 1e-6f)
+		return false;
+	float c0[3], c1[3];
+	for (int k = 0; k < 3; k++)
+	{
+		c0[k] = (ax[k] * bb - bx[k] * ab) / det;
+		c1[k] = (bx[k] * aa - ax[k] * ab) / det;
+	}
+	e0 = quantize565(c0[0], c0[1], c0[2]);
+	e1 = quantize565(c1[0], c1[1], c1[2]);
+	return true;
+}
+
+static void findEndpoints(const ColorBlock& block, Endpoint& e0, Endpoint& e1)
+{
+	principalEndpoints(block, e0, e1);
+	float error = endpointError(block, e0, e1);
+
+	for (int it = 0; it < 2; it++)
+	{
+		int indices[16];
+		endpointError(block, e0, e1, indices);
+		Endpoint r0, r1;
+		if (!refineEndpoints(block, indices, r0, r1))
+			break;
+		float refined = endpointError(block, r0, r1);
+		if (refined >= error)
+			break;
+		e0 = r0;
+		e1 = r1;
+		error = refined;
+	}
+
+	// Busca local: move um canal de um extremo por um passo de quantização enquanto o
+	// erro diminuir
+	const int maxValue[3] = { 31, 63, 31 };
+	for (int it = 0; it < 16 && error > 0.0f; it++)
+	{
+		Endpoint best0 = e0, best1 = e1;
+		float bestError = error;
+		for (int which = 0; which < 2; which++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				for (int step = -1; step <= 1; step += 2)
+				{
+					Endpoint c0 = e0, c1 = e1;
+					Endpoint& moved = which == 0 ? c0 : c1;
+					moved.c[k] += step;
+					if (moved.c[k] < 0 || moved.c[k] > maxValue[k])
+						continue;
+					float candidate = endpointError(block, c0, c1);
+					if (candidate < bestError)
+					{
+						bestError = candidate;
+						best0 = c0;
+						best1 = c1;
+					}
+				}
+			}
+		}
+		if (bestError >= error)
+			break;
+		e0 = best0;
+		e1 = best1;
+		error = bestError;
+	}
+}
+
+static void loadColorBlock(const unsigned char* rgba, ColorBlock& block)
+{
+	for (int i = 0; i < 16; i++)
+	{
+		block.r[i] = rgba[i * 4 + 0];
+		block.g[i] = rgba[i * 4 + 1];
+		block.b[i] = rgba[i * 4 + 2];
+	}
+}
+
+static void writeColorBlock(const ColorBlock& block, Endpoint e0, Endpoint e1, unsigned char* out)
+{
+	uint16_t c0 = pack565(e0), c1 = pack565(e1);
+	int indices[16];
+	if (c0 == c1)
+	{
+		// Uma cor só: todos os pixels no índice 0, que vale c0 nos dois modos
+		fill(indices, indices + 16, 0);
+	}
+	else
+	{
+		// O modo de 4 cores exige c0 > c1
+		if (c0 < c1)
+		{
+			swap(e0, e1);
+			swap(c0, c1);
+		}
+		endpointError(block, e0, e1, indices);
+	}
+	uint32_t bits = 0;
+	for (int i = 0; i < 16; i++)
+		bits |= (uint32_t)indices[i] << (2 * i);
+	out[0] = c0 & 0xFF; out[1] = c0 >> 8;
+	out[2] = c1 & 0xFF; out[3] = c1 >> 8;
+	for (int i = 0; i < 4; i++)
+		out[4 + i] = (bits >> (8 * i)) & 0xFF;
+}
+
+void compressBlockBC1(const unsigned char* rgba, unsigned char* out)
+{
+	ColorBlock block;
+	loadColorBlock(rgba, block);
+	Endpoint e0, e1;
+	findEndpoints(block, e0, e1);
+	writeColorBlock(block, e0, e1, out);
+}
+
+// Alfa de BC3: extremos 8 bits no modo de 8 valores (a0 > a1) e 3 bits por pixel
+void compressBlockBC3(const unsigned char* rgba, unsigned char* out)
+{
+	int a0 = 0, a1 = 255;
+	for (int i = 0; i < 16; i++)
+	{
+		a0 = max(a0, (int)rgba[i * 4 + 3]);
+		a1 = min(a1, (int)rgba[i * 4 + 3]);
+	}
+	uint64_t bits = 0;
+	if (a0 > a1)
+	{
+		int values[8] = { a0, a1 };
+		for (int k = 1; k <= 6; k++)
+			values[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+		for (int i = 0; i < 16; i++)
+		{
+			int a = rgba[i * 4 + 3], best = 0;
+			for (int k = 1; k < 8; k++)
+				if (abs(values[k] - a) < abs(values[best] - a))
+					best = k;
+			bits |= (uint64_t)best << (3 * i);
+		}
+	}
+	out[0] = (unsigned char)a0;
+	out[1] = (unsigned char)a1;
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = (bits >> (8 * i)) & 0xFF;
+	compressBlockBC1(rgba, out + 8);
+}
+
+void decompressBlock(uint32_t format, const unsigned char* in, unsigned char* rgba)
+{
+	const unsigned char* color = format == BLOCK_BC3 ? in + 8 : in;
+	uint16_t c0 = (uint16_t)(color[0] | (color[1] << 8)), c1 = (uint16_t)(color[2] | (color[3] << 8));
+	uint32_t bits = (uint32_t)color[4] | ((uint32_t)color[5] << 8) | ((uint32_t)color[6] << 16) | ((uint32_t)color[7] << 24);
+	int colors[4][3];
+	if (c0 > c1 || format == BLOCK_BC3)
+		palette4(unpack565(c0), unpack565(c1), colors);
+	else
+	{
+		// Modo de 3 cores: a média e preto
+		expand565(unpack565(c0), colors[0]);
+		expand565(unpack565(c1), colors[1]);
+		for (int k = 0; k < 3; k++)
+		{
+			colors[2][k] = (colors[0][k] + colors[1][k]) / 2;
+			colors[3][k] = 0;
+		}
+	}
+	for (int i = 0; i < 16; i++)
+	{
+		int index = (bits >> (2 * i)) & 3;
+		for (int k = 0; k < 3; k++)
+			rgba[i * 4 + k] = (unsigned char)colors[index][k];
+		rgba[i * 4 + 3] = 255;
+	}
+
+	if (format == BLOCK_BC3)
+	{
+		int a0 = in[0], a1 = in[1];
+		int values[8] = { a0, a1 };
+		if (a0 > a1)
+			for (int k = 1; k <= 6; k++)
+				values[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+		else
+		{
+			for (int k = 1; k <= 4; k++)
+				values[k + 1] = ((5 - k) * a0 + k * a1) / 5;
+			values[6] = 0;
+			values[7] = 255;
+		}
+		uint64_t alphaBits = 0;
+		for (int i = 0; i < 6; i++)
+			alphaBits |= (uint64_t)in[2 + i] << (8 * i);
+		for (int i = 0; i < 16; i++)
+			rgba[i * 4 + 3] = (unsigned char)values[(alphaBits >> (3 * i)) & 7];
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Imagens inteiras
+// ----------------------------------------------------------------------------
+
+// Copia um bloco de 4x4 da imagem, repetindo a última linha/coluna nas bordas
+static void gatherBlock(const unsigned char* rgba, int width, int height, int bx, int by, unsigned char* block)
+{
+	for (int y = 0; y < 4; y++)
+	{
+		int sy = min(by * 4 + y, height - 1);
+		for (int x = 0; x < 4; x++)
+		{
+			int sx = min(bx * 4 + x, width - 1);
+			memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+		}
+	}
+}
+
+void compressImage(const unsigned char* rgba, int width, int height, uint32_t format, unsigned char* out, unsigned nThreads)
+{
+	int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	size_t bytes = blockBytes(format);
+	ThreadPool::global().parallelFor((size_t)blocksY, [&](size_t by)
+	{
+		unsigned char block[64];
+		for (int bx = 0; bx < blocksX; bx++)
+		{
+			gatherBlock(rgba, width, height, bx, (int)by, block);
+			unsigned char* dst = out + (by * blocksX + bx) * bytes;
+			if (format == BLOCK_BC3)
+				compressBlockBC3(block, dst);
+			else
+				compressBlockBC1(block, dst);
+		}
+	}, nThreads);
+}
+
+void decompressImage(const unsigned char* in, int width, int height, uint32_t format, vector<unsigned char>& rgba)
+{
+	int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	size_t bytes = blockBytes(format);
+	rgba.resize((size_t)width * height * 4);
+	unsigned char block[64];
+	for (int by = 0; by < blocksY; by++)
+	{
+		for (int bx = 0; bx < blocksX; bx++)
+		{
+			decompressBlock(format, in + ((size_t)by * blocksX + bx) * bytes, block);
+			for (int y = 0; y < 4 && by * 4 + y < height; y++)
+				for (int x = 0; x < 4 && bx * 4 + x < width; x++)
+					memcpy(&rgba[((size_t)(by * 4 + y) * width + bx * 4 + x) * 4], block + (y * 4 + x) * 4, 4);
+		}
+	}
+}
+
+void compressTexture(const TextureLevels& mips, TextureLevels& out, unsigned nThreads)
+{
+	const unsigned char* rgba = mips.level(0);
+	bool opaque = true;
+	for (size_t i = 0; i < (size_t)mips.width * mips.height && opaque; i++)
+		opaque = rgba[i * 4 + 3] == 255;
+	out.allocate(opaque ? BLOCK_BC1 : BLOCK_BC3, mips.width, mips.height);
+	out.mipFilter = mips.mipFilter;
+	out.srgb = mips.srgb;
+	for (size_t i = 0; i < mips.levels.size() && i < out.levels.size(); i++)
+		compressImage(mips.level(i), (int)mips.levels[i].width, (int)mips.levels[i].height, out.format, out.level(i), nThreads);
+}
+
+double computePSNR(const unsigned char* a, const unsigned char* b, int width, int height, bool withAlpha)
+{
+	double sum = 0.0;
+	int channels = withAlpha ? 4 : 3;
+	for (size_t i = 0; i < (size_t)width * height; i++)
+		for (int k = 0; k < channels; k++)
+		{
+			double d = (double)a[i * 4 + k] - b[i * 4 + k];
+			sum += d * d;
+		}
+	double mse = sum / ((double)width * height * channels);
+	return mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+}
+
+// ----------------------------------------------------------------------------
+// Arquivo de cache
+// ----------------------------------------------------------------------------
+
+string textureCachePath(const string& imagePath)
+{
+	return imagePath + ".cgtex";
+}
+
+static size_t align16(size_t offset)
+{
+	return (offset + 15) & ~(size_t)15;
+}
+
+bool writeTextureCache(const string& imagePath, const TextureLevels& texture)
+{
+	MappedFile source;
+	if (!source.open(imagePath))
+		return false;
+
+	TextureCacheHeader header;
+	header.magic = TEXTURE_CACHE_MAGIC;
+	header.version = TEXTURE_CACHE_VERSION;
+	if (!sourceStats(imagePath, header.sourceSize, header.sourceMTime))
+		return false;
+	header.sourceHash = hashBytes(source.data(), source.size());
+	header.format = texture.format;
+	header.width = (uint32_t)texture.width;
+	header.height = (uint32_t)texture.height;
+	header.nLevels = (uint32_t)texture.levels.size();
+	header.mipFilter = texture.mipFilter;
+	header.srgb = texture.srgb ? 1 : 0;
+
+	vector<TextureCacheLevel> levels = texture.levels;
+	size_t offset = align16(sizeof(header) + levels.size() * sizeof(TextureCacheLevel));
+	for (TextureCacheLevel& level : levels)
+	{
+		level.offset = offset;
+		offset = align16(offset + (size_t)level.size);
+	}
+
+	// Arquivo temporário + rename, como em writeMeshCache
+	string path = textureCachePath(imagePath);
+	string tmpPath = path + ".tmp";
+	{
+		ofstream out(tmpPath, ios::binary | ios::trunc);
+		if (!out)
+			return false;
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)levels.data(), levels.size() * sizeof(TextureCacheLevel));
+		static const char zeros[16] = {};
+		size_t written = sizeof(header) + levels.size() * sizeof(TextureCacheLevel);
+		for (size_t i = 0; i < levels.size(); i++)
+		{
+			out.write(zeros, levels[i].offset - written);
+			out.write((const char*)texture.level(i), levels[i].size);
+			written = levels[i].offset + levels[i].size;
+		}
+		if (!out)
+			return false;
+	}
+	error_code ec;
+	filesystem::rename(tmpPath, path, ec);
+	if (ec)
+	{
+		filesystem::remove(tmpPath, ec);
+		return false;
+	}
+	return true;
+}
+
+bool readTextureCache(const string& imagePath, TextureLevels& texture)
+{
+	uint64_t size;
+	int64_t mtime;
+	if (!sourceStats(imagePath, size, mtime))
+		return false;
+
+	MappedFile file;
+	if (!file.open(textureCachePath(imagePath)) || file.size() < sizeof(TextureCacheHeader))
+		return false;
+	TextureCacheHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+	if (header.magic != TEXTURE_CACHE_MAGIC || header.version != TEXTURE_CACHE_VERSION || header.sourceSize != size ||
+		(header.format != BLOCK_RGBA8 && header.format != BLOCK_BC1 && header.format != BLOCK_BC3) || header.nLevels == 0 ||
+		sizeof(header) + header.nLevels * sizeof(TextureCacheLevel) > file.size())
+		return false;
+	if (header.sourceMTime != mtime)
+	{
+		// Imagem tocada: só o conteúdo decide
+		MappedFile source;
+		if (!source.open(imagePath) || hashBytes(source.data(), source.size()) != header.sourceHash)
+			return false;
+	}
+
+	// O nível 0 tem que caber no arquivo antes de alocar a cadeia: um tamanho estragado
+	// no cabeçalho não pode virar uma alocação gigante
+	if (header.width == 0 || header.height == 0 || header.width > INT_MAX || header.height > INT_MAX ||
+		levelBytes(header.format, (int)header.width, (int)header.height) > file.size())
+		return false;
+	// Os níveis gravados têm que ser exatamente a cadeia de mips da imagem
+	texture.allocate(header.format, (int)header.width, (int)header.height);
+	texture.mipFilter = header.mipFilter;
+	texture.srgb = header.srgb != 0;
+	if (texture.levels.size() != header.nLevels)
+		return false;
+	for (uint32_t i = 0; i < header.nLevels; i++)
+	{
+		TextureCacheLevel level;
+		memcpy(&level, file.data() + sizeof(header) + i * sizeof(TextureCacheLevel), sizeof(level));
+		const TextureCacheLevel& expected = texture.levels[i];
+		// Sem somar offset + size: num cache estragado a soma pode dar a volta
+		if (level.width != expected.width || level.height != expected.height || level.size != expected.size ||
+			level.offset > file.size() || level.size > file.size() - level.offset)
+			return false;
+		memcpy(texture.data.data() + expected.offset, file.data() + level.offset, (size_t)level.size);
+	}
+	return true;
+}
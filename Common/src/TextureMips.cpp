@@ -0,0 +1,473 @@
+#include "TextureMips.h"
+#include "ThreadPool.h"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTURE_MIPS_SSE2 1
+#endif
+// O caminho AVX2 é compilado mesmo sem -mavx2 (atributo target no GCC/Clang; o MSVC
+// aceita os intrínsecos em qualquer função) e só é usado se a CPU tiver AVX2 e FMA
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TEXTURE_MIPS_AVX2 1
+#define TEXTURE_MIPS_AVX2_TARGET __attribute__((target("avx2,fma")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#include <intrin.h>
+#define TEXTURE_MIPS_AVX2 1
+#define TEXTURE_MIPS_AVX2_TARGET
+#endif
+
+using namespace std;
+
+const float PI = 3.14159265358979f;
+
+// Linhas processadas por item do parallelFor
+const int ROWS_PER_TASK = 8;
+
+const char* mipFilterName(MipFilter filter)
+{
+	switch (filter)
+	{
+	case MIP_BOX: return "box";
+	case MIP_KAISER: return "kaiser";
+	case MIP_LANCZOS: return "lanczos";
+	}
+	return "?";
+}
+
+bool mipCpuHasAVX2()
+{
+#if defined(TEXTURE_MIPS_AVX2) && defined(__GNUC__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(TEXTURE_MIPS_AVX2) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	bool fma = (info[2] & (1 << 12)) != 0, osxsave = (info[2] & (1 << 27)) != 0;
+	if (!fma || !osxsave || (_xgetbv(0) & 6) != 6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+// Caminho das colunas escolhido para estas configurações
+static bool useAVX2(const MipSettings& settings)
+{
+	static const bool cpuAVX2 = mipCpuHasAVX2();
+	return settings.simd && settings.useAVX2 && cpuAVX2;
+}
+
+const char* mipSimdLevel(const MipSettings& settings)
+{
+	if (!settings.simd)
+		return "escalar";
+	if (useAVX2(settings))
+		return "AVX2";
+#if defined(TEXTURE_MIPS_SSE2)
+	return "SSE2";
+#else
+	return "escalar";
+#endif
+}
+
+void downsampleRGBA8(const unsigned char* src, int width, int height, vector<unsigned char>& dst)
+{
+	int w = max(1, width / 2), h = max(1, height / 2);
+	dst.resize((size_t)w * h * 4);
+	for (int y = 0; y < h; y++)
+	{
+		const unsigned char* row0 = src + (size_t)min(2 * y, height - 1) * width * 4;
+		const unsigned char* row1 = src + (size_t)min(2 * y + 1, height - 1) * width * 4;
+		unsigned char* out = dst.data() + (size_t)y * w * 4;
+		for (int x = 0; x < w; x++)
+		{
+			int x0 = min(2 * x, width - 1) * 4, x1 = min(2 * x + 1, width - 1) * 4;
+			for (int k = 0; k < 4; k++)
+				out[x * 4 + k] = (unsigned char)((row0[x0 + k] + row0[x1 + k] + row1[x0 + k] + row1[x1 + k] + 2) / 4);
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Conversão entre sRGB (8 bits) e linear (float)
+// ----------------------------------------------------------------------------
+
+const int LINEAR_TO_SRGB_SIZE = 16384;
+
+struct ColorTables
+{
+	float srgbToLinear[256];
+	unsigned char linearToSrgb[LINEAR_TO_SRGB_SIZE];
+
+	ColorTables()
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			float c = i / 255.0f;
+			this->srgbToLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int i = 0; i < LINEAR_TO_SRGB_SIZE; i++)
+		{
+			float c = i / (float)(LINEAR_TO_SRGB_SIZE - 1);
+			float s = c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+			this->linearToSrgb[i] = (unsigned char)min(255.0f, s * 255.0f + 0.5f);
+		}
+	}
+};
+
+static const ColorTables& colorTables()
+{
+	static ColorTables tables;
+	return tables;
+}
+
+static unsigned char toUnorm8(float value, bool srgb, const ColorTables& tables)
+{
+	value = min(1.0f, max(0.0f, value));
+	if (srgb)
+		return tables.linearToSrgb[(int)(value * (LINEAR_TO_SRGB_SIZE - 1) + 0.5f)];
+	return (unsigned char)(value * 255.0f + 0.5f);
+}
+
+// ----------------------------------------------------------------------------
+// Pesos do filtro
+// ----------------------------------------------------------------------------
+
+// Raio do filtro em pixels do nível de destino
+static float filterRadius(MipFilter filter)
+{
+	return filter == MIP_BOX ? 0.5f : 3.0f;
+}
+
+static float sinc(float x)
+{
+	if (fabsf(x) < 1e-6f)
+		return 1.0f;
+	return sinf(PI * x) / (PI * x);
+}
+
+// Função de Bessel modificada de primeira espécie e ordem 0 (série de potências)
+static float besselI0(float x)
+{
+	float sum = 1.0f, term = 1.0f, q = x * x / 4.0f;
+	for (int k = 1; k < 20; k++)
+	{
+		term *= q / (float)(k * k);
+		sum += term;
+	}
+	return sum;
+}
+
+static float filterWeight(MipFilter filter, float x)
+{
+	const float radius = filterRadius(filter);
+	x = fabsf(x);
+	switch (filter)
+	{
+	case MIP_BOX:
+		return x < 0.5f ? 1.0f : 0.0f;
+	case MIP_KAISER:
+	{
+		if (x >= radius)
+			return 0.0f;
+		const float alpha = 4.0f;
+		float t = x / radius;
+		return sinc(x) * besselI0(alpha * sqrtf(1.0f - t * t)) / besselI0(alpha);
+	}
+	case MIP_LANCZOS:
+		return x < radius ? sinc(x) * sinc(x / radius) : 0.0f;
+	}
+	return 0.0f;
+}
+
+// Pesos de uma dimensão: cada pixel de destino j lê taps[first[j]] até taps[first[j + 1] - 1]
+struct FilterTaps
+{
+	vector<int> first;
+	vector<int> index;   // coordenada na origem, já repetida nas bordas
+	vector<float> weight;
+
+	void build(MipFilter filter, int srcSize, int dstSize)
+	{
+		// Na ampliação (scale < 1) o filtro mantém a largura de um pixel da origem
+		float scale = (float)srcSize / dstSize;
+		float filterScale = max(scale, 1.0f);
+		float support = filterRadius(filter) * filterScale;
+		this->first.assign(1, 0);
+		this->index.clear();
+		this->weight.clear();
+		for (int j = 0; j < dstSize; j++)
+		{
+			float center = (j + 0.5f) * scale - 0.5f;
+			int begin = (int)ceilf(center - support), end = (int)floorf(center + support);
+			size_t start = this->weight.size();
+			float sum = 0.0f;
+			for (int i = begin; i <= end; i++)
+			{
+				float w = filterWeight(filter, (i - center) / filterScale);
+				if (w == 0.0f)
+					continue;
+				this->index.push_back(((i % srcSize) + srcSize) % srcSize);
+				this->weight.push_back(w);
+				sum += w;
+			}
+			if (sum == 0.0f)
+			{
+				// Box ampliando com o centro exatamente entre dois pixels: usa o mais próximo
+				this->index.push_back((((int)floorf(center + 0.5f) % srcSize) + srcSize) % srcSize);
+				this->weight.push_back(1.0f);
+				sum = 1.0f;
+			}
+			for (size_t k = start; k < this->weight.size(); k++)
+				this->weight[k] /= sum;
+			this->first.push_back((int)this->weight.size());
+		}
+	}
+};
+
+// ----------------------------------------------------------------------------
+// Passadas do filtro
+// ----------------------------------------------------------------------------
+
+// Linha y da origem (srcWidth pixels) -> linha y de tmp (dstWidth pixels)
+static void filterRow(const float* src, float* dst, int dstWidth, const FilterTaps& taps, bool simd)
+{
+#ifdef TEXTURE_MIPS_SSE2
+	if (simd)
+	{
+		// Duas somas independentes, para não esperar a latência de cada _mm_add_ps
+		for (int x = 0; x < dstWidth; x++)
+		{
+			__m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+			int k = taps.first[x], end = taps.first[x + 1];
+			for (; k + 1 < end; k += 2)
+			{
+				sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_set1_ps(taps.weight[k]), _mm_loadu_ps(src + (size_t)taps.index[k] * 4)));
+				sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_set1_ps(taps.weight[k + 1]), _mm_loadu_ps(src + (size_t)taps.index[k + 1] * 4)));
+			}
+			if (k < end)
+				sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_set1_ps(taps.weight[k]), _mm_loadu_ps(src + (size_t)taps.index[k] * 4)));
+			_mm_storeu_ps(dst + (size_t)x * 4, _mm_add_ps(sum0, sum1));
+		}
+		return;
+	}
+#else
+	(void)simd;
+#endif
+	for (int x = 0; x < dstWidth; x++)
+	{
+		float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int k = taps.first[x]; k < taps.first[x + 1]; k++)
+		{
+			const float* pixel = src + (size_t)taps.index[k] * 4;
+			for (int c = 0; c < 4; c++)
+				sum[c] += taps.weight[k] * pixel[c];
+		}
+		for (int c = 0; c < 4; c++)
+			dst[(size_t)x * 4 + c] = sum[c];
+	}
+}
+
+#if defined(TEXTURE_MIPS_AVX2)
+// Colunas com AVX2 e FMA: 16 floats por vez, em duas somas independentes. Devolve
+// quantos floats do começo da linha foram feitos (o resto fica para o SSE2).
+TEXTURE_MIPS_AVX2_TARGET static size_t filterColumnAVX2(const float* tmp, float* dst, size_t count, int begin, int end,
+	const FilterTaps& taps)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+		for (int k = begin; k < end; k++)
+		{
+			__m256 w = _mm256_set1_ps(taps.weight[k]);
+			const float* row = tmp + (size_t)taps.index[k] * count + i;
+			sum0 = _mm256_fmadd_ps(w, _mm256_loadu_ps(row), sum0);
+			sum1 = _mm256_fmadd_ps(w, _mm256_loadu_ps(row + 8), sum1);
+		}
+		__m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+		_mm256_storeu_ps(dst + i, _mm256_min_ps(one, _mm256_max_ps(zero, sum0)));
+		_mm256_storeu_ps(dst + i + 8, _mm256_min_ps(one, _mm256_max_ps(zero, sum1)));
+	}
+	return i;
+}
+#endif
+
+// Linha y do destino = soma ponderada das linhas de tmp (count floats por linha)
+static void filterColumn(const float* tmp, float* dst, size_t count, int y, const FilterTaps& taps, bool simd, bool avx2)
+{
+	int begin = taps.first[y], end = taps.first[y + 1];
+	size_t i = 0;
+	if (simd)
+	{
+#if defined(TEXTURE_MIPS_AVX2)
+		if (avx2)
+			i = filterColumnAVX2(tmp, dst, count, begin, end, taps);
+#else
+		(void)avx2;
+#endif
+#ifdef TEXTURE_MIPS_SSE2
+		// 16 floats por vez, em quatro somas independentes
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps(), sum2 = _mm_setzero_ps(), sum3 = _mm_setzero_ps();
+			for (int k = begin; k < end; k++)
+			{
+				__m128 w = _mm_set1_ps(taps.weight[k]);
+				const float* row = tmp + (size_t)taps.index[k] * count + i;
+				sum0 = _mm_add_ps(sum0, _mm_mul_ps(w, _mm_loadu_ps(row)));
+				sum1 = _mm_add_ps(sum1, _mm_mul_ps(w, _mm_loadu_ps(row + 4)));
+				sum2 = _mm_add_ps(sum2, _mm_mul_ps(w, _mm_loadu_ps(row + 8)));
+				sum3 = _mm_add_ps(sum3, _mm_mul_ps(w, _mm_loadu_ps(row + 12)));
+			}
+			__m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+			_mm_storeu_ps(dst + i, _mm_min_ps(one, _mm_max_ps(zero, sum0)));
+			_mm_storeu_ps(dst + i + 4, _mm_min_ps(one, _mm_max_ps(zero, sum1)));
+			_mm_storeu_ps(dst + i + 8, _mm_min_ps(one, _mm_max_ps(zero, sum2)));
+			_mm_storeu_ps(dst + i + 12, _mm_min_ps(one, _mm_max_ps(zero, sum3)));
+		}
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (int k = begin; k < end; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(taps.weight[k]), _mm_loadu_ps(tmp + (size_t)taps.index[k] * count + i)));
+			sum = _mm_min_ps(_mm_set1_ps(1.0f), _mm_max_ps(_mm_setzero_ps(), sum));
+			_mm_storeu_ps(dst + i, sum);
+		}
+#endif
+	}
+	for (; i < count; i++)
+	{
+		float sum = 0.0f;
+		for (int k = begin; k < end; k++)
+			sum += taps.weight[k] * tmp[(size_t)taps.index[k] * count + i];
+		dst[i] = min(1.0f, max(0.0f, sum));
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Cadeia completa e redimensionamento
+// ----------------------------------------------------------------------------
+
+static bool isOpaque(const unsigned char* rgba, int width, int height)
+{
+	for (size_t i = 0; i < (size_t)width * height; i++)
+		if (rgba[i * 4 + 3] != 255)
+			return false;
+	return true;
+}
+
+// RGBA8 -> float (linear, alfa pré-multiplicado quando a imagem não é opaca)
+static void expandRow(const unsigned char* in, float* pixel, int count, bool srgb, bool opaque, const ColorTables& tables)
+{
+	for (int x = 0; x < count; x++, in += 4, pixel += 4)
+	{
+		float alpha = in[3] / 255.0f;
+		for (int c = 0; c < 3; c++)
+		{
+			float value = srgb ? tables.srgbToLinear[in[c]] : in[c] / 255.0f;
+			pixel[c] = opaque ? value : value * alpha;
+		}
+		pixel[3] = alpha;
+	}
+}
+
+static void packRow(const float* pixel, unsigned char* dst, int count, bool srgb, bool opaque, const ColorTables& tables)
+{
+	for (int x = 0; x < count; x++, pixel += 4, dst += 4)
+	{
+		float alpha = pixel[3];
+		float inverse = opaque || alpha <= 0.0f ? 1.0f : 1.0f / alpha;
+		for (int c = 0; c < 3; c++)
+			dst[c] = toUnorm8(pixel[c] * inverse, srgb, tables);
+		dst[3] = toUnorm8(alpha, false, tables);
+	}
+}
+
+// Filtra srcW x srcH -> dstW x dstH, em duas passadas repartidas entre as threads do
+// pool. A origem é rgba (8 bits, convertida linha a linha) ou, se rgba for nullptr,
+// src em float. O resultado fica em float em dst e em 8 bits em pixels.
+static void filterImage(const unsigned char* rgba, const float* src, int srcW, int srcH, int dstW, int dstH,
+	const MipSettings& settings, bool opaque, vector<float>& tmp, vector<float>& dst, unsigned char* pixels)
+{
+	const ColorTables& tables = colorTables();
+	ThreadPool& pool = ThreadPool::global();
+	FilterTaps tapsX, tapsY;
+	tapsX.build(settings.filter, srcW, dstW);
+	tapsY.build(settings.filter, srcH, dstH);
+	tmp.resize((size_t)dstW * srcH * 4);
+	dst.resize((size_t)dstW * dstH * 4);
+
+	// Linhas: srcW x srcH -> dstW x srcH
+	size_t chunks = (srcH + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+	pool.parallelFor(chunks, [&](size_t chunk)
+	{
+		vector<float> row(rgba ? (size_t)srcW * 4 : 0);
+		int end = min(srcH, (int)(chunk + 1) * ROWS_PER_TASK);
+		for (int y = (int)chunk * ROWS_PER_TASK; y < end; y++)
+		{
+			const float* in = src + (size_t)y * srcW * 4;
+			if (rgba)
+			{
+				expandRow(rgba + (size_t)y * srcW * 4, row.data(), srcW, settings.srgb, opaque, tables);
+				in = row.data();
+			}
+			filterRow(in, tmp.data() + (size_t)y * dstW * 4, dstW, tapsX, settings.simd);
+		}
+	}, settings.nThreads);
+
+	// Colunas: dstW x srcH -> dstW x dstH, já convertendo para 8 bits
+	size_t rowFloats = (size_t)dstW * 4;
+	bool avx2 = useAVX2(settings);
+	chunks = (dstH + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+	pool.parallelFor(chunks, [&](size_t chunk)
+	{
+		int end = min(dstH, (int)(chunk + 1) * ROWS_PER_TASK);
+		for (int y = (int)chunk * ROWS_PER_TASK; y < end; y++)
+		{
+			float* row = dst.data() + y * rowFloats;
+			filterColumn(tmp.data(), row, rowFloats, y, tapsY, settings.simd, avx2);
+			packRow(row, pixels + y * rowFloats, dstW, settings.srgb, opaque, tables);
+		}
+	}, settings.nThreads);
+}
+
+void generateMipChain(const unsigned char* rgba, int width, int height, const MipSettings& settings, TextureLevels& out)
+{
+	out.allocate(BLOCK_RGBA8, width, height);
+	out.mipFilter = settings.filter;
+	out.srgb = settings.srgb;
+	copy(rgba, rgba + (size_t)width * height * 4, out.level(0));
+	bool opaque = isOpaque(rgba, width, height);
+
+	// O nível 0 é convertido para float (linear, alfa pré-multiplicado) linha a linha,
+	// dentro da primeira passada; os seguintes já ficam em float em current
+	vector<float> current, tmp, next;
+	for (size_t level = 1; level < out.levels.size(); level++)
+	{
+		int srcW = (int)out.levels[level - 1].width, srcH = (int)out.levels[level - 1].height;
+		int dstW = (int)out.levels[level].width, dstH = (int)out.levels[level].height;
+		filterImage(level == 1 ? rgba : nullptr, current.data(), srcW, srcH, dstW, dstH, settings, opaque, tmp, next, out.level(level));
+		current.swap(next);
+	}
+}
+
+void resizeRGBA8(const unsigned char* rgba, int width, int height, int newWidth, int newHeight,
+	const MipSettings& settings, vector<unsigned char>& out)
+{
+	out.resize((size_t)newWidth * newHeight * 4);
+	if (newWidth == width && newHeight == height)
+	{
+		copy(rgba, rgba + out.size(), out.begin());
+		return;
+	}
+	vector<float> tmp, result;
+	filterImage(rgba, nullptr, width, height, newWidth, newHeight, settings, isOpaque(rgba, width, height), tmp, result, out.data());
+}
@@ -14,6 +14,7 @@
  * - OpenGL, GLAD, GLFW: Para renderização gráfica e criação de janelas.
  * - GLM: Para cálculos matemáticos (vetores, matrizes, transformações).
  * - Shader: Classe utilitária para carregar e compilar shaders GLSL.
+ * - RenderQueue: fila de desenho que ordena os desenhos do frame por estado.
  */
 
 #include <iostream>
@@ -41,6 +42,7 @@ using namespace std;
 
 // Classes utilitárias
 #include "Shader.h"
+#include "RenderQueue.h"
 
 struct Curve
 {
@@ -62,6 +64,22 @@ struct GeometryAxes
     GLuint VBO;
 };
 
+// Passes da RenderQueue, na ordem de desenho (o teste de profundidade usa GL_ALWAYS,
+// então o que vem depois fica por cima)
+enum CurvePass
+{
+    PASS_GRID = 0,
+    PASS_AXES,
+    PASS_CURVES,
+    PASS_OVERLAY
+};
+
+// Materiais da RenderQueue: cor, largura das linhas e tamanho dos pontos
+struct CurveMaterials
+{
+    int grid, axisX, axisY, bezier, catmullRom, controlPoints, triangle;
+};
+
 // Outras funções
 void initializeBernsteinMatrix(glm::mat4x4 &matrix);
 void generateBezierCurvePoints(Curve &curve, int numPoints);
@@ -70,14 +88,15 @@ void generateCatmullRomCurvePoints(Curve &curve, int numPoints);
 void displayCurve(const Curve &curve);
 GLuint generateControlPointsBuffer(vector<glm::vec3> controlPoints);
 
-void drawTriangle(GLuint shaderID, GLuint VAO, glm::vec3 position, glm::vec3 dimensions, float angle, glm::vec3 color = glm::vec3(0.0, 0.0, 1.0), glm::vec3 axis = glm::vec3(0.0, 0.0, 1.0));
+void drawTriangle(RenderQueue &queue, Shader *shader, GLuint VAO, glm::vec3 position, glm::vec3 dimensions, float angle, int material, glm::vec3 axis = glm::vec3(0.0, 0.0, 1.0));
 int setupTriangle();
 
 // Funções para geração da grid
 GeometryGrid generateGrid(float cellSize = 0.1f);
-void drawGrid(const GeometryGrid &grid, GLuint shaderID);
+void drawGrid(RenderQueue &queue, const GeometryGrid &grid, Shader *shader, int material);
 GeometryAxes createAxesVAO();
-void drawAxesVAO(const GeometryAxes &axes, GLuint shaderID);
+void drawAxesVAO(RenderQueue &queue, const GeometryAxes &axes, Shader *shader, int materialX, int materialY);
+CurveMaterials createCurveMaterials(RenderQueue &queue);
 std::vector<glm::vec3> generateHeartControlPoints(int numPoints = 20);
 
 void generateGlobalBezierCurvePoints(Curve &curve, int numPoints);
@@ -106,6 +125,7 @@ int main()
     // Compilando e buildando o programa de shader
     Shader shader = Shader("./hello-curves.vs", "./hello-curves.fs");
     Shader shaderTri = Shader("./hello-triangle.vs", "./hello-curves.fs");
+    Shader::printStartupReport();
 
     // Criando a geometria do triângulo
     GLuint VAO = setupTriangle();
@@ -163,7 +183,11 @@ int main()
     cout << curvaBezier.curvePoints.size() << endl;
     cout << curvaCatmullRom.curvePoints.size() << endl;
 
-    shader.Use();
+    // Fila de desenho: os desenhos do frame são gravados, ordenados por estado e enviados
+    // sem repetir glUseProgram, glBindTexture e glBindVertexArray
+    RenderQueue queue;
+    CurveMaterials materials = createCurveMaterials(queue);
+    bool statsPrinted = false;
 
     // Loop da aplicação - "game loop"
     while (!glfwWindowShouldClose(window))
@@ -180,29 +204,20 @@ int main()
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f); // cor de fundo
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        shader.Use();
+        queue.begin();
         // Desenhar a grid
-        drawGrid(grid, shader.ID);
-        drawAxesVAO(axes, shader.ID);
+        drawGrid(queue, grid, &shader, materials.grid);
+        drawAxesVAO(queue, axes, &shader, materials.axisX, materials.axisY);
 
-        // Desenhar pontos da curva de Bezier e conectar com linhas
-        glBindVertexArray(VAOBezierCurve);
-        shader.setVec4("finalColor", 1.0f, 0.0f, 1.0f, 1.0f); // Magenta para a curva
-        glLineWidth(5.0);
-        glDrawArrays(GL_LINE_STRIP, 0, curvaBezier.curvePoints.size()); // Desenha a curva como uma linha contínua
+        // Desenhar pontos da curva de Bezier e conectar com linhas (uma linha contínua)
+        queue.drawArrays(PASS_CURVES, &shader, VAOBezierCurve, materials.bezier, GL_LINE_STRIP, 0, curvaBezier.curvePoints.size());
 
         // Desenhar pontos da curva de Catmull e conectar com linhas
-        glBindVertexArray(VAOCatmullRomCurve);
-        shader.setVec4("finalColor", 0.0f, 1.0f, 0.0f, 1.0f);               // Verde para a curva
-        glDrawArrays(GL_LINE_STRIP, 0, curvaCatmullRom.curvePoints.size()); // Desenha a curva como uma linha contínua
+        queue.drawArrays(PASS_CURVES, &shader, VAOCatmullRomCurve, materials.catmullRom, GL_LINE_STRIP, 0, curvaCatmullRom.curvePoints.size());
 
         // Desenhar pontos de controle maiores e com cor diferenciada
-        glBindVertexArray(VAOControl);
-        shader.setVec4("finalColor", 0.0f, 0.0f, 0.0f, 1.0f); // Preto para pontos de controle
-        glPointSize(12.0f);
-        glDrawArrays(GL_POINTS, 0, curvaBezier.controlPoints.size());
+        queue.drawArrays(PASS_OVERLAY, &shader, VAOControl, materials.controlPoints, GL_POINTS, 0, curvaBezier.controlPoints.size());
 
-        shaderTri.Use();
         // Desenhar o triângulo
         position = curvaCatmullRom.curvePoints[index];
 
@@ -218,8 +233,19 @@ int main()
             angle = atan2(dir.y, dir.x) + glm::radians(-90.0f);
         }
 
-        
-        drawTriangle(shaderTri.ID, VAO, position, dimensions, angle);
+        drawTriangle(queue, &shaderTri, VAO, position, dimensions, angle, materials.triangle);
+
+        queue.sort();
+        RenderQueueStats stats = queue.submit();
+        if (!statsPrinted)
+        {
+            // A cena é a mesma a cada frame: as contagens do primeiro valem para todos
+            cout << "RenderQueue: " << stats.packets << " desenhos, trocas de programa " << stats.programChanges
+                 << " (" << stats.programChangesAvoided() << " evitadas), de textura " << stats.textureChanges
+                 << " (" << stats.textureChangesAvoided() << " evitadas), de VAO " << stats.vaoChanges
+                 << " (" << stats.vaoChangesAvoided() << " evitadas), " << stats.uniformUploads << " uniforms enviados" << endl;
+            statsPrinted = true;
+        }
 
         // Troca os buffers da tela
         glfwSwapBuffers(window);
@@ -428,25 +454,11 @@ GeometryGrid generateGrid(float cellSize)
     return grid;
 }
 
-void drawGrid(const GeometryGrid &grid, GLuint shaderID)
+void drawGrid(RenderQueue &queue, const GeometryGrid &grid, Shader *shader, int material)
 {
-    glUseProgram(shaderID);
-
-    // Define a cor cinza médio para a grid
-    GLint colorLocation = glGetUniformLocation(shaderID, "finalColor");
-    glUniform4f(colorLocation, 0.5f, 0.5f, 0.5f, 1.0f); // RGBA: cinza médio
-
-    // Ativa o VAO da grid
-    glBindVertexArray(grid.VAO);
-
-    // Largura da grid
-    glLineWidth(1.0f);
-
-    // Desenha a grid como linhas usando GL_LINES para contorno
-    glDrawElements(GL_LINES, (grid.dimensions.x / 0.1f + 1) * 4, GL_UNSIGNED_INT, 0);
-
-    // Desvincula o VAO
-    glBindVertexArray(0);
+    // Desenha a grid como linhas usando GL_LINES para contorno (cinza médio, largura 1)
+    GLsizei nIndices = (GLsizei)((grid.dimensions.x / 0.1f + 1) * 4);
+    queue.drawElements(PASS_GRID, shader, grid.VAO, material, GL_LINES, 0, nIndices);
 }
 
 GeometryAxes createAxesVAO()
@@ -473,25 +485,25 @@ GeometryAxes createAxesVAO()
     return axes;
 }
 
-void drawAxesVAO(const GeometryAxes &axes, GLuint shaderID)
+void drawAxesVAO(RenderQueue &queue, const GeometryAxes &axes, Shader *shader, int materialX, int materialY)
 {
-    glUseProgram(shaderID);
-
-    // Desenha o eixo X em vermelho
-    GLint colorLocation = glGetUniformLocation(shaderID, "finalColor");
-    glUniform4f(colorLocation, 1.0f, 0.0f, 0.0f, 1.0f); // Cor vermelha
-
-    // Largura dos eixos
-    glLineWidth(3.0f);
-
-    glBindVertexArray(axes.VAO);
-    glDrawArrays(GL_LINES, 0, 2); // Desenha o eixo X
-
-    // Desenha o eixo Y em azul
-    glUniform4f(colorLocation, 0.0f, 0.0f, 1.0f, 1.0f); // Cor azul
-    glDrawArrays(GL_LINES, 2, 2);                       // Desenha o eixo Y
+    // Desenha o eixo X em vermelho e o eixo Y em azul (mesmo VAO, largura 3)
+    queue.drawArrays(PASS_AXES, shader, axes.VAO, materialX, GL_LINES, 0, 2);
+    queue.drawArrays(PASS_AXES, shader, axes.VAO, materialY, GL_LINES, 2, 2);
+}
 
-    glBindVertexArray(0); // Unbind VAO
+CurveMaterials createCurveMaterials(RenderQueue &queue)
+{
+    CurveMaterials materials;
+    // Registrados na ordem de desenho dentro de cada passe (a chave usa o índice)
+    materials.grid = queue.addMaterial(glm::vec4(0.5f, 0.5f, 0.5f, 1.0f), 0, 1.0f);          // cinza médio
+    materials.axisX = queue.addMaterial(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f), 0, 3.0f);         // vermelho
+    materials.axisY = queue.addMaterial(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), 0, 3.0f);         // azul
+    materials.bezier = queue.addMaterial(glm::vec4(1.0f, 0.0f, 1.0f, 1.0f), 0, 5.0f);        // magenta
+    materials.catmullRom = queue.addMaterial(glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), 0, 5.0f);    // verde
+    materials.controlPoints = queue.addMaterial(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), 0, 0.0f, 12.0f); // preto
+    materials.triangle = queue.addMaterial(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));               // azul
+    return materials;
 }
 
 std::vector<glm::vec3> generateHeartControlPoints(int numPoints)
@@ -596,9 +608,8 @@ int setupTriangle()
     return VAO;
 }
 
-void drawTriangle(GLuint shaderID, GLuint VAO, glm::vec3 position, glm::vec3 dimensions, float angle, glm::vec3 color, glm::vec3 axis)
+void drawTriangle(RenderQueue &queue, Shader *shader, GLuint VAO, glm::vec3 position, glm::vec3 dimensions, float angle, int material, glm::vec3 axis)
 {
-    glBindVertexArray(VAO);
     // Matriz de modelo: transformações na geometria (objeto)
     glm::mat4 model = glm::mat4(1); // matriz identidade
     // Translação
@@ -607,11 +618,8 @@ void drawTriangle(GLuint shaderID, GLuint VAO, glm::vec3 position, glm::vec3 dim
     model = glm::rotate(model, angle, axis);
     // Escala
     model = glm::scale(model, dimensions);
-    glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, glm::value_ptr(model));
 
-    glUniform4f(glGetUniformLocation(shaderID, "finalColor"), color.r, color.g, color.b, 1.0f); // enviando cor para variável uniform inputColor
-                                                                                                //  Chamada de desenho - drawcall
-                                                                                                //  Poligono Preenchido - GL_TRIANGLES
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-    glBindVertexArray(0);
+    // Chamada de desenho - drawcall, gravada na fila com a matriz e o material (cor)
+    // Poligono Preenchido - GL_TRIANGLES
+    queue.drawArrays(PASS_OVERLAY, shader, VAO, material, GL_TRIANGLES, 0, 3, &model);
 }
@@ -101,6 +101,7 @@ int main()
 
     // Compilando e buildando o programa de shader
     Shader shader = Shader("./hello-curves.vs", "./hello-curves.fs");
+    Shader::printStartupReport();
 
     // Estrutura para armazenar a curva de Bézier e pontos de controle
     Curve curvaBezier;
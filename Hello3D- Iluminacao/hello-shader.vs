@@ -3,8 +3,16 @@ layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 color;
 
 uniform mat4 model;
-uniform mat4 projection;
-uniform mat4 view;
+
+//Dados por frame compartilhados entre os programas (ver Common/include/FrameData.h)
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec4 cameraPos;
+	vec4 lightPos;
+	vec4 lightColor;
+};
 
 out vec4 finalColor;
 
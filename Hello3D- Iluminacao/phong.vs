@@ -5,8 +5,16 @@ layout (location = 2) in vec2 texc;
 layout (location = 3) in vec3 normal;
 
 uniform mat4 model;
-uniform mat4 projection;
-uniform mat4 view;
+
+//Dados por frame compartilhados entre os programas (ver Common/include/FrameData.h)
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec4 cameraPos;
+	vec4 lightPos;
+	vec4 lightColor;
+};
 
 //Variáveis que irão para o fragment shader
 out vec3 finalColor;
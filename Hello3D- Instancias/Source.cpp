@@ -0,0 +1,354 @@
+/* Hello Instancing - desenho instanciado de várias cópias da mesma malha
+ *
+ * Adaptado a partir do Hello3D- Texturas, de Rossana Baptista Queiroz,
+ * para as disciplinas de Processamento Gráfico/Computação Gráfica - Unisinos
+ *
+ * Uma grade de cadeiras (BlueChair e OrangeChair de Modelos3D/Novos) em que cada
+ * malha é desenhada com uma única chamada glDrawElementsInstanced, qualquer que seja
+ * o número de cópias. A matriz de modelo e o índice de material de cada cadeira ficam
+ * em um buffer de instâncias (ver Common/include/InstancedRenderer.h).
+ *
+ * Cadeiras distantes usam níveis de detalhe mais simples (InstancedMesh::drawLOD), gerados
+ * na primeira carga e guardados no cache da malha.
+ *
+ * As malhas e a textura são carregadas em segundo plano (AssetLoader.h): a janela abre
+ * e desenha desde o primeiro frame, e cada malha aparece assim que chega à GPU.
+ *
+ * Teclas: W/A/S/D ou setas movem a câmera, X/Y/Z escolhem o eixo de rotação das
+ * cadeiras, + e - aumentam e diminuem a grade, L liga e desliga os níveis de detalhe.
+ */
+
+#include <iostream>
+#include <string>
+#include <assert.h>
+
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstddef>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+//Classe gerenciadora de shaders
+#include "Shader.h"
+#include "FrameData.h"
+
+//Malhas instanciadas e tabela de materiais
+#include "InstancedRenderer.h"
+
+//Carregamento assíncrono de malhas e texturas
+#include "AssetLoader.h"
+
+// Protótipo da função de callback de teclado
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+
+// Protótipos das funções
+void buildGrid(InstancedMesh& blueChairs, InstancedMesh& orangeChairs, int gridSize, GLuint materials[2]);
+
+// Dimensões da janela (pode ser alterado em tempo de execução)
+const GLuint WIDTH = 1000, HEIGHT = 1000;
+
+bool rotateX=false, rotateY=false, rotateZ=false;
+
+//Lado da grade de cadeiras (gridSize x gridSize cópias)
+int gridSize = 20;
+bool gridChanged = false;
+
+//Níveis de detalhe pela distância (tecla L)
+bool useLOD = true;
+
+//Variáveis globais da câmera
+glm::vec3 cameraPos = glm::vec3(0.0f,20.0f,45.0f);
+glm::vec3 cameraFront = glm::normalize(glm::vec3(0.0f,-0.4f,-1.0f));
+glm::vec3 cameraUp = glm::vec3(0.0f,1.0f,0.0f);
+
+//Distância entre as cadeiras da grade
+const float GRID_SPACING = 3.0f;
+
+// Função MAIN
+int main()
+{
+	// Inicialização da GLFW
+	glfwInit();
+
+	// Criação da janela GLFW
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Ola Instancias!", nullptr, nullptr);
+	glfwMakeContextCurrent(window);
+
+	// Fazendo o registro da função de callback para a janela GLFW
+	glfwSetKeyCallback(window, key_callback);
+
+	// GLAD: carrega todos os ponteiros d funções da OpenGL
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+
+	}
+
+	// Obtendo as informações de versão
+	const GLubyte* renderer = glGetString(GL_RENDERER); /* get renderer string */
+	const GLubyte* version = glGetString(GL_VERSION); /* version as a string */
+	cout << "Renderer: " << renderer << endl;
+	cout << "OpenGL version supported " << version << endl;
+
+	// Definindo as dimensões da viewport com as mesmas dimensões da janela da aplicação
+	int width, height;
+	glfwGetFramebufferSize(window, &width, &height);
+	glViewport(0, 0, width, height);
+
+	// Compilando e buildando o programa de shader
+	Shader shader("phong-instanced.vs","phong-instanced.fs");
+	//Tempo gasto compilando os shaders (ou carregando do cache de binários em shader_cache/)
+	Shader::printStartupReport();
+	//Recompila o programa quando os shaders forem salvos (ver shader.update() no loop)
+	shader.enableHotReload();
+
+	//As malhas e o atlas de texturas (o mesmo para as duas cadeiras) são lidos nas threads
+	//do pool; loader.update(), no loop, envia os dados à GPU aos poucos
+	AssetLoader loader;
+	MeshHandle chairAssets[2] = { loader.loadMesh("../Modelos3D/Novos/BlueChair.obj"), loader.loadMesh("../Modelos3D/Novos/OrangeChair.obj") };
+	TextureHandle atlas = loader.loadTexture("../Modelos3D/Novos/TexturasOffice.png");
+
+	//Uma InstancedMesh por malha: todas as cópias de cada uma saem em uma única drawcall.
+	//A geometria é ligada a elas quando o carregamento termina (ver o loop)
+	InstancedMesh blueChairs, orangeChairs;
+	InstancedMesh* chairs[2] = { &blueChairs, &orangeChairs };
+	bool reported[2] = { false, false }; // falha de leitura já avisada
+
+	//Materiais indexados por instância (cor multiplicada pela textura e coeficientes de Phong)
+	MaterialTable materialTable;
+	materialTable.create();
+	InstanceMaterial plain, tinted;
+	tinted.color = glm::vec4(1.0f, 0.85f, 0.7f, 1.0f);
+	tinted.coefficients = glm::vec4(0.2f, 0.6f, 0.8f, 40.0f);
+	GLuint materials[2] = { materialTable.add(plain), materialTable.add(tinted) };
+	materialTable.update();
+
+	buildGrid(blueChairs, orangeChairs, gridSize, materials);
+
+	glUseProgram(shader.ID);
+
+	//Dados por frame (view, projection, câmera e luz) ficam em um Uniform Buffer Object
+	//compartilhado por todos os programas de shader (ver FrameData.h)
+	FrameUniforms frameUniforms;
+	frameUniforms.create();
+	FrameData frameData;
+
+	//Matriz de projeção
+	frameData.projection = glm::perspective(glm::radians(39.6f),(float)WIDTH/HEIGHT,0.1f,500.0f);
+
+	//Propriedades da fonte de luz
+	frameData.lightPos = glm::vec4(-20.0, 40.0, 30.0, 1.0);
+	frameData.lightColor = glm::vec4(1.0, 1.0, 1.0, 1.0);
+
+	//Buffer de textura no shader (enviado de novo sempre que o shader é recarregado)
+	glUniform1i(shader.uniform("texBuffer"), 0);
+
+	glEnable(GL_DEPTH_TEST);
+	glActiveTexture(GL_TEXTURE0);
+
+	double lastReport = glfwGetTime();
+	int frames = 0;
+
+	// Loop da aplicação - "game loop"
+	while (!glfwWindowShouldClose(window))
+	{
+		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
+		glfwPollEvents();
+
+		//Troca para o programa recompilado assim que ele linkar (o antigo segue desenhando até lá)
+		if (shader.update())
+			glUniform1i(shader.uniform("texBuffer"), 0);
+
+		//Envia uma parte dos dados já lidos e liga as malhas que ficaram prontas
+		loader.update();
+		for (int i = 0; i < 2; i++)
+		{
+			if (chairs[i]->VAO == 0 && chairAssets[i]->ready())
+			{
+				chairs[i]->lods = chairAssets[i]->lods;
+				chairs[i]->bounds = chairAssets[i]->bounds;
+				chairs[i]->attach(chairAssets[i]->VAO, chairAssets[i]->nIndices);
+				cout << "Malha pronta: " << chairAssets[i]->path << " (" << glfwGetTime() << " s)" << endl;
+			}
+			else if (chairAssets[i]->failed() && !reported[i])
+			{
+				cout << "Erro ao tentar ler o arquivo " << chairAssets[i]->path << endl;
+				reported[i] = true;
+			}
+		}
+
+		if (gridChanged)
+		{
+			buildGrid(blueChairs, orangeChairs, gridSize, materials);
+			gridChanged = false;
+		}
+
+		// Limpa o buffer de cor
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f); //cor de fundo
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		//Gira cada cadeira em torno do próprio centro: só as matrizes do buffer de
+		//instâncias mudam, a geometria continua a mesma
+		if (rotateX || rotateY || rotateZ)
+		{
+			float angle = (GLfloat)glfwGetTime();
+			glm::vec3 axis = rotateX ? glm::vec3(1.0f, 0.0f, 0.0f) : rotateY ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(0.0f, 0.0f, 1.0f);
+			InstancedMesh* meshes[2] = { &blueChairs, &orangeChairs };
+			for (InstancedMesh* mesh : meshes)
+			{
+				for (int i = 0; i < mesh->nInstances(); i++)
+				{
+					glm::mat4 model = mesh->instance(i).model;
+					glm::vec3 position = glm::vec3(model[3]);
+					mesh->setModel(i, glm::rotate(glm::translate(glm::mat4(1), position), angle, axis));
+				}
+			}
+		}
+
+		//Matriz de view e posição da câmera
+		frameData.view = glm::lookAt(cameraPos,cameraPos + cameraFront,cameraUp);
+		frameData.cameraPos = glm::vec4(cameraPos, 1.0f);
+		frameUniforms.update(frameData);
+
+		// Chamadas de desenho - uma por malha (uma por nível de detalhe usado), não uma por cadeira.
+		// Malhas ainda carregando ficam de fora; sem o atlas, a textura 0 desenha em preto
+		glBindTexture(GL_TEXTURE_2D,atlas->ready() ? atlas->texID : 0);
+		for (InstancedMesh* mesh : chairs)
+		{
+			if (mesh->VAO == 0)
+				continue;
+			if (useLOD)
+				mesh->drawLOD(frameData.view, frameData.projection, (float)height);
+			else
+				mesh->draw();
+		}
+
+		//Tempo médio por frame, uma vez por segundo
+		frames++;
+		double now = glfwGetTime();
+		if (now - lastReport >= 1.0)
+		{
+			cout << blueChairs.nInstances() + orangeChairs.nInstances() << " cadeiras, "
+				<< blueChairs.trianglesDrawn + orangeChairs.trianglesDrawn << " triangulos"
+				<< (useLOD ? " (LOD): " : ": ") << 1000.0 * (now - lastReport) / frames << " ms por frame" << endl;
+			lastReport = now;
+			frames = 0;
+		}
+
+		// Troca os buffers da tela
+		glfwSwapBuffers(window);
+	}
+	// Pede pra OpenGL desalocar os buffers
+	blueChairs.destroy();
+	orangeChairs.destroy();
+	for (MeshHandle& asset : chairAssets)
+		asset->destroy();
+	atlas->destroy();
+	materialTable.destroy();
+	frameUniforms.destroy();
+	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
+	glfwTerminate();
+	return 0;
+}
+
+// Função de callback de teclado - só pode ter uma instância (deve ser estática se
+// estiver dentro de uma classe) - É chamada sempre que uma tecla for pressionada
+// ou solta via GLFW
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
+{
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, GL_TRUE);
+
+	if (key == GLFW_KEY_X && action == GLFW_PRESS)
+	{
+		rotateX = true;
+		rotateY = false;
+		rotateZ = false;
+	}
+
+	if (key == GLFW_KEY_Y && action == GLFW_PRESS)
+	{
+		rotateX = false;
+		rotateY = true;
+		rotateZ = false;
+	}
+
+	if (key == GLFW_KEY_Z && action == GLFW_PRESS)
+	{
+		rotateX = false;
+		rotateY = false;
+		rotateZ = true;
+	}
+
+	//Tamanho da grade
+	if ((key == GLFW_KEY_EQUAL || key == GLFW_KEY_KP_ADD) && action == GLFW_PRESS)
+	{
+		gridSize *= 2;
+		gridChanged = true;
+	}
+	if ((key == GLFW_KEY_MINUS || key == GLFW_KEY_KP_SUBTRACT) && action == GLFW_PRESS && gridSize > 1)
+	{
+		gridSize /= 2;
+		gridChanged = true;
+	}
+
+	if (key == GLFW_KEY_L && action == GLFW_PRESS)
+	{
+		useLOD = !useLOD;
+		cout << "Niveis de detalhe " << (useLOD ? "ligados" : "desligados") << endl;
+	}
+
+	//Verifica a movimentação da câmera
+	float cameraSpeed = 1.0f;
+
+	if ((key == GLFW_KEY_W || key == GLFW_KEY_UP) && action == GLFW_PRESS)
+	{
+		cameraPos += cameraSpeed * cameraFront;
+	}
+	if ((key == GLFW_KEY_S || key == GLFW_KEY_DOWN) && action == GLFW_PRESS)
+	{
+		cameraPos -= cameraSpeed * cameraFront;
+	}
+	if ((key == GLFW_KEY_A || key == GLFW_KEY_LEFT) && action == GLFW_PRESS)
+	{
+		cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+	}
+	if ((key == GLFW_KEY_D || key == GLFW_KEY_RIGHT) && action == GLFW_PRESS)
+	{
+		cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+	}
+}
+
+// Preenche a grade centrada na origem: cadeiras azuis e laranjas alternadas,
+// com o material "tinted" em uma a cada três
+void buildGrid(InstancedMesh& blueChairs, InstancedMesh& orangeChairs, int gridSize, GLuint materials[2])
+{
+	blueChairs.clear();
+	orangeChairs.clear();
+	float half = 0.5f * (gridSize - 1) * GRID_SPACING;
+	for (int row = 0; row < gridSize; row++)
+	{
+		for (int col = 0; col < gridSize; col++)
+		{
+			glm::mat4 model = glm::translate(glm::mat4(1), glm::vec3(col * GRID_SPACING - half, 0.0f, row * GRID_SPACING - half));
+			GLuint material = materials[(row * gridSize + col) % 3 == 0 ? 1 : 0];
+			if ((row + col) % 2 == 0)
+				blueChairs.add(model, material);
+			else
+				orangeChairs.add(model, material);
+		}
+	}
+	cout << "Grade de " << gridSize << " x " << gridSize << " = " << gridSize * gridSize << " cadeiras" << endl;
+}
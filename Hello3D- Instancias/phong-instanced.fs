@@ -0,0 +1,58 @@
+#version 430
+
+in vec2 texCoord;
+in vec3 scaledNormal;
+in vec3 fragPos;
+flat in uint materialIndex;
+
+//Propriedades da fonte de luz e da câmera: dados por frame compartilhados
+//entre os programas (ver Common/include/FrameData.h)
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec4 cameraPos;
+	vec4 lightPos;
+	vec4 lightColor;
+};
+
+//Materiais indexados pela instância (ver Common/include/InstancedRenderer.h)
+struct Material
+{
+	vec4 color;        //rgb multiplica a textura
+	vec4 coefficients; //ka, kd, ks, q
+};
+layout (std140) uniform Materials
+{
+	Material materials[64]; //MAX_INSTANCE_MATERIALS
+};
+
+out vec4 color;
+//Buffer da textura
+uniform sampler2D texBuffer;
+
+void main()
+{
+    Material m = materials[materialIndex];
+    float ka = m.coefficients.x, kd = m.coefficients.y, ks = m.coefficients.z, q = m.coefficients.w;
+
+    //Coeficiente luz ambiente
+    vec3 ambient = ka * lightColor.rgb;
+
+    //Coeficiente reflexão difusa
+    vec3 N = normalize(scaledNormal);
+    vec3 L = normalize(lightPos.xyz - fragPos);
+    float diff = max(dot(N,L),0.0);
+    vec3 diffuse = kd * diff * lightColor.rgb;
+
+    //Coeficiente reflexão especular
+    vec3 R = normalize(reflect(-L,N));
+    vec3 V = normalize(cameraPos.xyz - fragPos);
+    float spec = pow(max(dot(R,V),0.0),q);
+    vec3 specular = ks * spec * lightColor.rgb;
+
+    vec3 texColor = texture(texBuffer,texCoord).rgb * m.color.rgb;
+    vec3 result = (ambient + diffuse) * texColor + specular;
+
+    color = vec4(result,1.0);
+}
@@ -0,0 +1,35 @@
+#version 430
+layout (location = 0) in vec3 position;
+layout (location = 2) in vec2 texc;
+layout (location = 3) in vec3 normal;
+
+//Atributos por instância (ver Common/include/InstancedRenderer.h): avançam uma vez
+//por cópia desenhada, e não a cada vértice
+layout (location = 4) in mat4 instanceModel; //locations 4, 5, 6 e 7
+layout (location = 8) in uint instanceMaterial;
+
+//Dados por frame compartilhados entre os programas (ver Common/include/FrameData.h)
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec4 cameraPos;
+	vec4 lightPos;
+	vec4 lightColor;
+};
+
+//Variáveis que irão para o fragment shader
+out vec2 texCoord;
+out vec3 scaledNormal;
+out vec3 fragPos;
+flat out uint materialIndex;
+
+void main()
+{
+	vec4 worldPos = instanceModel * vec4(position, 1.0);
+	gl_Position = projection * view * worldPos;
+	texCoord = vec2(texc.s, 1 - texc.t);
+	fragPos = vec3(worldPos);
+	scaledNormal = mat3(instanceModel) * normal;
+	materialIndex = instanceMaterial;
+}
@@ -14,6 +14,7 @@
 #include <vector>
 #include <fstream>
 #include <sstream>
+#include <cstddef>
 
 using namespace std;
 
@@ -28,19 +29,30 @@ using namespace std;
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-//STB_IMAGE
-#include <stb_image.h>
-
 //Classe gerenciadora de shaders
 #include "Shader.h"
+#include "FrameData.h"
+
+//Leitor de arquivos OBJ
+#include "OBJLoader.h"
+#include "MeshCache.h"
+#include "VertexPacking.h"
+
+//Desenho de uma submesh por material, ordenado por estado
+#include "DrawList.h"
+
+//Frustum culling dos objetos com uma BVH das caixas envolventes
+#include "SceneBVH.h"
+
+//Cache de texturas: cada arquivo é lido uma vez, com a decodificação em paralelo
+#include "TextureCache.h"
 
 // Protótipo da função de callback de teclado
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 
 // Protótipos das funções
 int setupGeometry();
-int loadSimpleOBJ(string filePATH, int &nVertices);
-GLuint loadTexture(string filePath, int &width, int &height);
+int loadSimpleOBJ(string filePATH, int &nVertices, vector<Submesh> &submeshes, vector<Material> &materials, MeshBounds &bounds, bool packed = false);
 
 // Dimensões da janela (pode ser alterado em tempo de execução)
 const GLuint WIDTH = 1000, HEIGHT = 1000;
@@ -56,10 +68,12 @@ struct Object
 {
 	GLuint VAO; //Índice do buffer de geometria
 	GLuint texID; //Identificador da textura carregada
-	int nVertices; //nro de vértices
+	int nVertices; //nro de vértices desenhados (tamanho do buffer de índices)
 	glm::mat4 model; //matriz de transformações do objeto
-	float ka, kd, ks; //coeficientes de iluminação - material do objeto
-
+	vector <Submesh> submeshes; //faixas do buffer de índices, uma por material (usemtl)
+	MeshBounds bounds; //caixa e esfera envolventes no espaço do modelo (para o frustum culling)
+	vector <Material> materials; //materiais do .mtl (coeficientes de iluminação e map_Kd)
+	vector <GLuint> textures; //textura de cada material (0: usa texID)
 };
 
 // Função MAIN
@@ -108,47 +122,66 @@ int main()
 
 	// Compilando e buildando o programa de shader
 	Shader shader("phong.vs","phong.fs");
+	//Tempo gasto compilando os shaders (ou carregando do cache de binários em shader_cache/)
+	Shader::printStartupReport();
+	//Recompila o programa quando phong.vs ou phong.fs forem salvos (ver shader.update() no loop)
+	shader.enableHotReload();
 
 	Object obj;
-	//obj.VAO = loadSimpleOBJ("../Modelos3D/Suzannes/SuzanneHigh.obj",obj.nVertices);
-	obj.VAO = loadSimpleOBJ("../Modelos3D/aratwearingabackpack/obj/model.obj",obj.nVertices);
-	//obj.VAO = loadSimpleOBJ("./Nave.obj",obj.nVertices);
-	//obj.VAO = loadSimpleOBJ("C:\\Users\\rossanaqueiroz\\Documents\\Github\\CG2024-2\\Hello3D-OBJ\\Suzanne.obj",obj.nVertices);
-	int texWidth,texHeight;
-	obj.texID = loadTexture("../Modelos3D/aratwearingabackpack/textures/texture_1.jpeg",texWidth,texHeight);
+	//obj.VAO = loadSimpleOBJ("../Modelos3D/Suzannes/SuzanneHigh.obj",obj.nVertices,obj.submeshes,obj.materials,obj.bounds);
+	//O último parâmetro liga o formato compacto de vértice (20 bytes em vez de 44, ver VertexPacking.h)
+	obj.VAO = loadSimpleOBJ("../Modelos3D/aratwearingabackpack/obj/model.obj",obj.nVertices,obj.submeshes,obj.materials,obj.bounds,true);
+	//obj.VAO = loadSimpleOBJ("./Nave.obj",obj.nVertices,obj.submeshes,obj.materials,obj.bounds);
+	//obj.VAO = loadSimpleOBJ("C:\\Users\\rossanaqueiroz\\Documents\\Github\\CG2024-2\\Hello3D-OBJ\\Suzanne.obj",obj.nVertices,obj.submeshes,obj.materials,obj.bounds);
+	//Materiais com map_Kd ganham a própria textura; os demais usam obj.texID. As imagens
+	//são decodificadas juntas nas threads do pool, e materiais que citam o mesmo arquivo
+	//recebem a mesma textura
+	AssetLoader loader;
+	TextureCache textureCache(loader);
+	TextureHandle baseTexture = textureCache.acquire("../Modelos3D/aratwearingabackpack/textures/texture_1.jpeg");
+	vector<TextureHandle> materialTextures;
+	for (const Material& material : obj.materials)
+		materialTextures.push_back(material.mapKd.empty() ? nullptr : textureCache.acquire(material.mapKd));
+	textureCache.finish();
+	obj.texID = baseTexture->texID;
+	for (const TextureHandle& texture : materialTextures)
+		obj.textures.push_back(texture ? texture->texID : 0);
+	//Tempo de decodificação e de envio e memória de cada textura
+	textureCache.report();
 
 	glUseProgram(shader.ID);
 
 
-	//Matriz de modelo
-	glm::mat4 model = glm::mat4(1); //matriz identidade;
-	GLint modelLoc = glGetUniformLocation(shader.ID, "model");
-	model = glm::rotate(model, /*(GLfloat)glfwGetTime()*/glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+	//Dados por frame (view, projection, câmera e luz) ficam em um Uniform Buffer Object
+	//compartilhado por todos os programas de shader (ver FrameData.h)
+	FrameUniforms frameUniforms;
+	frameUniforms.create();
+	FrameData frameData;
 
 	//Matriz de view
-	glm::mat4 view = glm::lookAt(cameraPos,glm::vec3(0.0f,0.0f,0.0f),cameraUp);
-	glUniformMatrix4fv(glGetUniformLocation(shader.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
+	frameData.view = glm::lookAt(cameraPos,glm::vec3(0.0f,0.0f,0.0f),cameraUp);
 	//Matriz de projeção
 	//glm::mat4 projection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, -1.0f, 1.0f);
-	glm::mat4 projection = glm::perspective(glm::radians(39.6f),(float)WIDTH/HEIGHT,0.1f,100.0f);
-	glUniformMatrix4fv(glGetUniformLocation(shader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-
-	//Buffer de textura no shader
-	glUniform1i(glGetUniformLocation(shader.ID, "texBuffer"), 0);
+	frameData.projection = glm::perspective(glm::radians(39.6f),(float)WIDTH/HEIGHT,0.1f,100.0f);
 
 	glEnable(GL_DEPTH_TEST);
 	glActiveTexture(GL_TEXTURE0);
 
-	//Propriedades da superfície
-	shader.setFloat("ka",0.2);
-	shader.setFloat("ks", 0.5);
-	shader.setFloat("kd", 0.5);
-	shader.setFloat("q", 10.0);
+	//Buffer de textura no shader (enviado de novo sempre que o shader é recarregado)
+	glUniform1i(shader.uniform("texBuffer"), 0);
+
+	//Propriedades da superfície: vêm do .mtl e são enviadas pela DrawList a cada troca
+	//de material (ver DrawList::applyMaterial)
+	DrawList drawList;
+
+	//Objetos da cena na BVH de culling: a caixa é atualizada quando o objeto se move
+	SceneBVH sceneBVH;
+	int objID = sceneBVH.insert(transformBounds(obj.bounds, glm::mat4(1)));
+	vector<int> visibleIDs;
 
 	//Propriedades da fonte de luz
-	shader.setVec3("lightPos",-2.0, 10.0, 3.0);
-	shader.setVec3("lightColor",1.0, 1.0, 1.0);
+	frameData.lightPos = glm::vec4(-2.0, 10.0, 3.0, 1.0);
+	frameData.lightColor = glm::vec4(1.0, 1.0, 1.0, 1.0);
 
 
 	// Loop da aplicação - "game loop"
@@ -157,6 +190,11 @@ int main()
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
 		glfwPollEvents();
 
+		//Troca para o programa recompilado assim que ele linkar (o antigo segue desenhando até lá)
+		//Material e matriz de modelo são reenviados pela DrawList a cada frame
+		if (shader.update())
+			glUniform1i(shader.uniform("texBuffer"), 0);
+
 		// Limpa o buffer de cor
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); //cor de fundo
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -183,21 +221,29 @@ int main()
 
 		}
 
-		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(obj.model));
-		
 		//Atualizar a matriz de view
 		//Matriz de view
-		glm::mat4 view = glm::lookAt(cameraPos,cameraPos + cameraFront,cameraUp);
-		glUniformMatrix4fv(glGetUniformLocation(shader.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
+		frameData.view = glm::lookAt(cameraPos,cameraPos + cameraFront,cameraUp);
 		
 		//Propriedades da câmera
-		shader.setVec3("cameraPos",cameraPos.x, cameraPos.y, cameraPos.z);
+		frameData.cameraPos = glm::vec4(cameraPos, 1.0f);
+
+		//Um único envio por frame, válido para todos os programas que usam o bloco FrameData
+		frameUniforms.update(frameData);
 		
-		// Chamada de desenho - drawcall
+		// Chamadas de desenho - uma drawcall por submesh (material), ordenadas para
+		// trocar de programa, textura e material o mínimo possível
 		// Poligono Preenchido - GL_TRIANGLES
-		glBindVertexArray(obj.VAO);
-		glBindTexture(GL_TEXTURE_2D,obj.texID);
-		glDrawArrays(GL_TRIANGLES, 0, obj.nVertices);
+		//Só entram na DrawList os objetos cuja caixa envolvente (já com a matriz de modelo)
+		//não está inteira fora do frustum de projection * view (ver SceneBVH.h)
+		sceneBVH.update(objID, transformBounds(obj.bounds, obj.model));
+		sceneBVH.cull(Frustum(frameData.projection * frameData.view), visibleIDs);
+		drawList.clear();
+		for (int id : visibleIDs)
+			if (id == objID)
+				drawList.addSubmeshes(&shader, obj.VAO, obj.submeshes, obj.materials, obj.textures, obj.texID, obj.model);
+		drawList.sort();
+		drawList.submit();
 
 
 		// Troca os buffers da tela
@@ -205,6 +251,8 @@ int main()
 	}
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &obj.VAO);
+	textureCache.clear();
+	frameUniforms.destroy();
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
 	glfwTerminate();
 	return 0;
@@ -352,100 +400,19 @@ int setupGeometry()
 	return VAO;
 }
 
-int loadSimpleOBJ(string filePath, int &nVertices)
+int loadSimpleOBJ(string filePath, int &nVertices, vector<Submesh> &submeshes, vector<Material> &materials, MeshBounds &bounds, bool packed)
 {
-	vector <glm::vec3> vertices;
-	vector <glm::vec2> texCoords;
-	vector <glm::vec3> normals;
-	vector <GLfloat> vBuffer;
-
-	glm::vec3 color = glm::vec3(1.0, 0.0, 0.0);
-
-	ifstream arqEntrada;
-
-	arqEntrada.open(filePath.c_str());
-	if (arqEntrada.is_open())
+	//Fazer o parsing (leitor compartilhado, ver Common/src/OBJLoader.cpp) e gerar a geometria
+	//indexada, em que cada trinca v/vt/vn distinta vira um único vértice. Depois da primeira
+	//execução a malha é lida do cache binário gravado ao lado do .obj (ver MeshCache.h)
+	CachedMesh mesh;
+	if (mesh.load(filePath))
 	{
-		//Fazer o parsing
-		string line;
-		while (!arqEntrada.eof())
-		{
-			getline(arqEntrada,line);
-			istringstream ssline(line);
-			string word;
-			ssline >> word;
-			if (word == "v")
-			{
-				glm::vec3 vertice;
-				ssline >> vertice.x >> vertice.y >> vertice.z;
-				//cout << vertice.x << " " << vertice.y << " " << vertice.z << endl;
-				vertices.push_back(vertice);
-
-			}
-			if (word == "vt")
-			{
-				glm::vec2 vt;
-				ssline >> vt.s >> vt.t;
-				//cout << vertice.x << " " << vertice.y << " " << vertice.z << endl;
-				texCoords.push_back(vt);
-
-			}
-			if (word == "vn")
-			{
-				glm::vec3 normal;
-				ssline >> normal.x >> normal.y >> normal.z;
-				//cout << vertice.x << " " << vertice.y << " " << vertice.z << endl;
-				normals.push_back(normal);
-
-			}
-			else if (word == "f")
-			{
-				while (ssline >> word) 
-				{
-					int vi, ti, ni;
-					istringstream ss(word);
-    				std::string index;
-
-    				// Pega o índice do vértice
-    				std::getline(ss, index, '/');
-    				vi = std::stoi(index) - 1;  // Ajusta para índice 0
-
-    				// Pega o índice da coordenada de textura
-    				std::getline(ss, index, '/');
-    				ti = std::stoi(index) - 1;
-
-    				// Pega o índice da normal
-    				std::getline(ss, index);
-    				ni = std::stoi(index) - 1;
-
-					//Recuperando os vértices do indice lido
-					vBuffer.push_back(vertices[vi].x);
-					vBuffer.push_back(vertices[vi].y);
-					vBuffer.push_back(vertices[vi].z);
-					
-					//Atributo cor
-					vBuffer.push_back(color.r);
-					vBuffer.push_back(color.g);
-					vBuffer.push_back(color.b);
-
-					//Atributo coordenada de textura
-					vBuffer.push_back(texCoords[ti].s);
-					vBuffer.push_back(texCoords[ti].t);
-
-					//Atributo vetor normal
-					vBuffer.push_back(normals[ni].x);
-					vBuffer.push_back(normals[ni].y);
-					vBuffer.push_back(normals[ni].z);
-					
-        			
-        			// Exibindo os índices para verificação
-       				// std::cout << "v: " << vi << ", vt: " << ti << ", vn: " << ni << std::endl;
-    			}
-				
-			}
-		}
-
-		arqEntrada.close();
+		cout << (mesh.fromCache() ? "Malha lida do cache: " : "Malha gerada do .obj: ")
+			<< mesh.nVertices() << " vertices unicos, " << mesh.nIndices() / 3 << " triangulos" << endl;
+		if (packed)
+			cout << "Formato compacto: " << sizeof(PackedVertex) << " bytes por vertice em vez de "
+				<< OBJ_FLOATS_PER_VERTEX * sizeof(GLfloat) << endl;
 
 		cout << "Gerando o buffer de geometria..." << endl;
 		GLuint VBO, VAO;
@@ -457,7 +424,17 @@ int loadSimpleOBJ(string filePath, int &nVertices)
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
 	//Envia os dados do array de floats para o buffer da OpenGl
-	glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
+	//(ou a versão compacta, com normal em 10 bits e uv em half-float)
+	vector <PackedVertex> packedBuffer;
+	if (packed)
+	{
+		packVertices(mesh.vertexData(), mesh.nVertices(), packedBuffer);
+		glBufferData(GL_ARRAY_BUFFER, packedBuffer.size() * sizeof(PackedVertex), packedBuffer.data(), GL_STATIC_DRAW);
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, mesh.vertexBytes(), mesh.vertexData(), GL_STATIC_DRAW);
+	}
 
 	//Geração do identificador do VAO (Vertex Array Object)
 	glGenVertexArrays(1, &VAO);
@@ -465,6 +442,13 @@ int loadSimpleOBJ(string filePath, int &nVertices)
 	// Vincula (bind) o VAO primeiro, e em seguida  conecta e seta o(s) buffer(s) de vértices
 	// e os ponteiros para os atributos 
 	glBindVertexArray(VAO);
+
+	//Geração do identificador do EBO (Element Buffer Object), com os índices dos vértices de
+	//cada triângulo. Ele fica registrado no VAO, por isso é vinculado depois do glBindVertexArray
+	GLuint EBO;
+	glGenBuffers(1, &EBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBytes(), mesh.indexData(), GL_STATIC_DRAW);
 	
 	//Para cada atributo do vertice, criamos um "AttribPointer" (ponteiro para o atributo), indicando: 
 	// Localização no shader * (a localização dos atributos devem ser correspondentes no layout especificado no vertex shader)
@@ -474,21 +458,40 @@ int loadSimpleOBJ(string filePath, int &nVertices)
 	// Tamanho em bytes 
 	// Deslocamento a partir do byte zero 
 	
-	//Atributo posição (x, y, z)
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)0);
-	glEnableVertexAttribArray(0);
+	if (packed)
+	{
+		//Atributo posição (x, y, z)
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, position));
+		glEnableVertexAttribArray(0);
 
-	//Atributo cor (r, g, b)
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(3*sizeof(GLfloat)));
-	glEnableVertexAttribArray(1);
+		//Atributo cor não existe no formato compacto: o shader recebe o valor padrão do atributo
 
-	//Atributo coordenada de textura - s, t
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(6*sizeof(GLfloat)));
-	glEnableVertexAttribArray(2);
+		//Atributo coordenada de textura - s, t (half-float)
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, texCoord));
+		glEnableVertexAttribArray(2);
 
-	//Atributo vetor normal - x, y, z
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(8*sizeof(GLfloat)));
-	glEnableVertexAttribArray(3);
+		//Atributo vetor normal - x, y, z (+ w) com 10 bits cada, normalizado para [-1, 1]
+		glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, normal));
+		glEnableVertexAttribArray(3);
+	}
+	else
+	{
+		//Atributo posição (x, y, z)
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, OBJ_FLOATS_PER_VERTEX * sizeof(GLfloat), (GLvoid*)0);
+		glEnableVertexAttribArray(0);
+
+		//Atributo cor (r, g, b)
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, OBJ_FLOATS_PER_VERTEX * sizeof(GLfloat), (GLvoid*)(3*sizeof(GLfloat)));
+		glEnableVertexAttribArray(1);
+
+		//Atributo coordenada de textura - s, t
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, OBJ_FLOATS_PER_VERTEX * sizeof(GLfloat), (GLvoid*)(6*sizeof(GLfloat)));
+		glEnableVertexAttribArray(2);
+
+		//Atributo vetor normal - x, y, z
+		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, OBJ_FLOATS_PER_VERTEX * sizeof(GLfloat), (GLvoid*)(8*sizeof(GLfloat)));
+		glEnableVertexAttribArray(3);
+	}
 
 	// Observe que isso é permitido, a chamada para glVertexAttribPointer registrou o VBO como o objeto de buffer de vértice 
 	// atualmente vinculado - para que depois possamos desvincular com segurança
@@ -497,7 +500,14 @@ int loadSimpleOBJ(string filePath, int &nVertices)
 	// Desvincula o VAO (é uma boa prática desvincular qualquer buffer ou array para evitar bugs medonhos)
 	glBindVertexArray(0);
 
-	nVertices = vBuffer.size() / 11;
+	nVertices = mesh.nIndices();
+
+	//Os triângulos vêm agrupados por material: uma faixa do buffer de índices para cada
+	//usemtl, com os materiais lidos dos arquivos mtllib
+	submeshes = mesh.submeshes();
+	bounds = mesh.bounds();
+	loadMaterials(filePath, mesh.materialLibs(), mesh.materialNames(), materials);
+	cout << submeshes.size() << " submeshes, " << materials.size() << " materiais" << endl;
 	return VAO;
 
 	}
@@ -507,47 +517,3 @@ int loadSimpleOBJ(string filePath, int &nVertices)
 		return -1;
 	}
 }
-
-GLuint loadTexture(string filePath, int &width, int &height)
-{
-	GLuint texID; // id da textura a ser carregada
-
-	// Gera o identificador da textura na memória
-	glGenTextures(1, &texID);
-	glBindTexture(GL_TEXTURE_2D, texID);
-
-	// Ajuste dos parâmetros de wrapping e filtering
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	// Carregamento da imagem usando a função stbi_load da biblioteca stb_image
-	int nrChannels;
-
-	unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
-
-	if (data)
-	{
-		if (nrChannels == 3) // jpg, bmp
-		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		}
-		else // assume que é 4 canais png
-		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		}
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture " << filePath << std::endl;
-	}
-
-	stbi_image_free(data);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	return texID;
-}
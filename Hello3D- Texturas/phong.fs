@@ -1,6 +1,5 @@
 #version 430
 
-in vec3 finalColor;
 in vec2 texCoord;
 in vec3 scaledNormal;
 in vec3 fragPos;
@@ -8,11 +7,16 @@ in vec3 fragPos;
 //Propriedades da superficie
 uniform float ka, kd, ks, q;
 
-//Propriedades da fonte de luz
-uniform vec3 lightPos, lightColor;
-
-//Propriedades da câmera
-uniform vec3 cameraPos;
+//Propriedades da fonte de luz e da câmera: dados por frame compartilhados
+//entre os programas (ver Common/include/FrameData.h)
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec4 cameraPos;
+	vec4 lightPos;
+	vec4 lightColor;
+};
 
 out vec4 color;
 //Buffer da textura
@@ -22,23 +26,23 @@ void main()
 {
 
     //Coeficiente luz ambiente
-    vec3 ambient = ka * lightColor;
+    vec3 ambient = ka * lightColor.rgb;
 
 
     //Coeficiente reflexão difusa
     vec3 diffuse;
     vec3 N = normalize(scaledNormal);
-    vec3 L = normalize(lightPos - fragPos);
+    vec3 L = normalize(lightPos.xyz - fragPos);
     float diff = max(dot(N,L),0.0);
-    diffuse = kd * diff * lightColor;
+    diffuse = kd * diff * lightColor.rgb;
 
     //Coeficiente reflexão especular
     vec3 specular;
     vec3 R = normalize(reflect(-L,N));
-    vec3 V = normalize(cameraPos - fragPos);
+    vec3 V = normalize(cameraPos.xyz - fragPos);
     float spec = max(dot(R,V),0.0);
     spec = pow(spec,q);
-    specular = ks * spec * lightColor;
+    specular = ks * spec * lightColor.rgb;
 
     vec4 texColor = texture(texBuffer,texCoord);
     vec3 result = (ambient + diffuse) * vec3(texColor) + specular;
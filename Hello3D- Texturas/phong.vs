@@ -1,15 +1,22 @@
 #version 430
 layout (location = 0) in vec3 position;
-layout (location = 1) in vec3 color;
+//location 1 (cor) não é usada na iluminação: o formato compacto de vértice nem a envia
 layout (location = 2) in vec2 texc;
-layout (location = 3) in vec3 normal;
+layout (location = 3) in vec3 normal; //pode vir em float ou empacotada (GL_INT_2_10_10_10_REV)
 
 uniform mat4 model;
-uniform mat4 projection;
-uniform mat4 view;
+
+//Dados por frame compartilhados entre os programas (ver Common/include/FrameData.h)
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec4 cameraPos;
+	vec4 lightPos;
+	vec4 lightColor;
+};
 
 //Variáveis que irão para o fragment shader
-out vec3 finalColor;
 out vec2 texCoord;
 out vec3 scaledNormal;
 out vec3 fragPos;
@@ -18,7 +25,6 @@ void main()
 {
 	//...pode ter mais linhas de código aqui!
 	gl_Position = projection * view * model * vec4(position, 1.0);
-	finalColor = color;
     texCoord = vec2(texc.s, 1 - texc.t);
     fragPos = vec3(model * vec4(position, 1.0));
     scaledNormal = vec3(model * vec4(normal, 1.0));
@@ -28,14 +28,22 @@ using namespace std;
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+//Leitor de arquivos OBJ
+#include "OBJLoader.h"
+#include "MeshCache.h"
 
-// Protótipo da função de callback de teclado
+//BVH dos triângulos, para selecionar o objeto com o mouse
+#include "MeshBVH.h"
+
+
+// Protótipos das funções de callback de teclado e mouse
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 
 // Protótipos das funções
 int setupShader();
 int setupGeometry();
-int loadSimpleOBJ(string filePATH, int &nVertices);
+int loadSimpleOBJ(string filePATH, int &nVertices, MeshBVH &bvh);
 
 // Dimensões da janela (pode ser alterado em tempo de execução)
 const GLuint WIDTH = 1000, HEIGHT = 1000;
@@ -71,11 +79,16 @@ glm::vec3 cameraPos = glm::vec3(0.0f,0.0f,3.0f);
 glm::vec3 cameraFront = glm::vec3(0.0f,0.0,-1.0f);
 glm::vec3 cameraUp = glm::vec3(0.0f,1.0f,0.0f);
 
+//Clique pendente (posição do cursor), tratado no loop onde as matrizes estão
+bool pickRequested = false;
+double pickX, pickY;
+
 struct Object
 {
 	GLuint VAO; //Índice do buffer de geometria
-	int nVertices; //nro de vértices
+	int nVertices; //nro de vértices desenhados (tamanho do buffer de índices)
 	glm::mat4 model; //matriz de transformações do objeto
+	MeshBVH bvh; //BVH dos triângulos no espaço do modelo (para o picking)
 };
 
 // Função MAIN
@@ -103,6 +116,7 @@ int main()
 
 	// Fazendo o registro da função de callback para a janela GLFW
 	glfwSetKeyCallback(window, key_callback);
+	glfwSetMouseButtonCallback(window, mouse_button_callback);
 
 	// GLAD: carrega todos os ponteiros d funções da OpenGL
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -127,7 +141,7 @@ int main()
 	GLuint shaderID = setupShader();
 
 	Object obj;
-	obj.VAO = loadSimpleOBJ("C:\\Users\\rossanaqueiroz\\Documents\\Github\\CG2024-2\\Hello3D-OBJ\\Suzanne.obj",obj.nVertices);
+	obj.VAO = loadSimpleOBJ("C:\\Users\\rossanaqueiroz\\Documents\\Github\\CG2024-2\\Hello3D-OBJ\\Suzanne.obj",obj.nVertices,obj.bvh);
 
 
 	glUseProgram(shaderID);
@@ -187,12 +201,31 @@ int main()
 		//Matriz de view
 		glm::mat4 view = glm::lookAt(cameraPos,cameraPos + cameraFront,cameraUp);
 		glUniformMatrix4fv(glGetUniformLocation(shaderID, "view"), 1, GL_FALSE, glm::value_ptr(view));
+
+		//Picking: o raio que passa pelo cursor é levado para o espaço do modelo (inversa
+		//da matriz de modelo) e testado contra a BVH dos triângulos
+		if (pickRequested)
+		{
+			pickRequested = false;
+			int windowWidth, windowHeight;
+			glfwGetWindowSize(window, &windowWidth, &windowHeight);
+			Ray ray = screenRay(pickX, pickY, windowWidth, windowHeight, projection, view);
+			RayHit hit;
+			if (obj.bvh.intersect(transformRay(ray, glm::inverse(obj.model)), hit))
+			{
+				glm::vec3 point = ray.at(hit.t);
+				cout << "Objeto selecionado: triangulo " << hit.triangle << ", distancia " << hit.t
+					<< ", ponto (" << point.x << ", " << point.y << ", " << point.z << ")" << endl;
+			}
+			else
+				cout << "Nenhum objeto sob o cursor" << endl;
+		}
 		
 		
 		// Chamada de desenho - drawcall
 		// Poligono Preenchido - GL_TRIANGLES
 		glBindVertexArray(obj.VAO);
-		glDrawArrays(GL_TRIANGLES, 0, obj.nVertices);
+		glDrawElements(GL_TRIANGLES, obj.nVertices, GL_UNSIGNED_INT, 0);
 
 
 		// Troca os buffers da tela
@@ -257,6 +290,17 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
 
 
+}
+
+// Função de callback dos botões do mouse: o clique com o botão esquerdo guarda a
+// posição do cursor, e o loop testa o raio que passa por ela contra o objeto
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+	{
+		glfwGetCursorPos(window, &pickX, &pickY);
+		pickRequested = true;
+	}
 }
 
 //Esta função está basntante hardcoded - objetivo é compilar e "buildar" um programa de
@@ -395,91 +439,16 @@ int setupGeometry()
 	return VAO;
 }
 
-int loadSimpleOBJ(string filePath, int &nVertices)
+int loadSimpleOBJ(string filePath, int &nVertices, MeshBVH &bvh)
 {
-	vector <glm::vec3> vertices;
-	vector <glm::vec2> texCoords;
-	vector <glm::vec3> normals;
-	vector <GLfloat> vBuffer;
-
-	glm::vec3 color = glm::vec3(1.0, 0.0, 0.0);
-
-	ifstream arqEntrada;
-
-	arqEntrada.open(filePath.c_str());
-	if (arqEntrada.is_open())
+	//Fazer o parsing (leitor compartilhado, ver Common/src/OBJLoader.cpp) e gerar a geometria
+	//indexada, em que cada trinca v/vt/vn distinta vira um único vértice. Depois da primeira
+	//execução a malha é lida do cache binário gravado ao lado do .obj (ver MeshCache.h)
+	CachedMesh mesh;
+	if (mesh.load(filePath))
 	{
-		//Fazer o parsing
-		string line;
-		while (!arqEntrada.eof())
-		{
-			getline(arqEntrada,line);
-			istringstream ssline(line);
-			string word;
-			ssline >> word;
-			if (word == "v")
-			{
-				glm::vec3 vertice;
-				ssline >> vertice.x >> vertice.y >> vertice.z;
-				//cout << vertice.x << " " << vertice.y << " " << vertice.z << endl;
-				vertices.push_back(vertice);
-
-			}
-			if (word == "vt")
-			{
-				glm::vec2 vt;
-				ssline >> vt.s >> vt.t;
-				//cout << vertice.x << " " << vertice.y << " " << vertice.z << endl;
-				texCoords.push_back(vt);
-
-			}
-			if (word == "vn")
-			{
-				glm::vec3 normal;
-				ssline >> normal.x >> normal.y >> normal.z;
-				//cout << vertice.x << " " << vertice.y << " " << vertice.z << endl;
-				normals.push_back(normal);
-
-			}
-			else if (word == "f")
-			{
-				while (ssline >> word) 
-				{
-					int vi, ti, ni;
-					istringstream ss(word);
-    				std::string index;
-
-    				// Pega o índice do vértice
-    				std::getline(ss, index, '/');
-    				vi = std::stoi(index) - 1;  // Ajusta para índice 0
-
-    				// Pega o índice da coordenada de textura
-    				std::getline(ss, index, '/');
-    				ti = std::stoi(index) - 1;
-
-    				// Pega o índice da normal
-    				std::getline(ss, index);
-    				ni = std::stoi(index) - 1;
-
-					//Recuperando os vértices do indice lido
-					vBuffer.push_back(vertices[vi].x);
-					vBuffer.push_back(vertices[vi].y);
-					vBuffer.push_back(vertices[vi].z);
-					
-					//Atributo cor
-					vBuffer.push_back(color.r);
-					vBuffer.push_back(color.g);
-					vBuffer.push_back(color.b);
-					
-        			
-        			// Exibindo os índices para verificação
-       				// std::cout << "v: " << vi << ", vt: " << ti << ", vn: " << ni << std::endl;
-    			}
-				
-			}
-		}
-
-		arqEntrada.close();
+		cout << (mesh.fromCache() ? "Malha lida do cache: " : "Malha gerada do .obj: ")
+			<< mesh.nVertices() << " vertices unicos, " << mesh.nIndices() / 3 << " triangulos" << endl;
 
 		cout << "Gerando o buffer de geometria..." << endl;
 		GLuint VBO, VAO;
@@ -491,7 +460,7 @@ int loadSimpleOBJ(string filePath, int &nVertices)
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
 	//Envia os dados do array de floats para o buffer da OpenGl
-	glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, mesh.vertexBytes(), mesh.vertexData(), GL_STATIC_DRAW);
 
 	//Geração do identificador do VAO (Vertex Array Object)
 	glGenVertexArrays(1, &VAO);
@@ -499,6 +468,13 @@ int loadSimpleOBJ(string filePath, int &nVertices)
 	// Vincula (bind) o VAO primeiro, e em seguida  conecta e seta o(s) buffer(s) de vértices
 	// e os ponteiros para os atributos 
 	glBindVertexArray(VAO);
+
+	//Geração do identificador do EBO (Element Buffer Object), com os índices dos vértices de
+	//cada triângulo. Ele fica registrado no VAO, por isso é vinculado depois do glBindVertexArray
+	GLuint EBO;
+	glGenBuffers(1, &EBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBytes(), mesh.indexData(), GL_STATIC_DRAW);
 	
 	//Para cada atributo do vertice, criamos um "AttribPointer" (ponteiro para o atributo), indicando: 
 	// Localização no shader * (a localização dos atributos devem ser correspondentes no layout especificado no vertex shader)
@@ -509,11 +485,11 @@ int loadSimpleOBJ(string filePath, int &nVertices)
 	// Deslocamento a partir do byte zero 
 	
 	//Atributo posição (x, y, z)
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, OBJ_FLOATS_PER_VERTEX * sizeof(GLfloat), (GLvoid*)0);
 	glEnableVertexAttribArray(0);
 
 	//Atributo cor (r, g, b)
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3*sizeof(GLfloat)));
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, OBJ_FLOATS_PER_VERTEX * sizeof(GLfloat), (GLvoid*)(3*sizeof(GLfloat)));
 	glEnableVertexAttribArray(1);
 
 	// Observe que isso é permitido, a chamada para glVertexAttribPointer registrou o VBO como o objeto de buffer de vértice 
@@ -523,7 +499,11 @@ int loadSimpleOBJ(string filePath, int &nVertices)
 	// Desvincula o VAO (é uma boa prática desvincular qualquer buffer ou array para evitar bugs medonhos)
 	glBindVertexArray(0);
 
-	nVertices = vBuffer.size() / 2;
+	nVertices = mesh.nIndices();
+
+	//BVH dos triângulos, a partir dos mesmos vértices e índices enviados para a GPU
+	bvh.build(mesh);
+	cout << "BVH: " << bvh.nTriangles() << " triangulos, " << bvh.nNodes() << " nos, montagem " << bvh.buildMs << " ms" << endl;
 	return VAO;
 
 	}
@@ -0,0 +1,94 @@
+/* Conversor de malhas para o cache binário
+ *
+ * Percorre uma pasta (por padrão ../Modelos3D) e grava o arquivo .cgmesh ao lado de
+ * cada .obj, para que os exemplos já encontrem o cache válido na primeira execução.
+ * Caches ainda válidos são mantidos, a menos que --force seja usado.
+ *
+ * Uso: MeshBake [--force] [pasta ou arquivo.obj ...]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+
+using namespace std;
+
+#include "OBJLoader.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+
+int main(int argc, char** argv)
+{
+	bool force = false;
+	vector<string> inputs;
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "--force")
+			force = true;
+		else
+			inputs.push_back(arg);
+	}
+	if (inputs.empty())
+		inputs.push_back("../Modelos3D");
+
+	vector<filesystem::path> files;
+	for (const string& input : inputs)
+	{
+		if (filesystem::is_directory(input))
+		{
+			for (auto& entry : filesystem::recursive_directory_iterator(input))
+				if (entry.is_regular_file() && entry.path().extension() == ".obj")
+					files.push_back(entry.path());
+		}
+		else
+			files.push_back(input);
+	}
+	sort(files.begin(), files.end());
+
+	int baked = 0, kept = 0, failed = 0;
+	for (const auto& path : files)
+	{
+		string objPath = path.string();
+		CachedMesh cached;
+		if (!force && cached.openCache(objPath))
+		{
+			cout << "ok       " << objPath << endl;
+			kept++;
+			continue;
+		}
+
+		auto t0 = chrono::high_resolution_clock::now();
+		OBJData data;
+		IndexedMesh mesh;
+		bool ok = loadOBJ(objPath, data, 0);
+		if (ok)
+		{
+			buildIndexedMesh(data, mesh);
+			optimizeMesh(mesh);
+			buildLODs(mesh);
+			ok = writeMeshCache(objPath, mesh);
+		}
+		auto t1 = chrono::high_resolution_clock::now();
+
+		if (ok)
+		{
+			cout << "gerado   " << objPath << " (" << mesh.nVertices() << " vertices, "
+				<< mesh.nIndices() / 3 << " triangulos, " << fixed << setprecision(1)
+				<< chrono::duration<double, milli>(t1 - t0).count() << " ms)" << endl;
+			baked++;
+		}
+		else
+		{
+			cout << "ERRO     " << objPath << endl;
+			failed++;
+		}
+	}
+
+	cout << baked << " gerados, " << kept << " ja validos, " << failed << " com erro" << endl;
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+/* Conversor de texturas para o cache comprimido (BC1/BC3)
+ *
+ * Percorre uma pasta (por padrão ../Modelos3D) e grava o arquivo .cgtex ao lado de cada
+ * imagem: a cadeia de mipmaps inteira, filtrada na CPU (ver TextureMips.h) e comprimida
+ * em blocos nas threads do pool (ver TextureCompression.h). Para cada imagem mostra o
+ * PSNR do nível 0 contra o original, a memória de vídeo com e sem compressão e o tempo
+ * de leitura (decodificar a imagem com stb_image contra ler o .cgtex). Caches ainda
+ * válidos, no mesmo formato e com o mesmo filtro, são mantidos, a menos que --force
+ * seja usado.
+ *
+ * Uso: TextureBake [--force] [--filtro box|kaiser|lanczos] [--sem-compressao] [pasta ou imagem ...]
+ *   --filtro          filtro dos mipmaps (padrão kaiser)
+ *   --sem-compressao  grava a cadeia em RGBA8, como o AssetLoader faz sozinho
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+//STB_IMAGE
+#include <stb_image.h>
+
+#include "TextureCompression.h"
+#include "TextureMips.h"
+#include "Timing.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+static bool isImage(const filesystem::path& path)
+{
+	string extension = path.extension().string();
+	transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp" || extension == ".tga";
+}
+
+int main(int argc, char** argv)
+{
+	bool force = false, compress = true;
+	MipSettings settings;
+	vector<string> inputs;
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "--force")
+			force = true;
+		else if (arg == "--sem-compressao")
+			compress = false;
+		else if (arg == "--filtro" && i + 1 < argc)
+		{
+			string name = argv[++i];
+			if (name == "box")
+				settings.filter = MIP_BOX;
+			else if (name == "kaiser")
+				settings.filter = MIP_KAISER;
+			else if (name == "lanczos")
+				settings.filter = MIP_LANCZOS;
+			else
+			{
+				cout << "Filtro desconhecido: " << name << endl;
+				return 1;
+			}
+		}
+		else
+			inputs.push_back(arg);
+	}
+	if (inputs.empty())
+		inputs.push_back("../Modelos3D");
+
+	vector<filesystem::path> files;
+	for (const string& input : inputs)
+	{
+		if (filesystem::is_directory(input))
+		{
+			for (auto& entry : filesystem::recursive_directory_iterator(input))
+				if (entry.is_regular_file() && isImage(entry.path()))
+					files.push_back(entry.path());
+		}
+		else
+			files.push_back(input);
+	}
+	sort(files.begin(), files.end());
+
+	int baked = 0, kept = 0, failed = 0;
+	size_t rawBytes = 0, compressedBytes = 0;
+	cout << fixed;
+	for (const auto& path : files)
+	{
+		string imagePath = path.string();
+		TextureLevels texture;
+		if (!force && readTextureCache(imagePath, texture) && texture.compressed() == compress && texture.mipFilter == settings.filter)
+		{
+			cout << "ok       " << imagePath << endl;
+			rawBytes += rgba8ChainBytes(texture.width, texture.height);
+			compressedBytes += texture.bytes();
+			kept++;
+			continue;
+		}
+
+		auto t0 = Clock::now();
+		int width, height, channels;
+		unsigned char* pixels = stbi_load(imagePath.c_str(), &width, &height, &channels, 4);
+		double decodeMs = elapsedMs(t0);
+		if (!pixels)
+		{
+			cout << "ERRO     " << imagePath << endl;
+			failed++;
+			continue;
+		}
+
+		auto t1 = Clock::now();
+		TextureLevels mips;
+		generateMipChain(pixels, width, height, settings, mips);
+		double mipMs = elapsedMs(t1);
+		auto t2 = Clock::now();
+		if (compress)
+			compressTexture(mips, texture);
+		else
+			texture = move(mips);
+		double compressMs = elapsedMs(t2);
+		bool ok = writeTextureCache(imagePath, texture);
+
+		double psnr = INFINITY;
+		if (texture.compressed())
+		{
+			vector<unsigned char> decoded;
+			decompressImage(texture.level(0), width, height, texture.format, decoded);
+			psnr = computePSNR(pixels, decoded.data(), width, height, texture.format == BLOCK_BC3);
+		}
+		stbi_image_free(pixels);
+
+		auto t3 = Clock::now();
+		TextureLevels reread;
+		ok = ok && readTextureCache(imagePath, reread);
+		double readMs = elapsedMs(t3);
+
+		if (ok)
+		{
+			size_t raw = rgba8ChainBytes(width, height);
+			const char* format = texture.format == BLOCK_BC3 ? " BC3" : texture.format == BLOCK_BC1 ? " BC1" : " RGBA8";
+			cout << "gerado   " << imagePath << " (" << width << "x" << height << format << ", " << texture.levels.size()
+				<< " niveis " << mipFilterName(settings.filter) << ", PSNR " << setprecision(1) << psnr << " dB, "
+				<< raw / 1024 << " -> " << texture.bytes() / 1024 << " KB na GPU, mipmaps " << mipMs << " ms, compressao "
+				<< compressMs << " ms, leitura " << decodeMs << " ms -> " << readMs << " ms)" << endl;
+			rawBytes += raw;
+			compressedBytes += texture.bytes();
+			baked++;
+		}
+		else
+		{
+			cout << "ERRO     " << imagePath << endl;
+			failed++;
+		}
+	}
+
+	cout << baked << " gerados, " << kept << " ja validos, " << failed << " com erro; memoria de video "
+		<< rawBytes / 1024 << " -> " << compressedBytes / 1024 << " KB (" << (rawBytes - compressedBytes) / 1024
+		<< " KB economizados)" << endl;
+	return failed == 0 ? 0 : 1;
+}